@@ -0,0 +1,343 @@
+#include "app/CachedPipeline.h"
+
+#include "common/Hash.h"
+#include "common/MappedFile.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <fstream>
+#include <numeric>
+#include <optional>
+#include <system_error>
+#include <utility>
+
+namespace lumos::app {
+
+namespace {
+
+// Bumped whenever the key or the files of an entry change meaning.
+constexpr std::string_view kFormatTag = "lumos-result-cache 2";
+
+std::string hex(const std::uint64_t value) {
+    constexpr char kDigits[] = "0123456789abcdef";
+    std::string text(16, '0');
+    for (int index = 15, shift = 0; index >= 0; --index, shift += 4) {
+        text[static_cast<std::size_t>(index)] = kDigits[(value >> shift) & 0xF];
+    }
+    return text;
+}
+
+std::string shortest(const float value) {
+    char buffer[32];
+    const auto [end, error] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    return error == std::errc {} ? std::string(buffer, end) : std::to_string(value);
+}
+
+std::uint64_t nanosecondsSince(const std::chrono::steady_clock::time_point start) {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+// `path` with a unique tag before its extension, for a file renamed over `path` once complete.
+std::filesystem::path stagedPath(const std::filesystem::path& path) {
+    static std::atomic<std::uint64_t> staged_count {0};
+    std::filesystem::path staged = path;
+    staged.replace_extension(".tmp" + std::to_string(staged_count.fetch_add(1)) + path.extension().string());
+    return staged;
+}
+
+// Writes `bytes` aside and renames them over `to`, so `to` is always either the old file or the
+// whole new one, and never shares its data with another path.
+bool writeWhole(const std::string_view bytes, const std::filesystem::path& to) {
+    const std::filesystem::path staged = stagedPath(to);
+    {
+        std::ofstream output(staged, std::ios::binary | std::ios::trunc);
+        output.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        if (!output) {
+            output.close();
+            std::error_code error;
+            std::filesystem::remove(staged, error);
+            return false;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(staged, to, error);
+    if (error) {
+        std::filesystem::remove(staged, error);
+        return false;
+    }
+    return true;
+}
+
+// Copies `from` to `to` when its bytes still hash to `content`; returns the bytes written, or
+// nullopt when the file is missing, changed or cannot be copied.
+std::optional<std::uint64_t> copyVerified(
+    const std::filesystem::path& from,
+    const std::filesystem::path& to,
+    const std::uint64_t content) {
+    common::MappedFile file;
+    if (!file.open(from.string()) || common::hash64(file.view()) != content || !writeWhole(file.view(), to)) {
+        return std::nullopt;
+    }
+    return file.size();
+}
+
+}  // namespace
+
+std::string canonicalSettings(const contracts::EnhancementRequest& request) {
+    const int divisor = std::max(1, std::gcd(request.scale_factor, request.scale_denominator));
+    std::string text(kFormatTag);
+    text += ";scale=" + std::to_string(request.scale_factor / divisor) + "/" +
+            std::to_string(request.scale_denominator / divisor);
+    text += ";filter=" + std::string(contracts::toString(request.filter));
+    if (!request.denoise_enabled) {
+        text += ";denoise=off";
+    } else if (request.preset_name == contracts::kEdgePreservingPreset) {
+        text += ";denoise=guided:" + shortest(request.denoise_strength);
+    } else {
+        text += ";denoise=box";
+    }
+    text += ";sharpen=" + (request.sharpen_strength > 0.0f ? shortest(request.sharpen_strength) : std::string("off"));
+    text += ";encoding=" + std::string(contracts::toString(request.output_encoding));
+    if (request.preview_max_extent > 0) {
+        text += ";preview=" + std::to_string(request.preview_max_extent);
+    }
+    const contracts::ImageRegion& region = request.region;
+    if (!region.empty()) {
+        text += ";region=" + std::to_string(region.x) + "," + std::to_string(region.y) + "," + std::to_string(region.width) +
+                "x" + std::to_string(region.height);
+    }
+    return text;
+}
+
+CachedPipeline::CachedPipeline(contracts::IEnhancementPipeline& pipeline, ResultCacheOptions options)
+    : pipeline_(pipeline), options_(std::move(options)) {
+    std::error_code error;
+    std::filesystem::create_directories(options_.directory, error);
+    load();
+}
+
+contracts::EnhancementResult CachedPipeline::run(const contracts::EnhancementRequest& request) {
+    return run(request, {});
+}
+
+contracts::EnhancementResult CachedPipeline::run(
+    const contracts::EnhancementRequest& request,
+    const contracts::RunControl& control) {
+    if (control.cancelled()) {
+        return contracts::cancelledResult("validate");
+    }
+    // Requests the pipeline will reject, and inputs that cannot be read, go to it for the error.
+    if (!contracts::isValidRequest(request)) {
+        return pipeline_.run(request, control);
+    }
+    const auto start = std::chrono::steady_clock::now();
+    std::string key;
+    std::uint64_t input_bytes = 0;
+    {
+        common::MappedFile input;
+        if (!input.open(request.input_path)) {
+            return pipeline_.run(request, control);
+        }
+        input_bytes = input.size();
+        const std::uint64_t content = common::hash64(input.view());
+        key = hex(content) + hex(common::hash64(options_.salt + '\n' + canonicalSettings(request), content));
+    }
+
+    std::optional<Entry> hit;
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        const auto found = entries_.find(key);
+        if (found != entries_.end()) {
+            found->second.last_used = ++clock_;
+            hit = found->second;
+        }
+    }
+    if (hit.has_value()) {
+        const auto written = copyVerified(outputPath(key), request.output_path, hit->content);
+        if (written.has_value()) {
+            writeMeta(key, *hit);
+            contracts::EnhancementResult result;
+            result.ok = true;
+            result.output_path = request.output_path;
+            result.error = {contracts::ErrorCode::kNone, "none", {}};
+            contracts::EnhancementMetrics& metrics = result.metrics;
+            metrics.input_width = hit->input_width;
+            metrics.input_height = hit->input_height;
+            metrics.output_width = hit->output_width;
+            metrics.output_height = hit->output_height;
+            metrics.duration_ns = nanosecondsSince(start);
+            metrics.duration_ms = metrics.duration_ns / 1'000'000;
+            metrics.stages = {{"cache", metrics.duration_ns}};
+            metrics.bytes_read = input_bytes;
+            metrics.bytes_written = *written;
+            const double seconds = static_cast<double>(std::max<std::uint64_t>(1, metrics.duration_ns)) / 1e9;
+            metrics.megapixels_per_second =
+                static_cast<double>(hit->output_width) * static_cast<double>(hit->output_height) / 1e6 / seconds;
+            metrics.threads = 1;
+            metrics.cache_hit = true;
+            metrics.cache_saved_ns = hit->duration_ns > metrics.duration_ns ? hit->duration_ns - metrics.duration_ns : 0;
+            control.report("cache", 1.0);
+            const std::lock_guard<std::mutex> lock(mutex_);
+            ++stats_.hits;
+            stats_.saved_ns += metrics.cache_saved_ns;
+            return result;
+        }
+        // Evicted meanwhile, or damaged on disk: run the request and store it afresh.
+        const std::lock_guard<std::mutex> lock(mutex_);
+        removeEntry(key);
+    }
+
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.misses;
+    }
+    // Written aside and renamed over the old output only once the run succeeds, so a failed or
+    // cancelled run leaves the old output as it was.
+    contracts::EnhancementRequest staged = request;
+    staged.output_path = stagedPath(request.output_path).string();
+    contracts::EnhancementResult result = pipeline_.run(staged, control);
+    std::error_code error;
+    if (result.ok) {
+        std::filesystem::rename(staged.output_path, request.output_path, error);
+        if (error) {
+            result = {};
+            result.error = {contracts::ErrorCode::kEncodeFailed, "encode", "failed to move the output into place"};
+        }
+    }
+    if (!result.ok) {
+        std::filesystem::remove(staged.output_path, error);
+        return result;
+    }
+    result.output_path = request.output_path;
+
+    Entry entry {
+        .bytes = 0,
+        .content = 0,
+        .duration_ns = result.metrics.duration_ns,
+        .last_used = 0,
+        .input_width = result.metrics.input_width,
+        .input_height = result.metrics.input_height,
+        .output_width = result.metrics.output_width,
+        .output_height = result.metrics.output_height,
+    };
+    common::MappedFile output;
+    if (!output.open(request.output_path) || output.size() > options_.max_bytes) {
+        return result;
+    }
+    entry.bytes = output.size();
+    entry.content = common::hash64(output.view());
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        if (entries_.contains(key)) {
+            return result;
+        }
+        entry.last_used = ++clock_;
+    }
+    if (!writeWhole(output.view(), outputPath(key)) || !writeMeta(key, entry)) {
+        std::filesystem::remove(outputPath(key), error);
+        std::filesystem::remove(metaPath(key), error);
+        return result;
+    }
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (entries_.emplace(key, entry).second) {
+        ++stats_.entries;
+        stats_.bytes += entry.bytes;
+        evict();
+    }
+    return result;
+}
+
+ResultCacheStats CachedPipeline::stats() const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+std::filesystem::path CachedPipeline::outputPath(const std::string& key) const {
+    return options_.directory / (key + ".ppm");
+}
+
+std::filesystem::path CachedPipeline::metaPath(const std::string& key) const {
+    return options_.directory / (key + ".meta");
+}
+
+void CachedPipeline::load() {
+    std::error_code error;
+    for (const auto& file : std::filesystem::directory_iterator(options_.directory, error)) {
+        const std::filesystem::path& path = file.path();
+        if (path.extension() != ".meta") {
+            continue;
+        }
+        const std::string key = path.stem().string();
+        std::ifstream meta(path);
+        std::string tag;
+        Entry entry;
+        std::getline(meta, tag);
+        meta >> entry.bytes >> entry.content >> entry.duration_ns >> entry.last_used >> entry.input_width >> entry.input_height >>
+            entry.output_width >> entry.output_height;
+        std::error_code size_error;
+        const bool valid = meta && tag == kFormatTag && std::filesystem::file_size(outputPath(key), size_error) == entry.bytes &&
+                           !size_error;
+        meta.close();
+        if (!valid) {
+            std::filesystem::remove(outputPath(key), size_error);
+            std::filesystem::remove(path, size_error);
+            continue;
+        }
+        clock_ = std::max(clock_, entry.last_used);
+        entries_.emplace(key, entry);
+        ++stats_.entries;
+        stats_.bytes += entry.bytes;
+    }
+    evict();
+}
+
+bool CachedPipeline::writeMeta(const std::string& key, const Entry& entry) const {
+    // Written aside and renamed over the old one, so a reader never sees half a file.
+    const std::filesystem::path path = metaPath(key);
+    const std::filesystem::path staged = stagedPath(path);
+    {
+        std::ofstream meta(staged, std::ios::trunc);
+        meta << kFormatTag << '\n'
+             << entry.bytes << ' ' << entry.content << ' ' << entry.duration_ns << ' ' << entry.last_used << ' '
+             << entry.input_width << ' ' << entry.input_height << ' ' << entry.output_width << ' ' << entry.output_height << '\n';
+        if (!meta) {
+            return false;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(staged, path, error);
+    if (error) {
+        std::filesystem::remove(staged, error);
+        return false;
+    }
+    return true;
+}
+
+void CachedPipeline::removeEntry(const std::string& key) {
+    const auto found = entries_.find(key);
+    if (found == entries_.end()) {
+        return;
+    }
+    --stats_.entries;
+    stats_.bytes -= found->second.bytes;
+    entries_.erase(found);
+    std::error_code error;
+    std::filesystem::remove(metaPath(key), error);
+    std::filesystem::remove(outputPath(key), error);
+}
+
+void CachedPipeline::evict() {
+    while (stats_.bytes > options_.max_bytes && !entries_.empty()) {
+        const auto oldest = std::min_element(entries_.begin(), entries_.end(), [](const auto& left, const auto& right) {
+            return left.second.last_used < right.second.last_used;
+        });
+        const std::string key = oldest->first;
+        removeEntry(key);
+        ++stats_.evictions;
+    }
+}
+
+}  // namespace lumos::app
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "contracts/EnhancementTypes.h"
+#include "contracts/IEnhancementPipeline.h"
+#include "contracts/RunControl.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace lumos::app {
+
+struct ResultCacheOptions {
+    // Directory holding the cached outputs; created when missing.
+    std::filesystem::path directory {};
+    // Bytes of cached outputs kept; the least recently used go first once this is exceeded.
+    std::uint64_t max_bytes {std::uint64_t {1} << 30};
+    // Mixed into every key. Change it whenever the wrapped pipeline's configuration changes what it
+    // writes, so results made before stop matching.
+    std::string salt {};
+};
+
+struct ResultCacheStats {
+    std::uint64_t hits {0};
+    std::uint64_t misses {0};
+    std::uint64_t evictions {0};
+    std::uint64_t entries {0};
+    std::uint64_t bytes {0};
+    // Run time of the cached results served, less the time serving them took.
+    std::uint64_t saved_ns {0};
+};
+
+// The settings of `request` that decide its output, as text: paths are left out, the scale is
+// reduced to lowest terms and the parameters of stages the request skips are dropped, so requests
+// that produce the same output from the same input give the same text.
+[[nodiscard]] std::string canonicalSettings(const contracts::EnhancementRequest& request);
+
+// Serves repeated requests from an on-disk cache of earlier outputs, keyed by a hash of the input
+// file's bytes and of its canonical settings. A hit copies the cached output to the request's
+// output path instead of running the wrapped pipeline, once its bytes still match the hash stored
+// with it; a miss runs it into a file beside the output, renamed over the output only once the run
+// succeeds, and copies the new output into the cache. Outputs and entries never share data, so
+// writing over either leaves the other intact. Entries survive restarts and are evicted least
+// recently used first once the cache exceeds its size cap. Thread-safe.
+class CachedPipeline final : public contracts::IEnhancementPipeline {
+  public:
+    CachedPipeline(contracts::IEnhancementPipeline& pipeline, ResultCacheOptions options);
+
+    contracts::EnhancementResult run(const contracts::EnhancementRequest& request) override;
+    contracts::EnhancementResult run(const contracts::EnhancementRequest& request, const contracts::RunControl& control) override;
+
+    [[nodiscard]] ResultCacheStats stats() const;
+
+  private:
+    struct Entry {
+        std::uint64_t bytes {0};
+        // Hash of the cached output's bytes, checked before it is served.
+        std::uint64_t content {0};
+        std::uint64_t duration_ns {0};
+        std::uint64_t last_used {0};
+        int input_width {0};
+        int input_height {0};
+        int output_width {0};
+        int output_height {0};
+    };
+
+    [[nodiscard]] std::filesystem::path outputPath(const std::string& key) const;
+    [[nodiscard]] std::filesystem::path metaPath(const std::string& key) const;
+    void load();
+    bool writeMeta(const std::string& key, const Entry& entry) const;
+    void removeEntry(const std::string& key);
+    // Drops the least recently used entries until the cache fits its cap. Called with mutex_ held.
+    void evict();
+
+    contracts::IEnhancementPipeline& pipeline_;
+    ResultCacheOptions options_;
+    std::map<std::string, Entry> entries_;
+    ResultCacheStats stats_ {};
+    std::uint64_t clock_ {0};
+    mutable std::mutex mutex_;
+};
+
+}  // namespace lumos::app
@@ -1,15 +1,95 @@
 #include "app/EnhancementController.h"
 
+#include <atomic>
+#include <cstdint>
+#include <exception>
 #include <filesystem>
-#include <fstream>
 #include <map>
+#include <memory>
+#include <random>
 #include <string>
+#include <system_error>
 #include <utility>
 
 namespace lumos::app {
 
-EnhancementController::EnhancementController(contracts::IEnhancementPipeline& pipeline, common::Telemetry& telemetry)
-    : pipeline_(pipeline), telemetry_(telemetry) {}
+namespace {
+
+// `path` with `tag` inserted before its extension.
+std::string taggedPath(const std::string& path, const char* tag) {
+    std::filesystem::path output(path);
+    const std::filesystem::path extension = output.extension();
+    output.replace_extension(tag);
+    output += extension;
+    return output.string();
+}
+
+// A preview file of its own under the temporary directory, so a preview never overwrites or
+// removes a file in the user's output folder. Unique across runs and, through a random token,
+// across instances of the app.
+std::string previewPath(const std::string& output_path) {
+    static const std::uint64_t process_token = std::random_device {}();
+    static std::atomic<std::uint64_t> preview_count {0};
+    std::error_code error;
+    const std::filesystem::path output(output_path);
+    std::filesystem::path directory = std::filesystem::temp_directory_path(error) / "lumos_previews";
+    if (!error) {
+        std::filesystem::create_directories(directory, error);
+    }
+    if (error) {
+        directory = output.parent_path();
+    }
+    return (directory / (output.stem().string() + ".preview-" + std::to_string(process_token) + "-" +
+                         std::to_string(preview_count.fetch_add(1)) + output.extension().string()))
+        .string();
+}
+
+// What a run is for, on every event it emits, so previews and viewports do not count as enhancements.
+std::string runMode(const contracts::EnhancementRequest& request) {
+    if (request.preview_max_extent > 0) {
+        return "preview";
+    }
+    return request.region.empty() ? "full" : "viewport";
+}
+
+// Removes `path` when it goes out of scope, however the scope is left.
+struct RemoveOnExit {
+    std::string path;
+
+    ~RemoveOnExit() {
+        std::error_code error;
+        std::filesystem::remove(path, error);
+    }
+};
+
+}  // namespace
+
+contracts::EnhancementRequest previewRequestFor(const contracts::EnhancementRequest& request, const int max_extent) {
+    contracts::EnhancementRequest preview = request;
+    preview.preview_max_extent = max_extent;
+    preview.output_path = previewPath(request.output_path);
+    return preview;
+}
+
+contracts::EnhancementRequest viewportRequestFor(
+    const contracts::EnhancementRequest& request,
+    const contracts::ImageRegion& region) {
+    contracts::EnhancementRequest viewport = request;
+    viewport.region = region;
+    viewport.output_path = taggedPath(request.output_path, ".viewport");
+    return viewport;
+}
+
+EnhancementController::EnhancementController(
+    contracts::IEnhancementPipeline& pipeline,
+    common::Telemetry& telemetry,
+    common::ThreadPool& pool)
+    : pipeline_(pipeline), telemetry_(telemetry), pool_(pool) {}
+
+EnhancementController::~EnhancementController() {
+    std::unique_lock<std::mutex> lock(jobs_mutex_);
+    jobs_done_.wait(lock, [this] { return jobs_in_flight_ == 0; });
+}
 
 void EnhancementController::trackInputSelected(const std::string& input_path) {
     if (input_path.empty()) {
@@ -21,54 +101,84 @@ void EnhancementController::trackInputSelected(const std::string& input_path) {
         {"input_ext", std::filesystem::path(input_path).extension().string()},
     };
 
-    const auto [width, height] = inspectPpmDimensions(input_path);
-    if (width > 0 && height > 0) {
-        fields["input_width"] = std::to_string(width);
-        fields["input_height"] = std::to_string(height);
+    if (const auto probe = probeInput(input_path)) {
+        fields["input_width"] = std::to_string(probe->header.width);
+        fields["input_height"] = std::to_string(probe->header.height);
     }
 
     telemetry_.track("input_selected", std::move(fields));
 }
 
 contracts::EnhancementResult EnhancementController::runEnhancement(const contracts::EnhancementRequest& request) {
-    const auto [width, height] = inspectPpmDimensions(request.input_path);
-    if (width > 0 && height > 0) {
+    return runEnhancement(request, {});
+}
+
+contracts::EnhancementResult EnhancementController::runEnhancement(
+    const contracts::EnhancementRequest& request,
+    const contracts::RunControl& control) {
+    const std::string mode = runMode(request);
+    if (const auto probe = probeInput(request.input_path)) {
         telemetry_.track(
             "image_imported",
             {
+                {"mode", mode},
                 {"input_path", request.input_path},
                 {"input_ext", std::filesystem::path(request.input_path).extension().string()},
-                {"input_width", std::to_string(width)},
-                {"input_height", std::to_string(height)},
+                {"input_width", std::to_string(probe->header.width)},
+                {"input_height", std::to_string(probe->header.height)},
             });
     }
 
     telemetry_.track(
         "enhance_clicked",
         {
+            {"mode", mode},
             {"input_path", request.input_path},
             {"output_path", request.output_path},
             {"scale_factor", std::to_string(request.scale_factor)},
+            {"scale_denominator", std::to_string(request.scale_denominator)},
+            {"filter", std::string(contracts::toString(request.filter))},
             {"denoise_enabled", request.denoise_enabled ? "true" : "false"},
+            {"denoise_strength", std::to_string(request.denoise_strength)},
             {"preset_name", request.preset_name},
+            {"sharpen_strength", std::to_string(request.sharpen_strength)},
+            {"output_encoding", std::string(contracts::toString(request.output_encoding))},
         });
 
-    contracts::EnhancementResult result = pipeline_.run(request);
+    contracts::EnhancementResult result = pipeline_.run(request, control);
     if (result.ok) {
-        telemetry_.track(
-            "enhance_completed",
-            {
-                {"output_path", result.output_path},
-                {"duration_ms", std::to_string(result.metrics.duration_ms)},
-                {"output_width", std::to_string(result.metrics.output_width)},
-                {"output_height", std::to_string(result.metrics.output_height)},
-            });
+        const contracts::EnhancementMetrics& metrics = result.metrics;
+        std::map<std::string, std::string> fields {
+            {"mode", mode},
+            {"output_path", result.output_path},
+            {"duration_ms", std::to_string(metrics.duration_ms)},
+            {"duration_ns", std::to_string(metrics.duration_ns)},
+            {"output_width", std::to_string(metrics.output_width)},
+            {"output_height", std::to_string(metrics.output_height)},
+            {"bytes_read", std::to_string(metrics.bytes_read)},
+            {"bytes_written", std::to_string(metrics.bytes_written)},
+            {"megapixels_per_second", std::to_string(metrics.megapixels_per_second)},
+            {"peak_buffer_bytes", std::to_string(metrics.peak_buffer_bytes)},
+            {"threads", std::to_string(metrics.threads)},
+            {"cache_hit", metrics.cache_hit ? "true" : "false"},
+            {"cache_saved_ns", std::to_string(metrics.cache_saved_ns)},
+        };
+        // One stage_<name>_ns field per stage; a stage that runs more than once is summed.
+        std::map<std::string, std::uint64_t> stage_ns;
+        for (const contracts::StageMetrics& stage : metrics.stages) {
+            stage_ns["stage_" + stage.name + "_ns"] += stage.duration_ns;
+        }
+        for (const auto& [name, duration_ns] : stage_ns) {
+            fields.emplace(name, std::to_string(duration_ns));
+        }
+        telemetry_.track("enhance_completed", std::move(fields));
         return result;
     }
 
     telemetry_.track(
         "enhance_failed",
         {
+            {"mode", mode},
             {"stage", result.error.stage},
             {"error_code", std::string(contracts::toString(result.error.code))},
             {"message", result.error.message},
@@ -77,27 +187,68 @@ contracts::EnhancementResult EnhancementController::runEnhancement(const contrac
     return result;
 }
 
-std::future<contracts::EnhancementResult> EnhancementController::runEnhancementAsync(contracts::EnhancementRequest request) {
-    return std::async(std::launch::async, [this, request = std::move(request)]() { return runEnhancement(request); });
-}
-
-std::pair<int, int> EnhancementController::inspectPpmDimensions(const std::string& input_path) {
-    std::ifstream input(input_path, std::ios::in);
-    if (!input.good()) {
-        return {0, 0};
+std::future<contracts::EnhancementResult> EnhancementController::runEnhancementAsync(
+    contracts::EnhancementRequest request,
+    contracts::RunControl control) {
+    {
+        const std::lock_guard<std::mutex> lock(jobs_mutex_);
+        ++jobs_in_flight_;
     }
+    return pool_.submit([this, request = std::move(request), control = std::move(control)]() {
+        const JobFinished finished {*this};
+        return runEnhancement(request, control);
+    });
+}
 
-    std::string magic;
-    int width = 0;
-    int height = 0;
-    int max_value = 0;
+EnhancementController::JobFinished::~JobFinished() {
+    const std::lock_guard<std::mutex> lock(controller.jobs_mutex_);
+    --controller.jobs_in_flight_;
+    controller.jobs_done_.notify_all();
+}
 
-    input >> magic >> width >> height >> max_value;
-    if (magic != "P3" || width <= 0 || height <= 0 || max_value <= 0) {
-        return {0, 0};
+ProgressiveRun EnhancementController::runProgressiveAsync(
+    contracts::EnhancementRequest request,
+    const int preview_max_extent,
+    contracts::RunControl control) {
+    auto preview = std::make_shared<std::promise<contracts::EnhancementResult>>();
+    ProgressiveRun run;
+    run.preview = preview->get_future();
+    {
+        const std::lock_guard<std::mutex> lock(jobs_mutex_);
+        ++jobs_in_flight_;
     }
+    run.full = pool_.submit([this, preview, preview_max_extent, request = std::move(request), control = std::move(control)]() {
+        const JobFinished finished {*this};
+        const contracts::EnhancementRequest preview_request = previewRequestFor(request, preview_max_extent);
+        // A preview at step 1 would be the full run done twice, so the full result stands in for it.
+        const auto probe = probeInput(request.input_path);
+        if (!probe || contracts::previewStep(probe->header.width, probe->header.height, preview_request) <= 1) {
+            try {
+                contracts::EnhancementResult result = runEnhancement(request, control);
+                preview->set_value(result);
+                return result;
+            } catch (...) {
+                preview->set_exception(std::current_exception());
+                throw;
+            }
+        }
+        const RemoveOnExit preview_file {preview_request.output_path};
+        try {
+            preview->set_value(runEnhancement(preview_request, control));
+        } catch (...) {
+            preview->set_exception(std::current_exception());
+        }
+        return runEnhancement(request, control);
+    });
+    return run;
+}
 
-    return {width, height};
+std::optional<engine::ImageProbe> EnhancementController::probeInput(const std::string& input_path) {
+    engine::ImageProbe probe;
+    if (!engine::probeImage(input_path, &probe)) {
+        return std::nullopt;
+    }
+    return probe;
 }
 
 }  // namespace lumos::app
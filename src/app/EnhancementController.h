@@ -1,26 +1,80 @@
 #pragma once
 
 #include "common/Telemetry.h"
+#include "common/ThreadPool.h"
 #include "contracts/IEnhancementPipeline.h"
+#include "engine/ImageProbe.h"
 
+#include <condition_variable>
 #include <future>
-#include <utility>
+#include <mutex>
+#include <optional>
+#include <string>
 
 namespace lumos::app {
 
+// `request` as a preview whose output fits `max_extent` pixels on each side, written to a file of
+// its own under the temporary directory.
+[[nodiscard]] contracts::EnhancementRequest previewRequestFor(const contracts::EnhancementRequest& request, int max_extent);
+// `request` cut to `region` of its output, such as the viewport of a zoomed compare view, written
+// next to the full-resolution output with ".viewport" before the extension.
+[[nodiscard]] contracts::EnhancementRequest viewportRequestFor(
+    const contracts::EnhancementRequest& request,
+    const contracts::ImageRegion& region);
+
+// The two results of a progressive run.
+struct ProgressiveRun {
+    std::future<contracts::EnhancementResult> preview;
+    // Started once the preview is done.
+    std::future<contracts::EnhancementResult> full;
+};
+
 class EnhancementController {
   public:
-    EnhancementController(contracts::IEnhancementPipeline& pipeline, common::Telemetry& telemetry);
+    // Asynchronous runs go to `pool`, so at most its worker count run at once however many are queued.
+    EnhancementController(
+        contracts::IEnhancementPipeline& pipeline,
+        common::Telemetry& telemetry,
+        common::ThreadPool& pool = common::ThreadPool::shared());
+    // Waits for the asynchronous runs still queued or in flight.
+    ~EnhancementController();
+
+    EnhancementController(const EnhancementController&) = delete;
+    EnhancementController& operator=(const EnhancementController&) = delete;
 
     void trackInputSelected(const std::string& input_path);
     contracts::EnhancementResult runEnhancement(const contracts::EnhancementRequest& request);
-    std::future<contracts::EnhancementResult> runEnhancementAsync(contracts::EnhancementRequest request);
+    contracts::EnhancementResult runEnhancement(const contracts::EnhancementRequest& request, const contracts::RunControl& control);
+    std::future<contracts::EnhancementResult> runEnhancementAsync(
+        contracts::EnhancementRequest request,
+        contracts::RunControl control = {});
+    // Runs the preview of `request` for `preview_max_extent` and then `request` itself as one
+    // asynchronous job, so the preview is ready long before the full-resolution result that replaces
+    // it; the preview file is removed once the full run ends, however it ends. When the preview would
+    // be full resolution anyway, or the input cannot be read, only the full run is made and both
+    // futures get its result. Cancelling `control` stops whichever is running; a failed preview does
+    // not stop the full run. Every event of a run carries its mode: "full", "preview" or "viewport".
+    ProgressiveRun runProgressiveAsync(
+        contracts::EnhancementRequest request,
+        int preview_max_extent,
+        contracts::RunControl control = {});
+
+    // Header of the input at `input_path`; nullopt when it is not an image the engine can read.
+    [[nodiscard]] static std::optional<engine::ImageProbe> probeInput(const std::string& input_path);
 
   private:
-    static std::pair<int, int> inspectPpmDimensions(const std::string& input_path);
+    // Drops an asynchronous job from jobs_in_flight_ however it ends, after its last use of the controller.
+    struct JobFinished {
+        EnhancementController& controller;
+        ~JobFinished();
+    };
 
     contracts::IEnhancementPipeline& pipeline_;
     common::Telemetry& telemetry_;
+    common::ThreadPool& pool_;
+    std::mutex jobs_mutex_;
+    std::condition_variable jobs_done_;
+    int jobs_in_flight_ {0};
 };
 
 }  // namespace lumos::app
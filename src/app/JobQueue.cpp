@@ -0,0 +1,303 @@
+#include "app/JobQueue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <system_error>
+#include <utility>
+
+namespace lumos::app {
+
+namespace {
+
+constexpr const char* kJournalTag = "lumos-job-queue 1";
+// Longest path or preset name read back from a journal.
+constexpr std::size_t kMaxJournalText = std::size_t {1} << 16;
+
+// Strings are written as <size>:<bytes> so paths may hold spaces and newlines.
+void writeText(std::ostream& out, const std::string& text) {
+    out << text.size() << ':' << text << ' ';
+}
+
+bool readText(std::istream& in, std::string& text) {
+    std::size_t size = 0;
+    char colon = 0;
+    if (!(in >> size >> colon) || colon != ':' || size > kMaxJournalText) {
+        return false;
+    }
+    text.resize(size);
+    return static_cast<bool>(in.read(text.data(), static_cast<std::streamsize>(size)));
+}
+
+void writeJob(std::ostream& out, const JobPriority priority, const contracts::EnhancementRequest& request) {
+    out << static_cast<int>(priority) << ' ';
+    writeText(out, request.input_path);
+    writeText(out, request.output_path);
+    writeText(out, request.preset_name);
+    out << request.scale_factor << ' ' << request.scale_denominator << ' ' << static_cast<int>(request.filter) << ' '
+        << request.denoise_enabled << ' ' << request.denoise_strength << ' ' << request.sharpen_strength << ' '
+        << static_cast<int>(request.output_encoding) << ' ' << request.preview_max_extent << ' ' << request.region.x << ' '
+        << request.region.y << ' ' << request.region.width << ' ' << request.region.height << '\n';
+}
+
+bool readJob(std::istream& in, JobPriority& priority, contracts::EnhancementRequest& request) {
+    int priority_value = 0;
+    int filter = 0;
+    int encoding = 0;
+    if (!(in >> priority_value) || !readText(in, request.input_path) || !readText(in, request.output_path) ||
+        !readText(in, request.preset_name) ||
+        !(in >> request.scale_factor >> request.scale_denominator >> filter >> request.denoise_enabled >>
+          request.denoise_strength >> request.sharpen_strength >> encoding >> request.preview_max_extent >> request.region.x >>
+          request.region.y >> request.region.width >> request.region.height)) {
+        return false;
+    }
+    if (priority_value < static_cast<int>(JobPriority::kBatch) || priority_value > static_cast<int>(JobPriority::kInteractive)) {
+        return false;
+    }
+    priority = static_cast<JobPriority>(priority_value);
+    request.filter = static_cast<contracts::ResampleFilter>(filter);
+    request.output_encoding = static_cast<contracts::OutputEncoding>(encoding);
+    return true;
+}
+
+}  // namespace
+
+std::size_t estimateJobBytes(const contracts::EnhancementRequest& request) {
+    const auto probe = EnhancementController::probeInput(request.input_path);
+    return probe ? engine::estimateCost(*probe, request).workingSetBytes() : 0;
+}
+
+JobQueue::JobQueue(EnhancementController& controller, JobQueueOptions options, common::ThreadPool& pool)
+    : controller_(controller), options_(std::move(options)), pool_(pool) {
+    options_.max_concurrent = std::max(1, options_.max_concurrent);
+    if (!options_.estimate_bytes) {
+        options_.estimate_bytes = estimateJobBytes;
+    }
+    if (options_.journal.empty()) {
+        return;
+    }
+    // A damaged entry ends the read; the jobs before it are kept.
+    std::vector<std::pair<JobPriority, contracts::EnhancementRequest>> saved;
+    std::ifstream journal(options_.journal, std::ios::binary);
+    std::string tag;
+    if (std::getline(journal, tag) && tag == kJournalTag) {
+        JobPriority priority {};
+        contracts::EnhancementRequest request;
+        while (readJob(journal, priority, request)) {
+            saved.emplace_back(priority, request);
+        }
+    }
+    journal.close();
+    for (auto& [priority, request] : saved) {
+        enqueue(std::move(request), priority);
+    }
+}
+
+JobQueue::~JobQueue() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    closing_ = true;
+    for (auto& [id, job] : jobs_) {
+        if (job.status.state == JobState::kQueued) {
+            job.status.state = JobState::kCancelled;
+        } else if (job.status.state == JobState::kRunning) {
+            job.control.cancellation.cancel();
+        }
+    }
+    waiting_.clear();
+    changed_.wait(lock, [this] { return running_ == 0; });
+}
+
+JobQueue::WaitingKey JobQueue::waitingKey(const Job& job) {
+    return {-static_cast<int>(job.status.priority), job.status.id};
+}
+
+JobId JobQueue::enqueue(contracts::EnhancementRequest request, const JobPriority priority) {
+    // Reads the input header, so keep it outside the lock.
+    const std::size_t bytes = options_.estimate_bytes(request);
+    const std::lock_guard<std::mutex> lock(mutex_);
+    const JobId id = next_id_++;
+    Job& job = jobs_[id];
+    job.status.id = id;
+    job.status.priority = priority;
+    job.request = std::move(request);
+    job.bytes = bytes;
+    job.control.progress = [this, id](const std::string_view stage, const double fraction) {
+        const std::lock_guard<std::mutex> progress_lock(mutex_);
+        const auto found = jobs_.find(id);
+        if (found != jobs_.end()) {
+            found->second.status.stage = stage;
+            found->second.status.progress = fraction;
+        }
+    };
+    waiting_.insert(waitingKey(job));
+    startReady();
+    saveJournal();
+    return id;
+}
+
+bool JobQueue::cancel(const JobId id) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    const auto found = jobs_.find(id);
+    if (found == jobs_.end()) {
+        return false;
+    }
+    if (found->second.status.state == JobState::kRunning) {
+        found->second.control.cancellation.cancel();
+        return true;
+    }
+    if (found->second.status.state != JobState::kQueued) {
+        return false;
+    }
+    waiting_.erase(waitingKey(found->second));
+    found->second.status.state = JobState::kCancelled;
+    retire(found->second);
+    // The cancelled job may have been holding back smaller ones behind it.
+    startReady();
+    changed_.notify_all();
+    return true;
+}
+
+bool JobQueue::reprioritize(const JobId id, const JobPriority priority) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    const auto found = jobs_.find(id);
+    if (found == jobs_.end() || found->second.status.state != JobState::kQueued) {
+        return false;
+    }
+    waiting_.erase(waitingKey(found->second));
+    found->second.status.priority = priority;
+    waiting_.insert(waitingKey(found->second));
+    startReady();
+    saveJournal();
+    return true;
+}
+
+std::optional<JobStatus> JobQueue::status(const JobId id) const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    const auto found = jobs_.find(id);
+    if (found == jobs_.end()) {
+        return std::nullopt;
+    }
+    return found->second.status;
+}
+
+std::vector<JobStatus> JobQueue::jobs() const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<JobStatus> statuses;
+    statuses.reserve(jobs_.size());
+    for (const auto& [id, job] : jobs_) {
+        statuses.push_back(job.status);
+    }
+    return statuses;
+}
+
+int JobQueue::runningCount() const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return running_;
+}
+
+void JobQueue::waitIdle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    changed_.wait(lock, [this] { return running_ == 0 && waiting_.empty(); });
+}
+
+void JobQueue::startReady() {
+    while (running_ < options_.max_concurrent && !waiting_.empty()) {
+        const JobId id = waiting_.begin()->second;
+        Job& job = jobs_[id];
+        if (running_ > 0 && running_bytes_ + job.bytes > options_.memory_budget_bytes) {
+            return;
+        }
+        waiting_.erase(waiting_.begin());
+        job.status.state = JobState::kRunning;
+        ++running_;
+        running_bytes_ += job.bytes;
+        static_cast<void>(pool_.submit([this, id] { run(id); }));
+    }
+}
+
+void JobQueue::retire(Job& job) {
+    // Only the status is read from here on.
+    job.request = {};
+    job.control = {};
+    finished_.push_back(job.status.id);
+    while (finished_.size() > options_.finished_history) {
+        jobs_.erase(finished_.front());
+        finished_.pop_front();
+    }
+    saveJournal();
+}
+
+void JobQueue::saveJournal() const {
+    if (options_.journal.empty() || closing_) {
+        return;
+    }
+    // Running jobs first, then the waiting ones in the order they would start, so a queue rebuilt
+    // from the journal starts them in the same order. Written aside and renamed over the old one.
+    static std::atomic<std::uint64_t> staged_count {0};
+    std::filesystem::path staged = options_.journal;
+    staged += ".tmp" + std::to_string(staged_count.fetch_add(1));
+    {
+        std::ofstream journal(staged, std::ios::binary | std::ios::trunc);
+        journal.precision(std::numeric_limits<float>::max_digits10);
+        journal << kJournalTag << '\n';
+        for (const auto& [id, job] : jobs_) {
+            if (job.status.state == JobState::kRunning) {
+                writeJob(journal, job.status.priority, job.request);
+            }
+        }
+        for (const auto& [order, id] : waiting_) {
+            const Job& job = jobs_.at(id);
+            writeJob(journal, job.status.priority, job.request);
+        }
+        journal.close();
+        if (!journal) {
+            std::error_code error;
+            std::filesystem::remove(staged, error);
+            return;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(staged, options_.journal, error);
+    if (error) {
+        std::filesystem::remove(staged, error);
+    }
+}
+
+void JobQueue::run(const JobId id) {
+    contracts::EnhancementRequest request;
+    contracts::RunControl control;
+    {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        request = jobs_[id].request;
+        control = jobs_[id].control;
+    }
+
+    contracts::EnhancementResult result;
+    try {
+        result = controller_.runEnhancement(request, control);
+    } catch (const std::exception& ex) {
+        result.error = {contracts::ErrorCode::kProcessFailed, "job", ex.what()};
+    } catch (...) {
+        // Anything else must still end the job below, or waitIdle() and the destructor never return.
+        result.error = {contracts::ErrorCode::kProcessFailed, "job", "unknown error"};
+    }
+
+    const std::lock_guard<std::mutex> lock(mutex_);
+    Job& job = jobs_[id];
+    if (result.ok) {
+        job.status.state = JobState::kSucceeded;
+    } else {
+        job.status.state = result.error.code == contracts::ErrorCode::kCancelled ? JobState::kCancelled : JobState::kFailed;
+    }
+    job.status.result = std::move(result);
+    --running_;
+    running_bytes_ -= job.bytes;
+    retire(job);
+    startReady();
+    changed_.notify_all();
+}
+
+}  // namespace lumos::app
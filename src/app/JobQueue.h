@@ -0,0 +1,156 @@
+#pragma once
+
+#include "app/EnhancementController.h"
+#include "common/ThreadPool.h"
+#include "contracts/EnhancementTypes.h"
+#include "contracts/RunControl.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace lumos::app {
+
+// Higher runs first; jobs of equal priority run in the order they were queued.
+enum class JobPriority {
+    kBatch,
+    kNormal,
+    kInteractive,
+};
+
+enum class JobState {
+    kQueued,
+    kRunning,
+    kSucceeded,
+    kFailed,
+    kCancelled,
+};
+
+inline std::string_view toString(const JobState state) noexcept {
+    switch (state) {
+        case JobState::kQueued:
+            return "queued";
+        case JobState::kRunning:
+            return "running";
+        case JobState::kSucceeded:
+            return "succeeded";
+        case JobState::kFailed:
+            return "failed";
+        case JobState::kCancelled:
+            return "cancelled";
+    }
+    return "unknown";
+}
+
+using JobId = std::uint64_t;
+
+struct JobStatus {
+    JobId id {0};
+    JobPriority priority {JobPriority::kNormal};
+    JobState state {JobState::kQueued};
+    // Stage the pipeline last reported and the fraction of it done.
+    std::string stage {};
+    double progress {0.0};
+    // Set once the job has succeeded, failed or been cancelled while running.
+    contracts::EnhancementResult result {};
+};
+
+struct JobQueueOptions {
+    // Jobs running at once.
+    int max_concurrent {2};
+    // Sum of the estimated working sets of the running jobs; a job that alone exceeds it still
+    // runs, but only by itself.
+    std::size_t memory_budget_bytes {std::size_t {4} << 30};
+    // Working-set estimate per job; empty uses estimateJobBytes.
+    std::function<std::size_t(const contracts::EnhancementRequest&)> estimate_bytes {};
+    // Finished jobs kept for status() and jobs(); older ones are forgotten.
+    std::size_t finished_history {64};
+    // File the queued and running jobs are saved to after every change; empty keeps them in memory
+    // only. Jobs found in it when the queue is built are queued again in their old order.
+    std::filesystem::path journal {};
+};
+
+// Input plus output frame of a request, sized from the channels, depth and dimensions in the input's
+// header; 0 when the header cannot be read.
+[[nodiscard]] std::size_t estimateJobBytes(const contracts::EnhancementRequest& request);
+
+// Thread-safe queue of enhancement requests run through the controller on a thread pool. The
+// highest-priority queued job starts whenever a slot and enough of the memory budget are free;
+// while it waits for memory no job behind it starts, so large jobs are not starved. With a journal,
+// jobs not finished when the process ends, running ones included, are run by the next queue built
+// on it; finished jobs are not saved.
+class JobQueue {
+  public:
+    JobQueue(EnhancementController& controller, JobQueueOptions options = {}, common::ThreadPool& pool = common::ThreadPool::shared());
+    // Cancels every job and waits for the running ones to stop; the journal keeps them for the next
+    // queue.
+    ~JobQueue();
+
+    JobQueue(const JobQueue&) = delete;
+    JobQueue& operator=(const JobQueue&) = delete;
+
+    JobId enqueue(contracts::EnhancementRequest request, JobPriority priority = JobPriority::kNormal);
+
+    // Removes a queued job, or asks a running one to stop at its next cancellation check; false
+    // once the job has ended or been forgotten.
+    bool cancel(JobId id);
+    // Only queued jobs can be reprioritized.
+    bool reprioritize(JobId id, JobPriority priority);
+
+    // nullopt for an unknown id or a finished job that has dropped out of the history.
+    [[nodiscard]] std::optional<JobStatus> status(JobId id) const;
+    // Queued and running jobs and the most recent finished ones, in the order they were queued.
+    [[nodiscard]] std::vector<JobStatus> jobs() const;
+    [[nodiscard]] int runningCount() const;
+
+    // Blocks until no job is queued or running.
+    void waitIdle();
+
+  private:
+    struct Job {
+        JobStatus status {};
+        contracts::EnhancementRequest request {};
+        contracts::RunControl control {};
+        std::size_t bytes {0};
+    };
+    // Orders the waiting jobs: highest priority first, then queue order (ids only grow).
+    using WaitingKey = std::pair<int, JobId>;
+
+    static WaitingKey waitingKey(const Job& job);
+    // Called with mutex_ held.
+    void startReady();
+    // Called with mutex_ held once `job` has reached its final state.
+    void retire(Job& job);
+    // Called with mutex_ held after the queued or running jobs change.
+    void saveJournal() const;
+    void run(JobId id);
+
+    EnhancementController& controller_;
+    JobQueueOptions options_ {};
+    common::ThreadPool& pool_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable changed_;
+    std::map<JobId, Job> jobs_;
+    std::set<WaitingKey> waiting_;
+    // Finished jobs still in jobs_, oldest first.
+    std::deque<JobId> finished_;
+    JobId next_id_ {1};
+    int running_ {0};
+    std::size_t running_bytes_ {0};
+    // Set by the destructor, so the jobs it cancels stay in the journal.
+    bool closing_ {false};
+};
+
+}  // namespace lumos::app
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+namespace lumos::common {
+
+// Blocking first-in first-out queue holding at most `capacity` items, for handing work between
+// threads without letting a fast producer run ahead of a slow consumer.
+template <typename T>
+class BoundedQueue {
+  public:
+    explicit BoundedQueue(const std::size_t capacity) : capacity_(capacity > 0 ? capacity : 1) {}
+
+    // Waits for room; false, dropping `item`, once the queue is closed.
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_full_.wait(lock, [this] { return closed_ || items_.size() < capacity_; });
+        if (closed_) {
+            return false;
+        }
+        items_.push_back(std::move(item));
+        not_empty_.notify_one();
+        return true;
+    }
+
+    // Waits for an item; empty once the queue is closed and drained.
+    std::optional<T> pop() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+        if (items_.empty()) {
+            return std::nullopt;
+        }
+        T item = std::move(items_.front());
+        items_.pop_front();
+        not_full_.notify_one();
+        return item;
+    }
+
+    // Wakes every waiter; pushes fail from now on and pops drain what is left.
+    void close() {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        not_full_.notify_all();
+        not_empty_.notify_all();
+    }
+
+  private:
+    std::mutex mutex_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+    std::deque<T> items_;
+    std::size_t capacity_ {1};
+    bool closed_ {false};
+};
+
+}  // namespace lumos::common
@@ -0,0 +1,89 @@
+#include "common/Hash.h"
+
+#include <cstddef>
+#include <cstring>
+
+namespace lumos::common {
+
+namespace {
+
+constexpr std::uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+constexpr std::uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr std::uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+constexpr std::uint64_t kPrime4 = 0x85EBCA77C2B2AE63ULL;
+constexpr std::uint64_t kPrime5 = 0x27D4EB2F165667C5ULL;
+
+constexpr std::uint64_t rotateLeft(const std::uint64_t value, const int bits) noexcept {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+std::uint64_t read64(const char* bytes) noexcept {
+    std::uint64_t value = 0;
+    std::memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+std::uint32_t read32(const char* bytes) noexcept {
+    std::uint32_t value = 0;
+    std::memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+constexpr std::uint64_t round(std::uint64_t accumulator, const std::uint64_t input) noexcept {
+    accumulator += input * kPrime2;
+    return rotateLeft(accumulator, 31) * kPrime1;
+}
+
+constexpr std::uint64_t mergeRound(const std::uint64_t accumulator, const std::uint64_t lane) noexcept {
+    return (accumulator ^ round(0, lane)) * kPrime1 + kPrime4;
+}
+
+}  // namespace
+
+std::uint64_t hash64(const std::string_view bytes, const std::uint64_t seed) noexcept {
+    const char* cursor = bytes.data();
+    const char* const end = cursor + bytes.size();
+    std::uint64_t hash = 0;
+
+    if (bytes.size() >= 32) {
+        // Four independent lanes over 32-byte stripes.
+        std::uint64_t lanes[4] = {seed + kPrime1 + kPrime2, seed + kPrime2, seed, seed - kPrime1};
+        const char* const last_stripe = end - 32;
+        do {
+            for (std::size_t lane = 0; lane < 4; ++lane) {
+                lanes[lane] = round(lanes[lane], read64(cursor + lane * 8));
+            }
+            cursor += 32;
+        } while (cursor <= last_stripe);
+        hash = rotateLeft(lanes[0], 1) + rotateLeft(lanes[1], 7) + rotateLeft(lanes[2], 12) + rotateLeft(lanes[3], 18);
+        for (const std::uint64_t lane : lanes) {
+            hash = mergeRound(hash, lane);
+        }
+    } else {
+        hash = seed + kPrime5;
+    }
+    hash += static_cast<std::uint64_t>(bytes.size());
+
+    for (; end - cursor >= 8; cursor += 8) {
+        hash ^= round(0, read64(cursor));
+        hash = rotateLeft(hash, 27) * kPrime1 + kPrime4;
+    }
+    if (end - cursor >= 4) {
+        hash ^= static_cast<std::uint64_t>(read32(cursor)) * kPrime1;
+        hash = rotateLeft(hash, 23) * kPrime2 + kPrime3;
+        cursor += 4;
+    }
+    for (; cursor < end; ++cursor) {
+        hash ^= static_cast<std::uint64_t>(static_cast<unsigned char>(*cursor)) * kPrime5;
+        hash = rotateLeft(hash, 11) * kPrime1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= kPrime2;
+    hash ^= hash >> 29;
+    hash *= kPrime3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+}  // namespace lumos::common
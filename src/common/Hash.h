@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace lumos::common {
+
+// XXH64 of `bytes`: a non-cryptographic 64-bit hash that runs at memory bandwidth, for keying
+// content. Words are read little-endian, so big-endian hosts produce different values.
+[[nodiscard]] std::uint64_t hash64(std::string_view bytes, std::uint64_t seed = 0) noexcept;
+
+}  // namespace lumos::common
@@ -0,0 +1,146 @@
+#include "common/MappedFile.h"
+
+#include <utility>
+
+#if defined(_WIN32)
+#include <filesystem>
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace lumos::common {
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)),
+      open_(std::exchange(other.open_, false)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        open_ = std::exchange(other.open_, false);
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+#if defined(_WIN32)
+    const std::filesystem::path native_path(path);
+    HANDLE file = CreateFileW(
+        native_path.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER file_size {};
+    if (!GetFileSizeEx(file, &file_size)) {
+        CloseHandle(file);
+        return false;
+    }
+
+    if (file_size.QuadPart == 0) {
+        CloseHandle(file);
+        open_ = true;
+        return true;
+    }
+
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr) {
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (view == nullptr) {
+        return false;
+    }
+
+    data_ = static_cast<const char*>(view);
+    size_ = static_cast<std::size_t>(file_size.QuadPart);
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat file_stat {};
+    if (::fstat(fd, &file_stat) != 0 || !S_ISREG(file_stat.st_mode)) {
+        ::close(fd);
+        return false;
+    }
+
+    if (file_stat.st_size == 0) {
+        ::close(fd);
+        open_ = true;
+        return true;
+    }
+
+    const auto file_size = static_cast<std::size_t>(file_stat.st_size);
+    void* view = ::mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    ::madvise(view, file_size, MADV_SEQUENTIAL);
+
+    data_ = static_cast<const char*>(view);
+    size_ = file_size;
+#endif
+
+    open_ = true;
+    return true;
+}
+
+void MappedFile::close() noexcept {
+    if (data_ != nullptr) {
+#if defined(_WIN32)
+        UnmapViewOfFile(data_);
+#else
+        ::munmap(const_cast<char*>(data_), size_);
+#endif
+    }
+    data_ = nullptr;
+    size_ = 0;
+    open_ = false;
+}
+
+bool MappedFile::isOpen() const noexcept {
+    return open_;
+}
+
+const char* MappedFile::data() const noexcept {
+    return data_;
+}
+
+std::size_t MappedFile::size() const noexcept {
+    return size_;
+}
+
+std::string_view MappedFile::view() const noexcept {
+    return {data_, size_};
+}
+
+}  // namespace lumos::common
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace lumos::common {
+
+// Read-only view of a whole file mapped into memory. Move-only; unmaps on destruction.
+class MappedFile {
+  public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool open(const std::string& path);
+    void close() noexcept;
+
+    [[nodiscard]] bool isOpen() const noexcept;
+    [[nodiscard]] const char* data() const noexcept;
+    [[nodiscard]] std::size_t size() const noexcept;
+    [[nodiscard]] std::string_view view() const noexcept;
+
+  private:
+    const char* data_ {nullptr};
+    std::size_t size_ {0};
+    bool open_ {false};
+};
+
+}  // namespace lumos::common
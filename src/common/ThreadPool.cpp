@@ -0,0 +1,172 @@
+#include "common/ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+namespace lumos::common {
+
+namespace {
+
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local std::size_t current_worker = 0;
+
+// One parallelFor call, shared with the helpers it posts; helpers that start after the call has
+// returned find no index left and never touch `task`.
+struct ParallelLoop {
+    int count {0};
+    const std::function<void(int)>* task {nullptr};
+    std::atomic<int> next {0};
+    std::atomic<int> finished {0};
+    std::atomic<bool> failed {false};
+    std::mutex mutex;
+    std::condition_variable done;
+    std::exception_ptr failure;
+
+    void drain() {
+        for (int index = next.fetch_add(1); index < count; index = next.fetch_add(1)) {
+            if (!failed.load(std::memory_order_relaxed)) {
+                try {
+                    (*task)(index);
+                } catch (...) {
+                    const std::lock_guard<std::mutex> lock(mutex);
+                    if (!failure) {
+                        failure = std::current_exception();
+                    }
+                    failed.store(true, std::memory_order_relaxed);
+                }
+            }
+            if (finished.fetch_add(1) + 1 == count) {
+                const std::lock_guard<std::mutex> lock(mutex);
+                done.notify_all();
+            }
+        }
+    }
+};
+
+}  // namespace
+
+ThreadPool::ThreadPool(const int workers) {
+    const int count = workers > 0 ? workers : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    queues_.reserve(static_cast<std::size_t>(count));
+    for (int index = 0; index < count; ++index) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    workers_.reserve(static_cast<std::size_t>(count));
+    for (std::size_t index = 0; index < queues_.size(); ++index) {
+        workers_.emplace_back([this, index] { workerLoop(index); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        const std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+int ThreadPool::workerCount() const noexcept {
+    return static_cast<int>(workers_.size());
+}
+
+bool ThreadPool::onWorkerThread() const noexcept {
+    return current_pool == this;
+}
+
+void ThreadPool::post(std::function<void()> task) {
+    std::size_t home = 0;
+    {
+        const std::lock_guard<std::mutex> lock(sleep_mutex_);
+        ++pending_;
+        home = onWorkerThread() ? current_worker : next_queue_++ % queues_.size();
+    }
+    {
+        Queue& queue = *queues_[home];
+        const std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    wake_.notify_one();
+}
+
+bool ThreadPool::runOne(const std::size_t home) {
+    std::function<void()> task;
+    for (std::size_t offset = 0; offset < queues_.size() && !task; ++offset) {
+        Queue& queue = *queues_[(home + offset) % queues_.size()];
+        const std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            continue;
+        }
+        // Newest from our own deque, oldest from anyone else's.
+        if (offset == 0) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+    }
+    if (!task) {
+        return false;
+    }
+    {
+        const std::lock_guard<std::mutex> lock(sleep_mutex_);
+        --pending_;
+    }
+    task();
+    return true;
+}
+
+void ThreadPool::workerLoop(const std::size_t index) {
+    current_pool = this;
+    current_worker = index;
+    for (;;) {
+        if (runOne(index)) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        wake_.wait(lock, [this] { return stopping_ || pending_ > 0; });
+        if (stopping_ && pending_ == 0) {
+            return;
+        }
+    }
+}
+
+void ThreadPool::parallelFor(const int count, const std::function<void(int)>& task, const int max_parallel) {
+    if (count <= 0) {
+        return;
+    }
+    const int parallel = max_parallel > 0 ? max_parallel : workerCount() + 1;
+    const int helpers = std::min({count, parallel, workerCount() + 1}) - 1;
+    if (helpers <= 0) {
+        for (int index = 0; index < count; ++index) {
+            task(index);
+        }
+        return;
+    }
+
+    const auto loop = std::make_shared<ParallelLoop>();
+    loop->count = count;
+    loop->task = &task;
+    for (int helper = 0; helper < helpers; ++helper) {
+        post([loop] { loop->drain(); });
+    }
+    loop->drain();
+    {
+        std::unique_lock<std::mutex> lock(loop->mutex);
+        loop->done.wait(lock, [&] { return loop->finished.load() == count; });
+    }
+    if (loop->failure) {
+        std::rethrow_exception(loop->failure);
+    }
+}
+
+}  // namespace lumos::common
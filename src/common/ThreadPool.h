@@ -0,0 +1,73 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace lumos::common {
+
+// Fixed set of worker threads, each with a deque of its own. A worker runs its newest task first
+// and, once its deque is empty, steals the oldest task of another worker, so work a task spawns
+// stays with the thread that has its data in cache. Tasks submitted from outside the pool are
+// dealt to the workers in turn. The destructor runs every queued task, then joins the workers.
+class ThreadPool {
+  public:
+    // `workers` threads; 0 uses every hardware thread.
+    explicit ThreadPool(int workers = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Pool shared by the controller and the engine, one worker per hardware thread.
+    [[nodiscard]] static ThreadPool& shared();
+
+    [[nodiscard]] int workerCount() const noexcept;
+    // True when called from one of this pool's workers.
+    [[nodiscard]] bool onWorkerThread() const noexcept;
+
+    // Queues `function`; its result, or the exception it throws, arrives through the future.
+    template <typename Function>
+    [[nodiscard]] auto submit(Function&& function) -> std::future<std::invoke_result_t<std::decay_t<Function>&>> {
+        using Result = std::invoke_result_t<std::decay_t<Function>&>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function));
+        std::future<Result> result = task->get_future();
+        post([task] { (*task)(); });
+        return result;
+    }
+
+    // Calls task(0) .. task(count - 1) on up to `max_parallel` threads at once (0: every worker and
+    // the caller) and returns once all have finished. The calling thread takes indices as well, so
+    // a task may call parallelFor on the same pool without waiting on itself. Rethrows the first
+    // exception a task throws; indices not started by then are skipped.
+    void parallelFor(int count, const std::function<void(int)>& task, int max_parallel = 0);
+
+  private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void post(std::function<void()> task);
+    bool runOne(std::size_t home);
+    void workerLoop(std::size_t index);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    // Queued tasks not yet taken; raised before a task is queued, so it never undercounts.
+    std::size_t pending_ {0};
+    std::size_t next_queue_ {0};
+    bool stopping_ {false};
+};
+
+}  // namespace lumos::common
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace lumos::contracts {
 
@@ -12,6 +14,7 @@ enum class ErrorCode {
     kDecodeFailed,
     kProcessFailed,
     kEncodeFailed,
+    kCancelled,
 };
 
 inline std::string_view toString(const ErrorCode code) noexcept {
@@ -26,16 +29,122 @@ inline std::string_view toString(const ErrorCode code) noexcept {
             return "process_failed";
         case ErrorCode::kEncodeFailed:
             return "encode_failed";
+        case ErrorCode::kCancelled:
+            return "cancelled";
     }
     return "unknown";
 }
 
+// How the output raster is written. kMatchInput keeps the input's ASCII/binary encoding so a
+// binary workflow never round-trips through text.
+enum class OutputEncoding {
+    kMatchInput = 0,
+    kAscii,
+    kBinary,
+};
+
+inline std::string_view toString(const OutputEncoding encoding) noexcept {
+    switch (encoding) {
+        case OutputEncoding::kMatchInput:
+            return "match_input";
+        case OutputEncoding::kAscii:
+            return "ascii";
+        case OutputEncoding::kBinary:
+            return "binary";
+    }
+    return "unknown";
+}
+
+// Reconstruction filter for upscaling. kNearest replicates pixels; the others are separable
+// filters of support 1 (bilinear), 2 (bicubic, a = -0.5) and 3 (Lanczos-3) input pixels.
+enum class ResampleFilter {
+    kNearest = 0,
+    kBilinear,
+    kBicubic,
+    kLanczos3,
+};
+
+inline std::string_view toString(const ResampleFilter filter) noexcept {
+    switch (filter) {
+        case ResampleFilter::kNearest:
+            return "nearest";
+        case ResampleFilter::kBilinear:
+            return "bilinear";
+        case ResampleFilter::kBicubic:
+            return "bicubic";
+        case ResampleFilter::kLanczos3:
+            return "lanczos3";
+    }
+    return "unknown";
+}
+
+inline constexpr int kMaxScaleFactor = 8;
+
+// Presets selectable through EnhancementRequest::preset_name. The default denoise is the box blur;
+// kEdgePreservingPreset swaps in the guided filter, which keeps edges the box blur would smear.
+inline constexpr std::string_view kDefaultPreset = "default";
+inline constexpr std::string_view kEdgePreservingPreset = "edge_preserving";
+
+// A rectangle of an image in pixels; empty, meaning the whole image, while either side is 0.
+struct ImageRegion {
+    int x {0};
+    int y {0};
+    int width {0};
+    int height {0};
+
+    [[nodiscard]] bool empty() const noexcept { return width <= 0 || height <= 0; }
+};
+
 struct EnhancementRequest {
     std::string input_path {};
     std::string output_path {};
+    // The output is scale_factor / scale_denominator times the input in each dimension.
     int scale_factor {2};
+    int scale_denominator {1};
+    ResampleFilter filter {ResampleFilter::kNearest};
     bool denoise_enabled {false};
-    std::string preset_name {"default"};
+    // Edge-preserving denoise strength in [0, 1]; 0 leaves the image unchanged.
+    float denoise_strength {0.5f};
+    std::string preset_name {std::string(kDefaultPreset)};
+    // Halo-clamped unsharp-mask amount applied after upscaling, in [0, 2]; 0 skips the stage.
+    float sharpen_strength {0.0f};
+    OutputEncoding output_encoding {OutputEncoding::kMatchInput};
+    // When positive, the run is a preview: the input is decoded keeping every step-th row and column,
+    // with the smallest step that keeps both sides of the output within this many pixels.
+    int preview_max_extent {0};
+    // When not empty, only this rectangle of the output is made and written, with the pixels a run of
+    // the whole image writes there; the input is decoded only as far as it and the stage halos reach.
+    ImageRegion region {};
+};
+
+// Output extent for an input extent of `size`: size * scale_factor / scale_denominator, rounded to
+// nearest and at least 1.
+inline int scaledExtent(const int size, const EnhancementRequest& request) noexcept {
+    const auto numerator = static_cast<std::int64_t>(size) * request.scale_factor;
+    const auto scaled = (2 * numerator + request.scale_denominator) / (2 * static_cast<std::int64_t>(request.scale_denominator));
+    return scaled < 1 ? 1 : static_cast<int>(scaled);
+}
+
+// Decode step of `request` for a width x height input; 1 unless the request is a preview whose
+// full-resolution output would not fit its extent.
+inline int previewStep(const int width, const int height, const EnhancementRequest& request) noexcept {
+    if (request.preview_max_extent <= 0) {
+        return 1;
+    }
+    const std::int64_t longest = std::max(scaledExtent(width, request), scaledExtent(height, request));
+    return static_cast<int>((longest + request.preview_max_extent - 1) / request.preview_max_extent);
+}
+
+// Whether `region` is empty or lies within a width x height image.
+inline bool regionWithin(const ImageRegion& region, const int width, const int height) noexcept {
+    return region.empty() || (region.x <= width - region.width && region.y <= height - region.height);
+}
+
+// Time one stage of a run took. Row stages that run in parallel tiles are summed over threads, so
+// together they can exceed the run's duration.
+struct StageMetrics {
+    std::string name {};
+    std::uint64_t duration_ns {0};
 };
 
 struct EnhancementMetrics {
@@ -44,6 +153,21 @@ struct EnhancementMetrics {
     int output_width {0};
     int output_height {0};
     std::uint64_t duration_ms {0};
+    std::uint64_t duration_ns {0};
+    // Decode, each row stage that ran, in order, then encode.
+    std::vector<StageMetrics> stages {};
+    // Bytes of the input file decoded and of the output file written.
+    std::uint64_t bytes_read {0};
+    std::uint64_t bytes_written {0};
+    // Output megapixels per second of duration.
+    double megapixels_per_second {0.0};
+    // Most bytes of pixel buffers (frames, tile buffers, streaming bands) held at once.
+    std::uint64_t peak_buffer_bytes {0};
+    // Most threads the run's stages used at once.
+    int threads {0};
+    // Whether a result cache served the output, and the run time it saved.
+    bool cache_hit {false};
+    std::uint64_t cache_saved_ns {0};
 };
 
 struct EnhancementError {
@@ -74,9 +198,48 @@ inline bool isValidRequest(const EnhancementRequest& request, std::string* reaso
         return false;
     }
 
-    if (request.scale_factor != 2 && request.scale_factor != 4 && request.scale_factor != 8) {
+    // Widened so a huge numerator or denominator cannot overflow the ratio check.
+    const std::int64_t factor = request.scale_factor;
+    const std::int64_t denominator = request.scale_denominator;
+    if (factor < 1 || denominator < 1 || factor > kMaxScaleFactor * denominator || denominator > kMaxScaleFactor * factor) {
+        if (reason != nullptr) {
+            *reason = "scale_factor / scale_denominator must be between 1/8 and 8";
+        }
+        return false;
+    }
+
+    if (!(request.denoise_strength >= 0.0f && request.denoise_strength <= 1.0f)) {
+        if (reason != nullptr) {
+            *reason = "denoise_strength must be between 0 and 1";
+        }
+        return false;
+    }
+
+    if (!(request.sharpen_strength >= 0.0f && request.sharpen_strength <= 2.0f)) {
+        if (reason != nullptr) {
+            *reason = "sharpen_strength must be between 0 and 2";
+        }
+        return false;
+    }
+
+    if (request.preset_name != kDefaultPreset && request.preset_name != kEdgePreservingPreset) {
+        if (reason != nullptr) {
+            *reason = "preset_name must be \"default\" or \"edge_preserving\"";
+        }
+        return false;
+    }
+
+    if (request.preview_max_extent < 0) {
+        if (reason != nullptr) {
+            *reason = "preview_max_extent must not be negative";
+        }
+        return false;
+    }
+
+    const ImageRegion& region = request.region;
+    if (region.x < 0 || region.y < 0 || region.width < 0 || region.height < 0 || (region.width == 0) != (region.height == 0)) {
         if (reason != nullptr) {
-            *reason = "scale_factor must be one of: 2, 4, 8";
+            *reason = "region must have a non-negative origin and either no size or a positive width and height";
         }
         return false;
     }
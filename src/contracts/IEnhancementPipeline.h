@@ -1,6 +1,7 @@
 #pragma once
 
 #include "contracts/EnhancementTypes.h"
+#include "contracts/RunControl.h"
 
 namespace lumos::contracts {
 
@@ -8,6 +9,15 @@ class IEnhancementPipeline {
   public:
     virtual ~IEnhancementPipeline() = default;
     virtual EnhancementResult run(const EnhancementRequest& request) = 0;
+
+    // Runs `request`, reporting progress to and stopping when cancelled through `control`.
+    // Pipelines that cannot stop part way only check for cancellation before they start.
+    virtual EnhancementResult run(const EnhancementRequest& request, const RunControl& control) {
+        if (control.cancelled()) {
+            return cancelledResult("validate");
+        }
+        return run(request);
+    }
 };
 
 }  // namespace lumos::contracts
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "contracts/EnhancementTypes.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace lumos::contracts {
+
+// Flag a caller raises to stop a run part way; copies share the flag.
+class CancellationToken {
+  public:
+    CancellationToken() : flag_(std::make_shared<std::atomic<bool>>(false)) {}
+
+    void cancel() const noexcept { flag_->store(true, std::memory_order_relaxed); }
+    [[nodiscard]] bool isCancelled() const noexcept { return flag_->load(std::memory_order_relaxed); }
+
+  private:
+    std::shared_ptr<std::atomic<bool>> flag_;
+};
+
+// Receives the fraction of `stage` finished so far, in [0, 1]. Calls for one run never overlap
+// but may come from any thread.
+using ProgressSink = std::function<void(std::string_view stage, double fraction)>;
+
+// What a caller can do to a run while it is in flight.
+struct RunControl {
+    CancellationToken cancellation {};
+    ProgressSink progress {};
+
+    [[nodiscard]] bool cancelled() const noexcept { return cancellation.isCancelled(); }
+
+    void report(const std::string_view stage, const double fraction) const {
+        if (progress) {
+            progress(stage, fraction);
+        }
+    }
+};
+
+inline EnhancementResult cancelledResult(std::string stage) {
+    EnhancementResult result {};
+    result.error.code = ErrorCode::kCancelled;
+    result.error.stage = std::move(stage);
+    result.error.message = "run cancelled";
+    return result;
+}
+
+}  // namespace lumos::contracts
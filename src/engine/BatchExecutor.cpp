@@ -0,0 +1,148 @@
+#include "engine/BatchExecutor.h"
+
+#include "common/BoundedQueue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace lumos::engine {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// A request between stages; `alive` until a stage fails or cancels it, after which the remaining
+// stages pass it on untouched so results still arrive in order.
+struct Slot {
+    std::size_t index {0};
+    PipelineFrame frame {};
+    bool alive {false};
+    bool holds_pixels {false};
+};
+
+// Counts the frames holding pixels and remembers the most at once.
+class FrameCounter {
+  public:
+    void add() {
+        const int now = live_.fetch_add(1) + 1;
+        for (int seen = peak_.load(); now > seen && !peak_.compare_exchange_weak(seen, now);) {
+        }
+    }
+    void remove() { live_.fetch_sub(1); }
+    [[nodiscard]] int peak() const noexcept { return peak_.load(); }
+
+  private:
+    std::atomic<int> live_ {0};
+    std::atomic<int> peak_ {0};
+};
+
+// Runs one stage on a slot, turning an exception into a failed result for that request alone.
+template <typename Stage>
+void runStage(Slot& slot, const char* stage_name, StageUtilization& utilization, Stage&& stage) {
+    const auto start = Clock::now();
+    try {
+        slot.alive = stage(&slot.frame);
+    } catch (const std::exception& ex) {
+        slot.frame.result = {};
+        slot.frame.result.error = {contracts::ErrorCode::kProcessFailed, stage_name, ex.what()};
+        slot.frame.pixels = Gray8Image {};
+        slot.frame.source.reset();
+        slot.alive = false;
+    }
+    utilization.busy += Clock::now() - start;
+}
+
+template <typename T>
+std::optional<T> timedPop(common::BoundedQueue<T>& queue, Clock::duration& waited) {
+    const auto start = Clock::now();
+    std::optional<T> item = queue.pop();
+    waited += Clock::now() - start;
+    return item;
+}
+
+template <typename T>
+void timedPush(common::BoundedQueue<T>& queue, T item, Clock::duration& waited) {
+    const auto start = Clock::now();
+    queue.push(std::move(item));
+    waited += Clock::now() - start;
+}
+
+}  // namespace
+
+double StageUtilization::busyFraction(const std::chrono::steady_clock::duration wall) const noexcept {
+    if (wall.count() <= 0) {
+        return 0.0;
+    }
+    return std::chrono::duration<double>(busy).count() / std::chrono::duration<double>(wall).count();
+}
+
+BatchExecutor::BatchExecutor(const Pipeline& pipeline, const BatchOptions options)
+    : pipeline_(pipeline), options_(options) {}
+
+BatchReport BatchExecutor::run(const std::vector<contracts::EnhancementRequest>& requests, const contracts::RunControl& control) const {
+    BatchReport report;
+    report.results.resize(requests.size());
+    const auto start = Clock::now();
+    const auto depth = static_cast<std::size_t>(std::max(1, options_.queue_depth));
+    common::BoundedQueue<Slot> decoded(depth);
+    common::BoundedQueue<Slot> enhanced(depth);
+    FrameCounter frames;
+    // Stages share the token but not the sink; only the batch as a whole reports progress.
+    contracts::RunControl stage_control;
+    stage_control.cancellation = control.cancellation;
+
+    std::thread decoder([&] {
+        for (std::size_t index = 0; index < requests.size(); ++index) {
+            Slot slot {.index = index};
+            runStage(slot, "decode", report.decode, [&](PipelineFrame* frame) {
+                return pipeline_.decode(requests[index], stage_control, frame);
+            });
+            slot.holds_pixels = slot.alive && !slot.frame.plan.streamed;
+            if (slot.holds_pixels) {
+                frames.add();
+            }
+            timedPush(decoded, std::move(slot), report.decode.blocked);
+        }
+        decoded.close();
+    });
+
+    std::thread encoder([&] {
+        std::size_t finished = 0;
+        while (std::optional<Slot> slot = timedPop(enhanced, report.encode.starved)) {
+            if (slot->alive) {
+                runStage(*slot, "encode", report.encode, [&](PipelineFrame* frame) { return pipeline_.encode(stage_control, frame); });
+            }
+            if (slot->holds_pixels) {
+                frames.remove();
+            }
+            report.results[slot->index] = std::move(slot->frame.result);
+            control.report("batch", static_cast<double>(++finished) / static_cast<double>(requests.size()));
+        }
+    });
+
+    while (std::optional<Slot> slot = timedPop(decoded, report.enhance.starved)) {
+        if (slot->alive) {
+            runStage(*slot, "enhance", report.enhance, [&](PipelineFrame* frame) { return pipeline_.enhance(stage_control, frame); });
+            if (!slot->alive && slot->holds_pixels) {
+                frames.remove();
+                slot->holds_pixels = false;
+            }
+        }
+        timedPush(enhanced, std::move(*slot), report.enhance.blocked);
+    }
+    enhanced.close();
+
+    decoder.join();
+    encoder.join();
+    report.wall = Clock::now() - start;
+    report.peak_frames = frames.peak();
+    return report;
+}
+
+}  // namespace lumos::engine
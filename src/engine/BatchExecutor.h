@@ -0,0 +1,61 @@
+#pragma once
+
+#include "contracts/EnhancementTypes.h"
+#include "contracts/RunControl.h"
+#include "engine/Pipeline.h"
+
+#include <chrono>
+#include <vector>
+
+namespace lumos::engine {
+
+struct BatchOptions {
+    // Frames waiting between two stages. At most one frame per stage plus the queued ones hold
+    // pixels at once: 3 + 2 * queue_depth.
+    int queue_depth {1};
+};
+
+// How one stage of a batch spent its time. The stage busy for nearly all of the batch is the one
+// holding the others back.
+struct StageUtilization {
+    std::chrono::steady_clock::duration busy {};
+    // Waiting for the stage before it to hand over a frame.
+    std::chrono::steady_clock::duration starved {};
+    // Waiting for room in the queue to the stage after it.
+    std::chrono::steady_clock::duration blocked {};
+
+    [[nodiscard]] double busyFraction(std::chrono::steady_clock::duration wall) const noexcept;
+};
+
+struct BatchReport {
+    // One result per request, in request order.
+    std::vector<contracts::EnhancementResult> results {};
+    std::chrono::steady_clock::duration wall {};
+    StageUtilization decode {};
+    StageUtilization enhance {};
+    StageUtilization encode {};
+    // Most frames holding pixels at the same time.
+    int peak_frames {0};
+};
+
+// Runs a batch through the pipeline's decode, enhance and encode stages on three threads joined by
+// bounded queues, so request N + 1 decodes while request N is enhanced and request N - 1 encoded.
+// Decode and encode, which mostly wait on the disk, get a thread each; enhance runs on the calling
+// thread and spreads its tiles over the thread pool. Every request produces exactly what
+// Pipeline::run would.
+class BatchExecutor {
+  public:
+    explicit BatchExecutor(const Pipeline& pipeline, BatchOptions options = {});
+
+    // Reports "batch" progress as requests finish. Cancelling stops every stage at its next check
+    // and marks the requests not yet finished as cancelled.
+    [[nodiscard]] BatchReport run(
+        const std::vector<contracts::EnhancementRequest>& requests,
+        const contracts::RunControl& control = {}) const;
+
+  private:
+    const Pipeline& pipeline_;
+    BatchOptions options_ {};
+};
+
+}  // namespace lumos::engine
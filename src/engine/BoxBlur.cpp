@@ -0,0 +1,242 @@
+#include "engine/BoxBlur.h"
+
+#include "engine/KernelRegistry.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace lumos::engine {
+
+namespace {
+
+// Maps a row or column index outside [0, size) back into the image.
+int borderIndex(int index, const int size, const BorderMode border) noexcept {
+    if (border != BorderMode::kMirror) {
+        return std::clamp(index, 0, size - 1);
+    }
+    if (size == 1) {
+        return 0;
+    }
+    const int period = 2 * (size - 1);
+    index %= period;
+    if (index < 0) {
+        index += period;
+    }
+    return index < size ? index : period - index;
+}
+
+// Extends one row by `radius` border pixels per side into `padded`, so the summing kernel needs
+// no edge handling, then takes its horizontal box sums.
+template <typename T, typename Sum>
+void horizontalSums(
+    const BoxRowSumsFn<T, Sum> row_sums,
+    const T* source,
+    const int width,
+    const std::size_t step,
+    const int radius,
+    const BorderMode border,
+    std::vector<T>& padded,
+    std::vector<Sum>& prefix,
+    Sum* sums) {
+    const std::size_t row_samples = static_cast<std::size_t>(width) * step;
+    const std::size_t edge = static_cast<std::size_t>(radius) * step;
+    for (int x = -radius; x < 0; ++x) {
+        const T* pixel = source + static_cast<std::size_t>(borderIndex(x, width, border)) * step;
+        std::copy_n(pixel, step, padded.data() + static_cast<std::size_t>(x + radius) * step);
+    }
+    std::copy_n(source, row_samples, padded.data() + edge);
+    for (int x = width; x < width + radius; ++x) {
+        const T* pixel = source + static_cast<std::size_t>(borderIndex(x, width, border)) * step;
+        std::copy_n(pixel, step, padded.data() + static_cast<std::size_t>(x + radius) * step);
+    }
+    row_sums(padded.data(), step, row_samples, radius, prefix.data(), sums);
+}
+
+// The separable sliding blur, one row at a time. `Sum` must hold a full box sum.
+template <typename Sum, typename T>
+class SlidingRows {
+  public:
+    SlidingRows(
+        const ImageView<T> window,
+        const int window_first_row,
+        const int image_height,
+        const int first_row,
+        const int radius,
+        const BorderMode border)
+        : window_(window),
+          window_first_row_(window_first_row),
+          image_height_(image_height),
+          radius_(radius),
+          taps_(2 * radius + 1),
+          border_(border),
+          row_samples_(window.rowSamples()),
+          step_(static_cast<std::size_t>(window.samples_per_pixel)),
+          area_(static_cast<std::uint32_t>(taps_) * static_cast<std::uint32_t>(taps_)),
+          row_sums_(boxRowSumsKernel<T, Sum>(activeKernels())),
+          slide_divide_(slideDivideKernel<Sum, T>(activeKernels())),
+          padded_(static_cast<std::size_t>(window.width + 2 * radius) * step_),
+          prefix_((static_cast<std::size_t>(window.width + 2 * radius) + 1) * step_),
+          ring_(static_cast<std::size_t>(taps_) * row_samples_),
+          column_(row_samples_, Sum {0}),
+          incoming_(row_samples_) {
+        // `ring_` keeps the horizontal sums of the last `taps_` virtual rows (y - radius .. y +
+        // radius, before border mapping); `column_` is their sum. Prime it with every row of the
+        // first window but its last; that row's ring slot is still zero, so next() adds it like
+        // any other incoming row.
+        for (int virtual_row = first_row - radius; virtual_row < first_row + radius; ++virtual_row) {
+            Sum* sums = ringRow(virtual_row);
+            sumsFor(virtual_row, sums);
+            for (std::size_t index = 0; index < row_samples_; ++index) {
+                column_[index] = static_cast<Sum>(column_[index] + sums[index]);
+            }
+        }
+    }
+
+    // Slides the window down to image row `y` and writes its blurred row.
+    void next(const int y, T* target) {
+        sumsFor(y + radius_, incoming_.data());
+        slide_divide_(column_.data(), incoming_.data(), ringRow(y + radius_), row_samples_, area_, target);
+    }
+
+  private:
+    Sum* ringRow(const int virtual_row) {
+        const int slot = ((virtual_row % taps_) + taps_) % taps_;
+        return ring_.data() + static_cast<std::size_t>(slot) * row_samples_;
+    }
+
+    void sumsFor(const int virtual_row, Sum* sums) {
+        const int y = borderIndex(virtual_row, image_height_, border_);
+        horizontalSums(
+            row_sums_, window_.row(y - window_first_row_), window_.width, step_, radius_, border_, padded_, prefix_, sums);
+    }
+
+    ImageView<T> window_;
+    int window_first_row_;
+    int image_height_;
+    int radius_;
+    int taps_;
+    BorderMode border_;
+    std::size_t row_samples_;
+    std::size_t step_;
+    std::uint32_t area_;
+    BoxRowSumsFn<T, Sum> row_sums_;
+    SlideDivideFn<Sum, T> slide_divide_;
+    std::vector<T> padded_;
+    std::vector<Sum> prefix_;
+    std::vector<Sum> ring_;
+    std::vector<Sum> column_;
+    std::vector<Sum> incoming_;
+};
+
+}  // namespace
+
+// 8-bit boxes up to 15x15 run on 16-bit sums (`narrow`), which halves the memory traffic and
+// doubles the lanes per vector; everything else on 32-bit sums (`wide`).
+template <typename T>
+struct BoxBlurRowStream<T>::State {
+    using NarrowRows = std::conditional_t<std::is_same_v<T, std::uint8_t>, SlidingRows<std::uint16_t, T>, SlidingRows<std::uint32_t, T>>;
+
+    ImageView<T> window;
+    int window_first_row {0};
+    int image_height {0};
+    int radius {0};
+    bool untouched {false};
+    bool copy_only {false};
+    int next_row {0};
+    std::optional<NarrowRows> narrow {};
+    std::optional<SlidingRows<std::uint32_t, T>> wide {};
+};
+
+template <typename T>
+BoxBlurRowStream<T>::BoxBlurRowStream(
+    const ImageView<T> window,
+    const int window_first_row,
+    const int image_height,
+    const int first_row,
+    const BoxBlurOptions& options)
+    : state_(std::make_unique<State>()) {
+    State& state = *state_;
+    state.window = window;
+    state.window_first_row = window_first_row;
+    state.image_height = image_height;
+    state.radius = std::clamp(options.radius, 0, kMaxBoxBlurRadius);
+    state.untouched = options.border == BorderMode::kUntouched;
+    state.next_row = first_row;
+
+    const int radius = state.radius;
+    state.copy_only = radius == 0 || (state.untouched && (window.width <= 2 * radius || image_height <= 2 * radius));
+    if (state.copy_only) {
+        return;
+    }
+
+    // Untouched borders are computed with clamped sums and then overwritten, which keeps the
+    // sliding passes free of edge branches.
+    const BorderMode border = state.untouched ? BorderMode::kClamp : options.border;
+    const std::uint64_t taps = 2 * static_cast<std::uint64_t>(radius) + 1;
+    if (std::is_same_v<T, std::uint8_t> &&
+        std::numeric_limits<T>::max() * taps * taps <= std::numeric_limits<std::uint16_t>::max()) {
+        state.narrow.emplace(window, window_first_row, image_height, first_row, radius, border);
+    } else {
+        state.wide.emplace(window, window_first_row, image_height, first_row, radius, border);
+    }
+}
+
+template <typename T>
+BoxBlurRowStream<T>::~BoxBlurRowStream() = default;
+
+template <typename T>
+void BoxBlurRowStream<T>::nextRow(T* target) {
+    State& state = *state_;
+    const int y = state.next_row++;
+    const T* source = state.window.row(y - state.window_first_row);
+    const std::size_t row_samples = state.window.rowSamples();
+    if (state.copy_only) {
+        std::copy_n(source, row_samples, target);
+        return;
+    }
+
+    if (state.narrow) {
+        state.narrow->next(y, target);
+    } else {
+        state.wide->next(y, target);
+    }
+
+    if (state.untouched) {
+        const int radius = state.radius;
+        const std::size_t edge = static_cast<std::size_t>(radius) * static_cast<std::size_t>(state.window.samples_per_pixel);
+        if (y < radius || y >= state.image_height - radius) {
+            std::copy_n(source, row_samples, target);
+        } else {
+            std::copy_n(source, edge, target);
+            std::copy_n(source + row_samples - edge, edge, target + row_samples - edge);
+        }
+    }
+}
+
+template <typename T>
+void boxBlurRows(
+    const ImageView<T> window,
+    const int window_first_row,
+    const int image_height,
+    const int first_row,
+    const int last_row,
+    const BoxBlurOptions& options,
+    const MutableImageView<T> target) {
+    BoxBlurRowStream<T> rows(window, window_first_row, image_height, first_row, options);
+    for (int y = first_row; y < last_row; ++y) {
+        rows.nextRow(target.row(y - first_row));
+    }
+}
+
+template class BoxBlurRowStream<std::uint8_t>;
+template class BoxBlurRowStream<std::uint16_t>;
+template void boxBlurRows<std::uint8_t>(
+    ImageView<std::uint8_t>, int, int, int, int, const BoxBlurOptions&, MutableImageView<std::uint8_t>);
+template void boxBlurRows<std::uint16_t>(
+    ImageView<std::uint16_t>, int, int, int, int, const BoxBlurOptions&, MutableImageView<std::uint16_t>);
+
+}  // namespace lumos::engine
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "engine/ImageView.h"
+
+#include <memory>
+
+namespace lumos::engine {
+
+// How samples outside the image feed the filter. kUntouched copies every pixel within `radius`
+// of an edge through unfiltered; kClamp repeats the edge pixel; kMirror reflects about the edge
+// pixel without repeating it (dcb|abcd|cba).
+enum class BorderMode {
+    kUntouched,
+    kClamp,
+    kMirror,
+};
+
+inline constexpr int kMaxBoxBlurRadius = 64;
+
+struct BoxBlurOptions {
+    // Half-width of the (2 * radius + 1)^2 box; clamped to [0, kMaxBoxBlurRadius].
+    int radius {1};
+    BorderMode border {BorderMode::kUntouched};
+};
+
+// Box-filters rows [first_row, last_row) of an image `image_height` rows tall into `target`.
+// `window` holds consecutive image rows starting at `window_first_row` and must cover `radius`
+// rows above and below the range, clipped to the image. Horizontal and vertical passes are
+// sliding sums, so the cost per sample does not depend on the radius. Results are the truncated
+// mean, matching the integer 3x3 average the pipeline used before at radius 1.
+template <typename T>
+void boxBlurRows(
+    ImageView<T> window,
+    int window_first_row,
+    int image_height,
+    int first_row,
+    int last_row,
+    const BoxBlurOptions& options,
+    MutableImageView<T> target);
+
+// The same filter one row at a time: rows first_row, first_row + 1, ... come out of nextRow() in
+// order, from a rolling window of 2 * radius + 1 rows of horizontal sums. A consumer can take each
+// blurred row while it is still in cache instead of reading back a blurred frame. `window` must
+// stay valid and hold the rows boxBlurRows would need for the rows requested.
+template <typename T>
+class BoxBlurRowStream {
+  public:
+    BoxBlurRowStream(ImageView<T> window, int window_first_row, int image_height, int first_row, const BoxBlurOptions& options);
+    ~BoxBlurRowStream();
+    BoxBlurRowStream(const BoxBlurRowStream&) = delete;
+    BoxBlurRowStream& operator=(const BoxBlurRowStream&) = delete;
+
+    // Writes the next blurred row (width * samples_per_pixel samples) into `target`.
+    void nextRow(T* target);
+
+  private:
+    struct State;
+    std::unique_ptr<State> state_;
+};
+
+template <typename T>
+void boxBlur(const ImageView<T> input, const BoxBlurOptions& options, const MutableImageView<T> target) {
+    boxBlurRows(input, 0, input.height, 0, input.height, options, target);
+}
+
+}  // namespace lumos::engine
@@ -1,13 +1,14 @@
 #pragma once
 
-#include "contracts/IEnhancementPipeline.h"
+#include "engine/Pipeline.h"
 
 namespace lumos::engine {
 
-class CpuStubPipeline final : public contracts::IEnhancementPipeline {
+// The standard engine configuration: decode, denoise, resample, sharpen and encode, with the
+// filters set in `options`.
+class CpuStubPipeline final : public Pipeline {
   public:
-    contracts::EnhancementResult run(const contracts::EnhancementRequest& request) override;
+    explicit CpuStubPipeline(PipelineOptions options = {});
 };
 
 }  // namespace lumos::engine
-
@@ -0,0 +1,91 @@
+#include "engine/DecodedImageCache.h"
+
+#include <system_error>
+#include <utility>
+#include <variant>
+
+namespace lumos::engine {
+
+std::optional<FileStamp> stampOf(const std::string& path) {
+    std::error_code error;
+    FileStamp stamp;
+    stamp.modified = std::filesystem::last_write_time(path, error);
+    if (error) {
+        return std::nullopt;
+    }
+    stamp.size = std::filesystem::file_size(path, error);
+    if (error) {
+        return std::nullopt;
+    }
+    return stamp;
+}
+
+DecodedImageCache::DecodedImageCache(const std::size_t budget_bytes) : budget_bytes_(budget_bytes) {}
+
+std::shared_ptr<const DecodedImage> DecodedImageCache::find(const std::string& path) {
+    const auto stamp = stampOf(path);
+    const std::lock_guard<std::mutex> lock(mutex_);
+    const auto found = entries_.find(path);
+    if (found == entries_.end() || !stamp.has_value() || found->second.stamp != *stamp) {
+        if (found != entries_.end()) {
+            erase(found);
+        }
+        ++stats_.misses;
+        return nullptr;
+    }
+    recent_.splice(recent_.begin(), recent_, found->second.recent);
+    ++stats_.hits;
+    return found->second.image;
+}
+
+std::optional<PpmHeader> DecodedImageCache::header(const std::string& path) const {
+    const auto stamp = stampOf(path);
+    const std::lock_guard<std::mutex> lock(mutex_);
+    const auto found = entries_.find(path);
+    if (found == entries_.end() || !stamp.has_value() || found->second.stamp != *stamp) {
+        return std::nullopt;
+    }
+    return found->second.image->header;
+}
+
+void DecodedImageCache::insert(const std::string& path, const FileStamp& stamp, std::shared_ptr<const DecodedImage> image) {
+    const std::size_t bytes = std::visit(
+        [](const auto& buffer) { return buffer.strideBytes() * static_cast<std::size_t>(buffer.height()); }, image->pixels);
+    const std::lock_guard<std::mutex> lock(mutex_);
+    if (const auto found = entries_.find(path); found != entries_.end()) {
+        erase(found);
+    }
+    if (bytes > budget_bytes_) {
+        return;
+    }
+    while (stats_.bytes + bytes > budget_bytes_ && !recent_.empty()) {
+        erase(entries_.find(recent_.back()));
+        ++stats_.evictions;
+    }
+    recent_.push_front(path);
+    entries_.emplace(path, Entry {.stamp = stamp, .image = std::move(image), .bytes = bytes, .recent = recent_.begin()});
+    ++stats_.entries;
+    stats_.bytes += bytes;
+}
+
+void DecodedImageCache::clear() {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    recent_.clear();
+    stats_.entries = 0;
+    stats_.bytes = 0;
+}
+
+DecodedImageCacheStats DecodedImageCache::stats() const {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void DecodedImageCache::erase(const std::unordered_map<std::string, Entry>::iterator entry) {
+    --stats_.entries;
+    stats_.bytes -= entry->second.bytes;
+    recent_.erase(entry->second.recent);
+    entries_.erase(entry);
+}
+
+}  // namespace lumos::engine
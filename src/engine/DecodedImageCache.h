@@ -0,0 +1,81 @@
+#pragma once
+
+#include "engine/Image.h"
+#include "engine/PpmCodec.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace lumos::engine {
+
+// A decoded input file, shared read-only by the runs that read it.
+struct DecodedImage {
+    PpmHeader header {};
+    PixelBuffer pixels {};
+};
+
+// The version of a file an entry was decoded from.
+struct FileStamp {
+    std::filesystem::file_time_type modified {};
+    std::uintmax_t size {0};
+
+    bool operator==(const FileStamp&) const = default;
+};
+
+// Stamp of `path` as it is now; nullopt when it cannot be read.
+[[nodiscard]] std::optional<FileStamp> stampOf(const std::string& path);
+
+struct DecodedImageCacheStats {
+    std::uint64_t hits {0};
+    std::uint64_t misses {0};
+    std::uint64_t evictions {0};
+    std::uint64_t entries {0};
+    std::size_t bytes {0};
+};
+
+// Byte-budgeted LRU cache of decoded input frames keyed by path, modification time and size. One
+// instance is shared by the pipelines and controller of a session, so rerunning an image with other
+// settings skips its decode. Frames are handed out as shared read-only buffers; an evicted frame
+// stays alive until its last reader lets go. Thread-safe.
+class DecodedImageCache {
+  public:
+    explicit DecodedImageCache(std::size_t budget_bytes = std::size_t {512} << 20);
+
+    // The frame decoded from `path` as it is now, or nullptr.
+    [[nodiscard]] std::shared_ptr<const DecodedImage> find(const std::string& path);
+    // Header of `path` when a frame of it as it is now is cached. Not counted as a use.
+    [[nodiscard]] std::optional<PpmHeader> header(const std::string& path) const;
+    // Keeps `image`, decoded from `path` when it had `stamp`, evicting the least recently used
+    // frames to stay within the budget. A frame larger than the whole budget is not kept.
+    void insert(const std::string& path, const FileStamp& stamp, std::shared_ptr<const DecodedImage> image);
+    void clear();
+
+    [[nodiscard]] DecodedImageCacheStats stats() const;
+
+  private:
+    struct Entry {
+        FileStamp stamp {};
+        std::shared_ptr<const DecodedImage> image {};
+        std::size_t bytes {0};
+        // Position in recent_, most recently used first.
+        std::list<std::string>::iterator recent {};
+    };
+
+    // Called with mutex_ held.
+    void erase(std::unordered_map<std::string, Entry>::iterator entry);
+
+    std::size_t budget_bytes_ {0};
+    std::unordered_map<std::string, Entry> entries_;
+    std::list<std::string> recent_;
+    DecodedImageCacheStats stats_ {};
+    mutable std::mutex mutex_;
+};
+
+}  // namespace lumos::engine
@@ -0,0 +1,277 @@
+#include "engine/GuidedFilter.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace lumos::engine {
+
+namespace {
+
+// a and b are box-averaged as fixed-point integers so the sliding sums are exact: a in [0, 1] with
+// 16 fractional bits, b in [0, max_value] with 4. Window sums stay below 2^31 up to radius 8.
+constexpr int kCoefficientBits = 16;
+constexpr int kOffsetBits = 4;
+
+// Horizontal box sums of one row with edge pixels repeated, via a running prefix per channel. The
+// prefix may wrap; the unsigned differences are still exact as long as a window sum fits `Sum`.
+// `Channels` 0 means `step` at runtime.
+template <int Channels, typename In, typename Sum>
+void rowBoxSumsFixed(const In* row, const int width, const int step, const int radius, Sum* prefix, Sum* sums) {
+    const auto channels = static_cast<std::size_t>(Channels == 0 ? step : Channels);
+    for (std::size_t channel = 0; channel < channels; ++channel) {
+        prefix[channel] = 0;
+    }
+    for (int index = 0; index < width + 2 * radius; ++index) {
+        const auto x = static_cast<std::size_t>(std::clamp(index - radius, 0, width - 1));
+        Sum* previous = prefix + static_cast<std::size_t>(index) * channels;
+        Sum* next = previous + channels;
+        for (std::size_t channel = 0; channel < channels; ++channel) {
+            next[channel] = static_cast<Sum>(previous[channel] + static_cast<Sum>(row[x * channels + channel]));
+        }
+    }
+    const std::size_t span = static_cast<std::size_t>(2 * radius + 1) * channels;
+    const std::size_t row_samples = static_cast<std::size_t>(width) * channels;
+    for (std::size_t index = 0; index < row_samples; ++index) {
+        sums[index] = static_cast<Sum>(prefix[index + span] - prefix[index]);
+    }
+}
+
+template <typename In, typename Sum>
+void rowBoxSums(const In* row, const int width, const int step, const int radius, Sum* prefix, Sum* sums) {
+    switch (step) {
+        case 1:
+            rowBoxSumsFixed<1>(row, width, step, radius, prefix, sums);
+            return;
+        case 3:
+            rowBoxSumsFixed<3>(row, width, step, radius, prefix, sums);
+            return;
+        case 4:
+            rowBoxSumsFixed<4>(row, width, step, radius, prefix, sums);
+            return;
+        default:
+            rowBoxSumsFixed<0>(row, width, step, radius, prefix, sums);
+            return;
+    }
+}
+
+// Replaces the window sum in `column` by sliding in `incoming` over `outgoing`, which then takes
+// its place in the ring.
+template <typename Sum>
+void slide(Sum* column, Sum* outgoing, const Sum* incoming, const std::size_t count) {
+    for (std::size_t index = 0; index < count; ++index) {
+        column[index] = static_cast<Sum>(column[index] + incoming[index] - outgoing[index]);
+        outgoing[index] = incoming[index];
+    }
+}
+
+}  // namespace
+
+template <typename T>
+struct GuidedFilterRowStream<T>::State {
+    // Window sums of squares: 8-bit fits in 32 bits up to radius 8, 16-bit needs 64.
+    using SquareSum = std::conditional_t<std::is_same_v<T, std::uint8_t>, std::uint32_t, std::uint64_t>;
+
+    ImageView<T> window;
+    int window_first_row {0};
+    int image_height {0};
+    int radius {0};
+    int taps {1};
+    std::size_t row_samples {0};
+    T max_value {0};
+    float inverse_area {1.0f};
+    float eps {0.0f};
+    int next_row {0};
+
+    // Stage 1: ring of horizontal sums of I and I * I over virtual rows c - radius .. c + radius
+    // and their column sums, for the coefficient row `center`.
+    int center {0};
+    std::vector<std::uint32_t> sum_ring {};
+    std::vector<SquareSum> square_ring {};
+    std::vector<std::uint32_t> sum_column {};
+    std::vector<SquareSum> square_column {};
+    std::vector<std::uint32_t> incoming_sums {};
+    std::vector<SquareSum> incoming_squares {};
+
+    // Horizontal sums of the quantized a and b of row `center`.
+    std::vector<std::uint32_t> a_sums {};
+    std::vector<std::uint32_t> b_sums {};
+
+    // Stage 2: ring of those sums over virtual rows y - radius .. y + radius and their columns.
+    std::vector<std::uint32_t> a_ring {};
+    std::vector<std::uint32_t> b_ring {};
+    std::vector<std::uint32_t> a_column {};
+    std::vector<std::uint32_t> b_column {};
+
+    std::vector<SquareSum> squares {};
+    std::vector<std::uint32_t> a_row {};
+    std::vector<std::uint32_t> b_row {};
+    std::vector<std::uint32_t> prefix {};
+    std::vector<SquareSum> square_prefix {};
+
+    std::size_t slot(const int virtual_row) const noexcept {
+        return static_cast<std::size_t>(((virtual_row % taps) + taps) % taps) * row_samples;
+    }
+
+    const T* imageRow(const int virtual_row) const noexcept {
+        return window.row(std::clamp(virtual_row, 0, image_height - 1) - window_first_row);
+    }
+
+    void inputSums(const int virtual_row) {
+        const T* row = imageRow(virtual_row);
+        for (std::size_t index = 0; index < row_samples; ++index) {
+            squares[index] = static_cast<SquareSum>(row[index]) * static_cast<SquareSum>(row[index]);
+        }
+        const int step = window.samples_per_pixel;
+        rowBoxSums(row, window.width, step, radius, prefix.data(), incoming_sums.data());
+        rowBoxSums(squares.data(), window.width, step, radius, square_prefix.data(), incoming_squares.data());
+    }
+
+    // Fits a and b for row `center` and takes their horizontal sums.
+    void coefficients() {
+        constexpr float kCoefficientScale = 1 << kCoefficientBits;
+        constexpr float kOffsetScale = 1 << kOffsetBits;
+        for (std::size_t index = 0; index < row_samples; ++index) {
+            // Window sums fit the signed types, which convert to float faster.
+            const float mean = static_cast<float>(static_cast<std::int32_t>(sum_column[index])) * inverse_area;
+            const float square_mean = static_cast<float>(static_cast<std::make_signed_t<SquareSum>>(square_column[index])) * inverse_area;
+            const float variance = std::max(0.0f, square_mean - mean * mean);
+            const float a = variance / (variance + eps);
+            const float b = mean * (1.0f - a);
+            a_row[index] = static_cast<std::uint32_t>(a * kCoefficientScale + 0.5f);
+            b_row[index] = static_cast<std::uint32_t>(b * kOffsetScale + 0.5f);
+        }
+        const int step = window.samples_per_pixel;
+        rowBoxSums(a_row.data(), window.width, step, radius, prefix.data(), a_sums.data());
+        rowBoxSums(b_row.data(), window.width, step, radius, prefix.data(), b_sums.data());
+    }
+
+    // Coefficient sums for image row `row`, which never moves backwards.
+    void advanceTo(const int row) {
+        while (center < row) {
+            ++center;
+            inputSums(center + radius);
+            const std::size_t outgoing = slot(center + radius);
+            slide(sum_column.data(), sum_ring.data() + outgoing, incoming_sums.data(), row_samples);
+            slide(square_column.data(), square_ring.data() + outgoing, incoming_squares.data(), row_samples);
+            coefficients();
+        }
+    }
+
+    // Adds the coefficient sums of virtual row `virtual_row` to the stage-2 window.
+    void pushCoefficients(const int virtual_row) {
+        advanceTo(std::clamp(virtual_row, 0, image_height - 1));
+        const std::size_t outgoing = slot(virtual_row);
+        slide(a_column.data(), a_ring.data() + outgoing, a_sums.data(), row_samples);
+        slide(b_column.data(), b_ring.data() + outgoing, b_sums.data(), row_samples);
+    }
+};
+
+template <typename T>
+GuidedFilterRowStream<T>::GuidedFilterRowStream(
+    const ImageView<T> window,
+    const int window_first_row,
+    const int image_height,
+    const int first_row,
+    const GuidedFilterOptions& options,
+    const T max_value)
+    : state_(std::make_unique<State>()) {
+    State& state = *state_;
+    state.window = window;
+    state.window_first_row = window_first_row;
+    state.image_height = image_height;
+    state.radius = std::clamp(options.radius, 0, kMaxGuidedFilterRadius);
+    state.taps = 2 * state.radius + 1;
+    state.row_samples = window.rowSamples();
+    state.max_value = max_value;
+    state.next_row = first_row;
+    if (state.radius == 0) {
+        return;
+    }
+
+    const float sigma = 0.2f * std::clamp(options.strength, 0.0f, 1.0f) * static_cast<float>(max_value);
+    // A floor keeps a = 0 / 0 out of perfectly flat windows at strength 0; there I == mean anyway.
+    state.eps = std::max(sigma * sigma, 1.0e-6f);
+    state.inverse_area = 1.0f / static_cast<float>(state.taps * state.taps);
+
+    const std::size_t samples = state.row_samples;
+    const std::size_t ring = static_cast<std::size_t>(state.taps) * samples;
+    const std::size_t prefix = (static_cast<std::size_t>(window.width + 2 * state.radius) + 1) *
+                               static_cast<std::size_t>(window.samples_per_pixel);
+    state.sum_ring.assign(ring, 0);
+    state.square_ring.assign(ring, 0);
+    state.sum_column.assign(samples, 0);
+    state.square_column.assign(samples, 0);
+    state.incoming_sums.resize(samples);
+    state.incoming_squares.resize(samples);
+    state.a_sums.resize(samples);
+    state.b_sums.resize(samples);
+    state.a_ring.assign(ring, 0);
+    state.b_ring.assign(ring, 0);
+    state.a_column.assign(samples, 0);
+    state.b_column.assign(samples, 0);
+    state.squares.resize(samples);
+    state.a_row.resize(samples);
+    state.b_row.resize(samples);
+    state.prefix.resize(prefix);
+    state.square_prefix.resize(prefix);
+
+    // Prime stage 1 on the first coefficient row the output needs. Empty ring slots are zero, so
+    // sliding a row into them just adds it.
+    const int radius = state.radius;
+    state.center = std::clamp(first_row - radius, 0, image_height - 1);
+    for (int virtual_row = state.center - radius; virtual_row <= state.center + radius; ++virtual_row) {
+        state.inputSums(virtual_row);
+        const std::size_t outgoing = state.slot(virtual_row);
+        slide(state.sum_column.data(), state.sum_ring.data() + outgoing, state.incoming_sums.data(), samples);
+        slide(state.square_column.data(), state.square_ring.data() + outgoing, state.incoming_squares.data(), samples);
+    }
+    state.coefficients();
+    // Stage 2 holds every row of the first output window but its last, which nextRow() adds.
+    for (int virtual_row = first_row - radius; virtual_row < first_row + radius; ++virtual_row) {
+        state.pushCoefficients(virtual_row);
+    }
+}
+
+template <typename T>
+GuidedFilterRowStream<T>::~GuidedFilterRowStream() = default;
+
+template <typename T>
+void GuidedFilterRowStream<T>::nextRow(T* target) {
+    State& state = *state_;
+    const int y = state.next_row++;
+    const T* source = state.window.row(y - state.window_first_row);
+    if (state.radius == 0) {
+        std::copy_n(source, state.row_samples, target);
+        return;
+    }
+
+    state.pushCoefficients(y + state.radius);
+    const float a_scale = state.inverse_area / static_cast<float>(1 << kCoefficientBits);
+    const float b_scale = state.inverse_area / static_cast<float>(1 << kOffsetBits);
+    const auto max_value = static_cast<float>(state.max_value);
+    const std::uint32_t* a_column = state.a_column.data();
+    const std::uint32_t* b_column = state.b_column.data();
+    for (std::size_t index = 0; index < state.row_samples; ++index) {
+        const float a = static_cast<float>(static_cast<std::int32_t>(a_column[index])) * a_scale;
+        const float b = static_cast<float>(static_cast<std::int32_t>(b_column[index])) * b_scale;
+        const float value = a * static_cast<float>(source[index]) + b + 0.5f;
+        target[index] = static_cast<T>(std::clamp(value, 0.0f, max_value));
+    }
+}
+
+template <typename T>
+void guidedFilter(const ImageView<T> input, const GuidedFilterOptions& options, const T max_value, const MutableImageView<T> target) {
+    GuidedFilterRowStream<T> rows(input, 0, input.height, 0, options, max_value);
+    for (int y = 0; y < input.height; ++y) {
+        rows.nextRow(target.row(y));
+    }
+}
+
+template class GuidedFilterRowStream<std::uint8_t>;
+template class GuidedFilterRowStream<std::uint16_t>;
+template void guidedFilter<std::uint8_t>(ImageView<std::uint8_t>, const GuidedFilterOptions&, std::uint8_t, MutableImageView<std::uint8_t>);
+template void guidedFilter<std::uint16_t>(ImageView<std::uint16_t>, const GuidedFilterOptions&, std::uint16_t, MutableImageView<std::uint16_t>);
+
+}  // namespace lumos::engine
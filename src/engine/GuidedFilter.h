@@ -0,0 +1,54 @@
+#pragma once
+
+#include "engine/ImageView.h"
+
+#include <memory>
+
+namespace lumos::engine {
+
+inline constexpr int kMaxGuidedFilterRadius = 8;
+
+// Self-guided filter (He et al., "Guided Image Filtering"), one channel at a time: every window
+// of (2 * radius + 1)^2 samples fits q = a * I + b with a = var / (var + eps), and each output
+// sample averages the a and b of the windows covering it. Flat and noisy areas (var << eps) are
+// smoothed towards their mean while edges (var >> eps) pass through, with
+// eps = (0.2 * strength * max_value)^2. Borders repeat the edge pixel.
+struct GuidedFilterOptions {
+    // Clamped to [0, kMaxGuidedFilterRadius]; 0 copies the input.
+    int radius {2};
+    // Clamped to [0, 1]; 0 leaves the image unchanged.
+    float strength {0.5f};
+};
+
+// Guided-filters rows first_row, first_row + 1, ... one at a time, like BoxBlurRowStream. Both box
+// passes are sliding sums over a ring of 2 * radius + 1 rows, so the cost per sample does not
+// depend on the radius and nothing frame-sized is allocated. `window` holds consecutive image rows
+// starting at `window_first_row` and must cover 2 * radius rows above and below the rows
+// requested, clipped to the image. Window sums are exact integers, so any split of the image into
+// bands gives the same result.
+template <typename T>
+class GuidedFilterRowStream {
+  public:
+    GuidedFilterRowStream(
+        ImageView<T> window,
+        int window_first_row,
+        int image_height,
+        int first_row,
+        const GuidedFilterOptions& options,
+        T max_value);
+    ~GuidedFilterRowStream();
+    GuidedFilterRowStream(const GuidedFilterRowStream&) = delete;
+    GuidedFilterRowStream& operator=(const GuidedFilterRowStream&) = delete;
+
+    // Writes the next filtered row (width * samples_per_pixel samples) into `target`.
+    void nextRow(T* target);
+
+  private:
+    struct State;
+    std::unique_ptr<State> state_;
+};
+
+template <typename T>
+void guidedFilter(ImageView<T> input, const GuidedFilterOptions& options, T max_value, MutableImageView<T> target);
+
+}  // namespace lumos::engine
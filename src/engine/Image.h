@@ -0,0 +1,48 @@
+#pragma once
+
+#include "engine/ImageBuffer.h"
+
+#include <type_traits>
+#include <variant>
+
+namespace lumos::engine {
+
+// The interleaved buffer types a decoded PPM/PGM can land in: 8-bit samples up to max value 255,
+// 16-bit above that.
+using PixelBuffer = std::variant<Gray8Image, Rgb8Image, Gray16Image, Rgb16Image>;
+
+// Calls `fn(std::type_identity<Buffer>{})` with the buffer type that holds `channels` samples per
+// pixel at `max_value`.
+template <typename Fn>
+decltype(auto) dispatchPixelBuffer(const int channels, const int max_value, Fn&& fn) {
+    if (channels == 1) {
+        if (max_value > 255) {
+            return fn(std::type_identity<Gray16Image> {});
+        }
+        return fn(std::type_identity<Gray8Image> {});
+    }
+    if (max_value > 255) {
+        return fn(std::type_identity<Rgb16Image> {});
+    }
+    return fn(std::type_identity<Rgb8Image> {});
+}
+
+struct Image {
+    int max_value {255};
+    PixelBuffer pixels {};
+
+    [[nodiscard]] int width() const noexcept {
+        return std::visit([](const auto& buffer) { return buffer.width(); }, pixels);
+    }
+    [[nodiscard]] int height() const noexcept {
+        return std::visit([](const auto& buffer) { return buffer.height(); }, pixels);
+    }
+    [[nodiscard]] int channels() const noexcept {
+        return std::visit([](const auto& buffer) { return std::decay_t<decltype(buffer)>::kChannels; }, pixels);
+    }
+    [[nodiscard]] int sample(const int x, const int y, const int channel) const noexcept {
+        return std::visit([=](const auto& buffer) { return static_cast<int>(buffer.at(x, y, channel)); }, pixels);
+    }
+};
+
+}  // namespace lumos::engine
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "engine/ImageView.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace lumos::engine {
+
+enum class PixelLayout {
+    kInterleaved,
+    kPlanar,
+};
+
+inline constexpr std::size_t kRowAlignmentBytes = 64;
+
+// Owning 2D sample buffer. Interleaved buffers store Channels samples per pixel in one plane;
+// planar buffers store one plane per channel. Every row of every plane starts on a 64-byte
+// boundary, and stride() is the explicit row pitch in samples (padding included).
+template <typename T, int Channels, PixelLayout Layout = PixelLayout::kInterleaved>
+class ImageBuffer {
+    static_assert(
+        std::is_same_v<T, std::uint8_t> || std::is_same_v<T, std::uint16_t> || std::is_same_v<T, float>,
+        "ImageBuffer samples must be uint8_t, uint16_t or float");
+    static_assert(Channels >= 1 && Channels <= 4, "ImageBuffer supports 1 to 4 channels");
+
+  public:
+    using Sample = T;
+    static constexpr int kChannels = Channels;
+    static constexpr PixelLayout kLayout = Layout;
+    static constexpr int kPlanes = Layout == PixelLayout::kPlanar ? Channels : 1;
+    // Samples per pixel within one plane row.
+    static constexpr int kSamplesPerPixel = Layout == PixelLayout::kPlanar ? 1 : Channels;
+
+    ImageBuffer() = default;
+
+    ImageBuffer(const int width, const int height)
+        : width_(std::max(0, width)),
+          height_(std::max(0, height)),
+          stride_(alignedStride(width_)),
+          storage_(allocate(stride_ * static_cast<std::size_t>(height_) * kPlanes)) {}
+
+    ImageBuffer(const ImageBuffer& other)
+        : width_(other.width_), height_(other.height_), stride_(other.stride_), storage_(allocate(other.sampleCapacity())) {
+        for (int plane = 0; plane < kPlanes; ++plane) {
+            copyPixels(other.view(plane), mutableView(plane));
+        }
+    }
+
+    ImageBuffer& operator=(const ImageBuffer& other) {
+        if (this != &other) {
+            ImageBuffer copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    ImageBuffer(ImageBuffer&& other) noexcept
+        : width_(std::exchange(other.width_, 0)),
+          height_(std::exchange(other.height_, 0)),
+          stride_(std::exchange(other.stride_, 0)),
+          storage_(std::move(other.storage_)) {}
+
+    ImageBuffer& operator=(ImageBuffer&& other) noexcept {
+        width_ = std::exchange(other.width_, 0);
+        height_ = std::exchange(other.height_, 0);
+        stride_ = std::exchange(other.stride_, 0);
+        storage_ = std::move(other.storage_);
+        return *this;
+    }
+
+    [[nodiscard]] int width() const noexcept { return width_; }
+    [[nodiscard]] int height() const noexcept { return height_; }
+    [[nodiscard]] bool empty() const noexcept { return width_ == 0 || height_ == 0; }
+    [[nodiscard]] std::size_t stride() const noexcept { return stride_; }
+    [[nodiscard]] std::size_t strideBytes() const noexcept { return stride_ * sizeof(T); }
+    [[nodiscard]] std::size_t byteSize() const noexcept { return sampleCapacity() * sizeof(T); }
+
+    [[nodiscard]] T* row(const int y, const int plane = 0) noexcept { return storage_.get() + rowOffset(y, plane); }
+    [[nodiscard]] const T* row(const int y, const int plane = 0) const noexcept {
+        return storage_.get() + rowOffset(y, plane);
+    }
+
+    [[nodiscard]] ImageView<T> view(const int plane = 0) const noexcept {
+        return {row(0, plane), width_, height_, stride_, kSamplesPerPixel};
+    }
+    [[nodiscard]] MutableImageView<T> mutableView(const int plane = 0) noexcept {
+        return {row(0, plane), width_, height_, stride_, kSamplesPerPixel};
+    }
+
+    [[nodiscard]] T& at(const int x, const int y, const int channel) noexcept {
+        return row(y, planeOf(channel))[sampleIndex(x, channel)];
+    }
+    [[nodiscard]] const T& at(const int x, const int y, const int channel) const noexcept {
+        return row(y, planeOf(channel))[sampleIndex(x, channel)];
+    }
+
+  private:
+    struct AlignedDelete {
+        void operator()(T* samples) const noexcept { ::operator delete(samples, std::align_val_t {kRowAlignmentBytes}); }
+    };
+    using Storage = std::unique_ptr<T[], AlignedDelete>;
+
+    static std::size_t alignedStride(const int width) noexcept {
+        const std::size_t row_bytes = static_cast<std::size_t>(width) * kSamplesPerPixel * sizeof(T);
+        const std::size_t padded = (row_bytes + kRowAlignmentBytes - 1) / kRowAlignmentBytes * kRowAlignmentBytes;
+        return padded / sizeof(T);
+    }
+
+    static Storage allocate(const std::size_t samples) {
+        if (samples == 0) {
+            return nullptr;
+        }
+        return Storage(static_cast<T*>(::operator new(samples * sizeof(T), std::align_val_t {kRowAlignmentBytes})));
+    }
+
+    static constexpr int planeOf(const int channel) noexcept { return Layout == PixelLayout::kPlanar ? channel : 0; }
+
+    static constexpr std::size_t sampleIndex(const int x, const int channel) noexcept {
+        if constexpr (Layout == PixelLayout::kPlanar) {
+            return static_cast<std::size_t>(x);
+        } else {
+            return static_cast<std::size_t>(x) * Channels + static_cast<std::size_t>(channel);
+        }
+    }
+
+    [[nodiscard]] std::size_t sampleCapacity() const noexcept {
+        return stride_ * static_cast<std::size_t>(height_) * kPlanes;
+    }
+
+    [[nodiscard]] std::size_t rowOffset(const int y, const int plane) const noexcept {
+        return (static_cast<std::size_t>(plane) * static_cast<std::size_t>(height_) + static_cast<std::size_t>(y)) * stride_;
+    }
+
+    int width_ {0};
+    int height_ {0};
+    std::size_t stride_ {0};
+    Storage storage_ {};
+};
+
+using Gray8Image = ImageBuffer<std::uint8_t, 1>;
+using Rgb8Image = ImageBuffer<std::uint8_t, 3>;
+using Gray16Image = ImageBuffer<std::uint16_t, 1>;
+using Rgb16Image = ImageBuffer<std::uint16_t, 3>;
+
+}  // namespace lumos::engine
@@ -0,0 +1,160 @@
+#include "engine/ImageProbe.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+
+#if defined(_WIN32)
+#include <filesystem>
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace lumos::engine {
+
+namespace {
+
+void setError(std::string* error_message, const char* message) {
+    if (error_message != nullptr) {
+        *error_message = message;
+    }
+}
+
+// Read-only handle that reads at explicit offsets, so probing leaves no file position behind.
+class ProbeFile {
+  public:
+    ProbeFile(const ProbeFile&) = delete;
+    ProbeFile& operator=(const ProbeFile&) = delete;
+
+#if defined(_WIN32)
+    explicit ProbeFile(const std::string& path) {
+        const std::filesystem::path native_path(path);
+        handle_ = CreateFileW(
+            native_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        LARGE_INTEGER size {};
+        if (handle_ != INVALID_HANDLE_VALUE && GetFileSizeEx(handle_, &size)) {
+            size_ = static_cast<std::uint64_t>(size.QuadPart);
+            open_ = true;
+        }
+    }
+
+    ~ProbeFile() {
+        if (handle_ != INVALID_HANDLE_VALUE) {
+            CloseHandle(handle_);
+        }
+    }
+
+    // Bytes read into `buffer` from `offset`; 0 at the end of the file or on failure.
+    std::size_t read(char* buffer, const std::size_t size, const std::uint64_t offset) const {
+        OVERLAPPED position {};
+        position.Offset = static_cast<DWORD>(offset);
+        position.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD read_bytes = 0;
+        if (!ReadFile(handle_, buffer, static_cast<DWORD>(size), &read_bytes, &position)) {
+            return 0;
+        }
+        return read_bytes;
+    }
+#else
+    explicit ProbeFile(const std::string& path) : descriptor_(::open(path.c_str(), O_RDONLY | O_CLOEXEC)) {
+        struct stat status {};
+        if (descriptor_ >= 0 && ::fstat(descriptor_, &status) == 0 && S_ISREG(status.st_mode)) {
+            size_ = static_cast<std::uint64_t>(status.st_size);
+            open_ = true;
+        }
+    }
+
+    ~ProbeFile() {
+        if (descriptor_ >= 0) {
+            ::close(descriptor_);
+        }
+    }
+
+    std::size_t read(char* buffer, const std::size_t size, const std::uint64_t offset) const {
+        const ssize_t read_bytes = ::pread(descriptor_, buffer, size, static_cast<off_t>(offset));
+        return read_bytes > 0 ? static_cast<std::size_t>(read_bytes) : 0;
+    }
+#endif
+
+    [[nodiscard]] bool isOpen() const noexcept { return open_; }
+    [[nodiscard]] std::uint64_t size() const noexcept { return size_; }
+
+  private:
+#if defined(_WIN32)
+    HANDLE handle_ {INVALID_HANDLE_VALUE};
+#else
+    int descriptor_ {-1};
+#endif
+    std::uint64_t size_ {0};
+    bool open_ {false};
+};
+
+bool finishProbe(const PpmHeaderParser& parser, const std::uint64_t file_bytes, ImageProbe* probe, std::string* error_message) {
+    ImageProbe result;
+    if (!parser.finish(file_bytes, &result.header, &result.raster_offset, error_message)) {
+        return false;
+    }
+    result.channels = channelCount(result.header.format);
+    result.bit_depth = std::bit_width(static_cast<unsigned>(result.header.max_value));
+    result.sample_bytes = result.header.max_value > 255 ? 2 : 1;
+    result.file_bytes = file_bytes;
+    *probe = result;
+    return true;
+}
+
+}  // namespace
+
+bool probeImage(const std::string& path, ImageProbe* probe, std::string* error_message) {
+    const ProbeFile file(path);
+    if (!file.isOpen()) {
+        setError(error_message, "failed to open file");
+        return false;
+    }
+
+    PpmHeaderParser parser;
+    std::array<char, kProbeReadBytes> buffer;
+    std::uint64_t offset = 0;
+    while (offset < file.size()) {
+        const std::size_t read_bytes = file.read(buffer.data(), buffer.size(), offset);
+        if (read_bytes == 0 || parser.feed(std::string_view(buffer.data(), read_bytes))) {
+            break;
+        }
+        offset += read_bytes;
+    }
+    return finishProbe(parser, file.size(), probe, error_message);
+}
+
+bool probeImage(const std::string_view bytes, const std::uint64_t file_bytes, ImageProbe* probe, std::string* error_message) {
+    PpmHeaderParser parser;
+    parser.feed(bytes);
+    return finishProbe(parser, file_bytes, probe, error_message);
+}
+
+std::size_t frameBytes(const PpmHeader& header) noexcept {
+    const std::size_t sample_bytes = header.max_value > 255 ? 2 : 1;
+    return static_cast<std::size_t>(header.width) * static_cast<std::size_t>(header.height) *
+           static_cast<std::size_t>(channelCount(header.format)) * sample_bytes;
+}
+
+ImageCost estimateCost(const ImageProbe& probe, const contracts::EnhancementRequest& request) noexcept {
+    PpmHeader output = probe.header;
+    output.width = contracts::scaledExtent(probe.header.width, request);
+    output.height = contracts::scaledExtent(probe.header.height, request);
+
+    ImageCost cost;
+    cost.input_frame_bytes = frameBytes(probe.header);
+    cost.output_frame_bytes = frameBytes(output);
+    cost.raster_bytes = probe.file_bytes - std::min<std::uint64_t>(probe.file_bytes, probe.raster_offset);
+    cost.output_samples = static_cast<std::uint64_t>(output.width) * static_cast<std::uint64_t>(output.height) *
+                          static_cast<std::uint64_t>(probe.channels);
+    return cost;
+}
+
+}  // namespace lumos::engine
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "contracts/EnhancementTypes.h"
+#include "engine/PpmCodec.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace lumos::engine {
+
+// What the header of an input file says about it, read without decoding it.
+struct ImageProbe {
+    PpmHeader header {};
+    int channels {0};
+    // Significant bits per sample, from the max value: 255 gives 8, 1023 gives 10.
+    int bit_depth {0};
+    // Bytes each sample takes once decoded: 1 up to a max value of 255, else 2.
+    int sample_bytes {0};
+    // Offset of the raster, just past the header.
+    std::size_t raster_offset {0};
+    std::uint64_t file_bytes {0};
+};
+
+// Resources an enhancement of a probed input needs, for admission control and progress estimates.
+struct ImageCost {
+    // Decoded input and output frames, as the pipeline sizes them.
+    std::size_t input_frame_bytes {0};
+    std::size_t output_frame_bytes {0};
+    // Raster bytes the decoder parses.
+    std::uint64_t raster_bytes {0};
+    // Output samples every active stage writes once.
+    std::uint64_t output_samples {0};
+
+    [[nodiscard]] std::size_t workingSetBytes() const noexcept { return input_frame_bytes + output_frame_bytes; }
+};
+
+// Bytes read per call to the file; every header short of long comments fits in the first read.
+inline constexpr std::size_t kProbeReadBytes = 512;
+
+// Reads the header of the P2, P3, P5 or P6 file at `path` with the rules PpmReader::open applies,
+// comments included, and checks that the file can hold the raster it declares. Allocates nothing
+// on success.
+bool probeImage(const std::string& path, ImageProbe* probe, std::string* error_message = nullptr);
+// The same over the leading bytes of a file of `file_bytes` bytes; `bytes` must run past the header.
+bool probeImage(std::string_view bytes, std::uint64_t file_bytes, ImageProbe* probe, std::string* error_message = nullptr);
+
+// Decoded size of a frame with `header`, without row padding.
+[[nodiscard]] std::size_t frameBytes(const PpmHeader& header) noexcept;
+[[nodiscard]] ImageCost estimateCost(const ImageProbe& probe, const contracts::EnhancementRequest& request) noexcept;
+
+}  // namespace lumos::engine
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace lumos::engine {
+
+// Pixels [x, x + width) of rows [y, y + height).
+struct PixelRect {
+    int x {0};
+    int y {0};
+    int width {0};
+    int height {0};
+
+    [[nodiscard]] int right() const noexcept { return x + width; }
+    [[nodiscard]] int bottom() const noexcept { return y + height; }
+    [[nodiscard]] bool empty() const noexcept { return width <= 0 || height <= 0; }
+    friend bool operator==(const PixelRect&, const PixelRect&) = default;
+};
+
+// Non-owning window onto `height` rows of `width` pixels, `stride` samples apart. Each row holds
+// `samples_per_pixel` interleaved samples per pixel (1 for a single plane of a planar buffer).
+template <typename T>
+struct ImageView {
+    const T* data {nullptr};
+    int width {0};
+    int height {0};
+    std::size_t stride {0};
+    int samples_per_pixel {1};
+
+    [[nodiscard]] const T* row(const int y) const noexcept { return data + static_cast<std::size_t>(y) * stride; }
+    [[nodiscard]] std::size_t rowSamples() const noexcept {
+        return static_cast<std::size_t>(width) * static_cast<std::size_t>(samples_per_pixel);
+    }
+    [[nodiscard]] ImageView rows(const int first, const int count) const noexcept {
+        return {row(first), width, count, stride, samples_per_pixel};
+    }
+    [[nodiscard]] ImageView region(const PixelRect& rect) const noexcept {
+        return {row(rect.y) + static_cast<std::size_t>(rect.x) * static_cast<std::size_t>(samples_per_pixel), rect.width,
+                rect.height, stride, samples_per_pixel};
+    }
+};
+
+template <typename T>
+struct MutableImageView {
+    T* data {nullptr};
+    int width {0};
+    int height {0};
+    std::size_t stride {0};
+    int samples_per_pixel {1};
+
+    [[nodiscard]] T* row(const int y) const noexcept { return data + static_cast<std::size_t>(y) * stride; }
+    [[nodiscard]] std::size_t rowSamples() const noexcept {
+        return static_cast<std::size_t>(width) * static_cast<std::size_t>(samples_per_pixel);
+    }
+    [[nodiscard]] MutableImageView rows(const int first, const int count) const noexcept {
+        return {row(first), width, count, stride, samples_per_pixel};
+    }
+    [[nodiscard]] MutableImageView region(const PixelRect& rect) const noexcept {
+        return {row(rect.y) + static_cast<std::size_t>(rect.x) * static_cast<std::size_t>(samples_per_pixel), rect.width,
+                rect.height, stride, samples_per_pixel};
+    }
+
+    operator ImageView<T>() const noexcept { return {data, width, height, stride, samples_per_pixel}; }
+};
+
+namespace detail {
+inline std::atomic<std::uint64_t> copied_pixel_bytes {0};
+}
+
+// Total bytes moved by copyPixels, including every ImageBuffer copy, since process start. Stages
+// should hand views to each other instead of copying, and tests use this to hold them to it.
+[[nodiscard]] inline std::uint64_t copiedPixelBytes() noexcept {
+    return detail::copied_pixel_bytes.load(std::memory_order_relaxed);
+}
+
+// Copies the samples of `source` into `target`, which must be at least as large.
+template <typename T>
+void copyPixels(const ImageView<T> source, const MutableImageView<T> target) noexcept {
+    const std::size_t row_samples = source.rowSamples();
+    for (int y = 0; y < source.height; ++y) {
+        std::copy_n(source.row(y), row_samples, target.row(y));
+    }
+    detail::copied_pixel_bytes.fetch_add(
+        static_cast<std::uint64_t>(row_samples) * static_cast<std::uint64_t>(source.height) * sizeof(T),
+        std::memory_order_relaxed);
+}
+
+}  // namespace lumos::engine
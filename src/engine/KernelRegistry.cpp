@@ -0,0 +1,184 @@
+#include "engine/KernelRegistry.h"
+
+#include <array>
+#include <cstdlib>
+#include <string>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace lumos::engine {
+
+// Each instruction set's build of the kernels lives in its own namespace (src/engine/kernels).
+namespace scalar_kernels {
+KernelTable makeKernelTable(CpuIsa isa);
+}
+namespace baseline_kernels {
+KernelTable makeKernelTable(CpuIsa isa);
+}
+#if defined(LUMOS_ENGINE_X86_KERNELS)
+namespace avx2_kernels {
+KernelTable makeKernelTable(CpuIsa isa);
+}
+namespace avx512_kernels {
+KernelTable makeKernelTable(CpuIsa isa);
+}
+#endif
+
+namespace {
+
+constexpr std::array<CpuIsa, 5> kAllIsas {CpuIsa::kScalar, CpuIsa::kSse2, CpuIsa::kAvx2, CpuIsa::kAvx512, CpuIsa::kNeon};
+
+struct CpuFeatures {
+    bool avx2 {false};
+    bool avx512 {false};
+};
+
+CpuFeatures queryCpuFeatures() noexcept {
+    CpuFeatures features;
+#if defined(LUMOS_ENGINE_X86_KERNELS)
+#if defined(_MSC_VER)
+    int info[4] {};
+    __cpuid(info, 0);
+    const int max_leaf = info[0];
+    __cpuid(info, 1);
+    const auto ecx = static_cast<unsigned>(info[2]);
+    const bool os_saves_ymm = (ecx & (1u << 27)) != 0 && (ecx & (1u << 28)) != 0;
+    if (!os_saves_ymm || max_leaf < 7) {
+        return features;
+    }
+    const auto xcr0 = _xgetbv(0);
+    __cpuidex(info, 7, 0);
+    const auto ebx = static_cast<unsigned>(info[1]);
+    features.avx2 = (xcr0 & 0x6) == 0x6 && (ecx & (1u << 12)) != 0 && (ebx & (1u << 5)) != 0;
+    features.avx512 = features.avx2 && (xcr0 & 0xE6) == 0xE6 && (ebx & (1u << 16)) != 0 && (ebx & (1u << 30)) != 0 &&
+                      (ebx & (1u << 31)) != 0;
+#else
+    // The builtins also check that the OS saves the wider registers.
+    __builtin_cpu_init();
+    features.avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    features.avx512 = features.avx2 && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+                      __builtin_cpu_supports("avx512vl");
+#endif
+#endif
+    return features;
+}
+
+struct Registry {
+    std::array<KernelTable, kAllIsas.size()> tables {};
+    std::array<bool, kAllIsas.size()> available {};
+
+    void add(const KernelTable& table) {
+        tables[static_cast<std::size_t>(table.isa)] = table;
+        available[static_cast<std::size_t>(table.isa)] = true;
+    }
+};
+
+const Registry& registry() noexcept {
+    static const Registry instance = [] {
+        Registry built;
+        built.add(scalar_kernels::makeKernelTable(CpuIsa::kScalar));
+#if defined(__x86_64__) || defined(_M_X64)
+        built.add(baseline_kernels::makeKernelTable(CpuIsa::kSse2));
+#elif defined(__aarch64__) || defined(_M_ARM64)
+        built.add(baseline_kernels::makeKernelTable(CpuIsa::kNeon));
+#endif
+#if defined(LUMOS_ENGINE_X86_KERNELS)
+        const CpuFeatures features = queryCpuFeatures();
+        if (features.avx2) {
+            built.add(avx2_kernels::makeKernelTable(CpuIsa::kAvx2));
+        }
+        if (features.avx512) {
+            built.add(avx512_kernels::makeKernelTable(CpuIsa::kAvx512));
+        }
+#endif
+        return built;
+    }();
+    return instance;
+}
+
+std::string requestedIsaFromEnvironment() {
+    std::string requested;
+#if defined(_WIN32)
+    char* env_buffer = nullptr;
+    std::size_t env_len = 0;
+    if (_dupenv_s(&env_buffer, &env_len, "LUMOS_CPU_ISA") == 0 && env_buffer != nullptr) {
+        requested = env_buffer;
+        free(env_buffer);
+    }
+#else
+    if (const char* value = std::getenv("LUMOS_CPU_ISA"); value != nullptr) {
+        requested = value;
+    }
+#endif
+    return requested;
+}
+
+}  // namespace
+
+const char* cpuIsaName(const CpuIsa isa) noexcept {
+    switch (isa) {
+        case CpuIsa::kScalar:
+            return "scalar";
+        case CpuIsa::kSse2:
+            return "sse2";
+        case CpuIsa::kAvx2:
+            return "avx2";
+        case CpuIsa::kAvx512:
+            return "avx512";
+        case CpuIsa::kNeon:
+            return "neon";
+    }
+    return "unknown";
+}
+
+bool parseCpuIsa(const std::string_view text, CpuIsa* isa) noexcept {
+    for (const CpuIsa candidate : kAllIsas) {
+        if (text == cpuIsaName(candidate)) {
+            *isa = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+CpuIsa detectCpuIsa() noexcept {
+    for (const CpuIsa candidate : {CpuIsa::kAvx512, CpuIsa::kAvx2, CpuIsa::kSse2, CpuIsa::kNeon}) {
+        if (kernelsFor(candidate) != nullptr) {
+            return candidate;
+        }
+    }
+    return CpuIsa::kScalar;
+}
+
+CpuIsa resolveCpuIsa(const CpuIsa detected, const std::string_view requested) noexcept {
+    CpuIsa isa = detected;
+    if (parseCpuIsa(requested, &isa) && kernelsFor(isa) != nullptr) {
+        return isa;
+    }
+    return detected;
+}
+
+const KernelTable* kernelsFor(const CpuIsa isa) noexcept {
+    const auto index = static_cast<std::size_t>(isa);
+    const Registry& instance = registry();
+    return index < instance.tables.size() && instance.available[index] ? &instance.tables[index] : nullptr;
+}
+
+std::vector<CpuIsa> supportedCpuIsas() {
+    std::vector<CpuIsa> isas;
+    for (const CpuIsa candidate : kAllIsas) {
+        if (kernelsFor(candidate) != nullptr) {
+            isas.push_back(candidate);
+        }
+    }
+    return isas;
+}
+
+const KernelTable& activeKernels() {
+    static const KernelTable& active = *kernelsFor(resolveCpuIsa(detectCpuIsa(), requestedIsaFromEnvironment()));
+    return active;
+}
+
+}  // namespace lumos::engine
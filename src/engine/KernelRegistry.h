@@ -0,0 +1,91 @@
+#pragma once
+
+#include "engine/kernels/KernelTable.h"
+
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace lumos::engine {
+
+[[nodiscard]] const char* cpuIsaName(CpuIsa isa) noexcept;
+
+// Accepts the names cpuIsaName returns ("scalar", "sse2", "avx2", "avx512", "neon").
+bool parseCpuIsa(std::string_view text, CpuIsa* isa) noexcept;
+
+// The best instruction set this build has kernels for and the CPU and OS support.
+[[nodiscard]] CpuIsa detectCpuIsa() noexcept;
+
+// `requested` if it names a supported instruction set, otherwise `detected`.
+[[nodiscard]] CpuIsa resolveCpuIsa(CpuIsa detected, std::string_view requested) noexcept;
+
+// The kernels built for `isa`, or null when this build has none or the CPU cannot run them.
+[[nodiscard]] const KernelTable* kernelsFor(CpuIsa isa) noexcept;
+
+// Every instruction set kernelsFor accepts on this machine, scalar first.
+[[nodiscard]] std::vector<CpuIsa> supportedCpuIsas();
+
+// The kernels engine code calls. Chosen once per process: the detected instruction set, unless
+// the LUMOS_CPU_ISA environment variable names another supported one.
+[[nodiscard]] const KernelTable& activeKernels();
+
+// Horizontal resample results kept between passes: 16-bit for 8-bit images, 32-bit above.
+template <typename T>
+using ResampleIntermediate = std::conditional_t<std::is_same_v<T, std::uint8_t>, std::int16_t, std::int32_t>;
+
+template <typename T, typename Sum>
+[[nodiscard]] BoxRowSumsFn<T, Sum> boxRowSumsKernel(const KernelTable& kernels) noexcept {
+    if constexpr (std::is_same_v<T, std::uint8_t> && std::is_same_v<Sum, std::uint16_t>) {
+        return kernels.box_row_sums_u8_u16;
+    } else if constexpr (std::is_same_v<T, std::uint8_t> && std::is_same_v<Sum, std::uint32_t>) {
+        return kernels.box_row_sums_u8_u32;
+    } else {
+        static_assert(std::is_same_v<T, std::uint16_t> && std::is_same_v<Sum, std::uint32_t>);
+        return kernels.box_row_sums_u16_u32;
+    }
+}
+
+template <typename Sum, typename T>
+[[nodiscard]] SlideDivideFn<Sum, T> slideDivideKernel(const KernelTable& kernels) noexcept {
+    if constexpr (std::is_same_v<Sum, std::uint16_t> && std::is_same_v<T, std::uint8_t>) {
+        return kernels.slide_divide_u16_u8;
+    } else if constexpr (std::is_same_v<Sum, std::uint32_t> && std::is_same_v<T, std::uint8_t>) {
+        return kernels.slide_divide_u32_u8;
+    } else {
+        static_assert(std::is_same_v<Sum, std::uint32_t> && std::is_same_v<T, std::uint16_t>);
+        return kernels.slide_divide_u32_u16;
+    }
+}
+
+template <typename T>
+[[nodiscard]] ExpandRowFn<T> expandRowKernel(const KernelTable& kernels) noexcept {
+    if constexpr (std::is_same_v<T, std::uint8_t>) {
+        return kernels.expand_row_u8;
+    } else {
+        static_assert(std::is_same_v<T, std::uint16_t>);
+        return kernels.expand_row_u16;
+    }
+}
+
+template <typename T>
+[[nodiscard]] ResampleHorizontalFn<T, ResampleIntermediate<T>> resampleHorizontalKernel(const KernelTable& kernels) noexcept {
+    if constexpr (std::is_same_v<T, std::uint8_t>) {
+        return kernels.resample_horizontal_u8;
+    } else {
+        static_assert(std::is_same_v<T, std::uint16_t>);
+        return kernels.resample_horizontal_u16;
+    }
+}
+
+template <typename T>
+[[nodiscard]] ResampleVerticalFn<ResampleIntermediate<T>, T> resampleVerticalKernel(const KernelTable& kernels) noexcept {
+    if constexpr (std::is_same_v<T, std::uint8_t>) {
+        return kernels.resample_vertical_u8;
+    } else {
+        static_assert(std::is_same_v<T, std::uint16_t>);
+        return kernels.resample_vertical_u16;
+    }
+}
+
+}  // namespace lumos::engine
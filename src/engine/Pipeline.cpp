@@ -0,0 +1,860 @@
+#include "engine/Pipeline.h"
+
+#include "common/ThreadPool.h"
+#include "engine/Image.h"
+#include "engine/ImageProbe.h"
+#include "engine/PpmCodec.h"
+#include "engine/TileProcessor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace lumos::engine {
+
+namespace {
+
+using Duration = std::chrono::steady_clock::duration;
+
+contracts::EnhancementResult makeFailure(
+    const contracts::ErrorCode code,
+    const std::string& stage,
+    const std::string& message) {
+    contracts::EnhancementResult result {};
+    result.ok = false;
+    result.error.code = code;
+    result.error.stage = stage;
+    result.error.message = message;
+    return result;
+}
+
+contracts::EnhancementResult makeSuccess(const PpmHeader& input_header, const PpmHeader& output_header) {
+    contracts::EnhancementResult result {};
+    result.ok = true;
+    result.metrics.input_width = input_header.width;
+    result.metrics.input_height = input_header.height;
+    result.metrics.output_width = output_header.width;
+    result.metrics.output_height = output_header.height;
+    result.error.code = contracts::ErrorCode::kNone;
+    result.error.stage = "none";
+    return result;
+}
+
+template <typename Buffer>
+std::size_t heldBytes(const Buffer& buffer) noexcept {
+    return buffer.strideBytes() * static_cast<std::size_t>(buffer.height());
+}
+
+// Decoded size of `rect` of a frame with `header`.
+std::size_t regionBytes(PpmHeader header, const PixelRect& rect) noexcept {
+    header.width = rect.width;
+    header.height = rect.height;
+    return frameBytes(header);
+}
+
+// The image the row stages of `plan` make of the whole input, before any region is cut from it.
+const PpmHeader& wholeOutput(const PipelinePlan& plan) noexcept {
+    return plan.stages.empty() ? plan.input_header : plan.stages.back().output;
+}
+
+// Pixels of `group`'s input that `wanted` of its output depends on, from the stages opened for it
+// as a tile would open them.
+PixelRect groupSourceRegion(
+    const PipelinePlan& plan,
+    const FusedGroup& group,
+    const contracts::EnhancementRequest& request,
+    PixelRect wanted) {
+    for (std::size_t index = group.last; index > group.first; --index) {
+        const PlannedStage& planned = plan.stages[index - 1];
+        const RowStageSetup setup {.input = planned.input, .output = planned.output, .wanted = wanted};
+        wanted = planned.stage->openRows(request, setup, std::type_identity<std::uint8_t> {})->sourceRegion();
+    }
+    return wanted;
+}
+
+// The row stages of one fused group opened for one rectangle of its output, from the last back to
+// the first so that each is opened for the pixels the one after it reads. Rows fed to the group
+// pass from stage to stage through a scratch row each, and the last stage writes row k of its
+// output to row k % target.height of `target`: either the whole rectangle or one reused row.
+template <typename Sample>
+class FusedRows {
+  public:
+    FusedRows(
+        const PipelinePlan& plan,
+        const std::size_t first,
+        const std::size_t last,
+        const contracts::EnhancementRequest& request,
+        const PixelRect& wanted,
+        const MutableImageView<Sample> target,
+        const contracts::RunControl& control)
+        : control_(control), target_(target), stages_(last - first), scratch_(stages_.size()), times_(stages_.size()) {
+        // Pixels wanted of the stage being opened; the first stage's are left at the end.
+        PixelRect rect = wanted;
+        PixelRect first_wanted = wanted;
+        for (std::size_t index = last; index > first; --index) {
+            const PlannedStage& planned = plan.stages[index - 1];
+            const RowStageSetup setup {.input = planned.input, .output = planned.output, .wanted = rect};
+            auto& stage = stages_[index - 1 - first];
+            stage = planned.stage->openRows(request, setup, std::type_identity<Sample> {});
+            if (index < last) {
+                scratch_[index - 1 - first].resize(
+                    static_cast<std::size_t>(rect.width) * static_cast<std::size_t>(channelCount(planned.output.format)));
+            }
+            first_wanted = rect;
+            rect = stage->sourceRegion();
+        }
+        source_ = rect;
+        // A first stage that reads a window is fed the rows it writes, any other the rows it reads.
+        reads_window_ = last > first && plan.stages[first].requirements.reads_window;
+        feed_first_ = reads_window_ ? first_wanted.y : source_.y;
+        feed_rows_ = reads_window_ ? first_wanted.height : source_.height;
+    }
+
+    // Input pixels the group reads.
+    [[nodiscard]] PixelRect sourceRegion() const noexcept { return source_; }
+    // Rows [first, last) to feed run() to produce every wanted row.
+    [[nodiscard]] int firstFeedRow() const noexcept { return feed_first_; }
+    [[nodiscard]] int lastFeedRow() const noexcept { return feed_first_ + feed_rows_; }
+    [[nodiscard]] const std::vector<Duration>& stageTimes() const noexcept { return times_; }
+
+    // Feeds rows [first_row, last_row) from `window`, which holds the columns of sourceRegion() for
+    // the rows from `window_first_row` on (and around the range, for a first stage that reads a
+    // window). Every finished output row goes to `emit` as a one-row view; stops and returns false
+    // once `emit` does or the run is cancelled.
+    template <typename Emit>
+    bool run(const ImageView<Sample> window, const int window_first_row, const int first_row, const int last_row, Emit&& emit) {
+        if (stages_.empty()) {
+            for (int y = first_row; y < last_row; ++y) {
+                if (control_.cancelled() || !emit(window.rows(y - window_first_row, 1))) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        if (reads_window_) {
+            const auto start = std::chrono::steady_clock::now();
+            stages_.front()->setWindow(window, window_first_row, first_row, last_row);
+            times_.front() += std::chrono::steady_clock::now() - start;
+            return drain(0, emit);
+        }
+        for (int y = first_row; y < last_row; ++y) {
+            if (control_.cancelled() || !push(0, window.row(y - window_first_row), emit)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+  private:
+    template <typename Emit>
+    bool push(const std::size_t index, const Sample* row, Emit& emit) {
+        const auto start = std::chrono::steady_clock::now();
+        stages_[index]->pushRow(row);
+        times_[index] += std::chrono::steady_clock::now() - start;
+        return drain(index, emit);
+    }
+
+    // Hands every row stage `index` has ready to the stage after it, or to `emit` after the last.
+    template <typename Emit>
+    bool drain(const std::size_t index, Emit& emit) {
+        RowStage<Sample>& stage = *stages_[index];
+        const bool last = index + 1 == stages_.size();
+        for (;;) {
+            if (index == 0 && reads_window_ && control_.cancelled()) {
+                return false;
+            }
+            const auto start = std::chrono::steady_clock::now();
+            if (!stage.rowReady()) {
+                times_[index] += std::chrono::steady_clock::now() - start;
+                return true;
+            }
+            if (!last) {
+                Sample* row = scratch_[index].data();
+                stage.writeRow(row);
+                times_[index] += std::chrono::steady_clock::now() - start;
+                if (!push(index + 1, row, emit)) {
+                    return false;
+                }
+                continue;
+            }
+            const MutableImageView<Sample> row = target_.rows(emitted_++ % target_.height, 1);
+            stage.writeRow(row.row(0));
+            times_[index] += std::chrono::steady_clock::now() - start;
+            if (!emit(ImageView<Sample>(row))) {
+                return false;
+            }
+        }
+    }
+
+    const contracts::RunControl& control_;
+    MutableImageView<Sample> target_;
+    std::vector<std::unique_ptr<RowStage<Sample>>> stages_;
+    std::vector<std::vector<Sample>> scratch_;
+    std::vector<Duration> times_;
+    PixelRect source_ {};
+    bool reads_window_ {false};
+    int feed_first_ {0};
+    int feed_rows_ {0};
+    int emitted_ {0};
+};
+
+// Bytes decoded or encoded between cancellation checks; about a millisecond of work for binary
+// PPM and well under 50 ms for ASCII.
+constexpr std::size_t kCancellationChunkBytes = std::size_t {1} << 20;
+
+int chunkRows(const int width, const int samples_per_pixel, const std::size_t sample_bytes) noexcept {
+    const std::size_t row_bytes =
+        std::max<std::size_t>(1, static_cast<std::size_t>(width) * static_cast<std::size_t>(samples_per_pixel) * sample_bytes);
+    return static_cast<int>(std::clamp<std::size_t>(kCancellationChunkBytes / row_bytes, 1, 1 << 20));
+}
+
+constexpr const char* kOutOfMemory = "not enough memory for the image";
+
+// Thrown from a tile to stop the tile processor once the run is cancelled.
+struct RunCancelled {};
+
+// Sums the work several threads finish and reports it as a fraction of `total`, one call at a time.
+class StageProgress {
+  public:
+    StageProgress(const contracts::RunControl& control, const std::string_view stage, const std::uint64_t total)
+        : control_(control), stage_(stage), total_(std::max<std::uint64_t>(1, total)) {}
+
+    void add(const std::uint64_t work) {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        done_ = std::min(total_, done_ + work);
+        control_.report(stage_, static_cast<double>(done_) / static_cast<double>(total_));
+    }
+
+  private:
+    const contracts::RunControl& control_;
+    std::string_view stage_;
+    std::uint64_t total_ {1};
+    std::uint64_t done_ {0};
+    std::mutex mutex_;
+};
+
+// Adds the times of a run of stages to the frame's, one caller at a time.
+class StageTimes {
+  public:
+    explicit StageTimes(std::vector<Duration>& times) : times_(times) {}
+
+    void add(const std::size_t first, const std::vector<Duration>& times) {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        for (std::size_t index = 0; index < times.size(); ++index) {
+            times_[first + index] += times[index];
+        }
+    }
+
+  private:
+    std::vector<Duration>& times_;
+    std::mutex mutex_;
+};
+
+// Closes and deletes a partly written output, for runs that stop before the end. Deleting a large
+// file takes tens of milliseconds, so it is renamed out of the way and deleted on the thread pool.
+void discardOutput(PpmWriter& writer, const std::string& path) {
+    static std::atomic<std::uint64_t> discarded {0};
+    std::string ignored;
+    writer.close(&ignored);
+    std::error_code error;
+    std::filesystem::path doomed = path + ".cancelled." + std::to_string(discarded.fetch_add(1));
+    std::filesystem::rename(path, doomed, error);
+    if (error) {
+        std::filesystem::remove(path, error);
+        return;
+    }
+    static_cast<void>(common::ThreadPool::shared().submit([doomed = std::move(doomed)] {
+        std::error_code remove_error;
+        std::filesystem::remove(doomed, remove_error);
+    }));
+}
+
+std::uint64_t nanoseconds(const Duration duration) noexcept {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+}
+
+std::uint64_t milliseconds(const Duration duration) noexcept {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(duration).count());
+}
+
+// Fills the metrics of a finished run from what its frame collected on the way.
+void recordMetrics(const PipelineFrame& frame, contracts::EnhancementMetrics& metrics) {
+    const PipelinePlan& plan = frame.plan;
+    metrics.duration_ns = nanoseconds(frame.elapsed);
+    metrics.duration_ms = milliseconds(frame.elapsed);
+    metrics.stages.clear();
+    metrics.stages.push_back({std::string(plan.decode->name()), nanoseconds(frame.decode_time)});
+    for (std::size_t index = 0; index < plan.stages.size(); ++index) {
+        metrics.stages.push_back({std::string(plan.stages[index].stage->name()), nanoseconds(frame.stage_times[index])});
+    }
+    metrics.stages.push_back({std::string(plan.encode->name()), nanoseconds(frame.encode_time)});
+    metrics.bytes_read = frame.bytes_read;
+    metrics.bytes_written = frame.bytes_written;
+    const double seconds = std::chrono::duration<double>(frame.elapsed).count();
+    const double megapixels = static_cast<double>(metrics.output_width) * static_cast<double>(metrics.output_height) / 1e6;
+    metrics.megapixels_per_second = seconds > 0.0 ? megapixels / seconds : 0.0;
+    metrics.peak_buffer_bytes = frame.peak_buffer_bytes;
+    metrics.threads = frame.threads;
+}
+
+// The full-frame path, a stage at a time: decode -> frame, each group -> the next frame, encode <-
+// the last frame. Each group splits its output into tiles that read views of its input frame and
+// write buffers of their own, which the tile processor blends into the output frame. Decode and
+// encode go a megabyte at a time and tiles a row at a time, checking for cancellation in between.
+// Each stage returns false with the reason in `failure`.
+template <typename Sample>
+bool decodeFrame(
+    PpmReader& reader,
+    const MutableImageView<Sample> decoded,
+    const contracts::RunControl& control,
+    contracts::EnhancementResult* failure) {
+    std::string io_error;
+    const int chunk = chunkRows(decoded.width, decoded.samples_per_pixel, sizeof(Sample));
+    for (int y = 0; y < decoded.height; y += chunk) {
+        if (control.cancelled()) {
+            *failure = contracts::cancelledResult("decode");
+            return false;
+        }
+        const int rows = std::min(chunk, decoded.height - y);
+        if (!reader.readRows(decoded.rows(y, rows), &io_error)) {
+            *failure = makeFailure(contracts::ErrorCode::kDecodeFailed, "decode", io_error);
+            return false;
+        }
+        control.report("decode", static_cast<double>(y + rows) / static_cast<double>(decoded.height));
+    }
+    return true;
+}
+
+// Frames hold `input_region` and `output_region` of the group's whole input and output, which the
+// stages are opened in the coordinates of.
+template <typename Sample>
+void enhanceGroup(
+    const PipelinePlan& plan,
+    const FusedGroup& group,
+    const contracts::EnhancementRequest& request,
+    TileProcessor<Sample>& tiles,
+    const ImageView<Sample> input,
+    const PixelRect& input_region,
+    const MutableImageView<Sample> output,
+    const PixelRect& output_region,
+    const contracts::RunControl& control,
+    StageProgress& progress,
+    StageTimes& times) {
+    tiles.run(
+        [&](const Tile& tile, const MutableImageView<Sample> target) {
+            PixelRect wanted = tile.extended;
+            wanted.x += output_region.x;
+            wanted.y += output_region.y;
+            FusedRows<Sample> rows(plan, group.first, group.last, request, wanted, target, control);
+            // Output rows finished but not reported yet; reported about a megabyte at a time.
+            const int report_rows = chunkRows(target.width, target.samples_per_pixel, sizeof(Sample));
+            int unreported_rows = 0;
+            const auto finish_row = [&](ImageView<Sample>) {
+                if (++unreported_rows == report_rows) {
+                    progress.add(static_cast<std::uint64_t>(unreported_rows) * static_cast<std::uint64_t>(target.width));
+                    unreported_rows = 0;
+                }
+                return true;
+            };
+            const PixelRect source = rows.sourceRegion();
+            const PixelRect held {source.x - input_region.x, source.y - input_region.y, source.width, source.height};
+            if (!rows.run(input.region(held), source.y, rows.firstFeedRow(), rows.lastFeedRow(), finish_row)) {
+                throw RunCancelled {};
+            }
+            progress.add(static_cast<std::uint64_t>(unreported_rows) * static_cast<std::uint64_t>(target.width));
+            times.add(group.first, rows.stageTimes());
+        },
+        output);
+}
+
+template <typename Sample>
+bool encodeFrame(
+    PpmWriter& writer,
+    const std::string& output_path,
+    const ImageView<Sample> enhanced,
+    const contracts::RunControl& control,
+    contracts::EnhancementResult* failure) {
+    std::string io_error;
+    const int chunk = chunkRows(enhanced.width, enhanced.samples_per_pixel, sizeof(Sample));
+    for (int y = 0; y < enhanced.height; y += chunk) {
+        if (control.cancelled()) {
+            discardOutput(writer, output_path);
+            *failure = contracts::cancelledResult("encode");
+            return false;
+        }
+        const int rows = std::min(chunk, enhanced.height - y);
+        if (!writer.writeRows(enhanced.rows(y, rows), &io_error)) {
+            *failure = makeFailure(contracts::ErrorCode::kEncodeFailed, "encode", io_error);
+            return false;
+        }
+        control.report("encode", static_cast<double>(y + rows) / static_cast<double>(enhanced.height));
+    }
+    if (!writer.close(&io_error)) {
+        *failure = makeFailure(contracts::ErrorCode::kEncodeFailed, "encode", io_error);
+        return false;
+    }
+    return true;
+}
+
+// Decodes `band_rows` input rows at a time, runs them through the plan's one fused group and
+// appends the output rows to the encoder, so the working set is a few bands of input plus a few
+// output rows regardless of the image height. Produces byte-identical output to the full-frame
+// path. Decode, enhance and encode interleave, so progress is reported as one "enhance" stage, a
+// band at a time; each row checks for cancellation, and a cancelled run deletes its partial output.
+// Times, bytes and buffers go into `frame`, whose plan this runs; `reader` reads its input region.
+template <typename Buffer>
+contracts::EnhancementResult runStreaming(
+    PpmReader& reader,
+    const contracts::EnhancementRequest& request,
+    const int band_rows,
+    const contracts::RunControl& control,
+    PipelineFrame& frame) {
+    const PipelinePlan& plan = frame.plan;
+    using Sample = typename Buffer::Sample;
+    const PpmHeader& input_header = plan.input_header;
+    const PpmHeader& output_header = plan.output_header;
+    const PixelRect& source = plan.regions.front();
+    const std::size_t stages = plan.groups.empty() ? 0 : plan.groups.front().last;
+    const int halo = stages > 0 && plan.stages.front().requirements.reads_window ? plan.stages.front().requirements.halo : 0;
+
+    std::string io_error;
+    PpmWriter writer;
+    auto start = std::chrono::steady_clock::now();
+    if (!plan.encode->openOutput(request, output_header, &writer, &io_error)) {
+        return makeFailure(contracts::ErrorCode::kEncodeFailed, "encode", io_error);
+    }
+    frame.encode_time += std::chrono::steady_clock::now() - start;
+
+    // `window` holds decoded rows [window_first, window_first + window_rows) of the source region.
+    Buffer window(source.width, band_rows + 2 * halo);
+    // One output row, reused for every row.
+    Buffer output(output_header.width, 1);
+    FusedRows<Sample> rows(plan, 0, stages, request, plan.regions.back(), output.mutableView(), control);
+    frame.peak_buffer_bytes = std::max(frame.peak_buffer_bytes, heldBytes(window) + heldBytes(output));
+    const auto write_row = [&](const ImageView<Sample> row) {
+        const auto write_start = std::chrono::steady_clock::now();
+        const bool written = writer.writeRows(row, &io_error);
+        frame.encode_time += std::chrono::steady_clock::now() - write_start;
+        return written;
+    };
+    const auto window_view = window.mutableView();
+    int window_first = source.y;
+    int window_rows = 0;
+
+    const int feed_first = rows.firstFeedRow();
+    const int feed_last = rows.lastFeedRow();
+    for (int band_first = feed_first; band_first < feed_last; band_first += band_rows) {
+        if (control.cancelled()) {
+            discardOutput(writer, request.output_path);
+            return contracts::cancelledResult("enhance");
+        }
+        const int band_last = std::min(feed_last, band_first + band_rows);
+        const int needed_first = std::max(source.y, band_first - halo);
+        const int needed_last = std::min(source.bottom(), band_last + halo);
+
+        // Carry the halo rows that are still needed to the front of the window.
+        const int keep = std::max(0, window_first + window_rows - needed_first);
+        if (keep > 0) {
+            copyPixels<Sample>(window_view.rows(window_rows - keep, keep), window_view.rows(0, keep));
+        }
+        window_first = needed_first;
+        window_rows = keep;
+
+        const int rows_to_read = needed_last - (window_first + window_rows);
+        start = std::chrono::steady_clock::now();
+        if (!reader.readRows(window_view.rows(window_rows, rows_to_read), &io_error)) {
+            return makeFailure(contracts::ErrorCode::kDecodeFailed, "decode", io_error);
+        }
+        frame.decode_time += std::chrono::steady_clock::now() - start;
+        window_rows += rows_to_read;
+
+        if (!rows.run(window_view.rows(0, window_rows), window_first, band_first, band_last, write_row)) {
+            if (control.cancelled()) {
+                discardOutput(writer, request.output_path);
+                return contracts::cancelledResult("enhance");
+            }
+            return makeFailure(contracts::ErrorCode::kEncodeFailed, "encode", io_error);
+        }
+        control.report("enhance", static_cast<double>(band_last - feed_first) / static_cast<double>(feed_last - feed_first));
+    }
+
+    start = std::chrono::steady_clock::now();
+    if (!writer.close(&io_error)) {
+        return makeFailure(contracts::ErrorCode::kEncodeFailed, "encode", io_error);
+    }
+    frame.encode_time += std::chrono::steady_clock::now() - start;
+    for (std::size_t index = 0; index < rows.stageTimes().size(); ++index) {
+        frame.stage_times[index] += rows.stageTimes()[index];
+    }
+    frame.bytes_read = reader.bytesRead();
+    frame.bytes_written = writer.bytesWritten();
+    return makeSuccess(input_header, output_header);
+}
+
+// Adds the time until stop(), or the end of the scope, to the frame's elapsed time and to `stage`
+// when given.
+class StageClock {
+  public:
+    explicit StageClock(PipelineFrame& frame, Duration* stage = nullptr)
+        : frame_(frame), stage_(stage), start_(std::chrono::steady_clock::now()) {}
+    StageClock(const StageClock&) = delete;
+    StageClock& operator=(const StageClock&) = delete;
+    ~StageClock() { stop(); }
+
+    void stop() {
+        if (running_) {
+            const Duration elapsed = std::chrono::steady_clock::now() - start_;
+            frame_.elapsed += elapsed;
+            if (stage_ != nullptr) {
+                *stage_ += elapsed;
+            }
+            running_ = false;
+        }
+    }
+
+  private:
+    PipelineFrame& frame_;
+    Duration* stage_ {nullptr};
+    std::chrono::steady_clock::time_point start_;
+    bool running_ {true};
+};
+
+// Ends a frame's trip through the stages with `failure`, freeing its pixels.
+bool stop(PipelineFrame* frame, contracts::EnhancementResult failure) {
+    frame->result = std::move(failure);
+    frame->pixels = Gray8Image {};
+    frame->source.reset();
+    return false;
+}
+
+// Stops a frame whose request has a region outside the output `plan` makes of the whole input.
+bool regionFits(const PipelinePlan& plan, PipelineFrame* frame) {
+    const PpmHeader& whole = wholeOutput(plan);
+    if (contracts::regionWithin(frame->request.region, whole.width, whole.height)) {
+        return true;
+    }
+    return stop(
+        frame,
+        makeFailure(
+            contracts::ErrorCode::kInvalidRequest, "validate",
+            "region must lie within the " + std::to_string(whole.width) + "x" + std::to_string(whole.height) + " output"));
+}
+
+}  // namespace
+
+std::string outputSignature(const PipelineOptions& options) {
+    // Tiling, band rows, the memory budget and the decoded-image cache change how a run is done but
+    // never its bytes, so they are left out.
+    return "lumos " LUMOS_VERSION ";denoise=" + std::to_string(options.denoise.radius) + "," +
+           std::to_string(static_cast<int>(options.denoise.border)) + ";guided=" + std::to_string(options.guided_denoise.radius) +
+           "," + std::to_string(options.guided_denoise.strength) + ";sharpen=" + std::to_string(options.sharpen.radius) + "," +
+           std::to_string(options.sharpen.strength);
+}
+
+Pipeline::Pipeline(std::vector<std::unique_ptr<IStage>> stages, const PipelineOptions options)
+    : stages_(std::move(stages)), options_(options) {
+    const auto kind_at = [this](const std::size_t index) { return stages_[index]->kind(); };
+    bool valid = stages_.size() >= 2 && kind_at(0) == StageKind::kDecode && kind_at(stages_.size() - 1) == StageKind::kEncode;
+    for (std::size_t index = 1; valid && index + 1 < stages_.size(); ++index) {
+        valid = kind_at(index) == StageKind::kRows;
+    }
+    if (!valid) {
+        throw std::invalid_argument("a pipeline runs a decode stage, row stages, then an encode stage");
+    }
+}
+
+contracts::EnhancementResult Pipeline::run(const contracts::EnhancementRequest& request) {
+    return run(request, {});
+}
+
+contracts::EnhancementResult Pipeline::run(const contracts::EnhancementRequest& request, const contracts::RunControl& control) {
+    PipelineFrame frame;
+    if (decode(request, control, &frame) && enhance(control, &frame)) {
+        encode(control, &frame);
+    }
+    return frame.result;
+}
+
+PipelinePlan Pipeline::plan(const contracts::EnhancementRequest& request, const PpmHeader& input_header) const {
+    PipelinePlan plan;
+    plan.decode = stages_.front().get();
+    plan.encode = stages_.back().get();
+    plan.input_header = input_header;
+
+    PpmHeader header = input_header;
+    for (std::size_t index = 1; index + 1 < stages_.size(); ++index) {
+        const IStage& stage = *stages_[index];
+        if (!stage.active(request, header)) {
+            continue;
+        }
+        const PlannedStage planned {
+            .stage = &stage,
+            .input = header,
+            .output = stage.outputHeader(request, header),
+            .requirements = stage.requirements(request, header),
+        };
+        if (plan.groups.empty() || planned.requirements.reads_window) {
+            plan.groups.push_back({.first = plan.stages.size(), .last = plan.stages.size()});
+        }
+        plan.stages.push_back(planned);
+        plan.groups.back().last = plan.stages.size();
+        header = planned.output;
+    }
+    plan.output_header = plan.encode->outputHeader(request, header);
+
+    // Frame g is the input of group g; each is whole unless a region that fits the output is cut from
+    // the last, when the others shrink to the pixels the one after depends on.
+    plan.regions.push_back({0, 0, input_header.width, input_header.height});
+    for (const FusedGroup& group : plan.groups) {
+        const PpmHeader& output = plan.stages[group.last - 1].output;
+        plan.regions.push_back({0, 0, output.width, output.height});
+    }
+    const contracts::ImageRegion& region = request.region;
+    if (!region.empty() && contracts::regionWithin(region, header.width, header.height)) {
+        PixelRect wanted {region.x, region.y, region.width, region.height};
+        plan.output_header.width = region.width;
+        plan.output_header.height = region.height;
+        for (std::size_t group = plan.groups.size(); group > 0; --group) {
+            plan.regions[group] = wanted;
+            wanted = groupSourceRegion(plan, plan.groups[group - 1], request, wanted);
+        }
+        plan.regions.front() = wanted;
+    }
+
+    // Group g reads frame g and writes frame g + 1, so frame g - 1 is free to take its output.
+    plan.frame_bytes = regionBytes(input_header, plan.regions.front());
+    for (std::size_t group = 0; group < plan.groups.size(); ++group) {
+        const PpmHeader& input = plan.stages[plan.groups[group].first].input;
+        const PpmHeader& output = plan.stages[plan.groups[group].last - 1].output;
+        const PixelRect& written = plan.regions[group + 1];
+        plan.frame_bytes = std::max(plan.frame_bytes, regionBytes(input, plan.regions[group]) + regionBytes(output, written));
+        if (group > 0) {
+            const PixelRect& spare = plan.regions[group - 1];
+            plan.groups[group].reuses_frame = spare.width == written.width && spare.height == written.height;
+        }
+    }
+    plan.streamed = plan.frame_bytes > options_.memory_budget_bytes && plan.groups.size() <= 1;
+    return plan;
+}
+
+bool Pipeline::decode(
+    const contracts::EnhancementRequest& request,
+    const contracts::RunControl& control,
+    PipelineFrame* frame) const {
+    const StageClock clock(*frame, &frame->decode_time);
+    frame->request = request;
+    if (control.cancelled()) {
+        return stop(frame, contracts::cancelledResult("validate"));
+    }
+
+    std::string reason;
+    if (!contracts::isValidRequest(request, &reason)) {
+        return stop(frame, makeFailure(contracts::ErrorCode::kInvalidRequest, "validate", reason));
+    }
+
+    // A preview decodes a proxy of the input, not the frame the cache holds for its path.
+    DecodedImageCache* const images = request.preview_max_extent > 0 ? nullptr : options_.decoded_images;
+    if (images != nullptr) {
+        if (auto cached = images->find(request.input_path)) {
+            PipelinePlan planned = plan(request, cached->header);
+            if (!regionFits(planned, frame)) {
+                return false;
+            }
+            if (!planned.streamed) {
+                frame->region = {0, 0, cached->header.width, cached->header.height};
+                frame->plan = std::move(planned);
+                frame->stage_times.assign(frame->plan.stages.size(), Duration {});
+                frame->peak_buffer_bytes = std::max(
+                    frame->peak_buffer_bytes, std::visit([](const auto& pixels) { return heldBytes(pixels); }, cached->pixels));
+                frame->source = std::move(cached);
+                return true;
+            }
+        }
+    }
+    // Taken before the file is read, so a change while it is read shows as a newer file next time. Only
+    // whole frames are shared.
+    const std::optional<FileStamp> stamp =
+        images != nullptr && request.region.empty() ? stampOf(request.input_path) : std::nullopt;
+
+    PpmReader reader;
+    std::string io_error;
+    if (!stages_.front()->openInput(request, &reader, &io_error)) {
+        return stop(frame, makeFailure(contracts::ErrorCode::kDecodeFailed, "decode", io_error));
+    }
+    frame->plan = plan(request, reader.header());
+    if (!regionFits(frame->plan, frame)) {
+        return false;
+    }
+    frame->stage_times.assign(frame->plan.stages.size(), Duration {});
+    if (frame->plan.streamed) {
+        return true;
+    }
+
+    frame->region = frame->plan.regions.front();
+    reader.crop(frame->region);
+    const PpmHeader& header = reader.header();
+    contracts::EnhancementResult failure;
+    // A header the file can hold may still describe a frame larger than memory.
+    const auto decode_frame = [&](auto buffer_type) {
+        using Buffer = typename decltype(buffer_type)::type;
+        Buffer pixels(header.width, header.height);
+        if (!decodeFrame(reader, pixels.mutableView(), control, &failure)) {
+            return false;
+        }
+        frame->bytes_read = reader.bytesRead();
+        frame->peak_buffer_bytes = std::max(frame->peak_buffer_bytes, heldBytes(pixels));
+        if (stamp.has_value()) {
+            auto image = std::make_shared<const DecodedImage>(DecodedImage {.header = header, .pixels = std::move(pixels)});
+            images->insert(request.input_path, *stamp, image);
+            frame->source = std::move(image);
+        } else {
+            frame->pixels = std::move(pixels);
+        }
+        return true;
+    };
+    try {
+        if (dispatchPixelBuffer(channelCount(header.format), header.max_value, decode_frame)) {
+            return true;
+        }
+    } catch (const std::bad_alloc&) {
+        failure = makeFailure(contracts::ErrorCode::kDecodeFailed, "decode", kOutOfMemory);
+    }
+    return stop(frame, std::move(failure));
+}
+
+bool Pipeline::enhance(const contracts::RunControl& control, PipelineFrame* frame) const {
+    const StageClock clock(*frame);
+    const contracts::EnhancementRequest& request = frame->request;
+    const PipelinePlan& plan = frame->plan;
+    if (plan.streamed) {
+        PpmReader reader;
+        std::string io_error;
+        if (!plan.decode->openInput(request, &reader, &io_error)) {
+            return stop(frame, makeFailure(contracts::ErrorCode::kDecodeFailed, "decode", io_error));
+        }
+        reader.crop(plan.regions.front());
+        const PpmHeader& header = reader.header();
+        const int band_rows = std::max(1, options_.band_rows);
+        contracts::EnhancementResult result;
+        try {
+            result = dispatchPixelBuffer(channelCount(header.format), header.max_value, [&](auto buffer_type) {
+                using Buffer = typename decltype(buffer_type)::type;
+                return runStreaming<Buffer>(reader, request, band_rows, control, *frame);
+            });
+        } catch (const std::bad_alloc&) {
+            result = makeFailure(contracts::ErrorCode::kProcessFailed, "enhance", kOutOfMemory);
+        }
+        if (!result.ok) {
+            return stop(frame, std::move(result));
+        }
+        frame->result = std::move(result);
+        return true;
+    }
+
+    if (plan.groups.empty()) {
+        return true;
+    }
+    // A shared decoded frame is only read, so the run's own frames start out empty.
+    const DecodedImage* const shared = frame->source.get();
+    if (shared != nullptr) {
+        frame->pixels = std::visit([](const auto& decoded) -> PixelBuffer { return std::decay_t<decltype(decoded)> {}; }, shared->pixels);
+    }
+    StageTimes times(frame->stage_times);
+    try {
+        std::visit(
+            [&](auto& frame_pixels) {
+                using Buffer = std::decay_t<decltype(frame_pixels)>;
+                using Sample = typename Buffer::Sample;
+                std::vector<TileProcessor<Sample>> tiles;
+                // Overlapping pixels are computed, and counted, once for every tile that covers them.
+                std::uint64_t tile_pixels = 0;
+                for (std::size_t index = 0; index < plan.groups.size(); ++index) {
+                    const PixelRect& output = plan.regions[index + 1];
+                    const TileGrid& grid =
+                        tiles.emplace_back(output.width, output.height, Buffer::kChannels, options_.tiling).grid();
+                    for (int row = 0; row < grid.rows(); ++row) {
+                        for (int column = 0; column < grid.columns(); ++column) {
+                            const PixelRect extended = grid.tile(column, row).extended;
+                            tile_pixels +=
+                                static_cast<std::uint64_t>(extended.width) * static_cast<std::uint64_t>(extended.height);
+                        }
+                    }
+                }
+                StageProgress progress(control, "enhance", tile_pixels);
+                // The frame two groups back, kept only for a group that reuses it; never the shared one.
+                Buffer spare;
+                const Buffer* input = shared != nullptr ? &std::get<Buffer>(shared->pixels) : &frame_pixels;
+                for (std::size_t index = 0; index < plan.groups.size(); ++index) {
+                    const FusedGroup& group = plan.groups[index];
+                    const PixelRect& output = plan.regions[index + 1];
+                    Buffer enhanced = group.reuses_frame && spare.height() > 0 ? std::move(spare) : Buffer(output.width, output.height);
+                    frame->peak_buffer_bytes = std::max(
+                        frame->peak_buffer_bytes, heldBytes(*input) + heldBytes(enhanced) + tiles[index].bufferBytes());
+                    frame->threads = std::max(frame->threads, tiles[index].concurrency());
+                    enhanceGroup<Sample>(
+                        plan, group, request, tiles[index], input->view(), frame->region, enhanced.mutableView(), output, control,
+                        progress, times);
+                    if (index + 1 < plan.groups.size() && plan.groups[index + 1].reuses_frame) {
+                        spare = std::move(frame_pixels);
+                    }
+                    frame_pixels = std::move(enhanced);
+                    frame->region = output;
+                    input = &frame_pixels;
+                }
+            },
+            frame->pixels);
+    } catch (const RunCancelled&) {
+        return stop(frame, contracts::cancelledResult("enhance"));
+    } catch (const std::bad_alloc&) {
+        return stop(frame, makeFailure(contracts::ErrorCode::kProcessFailed, "enhance", kOutOfMemory));
+    }
+    frame->source.reset();
+    return true;
+}
+
+bool Pipeline::encode(const contracts::RunControl& control, PipelineFrame* frame) const {
+    StageClock clock(*frame, &frame->encode_time);
+    const PipelinePlan& plan = frame->plan;
+    if (!plan.streamed) {
+        std::string io_error;
+        PpmWriter writer;
+        if (!plan.encode->openOutput(frame->request, plan.output_header, &writer, &io_error)) {
+            return stop(frame, makeFailure(contracts::ErrorCode::kEncodeFailed, "encode", io_error));
+        }
+        contracts::EnhancementResult failure;
+        const PixelRect& wanted = plan.regions.back();
+        const PixelRect held {wanted.x - frame->region.x, wanted.y - frame->region.y, wanted.width, wanted.height};
+        const bool encoded = std::visit(
+            [&](const auto& enhanced) {
+                return encodeFrame(writer, frame->request.output_path, enhanced.view().region(held), control, &failure);
+            },
+            frame->source != nullptr ? frame->source->pixels : frame->pixels);
+        if (!encoded) {
+            return stop(frame, std::move(failure));
+        }
+        frame->bytes_written = writer.bytesWritten();
+        frame->pixels = Gray8Image {};
+        frame->source.reset();
+        frame->result = makeSuccess(plan.input_header, plan.output_header);
+    }
+    clock.stop();
+    frame->result.output_path = frame->request.output_path;
+    recordMetrics(*frame, frame->result.metrics);
+    return true;
+}
+
+}  // namespace lumos::engine
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "contracts/IEnhancementPipeline.h"
+#include "engine/BoxBlur.h"
+#include "engine/DecodedImageCache.h"
+#include "engine/GuidedFilter.h"
+#include "engine/Image.h"
+#include "engine/PpmCodec.h"
+#include "engine/Sharpen.h"
+#include "engine/Stage.h"
+#include "engine/TileProcessor.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace lumos::engine {
+
+struct PipelineOptions {
+    // Runs whose planned working set exceeds this switch to strip streaming.
+    std::size_t memory_budget_bytes {std::size_t {2} << 30};
+    // Input rows decoded, processed and encoded per strip in streaming mode.
+    int band_rows {64};
+    // Box blur applied when a request enables denoise.
+    BoxBlurOptions denoise {};
+    // Guided filter applied instead for the edge-preserving preset; each request sets its strength.
+    GuidedFilterOptions guided_denoise {};
+    // Unsharp mask applied after upscaling when a request sets a sharpen strength, which overrides
+    // the strength here.
+    UnsharpMaskOptions sharpen {};
+    // Tiles the full-frame path splits each frame into and the threads that run them.
+    TileOptions tiling {};
+    // Decoded frames shared with other runs and the controller; nullptr decodes every run from its
+    // file. Streamed runs neither read nor fill it.
+    DecodedImageCache* decoded_images {nullptr};
+};
+
+// The engine version and the settings in `options` that change what a run writes, as text; a
+// result cache salted with it stops matching once either changes.
+[[nodiscard]] std::string outputSignature(const PipelineOptions& options);
+
+// A row stage the planner kept for a request, with the image it reads and the one it makes.
+struct PlannedStage {
+    const IStage* stage {nullptr};
+    PpmHeader input {};
+    PpmHeader output {};
+    StageRequirements requirements {};
+};
+
+// Row stages [first, last) of a plan fused row by row: each row one stage writes goes through the
+// next while it is still in cache, so only the group's input and output are whole frames.
+struct FusedGroup {
+    std::size_t first {0};
+    std::size_t last {0};
+    // The output goes into the frame the group before last wrote, which has the same size and is no
+    // longer read, instead of a new one.
+    bool reuses_frame {false};
+};
+
+// How one request runs: the row stages left once the ones with nothing to do are dropped, split
+// into fused groups wherever a stage needs a whole frame to read; either every frame in memory
+// with each group tiled, or when that exceeds the memory budget and there is at most one group, a
+// band of rows at a time from decode to encode. A request with a region makes only the part of each
+// frame that the region depends on.
+struct PipelinePlan {
+    const IStage* decode {nullptr};
+    const IStage* encode {nullptr};
+    std::vector<PlannedStage> stages {};
+    std::vector<FusedGroup> groups {};
+    PpmHeader input_header {};
+    // The image written: the whole output, or the request's region of it.
+    PpmHeader output_header {};
+    // Part of each frame the run makes, in the coordinates of the whole frame: the input's first and
+    // then the output of each group, ending with the output's.
+    std::vector<PixelRect> regions {};
+    // Most bytes of frames held at once when every frame is in memory.
+    std::size_t frame_bytes {0};
+    bool streamed {false};
+};
+
+// A request on its way through the stages of a run. decode() plans the run and fills `pixels`
+// with the decoded frame, enhance() replaces it with the enhanced one and encode() writes and frees
+// it. Streamed plans run start to finish in enhance() and the other stages only pass them on.
+struct PipelineFrame {
+    contracts::EnhancementRequest request {};
+    PipelinePlan plan {};
+    PixelBuffer pixels {};
+    // The decoded frame when it is shared through a DecodedImageCache: read in place of `pixels`,
+    // never written, and let go once enhance() has made a frame of the run's own.
+    std::shared_ptr<const DecodedImage> source {};
+    // Rectangle of its whole image the current frame holds: one of the plan's regions, or the whole
+    // input for a shared decoded frame.
+    PixelRect region {};
+    // Why the request stopped, or once encoded the finished result.
+    contracts::EnhancementResult result {};
+    // Time spent in the stages so far and, within it, reading the input, each planned row stage
+    // (summed over threads) and writing the output.
+    std::chrono::steady_clock::duration elapsed {};
+    std::chrono::steady_clock::duration decode_time {};
+    std::vector<std::chrono::steady_clock::duration> stage_times {};
+    std::chrono::steady_clock::duration encode_time {};
+    std::uint64_t bytes_read {0};
+    std::uint64_t bytes_written {0};
+    // Most bytes of pixel buffers, and most threads, the stages have used at once so far.
+    std::size_t peak_buffer_bytes {0};
+    int threads {1};
+};
+
+// Enhancement engine built from stages: a decode stage, any number of row stages and an encode
+// stage, in that order. Each request is planned before it runs; stages fuse wherever they can take
+// their input a row at a time, every fused group is tiled over the thread pool, and requests too
+// large for the memory budget stream when their plan allows it. Tiled, streamed and unfused runs
+// of a request all produce the same bytes.
+class Pipeline : public contracts::IEnhancementPipeline {
+  public:
+    // Throws std::invalid_argument when `stages` does not run decode, row stages, encode.
+    Pipeline(std::vector<std::unique_ptr<IStage>> stages, PipelineOptions options = {});
+
+    contracts::EnhancementResult run(const contracts::EnhancementRequest& request) override;
+    contracts::EnhancementResult run(const contracts::EnhancementRequest& request, const contracts::RunControl& control) override;
+
+    [[nodiscard]] PipelinePlan plan(const contracts::EnhancementRequest& request, const PpmHeader& input_header) const;
+
+    // The stages of run(), for callers that overlap the stages of several requests. Each returns
+    // false once the request has failed or been cancelled, with the reason in frame->result.
+    bool decode(const contracts::EnhancementRequest& request, const contracts::RunControl& control, PipelineFrame* frame) const;
+    bool enhance(const contracts::RunControl& control, PipelineFrame* frame) const;
+    bool encode(const contracts::RunControl& control, PipelineFrame* frame) const;
+
+  private:
+    std::vector<std::unique_ptr<IStage>> stages_;
+    PipelineOptions options_;
+};
+
+}  // namespace lumos::engine
@@ -0,0 +1,644 @@
+#include "engine/PpmCodec.h"
+
+#include "engine/KernelRegistry.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <system_error>
+#include <type_traits>
+
+namespace lumos::engine {
+
+namespace {
+
+constexpr bool isPpmWhitespace(const char ch) noexcept {
+    return ch == ' ' || ch == '\n' || ch == '\t' || ch == '\r' || ch == '\v' || ch == '\f';
+}
+
+void setError(std::string* error_message, const char* message) {
+    if (error_message != nullptr) {
+        *error_message = message;
+    }
+}
+
+// Mirrors std::stoi on a whitespace-delimited token: optional sign, at least one digit,
+// trailing characters ignored, out-of-range rejected.
+const char* parseLeadingInt(const char* first, const char* last, int* value) {
+    if (first != last && *first == '+') {
+        ++first;
+        if (first != last && *first == '-') {
+            return nullptr;
+        }
+    }
+    const auto [ptr, ec] = std::from_chars(first, last, *value);
+    if (ec != std::errc {}) {
+        return nullptr;
+    }
+    return ptr;
+}
+
+bool parseIntToken(const std::string_view token, int* value) {
+    return parseLeadingInt(token.data(), token.data() + token.size(), value) != nullptr;
+}
+
+bool parseMagic(const std::string_view magic, PpmFormat* format) {
+    if (magic == "P2") {
+        *format = PpmFormat::kAsciiGray;
+    } else if (magic == "P3") {
+        *format = PpmFormat::kAsciiRgb;
+    } else if (magic == "P5") {
+        *format = PpmFormat::kBinaryGray;
+    } else if (magic == "P6") {
+        *format = PpmFormat::kBinaryRgb;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+constexpr int kMaxSampleValue = 65535;
+
+}  // namespace
+
+std::string_view magicFor(const PpmFormat format) noexcept {
+    switch (format) {
+        case PpmFormat::kAsciiGray:
+            return "P2";
+        case PpmFormat::kAsciiRgb:
+            return "P3";
+        case PpmFormat::kBinaryGray:
+            return "P5";
+        case PpmFormat::kBinaryRgb:
+            return "P6";
+    }
+    return "P3";
+}
+
+int channelCount(const PpmFormat format) noexcept {
+    return (format == PpmFormat::kAsciiGray || format == PpmFormat::kBinaryGray) ? 1 : 3;
+}
+
+bool isBinary(const PpmFormat format) noexcept {
+    return format == PpmFormat::kBinaryGray || format == PpmFormat::kBinaryRgb;
+}
+
+PpmFormat formatFor(const int channels, const bool binary) noexcept {
+    if (channels == 1) {
+        return binary ? PpmFormat::kBinaryGray : PpmFormat::kAsciiGray;
+    }
+    return binary ? PpmFormat::kBinaryRgb : PpmFormat::kAsciiRgb;
+}
+
+bool PpmHeaderParser::feed(const std::string_view chunk) noexcept {
+    for (const char ch : chunk) {
+        if (complete_ == kTokens) {
+            break;
+        }
+        if (in_comment_) {
+            in_comment_ = ch != '\n';
+        } else if (isPpmWhitespace(ch)) {
+            if (in_token_) {
+                in_token_ = false;
+                // The separator after the last token is left for the raster.
+                if (++complete_ == kTokens) {
+                    break;
+                }
+            }
+        } else if (in_token_ || ch != '#') {
+            in_token_ = true;
+            std::size_t& size = token_sizes_[static_cast<std::size_t>(complete_)];
+            if (size < kTokenCapacity) {
+                tokens_[static_cast<std::size_t>(complete_)][size++] = ch;
+            }
+        } else {
+            in_comment_ = true;
+        }
+        ++consumed_;
+    }
+    return complete_ == kTokens;
+}
+
+bool PpmHeaderParser::finish(
+    const std::uint64_t file_bytes,
+    PpmHeader* header_out,
+    std::size_t* raster_offset,
+    std::string* error_message) const {
+    // A last token running to the end of the input ends there.
+    const int tokens = complete_ + (in_token_ ? 1 : 0);
+    const auto token = [this](const int index) {
+        const auto slot = static_cast<std::size_t>(index);
+        return std::string_view(tokens_[slot].data(), token_sizes_[slot]);
+    };
+
+    PpmHeader header {};
+    if (tokens < kTokens || !parseMagic(token(0), &header.format)) {
+        setError(error_message, "unsupported or invalid ppm header");
+        return false;
+    }
+
+    if (!parseIntToken(token(1), &header.width) || !parseIntToken(token(2), &header.height) ||
+        !parseIntToken(token(3), &header.max_value)) {
+        setError(error_message, "invalid ppm dimensions");
+        return false;
+    }
+
+    if (header.width <= 0 || header.height <= 0 || header.max_value <= 0) {
+        setError(error_message, "ppm dimensions must be positive");
+        return false;
+    }
+
+    // Samples are stored in at most 16 bits, which is also the Netpbm limit for every variant.
+    if (header.max_value > kMaxSampleValue) {
+        setError(error_message, "unsupported or invalid ppm header");
+        return false;
+    }
+
+    const bool binary = isBinary(header.format);
+    const std::uint64_t header_end = consumed_;
+    const std::uint64_t sample_count = static_cast<std::uint64_t>(header.width) * static_cast<std::uint64_t>(header.height) *
+                                       static_cast<std::uint64_t>(channelCount(header.format));
+    if (binary) {
+        // Exactly one whitespace byte separates the max value from the raster.
+        const std::uint64_t sample_bytes = header.max_value > 255 ? 2 : 1;
+        if (header_end >= file_bytes || sample_count > (file_bytes - header_end - 1) / sample_bytes) {
+            setError(error_message, "ppm data is incomplete");
+            return false;
+        }
+    } else if (sample_count > (file_bytes - header_end + 1) / 2) {
+        // Every ASCII sample needs at least one digit plus a separator, so files that cannot hold
+        // the declared raster are rejected before the caller sizes a buffer from the header. Both
+        // checks divide the file size rather than multiply the sample count, which can wrap.
+        setError(error_message, "ppm data is incomplete");
+        return false;
+    }
+
+    *header_out = header;
+    *raster_offset = static_cast<std::size_t>(header_end) + (binary ? 1 : 0);
+    return true;
+}
+
+bool PpmReader::open(const std::string& path, std::string* error_message) {
+    cursor_ = 0;
+    rows_read_ = 0;
+    step_ = 1;
+    header_ = {};
+    source_ = {};
+
+    if (!file_.open(path)) {
+        setError(error_message, "failed to open file");
+        return false;
+    }
+
+    PpmHeaderParser parser;
+    parser.feed(file_.view());
+    PpmHeader header {};
+    if (!parser.finish(file_.size(), &header, &cursor_, error_message)) {
+        return false;
+    }
+    header_ = header;
+    source_ = header;
+    crop_ = {0, 0, header.width, header.height};
+    return true;
+}
+
+void PpmReader::subsample(const int step) noexcept {
+    step_ = std::max(1, step);
+    header_.width = (source_.width + step_ - 1) / step_;
+    header_.height = (source_.height + step_ - 1) / step_;
+    crop_ = {0, 0, header_.width, header_.height};
+}
+
+void PpmReader::crop(const PixelRect& rect) noexcept {
+    crop_ = rect;
+    header_.width = rect.width;
+    header_.height = rect.height;
+}
+
+const PpmHeader& PpmReader::header() const noexcept {
+    return header_;
+}
+
+const PpmHeader& PpmReader::sourceHeader() const noexcept {
+    return source_;
+}
+
+int PpmReader::rowsRead() const noexcept {
+    return rows_read_;
+}
+
+std::size_t PpmReader::bytesRead() const noexcept {
+    return cursor_;
+}
+
+template <typename T>
+bool PpmReader::readRows(const MutableImageView<T> destination, std::string* error_message) {
+    const int row_count = destination.height;
+    if (destination.width != header_.width || destination.samples_per_pixel != channelCount(header_.format)) {
+        setError(error_message, "ppm destination does not match image layout");
+        return false;
+    }
+    if (row_count < 0 || row_count > header_.height - rows_read_) {
+        setError(error_message, "ppm data is incomplete");
+        return false;
+    }
+    if (header_.max_value > std::numeric_limits<T>::max()) {
+        setError(error_message, "ppm sample depth exceeds destination");
+        return false;
+    }
+
+    if (isBinary(header_.format)) {
+        readBinaryRows(destination);
+    } else if (!readAsciiRows(destination, error_message)) {
+        return false;
+    }
+
+    rows_read_ += row_count;
+    return true;
+}
+
+template <typename T>
+bool PpmReader::readAsciiRows(const MutableImageView<T> destination, std::string* error_message) {
+    const char* const data = file_.data();
+    const char* const end = data + file_.size();
+    const char* cursor = data + cursor_;
+    const int max_value = header_.max_value;
+    const int channels = channelCount(header_.format);
+    const std::size_t samples_per_row = static_cast<std::size_t>(source_.width) * static_cast<std::size_t>(channels);
+    const std::size_t samples_before = static_cast<std::size_t>(sourceColumnsBefore()) * static_cast<std::size_t>(channels);
+    const std::size_t samples_in = static_cast<std::size_t>(sourceColumnsIn()) * static_cast<std::size_t>(channels);
+
+    // Moves to the start of the next sample, past whitespace and comments; false when there is none.
+    const auto next_sample = [&cursor, end] {
+        for (;;) {
+            while (cursor != end && isPpmWhitespace(*cursor)) {
+                ++cursor;
+            }
+            if (cursor == end || *cursor != '#') {
+                break;
+            }
+            cursor = std::find(cursor, end, '\n');
+        }
+        return cursor != end;
+    };
+    const auto skip_sample = [&cursor, end] {
+        while (cursor != end && !isPpmWhitespace(*cursor)) {
+            ++cursor;
+        }
+    };
+    const auto skip_samples = [&](const std::size_t count) {
+        for (std::size_t index = 0; index < count; ++index) {
+            if (!next_sample()) {
+                setError(error_message, "ppm data is incomplete");
+                return false;
+            }
+            skip_sample();
+        }
+        return true;
+    };
+
+    if (rows_read_ == 0 && destination.height > 0 &&
+        !skip_samples(samples_per_row * static_cast<std::size_t>(sourceRowsBefore()))) {
+        return false;
+    }
+    for (int y = 0; y < destination.height; ++y) {
+        T* row = destination.row(y);
+        T* sample = row;
+        if (!skip_samples(samples_before)) {
+            return false;
+        }
+        // Channel of the next sample, and its pixel's column modulo the step; only column 0 is kept.
+        int channel = 0;
+        int column = 0;
+        for (std::size_t index = 0; index < samples_in; ++index) {
+            if (!next_sample()) {
+                setError(error_message, "ppm data is incomplete");
+                return false;
+            }
+
+            if (column == 0) {
+                int value = 0;
+                const char* parsed_end = parseLeadingInt(cursor, end, &value);
+                if (parsed_end == nullptr) {
+                    setError(error_message, "ppm pixel parse failed");
+                    return false;
+                }
+                cursor = parsed_end;
+                *sample++ = static_cast<T>(std::clamp(value, 0, max_value));
+            }
+            skip_sample();
+
+            if (++channel == channels) {
+                channel = 0;
+                if (++column == step_) {
+                    column = 0;
+                }
+            }
+        }
+
+        const std::size_t skipped = samples_per_row - samples_before - samples_in +
+                                    samples_per_row * static_cast<std::size_t>(sourceRowsAfter(rows_read_ + y));
+        if (!skip_samples(skipped)) {
+            return false;
+        }
+    }
+
+    cursor_ = static_cast<std::size_t>(cursor - data);
+    return true;
+}
+
+template <typename T>
+void PpmReader::readBinaryRows(const MutableImageView<T> destination) {
+    const auto* source = reinterpret_cast<const unsigned char*>(file_.data() + cursor_);
+    const auto channels = static_cast<std::size_t>(channelCount(header_.format));
+    const std::size_t samples_per_row = static_cast<std::size_t>(header_.width) * channels;
+    const bool wide_samples = header_.max_value > 255;
+    const std::size_t sample_bytes = wide_samples ? 2 : 1;
+    const std::size_t row_bytes = static_cast<std::size_t>(source_.width) * channels * sample_bytes;
+    const auto max_value = static_cast<T>(header_.max_value);
+
+    if (rows_read_ == 0) {
+        source += row_bytes * static_cast<std::size_t>(sourceRowsBefore());
+    }
+    const std::size_t bytes_before = static_cast<std::size_t>(sourceColumnsBefore()) * channels * sample_bytes;
+    for (int y = 0; y < destination.height; ++y) {
+        T* row = destination.row(y);
+        const unsigned char* const first = source + bytes_before;
+        if (step_ > 1) {
+            // Every step-th pixel of the row, gathered one sample at a time.
+            const std::size_t pixel_bytes = channels * sample_bytes * static_cast<std::size_t>(step_);
+            const unsigned char* pixel = first;
+            for (std::size_t index = 0; index < samples_per_row; index += channels, pixel += pixel_bytes) {
+                for (std::size_t channel = 0; channel < channels; ++channel) {
+                    const unsigned value = wide_samples ? (static_cast<unsigned>(pixel[2 * channel]) << 8) | pixel[2 * channel + 1]
+                                                        : pixel[channel];
+                    row[index + channel] = static_cast<T>(std::min<unsigned>(value, max_value));
+                }
+            }
+        } else if (std::is_same_v<T, std::uint16_t> && wide_samples) {
+            // Byte swap and clamp in one dispatched pass.
+            if constexpr (std::is_same_v<T, std::uint16_t>) {
+                activeKernels().unpack_big_endian_u16(first, samples_per_row, max_value, row);
+            }
+        } else {
+            if constexpr (std::is_same_v<T, std::uint8_t>) {
+                std::memcpy(row, first, samples_per_row);
+            } else {
+                std::copy(first, first + samples_per_row, row);
+            }
+
+            // Out-of-range samples clamp to max value, matching the ASCII path.
+            if (header_.max_value != std::numeric_limits<T>::max()) {
+                for (std::size_t index = 0; index < samples_per_row; ++index) {
+                    row[index] = std::min(row[index], max_value);
+                }
+            }
+        }
+        source += row_bytes * static_cast<std::size_t>(1 + sourceRowsAfter(rows_read_ + y));
+    }
+    cursor_ = static_cast<std::size_t>(reinterpret_cast<const char*>(source) - file_.data());
+}
+
+int PpmReader::sourceRowsAfter(const int row) const noexcept {
+    return std::min(step_ - 1, source_.height - (crop_.y + row) * step_ - 1);
+}
+
+int PpmReader::sourceRowsBefore() const noexcept {
+    return crop_.y * step_;
+}
+
+int PpmReader::sourceColumnsBefore() const noexcept {
+    return crop_.x * step_;
+}
+
+int PpmReader::sourceColumnsIn() const noexcept {
+    return std::min(crop_.width * step_, source_.width - crop_.x * step_);
+}
+
+bool decodePpm(const std::string& path, Image* image, std::string* error_message, PpmHeader* header_out) {
+    PpmReader reader;
+    if (!reader.open(path, error_message)) {
+        return false;
+    }
+
+    const PpmHeader& header = reader.header();
+    const bool ok = dispatchPixelBuffer(channelCount(header.format), header.max_value, [&](auto buffer_type) {
+        using Buffer = typename decltype(buffer_type)::type;
+        Buffer pixels(header.width, header.height);
+        if (!reader.readRows(pixels.mutableView(), error_message)) {
+            return false;
+        }
+        if (image != nullptr) {
+            image->max_value = header.max_value;
+            image->pixels = std::move(pixels);
+        }
+        return true;
+    });
+    if (!ok) {
+        return false;
+    }
+
+    if (header_out != nullptr) {
+        *header_out = header;
+    }
+    return true;
+}
+
+bool PpmWriter::open(const std::string& path, const PpmHeader& header, std::string* error_message) {
+    if (header.max_value <= 0 || header.max_value > kMaxSampleValue) {
+        setError(error_message, "max value exceeds ppm sample range");
+        return false;
+    }
+
+    const std::filesystem::path output_path(path);
+    const auto output_dir = output_path.parent_path();
+    if (!output_dir.empty()) {
+        std::filesystem::create_directories(output_dir);
+    }
+
+    output_ = std::ofstream(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!output_.good()) {
+        setError(error_message, "failed to open output path");
+        return false;
+    }
+
+    header_ = header;
+    bytes_written_ = 0;
+    buffered_ = 0;
+    buffer_.resize(kFlushBytes);
+
+    // Entry v holds the decimal digits of v padded to 8 bytes with the length in the last byte;
+    // appendAsciiRow copies all 8 and advances by the length, so no per-sample branching.
+    digit_table_.clear();
+    if (!isBinary(header.format)) {
+        digit_table_.resize(static_cast<std::size_t>(header.max_value) + 1);
+        for (int value = 0; value <= header.max_value; ++value) {
+            auto& entry = digit_table_[static_cast<std::size_t>(value)];
+            entry.fill('\0');
+            const auto [end, ec] = std::to_chars(entry.data(), entry.data() + 7, value);
+            (void)ec;
+            entry[7] = static_cast<char>(end - entry.data());
+        }
+    }
+
+    std::string header_text(magicFor(header.format));
+    header_text.push_back('\n');
+    header_text.append(std::to_string(header.width)).push_back(' ');
+    header_text.append(std::to_string(header.height)).push_back('\n');
+    header_text.append(std::to_string(header.max_value)).push_back('\n');
+    std::copy(header_text.begin(), header_text.end(), buffer_.begin());
+    buffered_ = header_text.size();
+    return true;
+}
+
+template <typename T>
+bool PpmWriter::writeRows(const ImageView<T> source, std::string* error_message) {
+    if (source.width != header_.width || source.samples_per_pixel != channelCount(header_.format)) {
+        setError(error_message, "ppm source does not match image layout");
+        return false;
+    }
+    const std::size_t samples_per_row =
+        static_cast<std::size_t>(header_.width) * static_cast<std::size_t>(channelCount(header_.format));
+    // Worst case per sample: 5 digits plus a separator in ASCII, 2 bytes in binary; the extra
+    // 8 bytes cover the fixed-width table copy at the end of a row.
+    const std::size_t row_capacity = isBinary(header_.format) ? samples_per_row * 2 : samples_per_row * 6 + 8;
+
+    for (int y = 0; y < source.height; ++y) {
+        if (buffer_.size() - buffered_ < row_capacity) {
+            if (!flush(error_message)) {
+                return false;
+            }
+            if (buffer_.size() < row_capacity) {
+                buffer_.resize(row_capacity);
+            }
+        }
+
+        const T* row = source.row(y);
+        if (isBinary(header_.format)) {
+            appendBinaryRow(row);
+        } else {
+            appendAsciiRow(row);
+        }
+
+        if (buffered_ >= kFlushBytes && !flush(error_message)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PpmWriter::close(std::string* error_message) {
+    if (!flush(error_message)) {
+        return false;
+    }
+    output_.close();
+    if (output_.fail()) {
+        setError(error_message, "failed to write output");
+        return false;
+    }
+    return true;
+}
+
+std::size_t PpmWriter::bytesWritten() const noexcept {
+    return bytes_written_ + buffered_;
+}
+
+template <typename T>
+void PpmWriter::appendAsciiRow(const T* row) {
+    char* target = buffer_.data() + buffered_;
+    const std::size_t width = static_cast<std::size_t>(header_.width);
+    const auto max_value = static_cast<T>(header_.max_value);
+
+    const auto append_sample = [this, &target, max_value](const T value, const char separator) {
+        const auto& entry = digit_table_[static_cast<std::size_t>(std::min(value, max_value))];
+        std::copy(entry.begin(), entry.end(), target);
+        target += entry[7];
+        *target++ = separator;
+    };
+
+    if (channelCount(header_.format) == 1) {
+        for (std::size_t x = 0; x < width; ++x) {
+            append_sample(row[x], '\n');
+        }
+    } else {
+        for (std::size_t x = 0; x < width; ++x) {
+            append_sample(row[x * 3], ' ');
+            append_sample(row[x * 3 + 1], ' ');
+            append_sample(row[x * 3 + 2], '\n');
+        }
+    }
+    buffered_ = static_cast<std::size_t>(target - buffer_.data());
+}
+
+template <typename T>
+void PpmWriter::appendBinaryRow(const T* row) {
+    auto* target = reinterpret_cast<unsigned char*>(buffer_.data() + buffered_);
+    const std::size_t samples_per_row =
+        static_cast<std::size_t>(header_.width) * static_cast<std::size_t>(channelCount(header_.format));
+
+    if (header_.max_value > 255) {
+        if constexpr (std::is_same_v<T, std::uint16_t>) {
+            activeKernels().pack_big_endian_u16(row, samples_per_row, target);
+        } else {
+            for (std::size_t index = 0; index < samples_per_row; ++index) {
+                target[index * 2] = 0;
+                target[index * 2 + 1] = static_cast<unsigned char>(row[index]);
+            }
+        }
+        buffered_ += samples_per_row * 2;
+        return;
+    }
+
+    if constexpr (std::is_same_v<T, std::uint8_t>) {
+        std::memcpy(target, row, samples_per_row);
+    } else {
+        std::transform(row, row + samples_per_row, target, [](const T value) { return static_cast<unsigned char>(value); });
+    }
+    buffered_ += samples_per_row;
+}
+
+bool PpmWriter::flush(std::string* error_message) {
+    if (buffered_ == 0) {
+        return true;
+    }
+    output_.write(buffer_.data(), static_cast<std::streamsize>(buffered_));
+    bytes_written_ += buffered_;
+    buffered_ = 0;
+    if (!output_.good()) {
+        setError(error_message, "failed to write output");
+        return false;
+    }
+    return true;
+}
+
+bool encodePpm(const Image& image, const PpmFormat format, const std::string& path, std::string* error_message) {
+    const PpmHeader header {
+        .format = format,
+        .width = image.width(),
+        .height = image.height(),
+        .max_value = image.max_value,
+    };
+    if (channelCount(format) != image.channels()) {
+        setError(error_message, "ppm format does not match image channels");
+        return false;
+    }
+
+    PpmWriter writer;
+    if (!writer.open(path, header, error_message)) {
+        return false;
+    }
+    const bool written = std::visit(
+        [&](const auto& pixels) { return writer.writeRows(pixels.view(), error_message); },
+        image.pixels);
+    return written && writer.close(error_message);
+}
+
+template bool PpmReader::readRows<std::uint8_t>(MutableImageView<std::uint8_t>, std::string*);
+template bool PpmReader::readRows<std::uint16_t>(MutableImageView<std::uint16_t>, std::string*);
+template bool PpmWriter::writeRows<std::uint8_t>(ImageView<std::uint8_t>, std::string*);
+template bool PpmWriter::writeRows<std::uint16_t>(ImageView<std::uint16_t>, std::string*);
+
+}  // namespace lumos::engine
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "common/MappedFile.h"
+#include "engine/Image.h"
+#include "engine/ImageView.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace lumos::engine {
+
+// Netpbm variants handled by the engine: ASCII and binary graymaps (P2/P5) and pixmaps (P3/P6).
+enum class PpmFormat {
+    kAsciiGray,
+    kAsciiRgb,
+    kBinaryGray,
+    kBinaryRgb,
+};
+
+[[nodiscard]] std::string_view magicFor(PpmFormat format) noexcept;
+[[nodiscard]] int channelCount(PpmFormat format) noexcept;
+[[nodiscard]] bool isBinary(PpmFormat format) noexcept;
+[[nodiscard]] PpmFormat formatFor(int channels, bool binary) noexcept;
+
+struct PpmHeader {
+    PpmFormat format {PpmFormat::kAsciiRgb};
+    int width {0};
+    int height {0};
+    int max_value {0};
+};
+
+// Incremental parser for the header of a Netpbm file, fed the file's leading bytes in order in
+// chunks of any size. A comment runs from a '#' that starts a token to the end of its line. Tokens
+// are kept in fixed storage, so parsing allocates nothing.
+class PpmHeaderParser {
+  public:
+    // Consumes `chunk`; true once the last header token has ended, after which nothing more is read.
+    bool feed(std::string_view chunk) noexcept;
+    // Validates the header fed so far as that of a file of `file_bytes` bytes, including whether the
+    // file can hold the raster it declares, and gives the offset of that raster.
+    bool finish(std::uint64_t file_bytes, PpmHeader* header, std::size_t* raster_offset, std::string* error_message) const;
+
+  private:
+    static constexpr int kTokens = 4;
+    // Longer tokens are cut; only their leading number counts anyway.
+    static constexpr std::size_t kTokenCapacity = 24;
+
+    std::array<std::array<char, kTokenCapacity>, kTokens> tokens_ {};
+    std::array<std::size_t, kTokens> token_sizes_ {};
+    int complete_ {0};
+    bool in_token_ {false};
+    bool in_comment_ {false};
+    std::uint64_t consumed_ {0};
+};
+
+// Single-pass decoder over a memory-mapped file. ASCII samples are parsed in place with
+// std::from_chars; binary samples (8-bit, or 16-bit big-endian when max value > 255) are copied
+// or byte-swapped directly from the mapping. Either way rows go straight into the caller's
+// buffer without per-token allocation.
+class PpmReader {
+  public:
+    bool open(const std::string& path, std::string* error_message);
+    // Decodes only every `step`-th row and column from here on, the first of each included, so the
+    // image reads as a proxy ceil(width / step) x ceil(height / step); the rows between are skipped
+    // without being decoded. Call before the first read.
+    void subsample(int step) noexcept;
+    // Decodes only `rect` of the image as read from here on, which must lie within it: the image reads
+    // as `rect`, the rows above it are skipped when the first row is read and the columns either side
+    // of it are stepped over. Call after subsample() and before the first read.
+    void crop(const PixelRect& rect) noexcept;
+
+    // Header of the image as read, which is the proxy's when subsampling and the rectangle's when
+    // cropping.
+    [[nodiscard]] const PpmHeader& header() const noexcept;
+    // Header in the file.
+    [[nodiscard]] const PpmHeader& sourceHeader() const noexcept;
+    [[nodiscard]] int rowsRead() const noexcept;
+    // Bytes of the file consumed so far, header included.
+    [[nodiscard]] std::size_t bytesRead() const noexcept;
+
+    // Decodes the next `destination.height` rows as interleaved samples into `destination`, which
+    // must be as wide as the image with one sample per channel. uint8_t destinations require
+    // max value <= 255.
+    template <typename T>
+    bool readRows(MutableImageView<T> destination, std::string* error_message);
+
+  private:
+    template <typename T>
+    bool readAsciiRows(MutableImageView<T> destination, std::string* error_message);
+    template <typename T>
+    void readBinaryRows(MutableImageView<T> destination);
+
+    // Rows of the file to step over after reading row `row` of the image as read.
+    [[nodiscard]] int sourceRowsAfter(int row) const noexcept;
+    // Rows of the file above the crop, and pixels of each row of the file before and in it.
+    [[nodiscard]] int sourceRowsBefore() const noexcept;
+    [[nodiscard]] int sourceColumnsBefore() const noexcept;
+    [[nodiscard]] int sourceColumnsIn() const noexcept;
+
+    common::MappedFile file_;
+    std::size_t cursor_ {0};
+    PpmHeader header_ {};
+    PpmHeader source_ {};
+    int step_ {1};
+    // Rectangle of the subsampled image read; its whole extent unless cropped.
+    PixelRect crop_ {};
+    int rows_read_ {0};
+};
+
+// Row-at-a-time encoder. Rows are formatted into one reusable byte buffer (ASCII samples via a
+// per-value digit table, 8-bit binary rows as a straight block copy, 16-bit rows byte-swapped)
+// and handed to the stream in large blocks.
+class PpmWriter {
+  public:
+    static constexpr std::size_t kFlushBytes = std::size_t {1} << 20;
+
+    bool open(const std::string& path, const PpmHeader& header, std::string* error_message);
+
+    // Appends the rows of `source`, which must match the header width and channel count.
+    template <typename T>
+    bool writeRows(ImageView<T> source, std::string* error_message);
+    bool close(std::string* error_message);
+
+    [[nodiscard]] std::size_t bytesWritten() const noexcept;
+
+  private:
+    template <typename T>
+    void appendAsciiRow(const T* row);
+    template <typename T>
+    void appendBinaryRow(const T* row);
+    bool flush(std::string* error_message);
+
+    std::ofstream output_;
+    PpmHeader header_ {};
+    std::vector<char> buffer_;
+    std::size_t buffered_ {0};
+    std::size_t bytes_written_ {0};
+    std::vector<std::array<char, 8>> digit_table_;
+};
+
+bool decodePpm(const std::string& path, Image* image, std::string* error_message, PpmHeader* header = nullptr);
+
+// Writes `image` in `format` through PpmWriter. The format's channel count must match the image.
+bool encodePpm(const Image& image, PpmFormat format, const std::string& path, std::string* error_message);
+
+}  // namespace lumos::engine
@@ -0,0 +1,278 @@
+#include "engine/Resample.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <numbers>
+#include <tuple>
+#include <utility>
+
+namespace lumos::engine {
+
+namespace {
+
+constexpr std::size_t kMaxCachedWeights = 64;
+
+double filterSupport(const ResampleFilter filter) noexcept {
+    switch (filter) {
+        case ResampleFilter::kNearest:
+            return 0.5;
+        case ResampleFilter::kBilinear:
+            return 1.0;
+        case ResampleFilter::kBicubic:
+            return 2.0;
+        case ResampleFilter::kLanczos3:
+            return 3.0;
+    }
+    return 1.0;
+}
+
+double sinc(const double x) noexcept {
+    if (x == 0.0) {
+        return 1.0;
+    }
+    const double angle = std::numbers::pi * x;
+    return std::sin(angle) / angle;
+}
+
+// `x` is the signed distance from the target sample's centre, in (stretched) source pixels.
+double filterWeight(const ResampleFilter filter, const double x) noexcept {
+    const double distance = std::abs(x);
+    switch (filter) {
+        case ResampleFilter::kNearest:
+            // Half-open so a centre exactly between two pixels picks one of them.
+            return x >= -0.5 && x < 0.5 ? 1.0 : 0.0;
+        case ResampleFilter::kBilinear:
+            return distance < 1.0 ? 1.0 - distance : 0.0;
+        case ResampleFilter::kBicubic: {
+            // Keys cubic with a = -0.5 (Catmull-Rom).
+            constexpr double a = -0.5;
+            if (distance < 1.0) {
+                return ((a + 2.0) * distance - (a + 3.0)) * distance * distance + 1.0;
+            }
+            if (distance < 2.0) {
+                return ((a * distance - 5.0 * a) * distance + 8.0 * a) * distance - 4.0 * a;
+            }
+            return 0.0;
+        }
+        case ResampleFilter::kLanczos3:
+            return distance < 3.0 ? sinc(distance) * sinc(distance / 3.0) : 0.0;
+    }
+    return 0.0;
+}
+
+ResampleWeights computeWeights(const ResampleFilter filter, const int source_size, const int target_size) {
+    const double scale = static_cast<double>(source_size) / static_cast<double>(target_size);
+    const double stretch = std::max(1.0, scale);
+    const double support = filterSupport(filter) * stretch;
+
+    // Real-valued weights per target index over the source range they touch.
+    std::vector<int> starts(static_cast<std::size_t>(target_size));
+    std::vector<std::vector<double>> spans(static_cast<std::size_t>(target_size));
+    int taps = 1;
+    for (int target = 0; target < target_size; ++target) {
+        const double center = (target + 0.5) * scale;
+        const int begin = std::max(0, static_cast<int>(std::floor(center - support + 0.5)));
+        const int end = std::min(source_size, static_cast<int>(std::floor(center + support + 0.5)) + 1);
+        std::vector<double> span;
+        for (int source = begin; source < end; ++source) {
+            span.push_back(filterWeight(filter, (source + 0.5 - center) / stretch));
+        }
+        // Drop zero taps at either end so they do not widen the table.
+        int start = begin;
+        while (!span.empty() && span.front() == 0.0) {
+            span.erase(span.begin());
+            ++start;
+        }
+        while (!span.empty() && span.back() == 0.0) {
+            span.pop_back();
+        }
+        if (span.empty()) {
+            start = std::clamp(static_cast<int>(center), 0, source_size - 1);
+            span.push_back(1.0);
+        }
+        double total = 0.0;
+        for (const double weight : span) {
+            total += weight;
+        }
+        for (double& weight : span) {
+            weight /= total;
+        }
+        starts[static_cast<std::size_t>(target)] = start;
+        spans[static_cast<std::size_t>(target)] = std::move(span);
+    }
+
+    // Windows must never move backwards, or the resampler's ring would already have dropped a row
+    // a later target reads. Dropping zero taps can do that where a centre lands exactly on a source
+    // pixel, so each window starts no later than every window after it and the table widens to fit.
+    std::vector<int> window_starts(starts);
+    for (int target = target_size - 2; target >= 0; --target) {
+        window_starts[static_cast<std::size_t>(target)] =
+            std::min(window_starts[static_cast<std::size_t>(target)], window_starts[static_cast<std::size_t>(target) + 1]);
+    }
+    for (int target = 0; target < target_size; ++target) {
+        const auto index = static_cast<std::size_t>(target);
+        taps = std::max(taps, starts[index] + static_cast<int>(spans[index].size()) - window_starts[index]);
+    }
+
+    ResampleWeights result;
+    result.filter = filter;
+    result.source_size = source_size;
+    result.target_size = target_size;
+    result.taps = std::min(taps, source_size);
+    result.first.resize(static_cast<std::size_t>(target_size));
+    result.weights.assign(static_cast<std::size_t>(target_size) * static_cast<std::size_t>(result.taps), 0);
+
+    constexpr int kOne = 1 << kResampleWeightBits;
+    for (int target = 0; target < target_size; ++target) {
+        const auto& span = spans[static_cast<std::size_t>(target)];
+        // Shift windows near the end left so every tap reads inside the source; the extra taps
+        // carry zero weight.
+        const int first = std::min(window_starts[static_cast<std::size_t>(target)], source_size - result.taps);
+        const int offset = starts[static_cast<std::size_t>(target)] - first;
+        std::int16_t* quantized = result.weights.data() + static_cast<std::size_t>(target) * static_cast<std::size_t>(result.taps);
+        int total = 0;
+        std::size_t largest = 0;
+        for (std::size_t index = 0; index < span.size(); ++index) {
+            const auto value = static_cast<int>(std::lround(span[index] * kOne));
+            quantized[static_cast<std::size_t>(offset) + index] = static_cast<std::int16_t>(value);
+            total += value;
+            if (std::abs(span[index]) > std::abs(span[largest])) {
+                largest = index;
+            }
+        }
+        // Rounding error goes to the largest weight, where it matters least.
+        quantized[static_cast<std::size_t>(offset) + largest] =
+            static_cast<std::int16_t>(quantized[static_cast<std::size_t>(offset) + largest] + kOne - total);
+        result.first[static_cast<std::size_t>(target)] = first;
+    }
+    return result;
+}
+
+}  // namespace
+
+std::shared_ptr<const ResampleWeights> resampleWeights(const ResampleFilter filter, const int source_size, const int target_size) {
+    static std::mutex mutex;
+    static std::map<std::tuple<ResampleFilter, int, int>, std::shared_ptr<const ResampleWeights>> cache;
+
+    const auto key = std::make_tuple(filter, source_size, target_size);
+    {
+        const std::lock_guard<std::mutex> lock(mutex);
+        if (const auto found = cache.find(key); found != cache.end()) {
+            return found->second;
+        }
+    }
+
+    auto weights = std::make_shared<const ResampleWeights>(computeWeights(filter, source_size, target_size));
+    const std::lock_guard<std::mutex> lock(mutex);
+    if (cache.size() >= kMaxCachedWeights) {
+        cache.clear();
+    }
+    return cache.try_emplace(key, std::move(weights)).first->second;
+}
+
+template <typename T>
+Resampler<T>::Resampler(
+    const ResampleFilter filter,
+    const int source_width,
+    const int source_height,
+    const int target_width,
+    const int target_height,
+    const int samples_per_pixel,
+    const T max_value)
+    : Resampler(
+          filter, source_width, source_height, target_width, target_height, samples_per_pixel, max_value,
+          PixelRect {0, 0, target_width, target_height}) {}
+
+template <typename T>
+Resampler<T>::Resampler(
+    const ResampleFilter filter,
+    const int source_width,
+    const int source_height,
+    const int target_width,
+    const int target_height,
+    const int samples_per_pixel,
+    const T max_value,
+    const PixelRect& target_region)
+    : horizontal_(resampleWeights(filter, source_width, target_width)),
+      vertical_(resampleWeights(filter, source_height, target_height)),
+      target_region_(target_region),
+      row_samples_(static_cast<std::size_t>(target_region.width) * static_cast<std::size_t>(samples_per_pixel)),
+      samples_per_pixel_(samples_per_pixel),
+      max_value_(max_value),
+      ring_(static_cast<std::size_t>(vertical_->taps) * row_samples_),
+      tap_rows_(static_cast<std::size_t>(vertical_->taps)) {
+    // Tap windows only move forward along an axis, so the first and last target pixels bound them.
+    const auto span = [](const ResampleWeights& weights, const int first, const int count) {
+        const int begin = weights.first[static_cast<std::size_t>(first)];
+        const int end = weights.first[static_cast<std::size_t>(first + count - 1)] + weights.taps;
+        return std::pair {begin, end - begin};
+    };
+    if (target_region == PixelRect {0, 0, target_width, target_height}) {
+        // Whole images take every source row, even ones no target pixel reads.
+        source_region_ = {0, 0, source_width, source_height};
+    } else {
+        const auto [source_x, source_columns] = span(*horizontal_, target_region.x, target_region.width);
+        const auto [source_y, source_rows] = span(*vertical_, target_region.y, target_region.height);
+        source_region_ = {source_x, source_y, source_columns, source_rows};
+    }
+
+    first_columns_.resize(static_cast<std::size_t>(target_region.width));
+    for (int column = 0; column < target_region.width; ++column) {
+        first_columns_[static_cast<std::size_t>(column)] =
+            horizontal_->first[static_cast<std::size_t>(target_region.x + column)] - source_region_.x;
+    }
+}
+
+template <typename T>
+bool Resampler<T>::rowReady() const noexcept {
+    return rows_written_ < target_region_.height &&
+           vertical_->first[static_cast<std::size_t>(target_region_.y + rows_written_)] + vertical_->taps <=
+               source_region_.y + rows_pushed_;
+}
+
+template <typename T>
+void Resampler<T>::pushRow(const T* row) {
+    Intermediate* slot = ring_.data() + static_cast<std::size_t>(rows_pushed_ % vertical_->taps) * row_samples_;
+    resampleHorizontalKernel<T>(activeKernels())(
+        row, samples_per_pixel_, target_region_.width, horizontal_->taps, first_columns_.data(),
+        horizontal_->weights.data() + static_cast<std::size_t>(target_region_.x) * static_cast<std::size_t>(horizontal_->taps),
+        slot);
+    ++rows_pushed_;
+}
+
+template <typename T>
+void Resampler<T>::writeRow(T* target) {
+    const auto index = static_cast<std::size_t>(target_region_.y + rows_written_);
+    const int taps = vertical_->taps;
+    const int first = vertical_->first[index] - source_region_.y;
+    for (int tap = 0; tap < taps; ++tap) {
+        tap_rows_[static_cast<std::size_t>(tap)] = ring_.data() + static_cast<std::size_t>((first + tap) % taps) * row_samples_;
+    }
+    resampleVerticalKernel<T>(activeKernels())(
+        tap_rows_.data(), taps, vertical_->weights.data() + index * static_cast<std::size_t>(taps), row_samples_,
+        max_value_, target);
+    ++rows_written_;
+}
+
+template <typename T>
+void resample(const ImageView<T> input, const ResampleFilter filter, const T max_value, const MutableImageView<T> output) {
+    Resampler<T> resampler(filter, input.width, input.height, output.width, output.height, input.samples_per_pixel, max_value);
+    for (int y = 0; y < input.height; ++y) {
+        while (resampler.rowReady()) {
+            resampler.writeRow(output.row(resampler.rowsWritten()));
+        }
+        resampler.pushRow(input.row(y));
+    }
+    while (resampler.rowReady()) {
+        resampler.writeRow(output.row(resampler.rowsWritten()));
+    }
+}
+
+template class Resampler<std::uint8_t>;
+template class Resampler<std::uint16_t>;
+template void resample<std::uint8_t>(ImageView<std::uint8_t>, ResampleFilter, std::uint8_t, MutableImageView<std::uint8_t>);
+template void resample<std::uint16_t>(ImageView<std::uint16_t>, ResampleFilter, std::uint16_t, MutableImageView<std::uint16_t>);
+
+}  // namespace lumos::engine
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "contracts/EnhancementTypes.h"
+#include "engine/ImageView.h"
+#include "engine/KernelRegistry.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace lumos::engine {
+
+using contracts::ResampleFilter;
+
+// Fixed-point filter weights for resampling one axis from `source_size` to `target_size` samples.
+// Target index i reads source indices [first[i], first[i] + taps), always inside the source, with
+// weights[i * taps ..] in Q14 summing to exactly 1 << kResampleWeightBits, so flat areas stay flat.
+// first[] never decreases.
+// Downscaling widens the filter by the scale to avoid aliasing. kNearest is a box of width one
+// source pixel.
+struct ResampleWeights {
+    ResampleFilter filter {ResampleFilter::kNearest};
+    int source_size {0};
+    int target_size {0};
+    int taps {0};
+    std::vector<std::int32_t> first {};
+    std::vector<std::int16_t> weights {};
+};
+
+// Weights for (filter, source_size, target_size), computed on first use and shared from a small
+// process-wide cache afterwards. Thread-safe.
+[[nodiscard]] std::shared_ptr<const ResampleWeights> resampleWeights(ResampleFilter filter, int source_size, int target_size);
+
+// Separable resampler fed one source row at a time. Each pushed row is filtered horizontally once
+// into a ring of `taps` rows; a target row is ready as soon as its last source row has arrived, so
+// the working set is a few target-width rows regardless of the image height.
+//
+// Given a `target_region`, it produces only that rectangle of the target with the weights of the
+// whole image, so pieces computed separately match the whole image exactly. Rows pushed are then
+// the pixels of sourceRegion(), which is every source pixel the rectangle reads.
+template <typename T>
+class Resampler {
+  public:
+    Resampler(
+        ResampleFilter filter,
+        int source_width,
+        int source_height,
+        int target_width,
+        int target_height,
+        int samples_per_pixel,
+        T max_value);
+    Resampler(
+        ResampleFilter filter,
+        int source_width,
+        int source_height,
+        int target_width,
+        int target_height,
+        int samples_per_pixel,
+        T max_value,
+        const PixelRect& target_region);
+
+    // True when every source row of the next target row has been pushed.
+    [[nodiscard]] bool rowReady() const noexcept;
+    // Feeds the next source row. Write out every ready row first: pushing may recycle their inputs.
+    void pushRow(const T* row);
+    // Writes the next target row, clamped to [0, max_value], into `target`.
+    void writeRow(T* target);
+    [[nodiscard]] int rowsWritten() const noexcept { return rows_written_; }
+    [[nodiscard]] const PixelRect& sourceRegion() const noexcept { return source_region_; }
+
+  private:
+    using Intermediate = ResampleIntermediate<T>;
+
+    std::shared_ptr<const ResampleWeights> horizontal_;
+    std::shared_ptr<const ResampleWeights> vertical_;
+    PixelRect target_region_ {};
+    PixelRect source_region_ {};
+    // Horizontal taps of the region's columns, relative to the source region.
+    std::vector<std::int32_t> first_columns_ {};
+    std::size_t row_samples_ {0};
+    int samples_per_pixel_ {1};
+    T max_value_ {0};
+    int rows_pushed_ {0};
+    int rows_written_ {0};
+    std::vector<Intermediate> ring_ {};
+    std::vector<const Intermediate*> tap_rows_ {};
+};
+
+// Resamples all of `input` into `output` with `filter`; the sizes set the scale on each axis.
+template <typename T>
+void resample(ImageView<T> input, ResampleFilter filter, T max_value, MutableImageView<T> output);
+
+}  // namespace lumos::engine
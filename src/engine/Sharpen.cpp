@@ -0,0 +1,140 @@
+#include "engine/Sharpen.h"
+
+#include <algorithm>
+
+namespace lumos::engine {
+
+template <typename T>
+UnsharpMask<T>::UnsharpMask(const int width, const int height, const int samples_per_pixel, const UnsharpMaskOptions& options)
+    : width_(width),
+      height_(height),
+      samples_per_pixel_(samples_per_pixel),
+      radius_(std::clamp(options.radius, 1, kMaxUnsharpMaskRadius)),
+      taps_(2 * radius_ + 1),
+      strength_(std::max(0.0f, options.strength)),
+      row_samples_(static_cast<std::size_t>(width) * static_cast<std::size_t>(samples_per_pixel)),
+      rows_(static_cast<std::size_t>(taps_) * row_samples_),
+      sums_(rows_.size()),
+      minima_(rows_.size()),
+      maxima_(rows_.size()),
+      padded_(static_cast<std::size_t>(width + 2 * radius_) * static_cast<std::size_t>(samples_per_pixel)),
+      column_sums_(row_samples_),
+      column_minima_(row_samples_),
+      column_maxima_(row_samples_) {}
+
+template <typename T>
+std::size_t UnsharpMask<T>::slot(const int row) const noexcept {
+    return static_cast<std::size_t>(row % taps_) * row_samples_;
+}
+
+template <typename T>
+bool UnsharpMask<T>::rowReady() const noexcept {
+    return rows_written_ < height_ && (rows_pushed_ > rows_written_ + radius_ || rows_pushed_ == height_);
+}
+
+template <typename T>
+void UnsharpMask<T>::pushRow(const T* row) {
+    // Raw pointers throughout: 8-bit stores may alias anything, vector internals included, which
+    // would otherwise force a reload per sample and defeat vectorization.
+    const std::size_t offset = slot(rows_pushed_);
+    const std::size_t count = row_samples_;
+    std::copy_n(row, count, rows_.data() + offset);
+
+    // Horizontal sums, minima and maxima over the row extended by `radius` edge pixels per side.
+    const auto step = static_cast<std::size_t>(samples_per_pixel_);
+    const std::size_t edge = static_cast<std::size_t>(radius_) * step;
+    T* padded = padded_.data();
+    for (std::size_t index = 0; index < edge; ++index) {
+        padded[index] = row[index % step];
+        padded[edge + count + index] = row[count - step + index % step];
+    }
+    std::copy_n(row, count, padded + edge);
+
+    std::uint32_t* sums = sums_.data() + offset;
+    T* minima = minima_.data() + offset;
+    T* maxima = maxima_.data() + offset;
+    std::copy_n(padded, count, sums);
+    std::copy_n(padded, count, minima);
+    std::copy_n(padded, count, maxima);
+    for (int tap = 1; tap < taps_; ++tap) {
+        const T* shifted = padded + static_cast<std::size_t>(tap) * step;
+        for (std::size_t index = 0; index < count; ++index) {
+            sums[index] += shifted[index];
+        }
+        for (std::size_t index = 0; index < count; ++index) {
+            minima[index] = std::min(minima[index], shifted[index]);
+        }
+        for (std::size_t index = 0; index < count; ++index) {
+            maxima[index] = std::max(maxima[index], shifted[index]);
+        }
+    }
+    ++rows_pushed_;
+}
+
+template <typename T>
+void UnsharpMask<T>::writeRow(T* target) {
+    const int y = rows_written_++;
+    const std::size_t count = row_samples_;
+    const T* source = rows_.data() + slot(y);
+    if (strength_ == 0.0f) {
+        std::copy_n(source, count, target);
+        return;
+    }
+
+    // Vertical pass over the ring rows of y - radius .. y + radius, edge rows repeated.
+    std::uint32_t* column_sums = column_sums_.data();
+    T* column_minima = column_minima_.data();
+    T* column_maxima = column_maxima_.data();
+    for (int offset = -radius_; offset <= radius_; ++offset) {
+        const std::size_t row = slot(std::clamp(y + offset, 0, height_ - 1));
+        const std::uint32_t* sums = sums_.data() + row;
+        const T* minima = minima_.data() + row;
+        const T* maxima = maxima_.data() + row;
+        if (offset == -radius_) {
+            std::copy_n(sums, count, column_sums);
+            std::copy_n(minima, count, column_minima);
+            std::copy_n(maxima, count, column_maxima);
+            continue;
+        }
+        // One stream per loop keeps each loop to a single store pointer, which GCC can vectorize
+        // with a couple of runtime alias checks.
+        for (std::size_t index = 0; index < count; ++index) {
+            column_sums[index] += sums[index];
+        }
+        for (std::size_t index = 0; index < count; ++index) {
+            column_minima[index] = std::min(column_minima[index], minima[index]);
+        }
+        for (std::size_t index = 0; index < count; ++index) {
+            column_maxima[index] = std::max(column_maxima[index], maxima[index]);
+        }
+    }
+
+    // Subtract, scale and clamp in one pass.
+    const float inverse_area = 1.0f / static_cast<float>(taps_ * taps_);
+    const float strength = strength_;
+    for (std::size_t index = 0; index < count; ++index) {
+        const auto value = static_cast<float>(source[index]);
+        const float blurred = static_cast<float>(column_sums[index]) * inverse_area;
+        const float sharpened = value + strength * (value - blurred) + 0.5f;
+        const float clamped = std::min(std::max(sharpened, static_cast<float>(column_minima[index])), static_cast<float>(column_maxima[index]));
+        target[index] = static_cast<T>(clamped);
+    }
+}
+
+template <typename T>
+void unsharpMask(const ImageView<T> input, const UnsharpMaskOptions& options, const MutableImageView<T> output) {
+    UnsharpMask<T> sharpen(input.width, input.height, input.samples_per_pixel, options);
+    for (int y = 0; y < input.height; ++y) {
+        sharpen.pushRow(input.row(y));
+        while (sharpen.rowReady()) {
+            sharpen.writeRow(output.row(sharpen.rowsWritten()));
+        }
+    }
+}
+
+template class UnsharpMask<std::uint8_t>;
+template class UnsharpMask<std::uint16_t>;
+template void unsharpMask<std::uint8_t>(ImageView<std::uint8_t>, const UnsharpMaskOptions&, MutableImageView<std::uint8_t>);
+template void unsharpMask<std::uint16_t>(ImageView<std::uint16_t>, const UnsharpMaskOptions&, MutableImageView<std::uint16_t>);
+
+}  // namespace lumos::engine
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "engine/ImageView.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lumos::engine {
+
+inline constexpr int kMaxUnsharpMaskRadius = 4;
+
+// Unsharp mask with halo clamping: out = I + strength * (I - box(I)) over a (2 * radius + 1)^2
+// box, clamped to the minimum and maximum of the same neighbourhood, so overshoot at an edge can
+// never draw a light or dark rim beside it. Borders repeat the edge pixel.
+struct UnsharpMaskOptions {
+    // Clamped to [1, kMaxUnsharpMaskRadius].
+    int radius {1};
+    // 0 copies the input.
+    float strength {0.5f};
+};
+
+// Unsharp mask fed the rows of an image one at a time, like Resampler, so it can run on upscaled
+// rows while they are still in cache. Keeps copies of the last 2 * radius + 1 rows with their
+// horizontal sums, minima and maxima; row y is ready once row y + radius has arrived or the image
+// has ended, so a caller may write sharpened rows back over the rows it pushed.
+template <typename T>
+class UnsharpMask {
+  public:
+    UnsharpMask(int width, int height, int samples_per_pixel, const UnsharpMaskOptions& options);
+
+    [[nodiscard]] bool rowReady() const noexcept;
+    // Feeds (and copies) the next row. Write out every ready row first.
+    void pushRow(const T* row);
+    void writeRow(T* target);
+    [[nodiscard]] int rowsWritten() const noexcept { return rows_written_; }
+
+  private:
+    [[nodiscard]] std::size_t slot(int row) const noexcept;
+
+    int width_ {0};
+    int height_ {0};
+    int samples_per_pixel_ {1};
+    int radius_ {1};
+    int taps_ {3};
+    float strength_ {0.0f};
+    std::size_t row_samples_ {0};
+    int rows_pushed_ {0};
+    int rows_written_ {0};
+    std::vector<T> rows_ {};
+    std::vector<std::uint32_t> sums_ {};
+    std::vector<T> minima_ {};
+    std::vector<T> maxima_ {};
+    std::vector<T> padded_ {};
+    std::vector<std::uint32_t> column_sums_ {};
+    std::vector<T> column_minima_ {};
+    std::vector<T> column_maxima_ {};
+};
+
+template <typename T>
+void unsharpMask(ImageView<T> input, const UnsharpMaskOptions& options, MutableImageView<T> output);
+
+}  // namespace lumos::engine
@@ -0,0 +1,339 @@
+#include "engine/Stage.h"
+
+#include "engine/Upscale.h"
+
+#include <algorithm>
+#include <optional>
+#include <vector>
+
+namespace lumos::engine {
+
+namespace {
+
+// `rect` grown by `margin` on every side, clipped to a width x height image.
+PixelRect grow(const PixelRect& rect, const int margin, const int width, const int height) noexcept {
+    const int left = std::max(0, rect.x - margin);
+    const int top = std::max(0, rect.y - margin);
+    return {left, top, std::min(width, rect.right() + margin) - left, std::min(height, rect.bottom() + margin) - top};
+}
+
+std::size_t samplesOf(const int width, const PpmHeader& header) noexcept {
+    return static_cast<std::size_t>(width) * static_cast<std::size_t>(channelCount(header.format));
+}
+
+bool edgePreserving(const contracts::EnhancementRequest& request) noexcept {
+    return request.preset_name == contracts::kEdgePreservingPreset;
+}
+
+// Denoise treats its source region as an image of its own, which only changes pixels within its
+// halo of the cut edges, so the wanted pixels are the ones an untiled run produces.
+template <typename Sample>
+class DenoiseRows final : public RowStage<Sample> {
+  public:
+    DenoiseRows(
+        const bool edge_preserving,
+        const BoxBlurOptions& box,
+        const GuidedFilterOptions& guided,
+        const int halo,
+        const RowStageSetup& setup)
+        : edge_preserving_(edge_preserving),
+          box_(box),
+          guided_(guided),
+          max_value_(static_cast<Sample>(setup.input.max_value)),
+          source_(grow(setup.wanted, halo, setup.input.width, setup.input.height)),
+          column_offset_(samplesOf(setup.wanted.x - source_.x, setup.input)),
+          cropped_(setup.wanted.width != source_.width),
+          row_(cropped_ ? samplesOf(source_.width, setup.input) : 0),
+          row_samples_(samplesOf(setup.wanted.width, setup.input)) {}
+
+    [[nodiscard]] PixelRect sourceRegion() const noexcept override { return source_; }
+
+    void setWindow(const ImageView<Sample> window, const int window_first_row, const int first_row, const int last_row) override {
+        blurred_rows_.reset();
+        guided_rows_.reset();
+        const int window_first = window_first_row - source_.y;
+        if (edge_preserving_) {
+            guided_rows_.emplace(window, window_first, source_.height, first_row - source_.y, guided_, max_value_);
+        } else {
+            blurred_rows_.emplace(window, window_first, source_.height, first_row - source_.y, box_);
+        }
+        next_row_ = first_row;
+        last_row_ = last_row;
+    }
+
+    [[nodiscard]] bool rowReady() override { return next_row_ < last_row_; }
+
+    void writeRow(Sample* target) override {
+        Sample* filtered = cropped_ ? row_.data() : target;
+        if (guided_rows_) {
+            guided_rows_->nextRow(filtered);
+        } else {
+            blurred_rows_->nextRow(filtered);
+        }
+        if (cropped_) {
+            std::copy_n(row_.data() + column_offset_, row_samples_, target);
+        }
+        ++next_row_;
+    }
+
+  private:
+    bool edge_preserving_ {false};
+    BoxBlurOptions box_ {};
+    GuidedFilterOptions guided_ {};
+    Sample max_value_ {0};
+    PixelRect source_ {};
+    std::size_t column_offset_ {0};
+    bool cropped_ {false};
+    std::vector<Sample> row_ {};
+    std::size_t row_samples_ {0};
+    std::optional<BoxBlurRowStream<Sample>> blurred_rows_ {};
+    std::optional<GuidedFilterRowStream<Sample>> guided_rows_ {};
+    int next_row_ {0};
+    int last_row_ {0};
+};
+
+// The upscaler uses the weights of the whole image whatever region it is opened for.
+template <typename Sample>
+class ResampleRows final : public RowStage<Sample> {
+  public:
+    ResampleRows(const contracts::EnhancementRequest& request, const RowStageSetup& setup)
+        : upscaler_(
+              request.filter, setup.input.width, setup.input.height, setup.output.width, setup.output.height,
+              channelCount(setup.input.format), static_cast<Sample>(setup.input.max_value), setup.wanted) {}
+
+    [[nodiscard]] PixelRect sourceRegion() const noexcept override { return upscaler_.sourceRegion(); }
+    void pushRow(const Sample* row) override { upscaler_.pushRow(row); }
+    [[nodiscard]] bool rowReady() override { return upscaler_.rowReady(); }
+    void writeRow(Sample* target) override { upscaler_.writeRow(target); }
+
+  private:
+    RowUpscaler<Sample> upscaler_;
+};
+
+// Sharpens the wanted rectangle grown by the mask's radius as an image of its own and drops the
+// rows and columns outside the wanted one, which are the only ones the cut edges change.
+template <typename Sample>
+class SharpenRows final : public RowStage<Sample> {
+  public:
+    SharpenRows(const UnsharpMaskOptions& options, const RowStageSetup& setup)
+        : source_(grow(
+              setup.wanted, std::clamp(options.radius, 1, kMaxUnsharpMaskRadius), setup.input.width, setup.input.height)),
+          wanted_(setup.wanted),
+          column_offset_(samplesOf(setup.wanted.x - source_.x, setup.input)),
+          cropped_(setup.wanted.width != source_.width),
+          row_(samplesOf(source_.width, setup.input)),
+          row_samples_(samplesOf(setup.wanted.width, setup.input)),
+          sharpener_(source_.width, source_.height, channelCount(setup.input.format), options) {}
+
+    [[nodiscard]] PixelRect sourceRegion() const noexcept override { return source_; }
+    void pushRow(const Sample* row) override { sharpener_.pushRow(row); }
+
+    [[nodiscard]] bool rowReady() override {
+        while (sharpener_.rowReady()) {
+            const int row = source_.y + sharpener_.rowsWritten();
+            if (row >= wanted_.y && row < wanted_.bottom()) {
+                return true;
+            }
+            sharpener_.writeRow(row_.data());
+        }
+        return false;
+    }
+
+    void writeRow(Sample* target) override {
+        if (!cropped_) {
+            sharpener_.writeRow(target);
+            return;
+        }
+        sharpener_.writeRow(row_.data());
+        std::copy_n(row_.data() + column_offset_, row_samples_, target);
+    }
+
+  private:
+    PixelRect source_ {};
+    PixelRect wanted_ {};
+    std::size_t column_offset_ {0};
+    bool cropped_ {false};
+    std::vector<Sample> row_ {};
+    std::size_t row_samples_ {0};
+    UnsharpMask<Sample> sharpener_;
+};
+
+int filterRadius(const contracts::ResampleFilter filter) noexcept {
+    switch (filter) {
+        case contracts::ResampleFilter::kNearest:
+            return 0;
+        case contracts::ResampleFilter::kBilinear:
+            return 1;
+        case contracts::ResampleFilter::kBicubic:
+            return 2;
+        case contracts::ResampleFilter::kLanczos3:
+            return 3;
+    }
+    return 0;
+}
+
+}  // namespace
+
+bool IStage::active(const contracts::EnhancementRequest&, const PpmHeader&) const {
+    return true;
+}
+
+PpmHeader IStage::outputHeader(const contracts::EnhancementRequest&, const PpmHeader& input) const {
+    return input;
+}
+
+StageRequirements IStage::requirements(const contracts::EnhancementRequest&, const PpmHeader&) const {
+    return {};
+}
+
+bool IStage::openInput(const contracts::EnhancementRequest&, PpmReader*, std::string* error_message) const {
+    if (error_message != nullptr) {
+        *error_message = std::string(name()) + " does not decode";
+    }
+    return false;
+}
+
+bool IStage::openOutput(const contracts::EnhancementRequest&, const PpmHeader&, PpmWriter*, std::string* error_message) const {
+    if (error_message != nullptr) {
+        *error_message = std::string(name()) + " does not encode";
+    }
+    return false;
+}
+
+std::unique_ptr<RowStage<std::uint8_t>> IStage::openRows(
+    const contracts::EnhancementRequest&,
+    const RowStageSetup&,
+    std::type_identity<std::uint8_t>) const {
+    return nullptr;
+}
+
+std::unique_ptr<RowStage<std::uint16_t>> IStage::openRows(
+    const contracts::EnhancementRequest&,
+    const RowStageSetup&,
+    std::type_identity<std::uint16_t>) const {
+    return nullptr;
+}
+
+bool DecodeStage::openInput(const contracts::EnhancementRequest& request, PpmReader* reader, std::string* error_message) const {
+    if (!reader->open(request.input_path, error_message)) {
+        return false;
+    }
+    reader->subsample(contracts::previewStep(reader->header().width, reader->header().height, request));
+    return true;
+}
+
+DenoiseStage::DenoiseStage(const BoxBlurOptions box, const GuidedFilterOptions guided) : box_(box), guided_(guided) {}
+
+bool DenoiseStage::active(const contracts::EnhancementRequest& request, const PpmHeader&) const {
+    return request.denoise_enabled;
+}
+
+StageRequirements DenoiseStage::requirements(const contracts::EnhancementRequest& request, const PpmHeader&) const {
+    const int halo = edgePreserving(request) ? 2 * std::clamp(guided_.radius, 0, kMaxGuidedFilterRadius)
+                                             : std::clamp(box_.radius, 0, kMaxBoxBlurRadius);
+    return {.halo = halo, .reads_window = true};
+}
+
+std::unique_ptr<RowStage<std::uint8_t>> DenoiseStage::openRows(
+    const contracts::EnhancementRequest& request,
+    const RowStageSetup& setup,
+    std::type_identity<std::uint8_t>) const {
+    GuidedFilterOptions guided = guided_;
+    guided.strength = request.denoise_strength;
+    return std::make_unique<DenoiseRows<std::uint8_t>>(
+        edgePreserving(request), box_, guided, requirements(request, setup.input).halo, setup);
+}
+
+std::unique_ptr<RowStage<std::uint16_t>> DenoiseStage::openRows(
+    const contracts::EnhancementRequest& request,
+    const RowStageSetup& setup,
+    std::type_identity<std::uint16_t>) const {
+    GuidedFilterOptions guided = guided_;
+    guided.strength = request.denoise_strength;
+    return std::make_unique<DenoiseRows<std::uint16_t>>(
+        edgePreserving(request), box_, guided, requirements(request, setup.input).halo, setup);
+}
+
+bool ResampleStage::active(const contracts::EnhancementRequest& request, const PpmHeader& input) const {
+    const PpmHeader output = outputHeader(request, input);
+    return request.filter != contracts::ResampleFilter::kNearest || output.width != input.width || output.height != input.height;
+}
+
+PpmHeader ResampleStage::outputHeader(const contracts::EnhancementRequest& request, const PpmHeader& input) const {
+    PpmHeader output = input;
+    output.width = contracts::scaledExtent(input.width, request);
+    output.height = contracts::scaledExtent(input.height, request);
+    return output;
+}
+
+StageRequirements ResampleStage::requirements(const contracts::EnhancementRequest& request, const PpmHeader& input) const {
+    // Downscaling stretches the filter over as many source pixels as it shrinks by.
+    const PpmHeader output = outputHeader(request, input);
+    const int shrink =
+        std::max({1, (input.width + output.width - 1) / output.width, (input.height + output.height - 1) / output.height});
+    return {.halo = filterRadius(request.filter) * shrink};
+}
+
+std::unique_ptr<RowStage<std::uint8_t>> ResampleStage::openRows(
+    const contracts::EnhancementRequest& request,
+    const RowStageSetup& setup,
+    std::type_identity<std::uint8_t>) const {
+    return std::make_unique<ResampleRows<std::uint8_t>>(request, setup);
+}
+
+std::unique_ptr<RowStage<std::uint16_t>> ResampleStage::openRows(
+    const contracts::EnhancementRequest& request,
+    const RowStageSetup& setup,
+    std::type_identity<std::uint16_t>) const {
+    return std::make_unique<ResampleRows<std::uint16_t>>(request, setup);
+}
+
+SharpenStage::SharpenStage(const UnsharpMaskOptions options) : options_(options) {}
+
+bool SharpenStage::active(const contracts::EnhancementRequest& request, const PpmHeader&) const {
+    return request.sharpen_strength > 0.0f;
+}
+
+StageRequirements SharpenStage::requirements(const contracts::EnhancementRequest&, const PpmHeader&) const {
+    return {.halo = std::clamp(options_.radius, 1, kMaxUnsharpMaskRadius)};
+}
+
+std::unique_ptr<RowStage<std::uint8_t>> SharpenStage::openRows(
+    const contracts::EnhancementRequest& request,
+    const RowStageSetup& setup,
+    std::type_identity<std::uint8_t>) const {
+    UnsharpMaskOptions options = options_;
+    options.strength = request.sharpen_strength;
+    return std::make_unique<SharpenRows<std::uint8_t>>(options, setup);
+}
+
+std::unique_ptr<RowStage<std::uint16_t>> SharpenStage::openRows(
+    const contracts::EnhancementRequest& request,
+    const RowStageSetup& setup,
+    std::type_identity<std::uint16_t>) const {
+    UnsharpMaskOptions options = options_;
+    options.strength = request.sharpen_strength;
+    return std::make_unique<SharpenRows<std::uint16_t>>(options, setup);
+}
+
+PpmHeader EncodeStage::outputHeader(const contracts::EnhancementRequest& request, const PpmHeader& input) const {
+    bool binary = isBinary(input.format);
+    if (request.output_encoding == contracts::OutputEncoding::kAscii) {
+        binary = false;
+    } else if (request.output_encoding == contracts::OutputEncoding::kBinary) {
+        binary = true;
+    }
+    PpmHeader output = input;
+    output.format = formatFor(channelCount(input.format), binary);
+    return output;
+}
+
+bool EncodeStage::openOutput(
+    const contracts::EnhancementRequest& request,
+    const PpmHeader& header,
+    PpmWriter* writer,
+    std::string* error_message) const {
+    return writer->open(request.output_path, header, error_message);
+}
+
+}  // namespace lumos::engine
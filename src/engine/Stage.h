@@ -0,0 +1,193 @@
+#pragma once
+
+#include "contracts/EnhancementTypes.h"
+#include "engine/BoxBlur.h"
+#include "engine/GuidedFilter.h"
+#include "engine/ImageView.h"
+#include "engine/PpmCodec.h"
+#include "engine/Sharpen.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace lumos::engine {
+
+// Where a stage sits in a pipeline: decode reads the input file, row stages turn rows into rows and
+// encode writes the last row stage's rows to the output file.
+enum class StageKind {
+    kDecode,
+    kRows,
+    kEncode,
+};
+
+// What a row stage needs from the pipeline for one request.
+struct StageRequirements {
+    // Input rows and columns read on each side of the ones an output pixel maps onto.
+    int halo {0};
+    // The stage reads a window of input rows already in memory instead of taking them one at a
+    // time, so it can only start a run of fused stages; after another row stage it gets a frame.
+    bool reads_window {false};
+};
+
+// The part of one run a row stage is opened for: the whole images it reads and writes, and the
+// rectangle of its output wanted.
+struct RowStageSetup {
+    PpmHeader input {};
+    PpmHeader output {};
+    PixelRect wanted {};
+};
+
+// A row stage opened for one rectangle of one run. Rows go in through pushRow(), or come from the
+// window of a stage that reads one, and the rows of the wanted rectangle come out of writeRow() in
+// order, so a chain of stages can hand every row on while it is still in cache.
+template <typename Sample>
+class RowStage {
+  public:
+    virtual ~RowStage() = default;
+
+    // Input pixels the wanted rectangle depends on.
+    [[nodiscard]] virtual PixelRect sourceRegion() const noexcept = 0;
+    // Window stages: output rows [first_row, last_row) become ready, read from `window`, which
+    // holds the columns of sourceRegion() for the input rows from `window_first_row` on, including
+    // the halo around the range that falls inside sourceRegion().
+    virtual void setWindow(ImageView<Sample>, int /*window_first_row*/, int /*first_row*/, int /*last_row*/) {}
+    // Other stages: feeds the next row of sourceRegion(), which must stay valid until every ready
+    // row has been written.
+    virtual void pushRow(const Sample*) {}
+    [[nodiscard]] virtual bool rowReady() = 0;
+    // Writes the next output row into `target`. Callers pass the same buffer every time, or leave
+    // the row written before intact.
+    virtual void writeRow(Sample* target) = 0;
+};
+
+// One step of an engine::Pipeline. A stage describes what it does to a request's image and opens
+// the per-run objects that do it; it holds no per-run state, so one stage serves concurrent runs.
+class IStage {
+  public:
+    virtual ~IStage() = default;
+
+    [[nodiscard]] virtual std::string_view name() const noexcept = 0;
+    [[nodiscard]] virtual StageKind kind() const noexcept = 0;
+
+    // False when the stage would pass `input` through unchanged, so the planner leaves it out.
+    [[nodiscard]] virtual bool active(const contracts::EnhancementRequest& request, const PpmHeader& input) const;
+    // The image the stage makes from `input`.
+    [[nodiscard]] virtual PpmHeader outputHeader(const contracts::EnhancementRequest& request, const PpmHeader& input) const;
+    [[nodiscard]] virtual StageRequirements requirements(
+        const contracts::EnhancementRequest& request,
+        const PpmHeader& input) const;
+
+    // kDecode stages: opens the request's input.
+    virtual bool openInput(const contracts::EnhancementRequest& request, PpmReader* reader, std::string* error_message) const;
+    // kEncode stages: opens the request's output for an image described by `header`.
+    virtual bool openOutput(
+        const contracts::EnhancementRequest& request,
+        const PpmHeader& header,
+        PpmWriter* writer,
+        std::string* error_message) const;
+    // kRows stages: the stage for one rectangle of one run, for each sample type.
+    [[nodiscard]] virtual std::unique_ptr<RowStage<std::uint8_t>> openRows(
+        const contracts::EnhancementRequest& request,
+        const RowStageSetup& setup,
+        std::type_identity<std::uint8_t>) const;
+    [[nodiscard]] virtual std::unique_ptr<RowStage<std::uint16_t>> openRows(
+        const contracts::EnhancementRequest& request,
+        const RowStageSetup& setup,
+        std::type_identity<std::uint16_t>) const;
+};
+
+// Opens request.input_path, subsampled to the preview step of a preview request.
+class DecodeStage final : public IStage {
+  public:
+    [[nodiscard]] std::string_view name() const noexcept override { return "decode"; }
+    [[nodiscard]] StageKind kind() const noexcept override { return StageKind::kDecode; }
+    bool openInput(const contracts::EnhancementRequest& request, PpmReader* reader, std::string* error_message) const override;
+};
+
+// Box blur when a request enables denoise, or the guided filter at the request's strength for the
+// edge-preserving preset.
+class DenoiseStage final : public IStage {
+  public:
+    DenoiseStage(BoxBlurOptions box, GuidedFilterOptions guided);
+
+    [[nodiscard]] std::string_view name() const noexcept override { return "denoise"; }
+    [[nodiscard]] StageKind kind() const noexcept override { return StageKind::kRows; }
+    [[nodiscard]] bool active(const contracts::EnhancementRequest& request, const PpmHeader& input) const override;
+    [[nodiscard]] StageRequirements requirements(
+        const contracts::EnhancementRequest& request,
+        const PpmHeader& input) const override;
+    [[nodiscard]] std::unique_ptr<RowStage<std::uint8_t>> openRows(
+        const contracts::EnhancementRequest& request,
+        const RowStageSetup& setup,
+        std::type_identity<std::uint8_t>) const override;
+    [[nodiscard]] std::unique_ptr<RowStage<std::uint16_t>> openRows(
+        const contracts::EnhancementRequest& request,
+        const RowStageSetup& setup,
+        std::type_identity<std::uint16_t>) const override;
+
+  private:
+    BoxBlurOptions box_ {};
+    GuidedFilterOptions guided_ {};
+};
+
+// Scales by the request's factor with its filter; left out when that keeps every pixel as it is.
+class ResampleStage final : public IStage {
+  public:
+    [[nodiscard]] std::string_view name() const noexcept override { return "resample"; }
+    [[nodiscard]] StageKind kind() const noexcept override { return StageKind::kRows; }
+    [[nodiscard]] bool active(const contracts::EnhancementRequest& request, const PpmHeader& input) const override;
+    [[nodiscard]] PpmHeader outputHeader(const contracts::EnhancementRequest& request, const PpmHeader& input) const override;
+    [[nodiscard]] StageRequirements requirements(
+        const contracts::EnhancementRequest& request,
+        const PpmHeader& input) const override;
+    [[nodiscard]] std::unique_ptr<RowStage<std::uint8_t>> openRows(
+        const contracts::EnhancementRequest& request,
+        const RowStageSetup& setup,
+        std::type_identity<std::uint8_t>) const override;
+    [[nodiscard]] std::unique_ptr<RowStage<std::uint16_t>> openRows(
+        const contracts::EnhancementRequest& request,
+        const RowStageSetup& setup,
+        std::type_identity<std::uint16_t>) const override;
+};
+
+// Unsharp mask at the request's sharpen strength, which overrides the one in `options`.
+class SharpenStage final : public IStage {
+  public:
+    explicit SharpenStage(UnsharpMaskOptions options);
+
+    [[nodiscard]] std::string_view name() const noexcept override { return "sharpen"; }
+    [[nodiscard]] StageKind kind() const noexcept override { return StageKind::kRows; }
+    [[nodiscard]] bool active(const contracts::EnhancementRequest& request, const PpmHeader& input) const override;
+    [[nodiscard]] StageRequirements requirements(
+        const contracts::EnhancementRequest& request,
+        const PpmHeader& input) const override;
+    [[nodiscard]] std::unique_ptr<RowStage<std::uint8_t>> openRows(
+        const contracts::EnhancementRequest& request,
+        const RowStageSetup& setup,
+        std::type_identity<std::uint8_t>) const override;
+    [[nodiscard]] std::unique_ptr<RowStage<std::uint16_t>> openRows(
+        const contracts::EnhancementRequest& request,
+        const RowStageSetup& setup,
+        std::type_identity<std::uint16_t>) const override;
+
+  private:
+    UnsharpMaskOptions options_ {};
+};
+
+// Writes request.output_path in the encoding the request asks for.
+class EncodeStage final : public IStage {
+  public:
+    [[nodiscard]] std::string_view name() const noexcept override { return "encode"; }
+    [[nodiscard]] StageKind kind() const noexcept override { return StageKind::kEncode; }
+    [[nodiscard]] PpmHeader outputHeader(const contracts::EnhancementRequest& request, const PpmHeader& input) const override;
+    bool openOutput(
+        const contracts::EnhancementRequest& request,
+        const PpmHeader& header,
+        PpmWriter* writer,
+        std::string* error_message) const override;
+};
+
+}  // namespace lumos::engine
@@ -0,0 +1,331 @@
+#include "engine/TileProcessor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <sys/sysctl.h>
+#elif defined(__unix__)
+#include <unistd.h>
+#endif
+
+namespace lumos::engine {
+
+namespace {
+
+constexpr int kTileAlignment = 16;
+constexpr int kMinAutomaticTile = 64;
+constexpr int kMaxAutomaticTile = 2048;
+// Used when the platform reports no cache sizes.
+constexpr std::size_t kFallbackTileBytes = std::size_t {512} << 10;
+
+std::vector<int> splitEvenly(const int size, const int tile_size, const int overlap) {
+    const int tile = std::max(1, tile_size);
+    int count = std::max(1, size / tile + (size % tile != 0 ? 1 : 0));
+    if (overlap > 0) {
+        count = std::min(count, std::max(1, size / overlap));
+    }
+    std::vector<int> edges(static_cast<std::size_t>(count) + 1);
+    for (int index = 0; index <= count; ++index) {
+        edges[static_cast<std::size_t>(index)] =
+            static_cast<int>(static_cast<std::int64_t>(index) * size / count);
+    }
+    return edges;
+}
+
+// Bytes of one stripe of extended tiles.
+std::size_t stripeBytes(const int width, const int side, const int overlap, const std::size_t bytes_per_pixel) {
+    const auto columns = static_cast<std::size_t>((width + side - 1) / side);
+    const std::size_t extended_width = static_cast<std::size_t>(width) + columns * static_cast<std::size_t>(overlap);
+    return extended_width * static_cast<std::size_t>(side + overlap) * bytes_per_pixel;
+}
+
+// out = a + (b - a) * weight, rounded; equal inputs come back unchanged.
+template <typename T>
+void blendSamples(const T* a, const T* b, const float weight, const std::size_t count, T* out) {
+    for (std::size_t index = 0; index < count; ++index) {
+        const auto from = static_cast<float>(a[index]);
+        out[index] = static_cast<T>(from + (static_cast<float>(b[index]) - from) * weight + 0.5f);
+    }
+}
+
+}  // namespace
+
+Tile TileGrid::tile(const int column, const int row) const noexcept {
+    const int before = overlap / 2;
+    const int after = overlap - before;
+    const int left = column_edges[static_cast<std::size_t>(column)];
+    const int right = column_edges[static_cast<std::size_t>(column) + 1];
+    const int top = row_edges[static_cast<std::size_t>(row)];
+    const int bottom = row_edges[static_cast<std::size_t>(row) + 1];
+    const int extended_left = column > 0 ? left - before : 0;
+    const int extended_right = column + 1 < columns() ? right + after : width;
+    const int extended_top = row > 0 ? top - before : 0;
+    const int extended_bottom = row + 1 < rows() ? bottom + after : height;
+    return {
+        .core = {left, top, right - left, bottom - top},
+        .extended = {extended_left, extended_top, extended_right - extended_left, extended_bottom - extended_top},
+    };
+}
+
+TileGrid planTiles(const int width, const int height, const int tile_size, const int overlap) {
+    TileGrid grid;
+    grid.width = width;
+    grid.height = height;
+    grid.overlap = std::max(0, overlap);
+    grid.column_edges = splitEvenly(width, tile_size, grid.overlap);
+    grid.row_edges = splitEvenly(height, tile_size, grid.overlap);
+    return grid;
+}
+
+CacheSizes detectCacheSizes() noexcept {
+    CacheSizes caches;
+#if defined(_WIN32)
+    DWORD length = 0;
+    GetLogicalProcessorInformation(nullptr, &length);
+    std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> entries;
+    try {
+        entries.resize(length / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+    } catch (...) {
+        return caches;
+    }
+    if (!entries.empty() && GetLogicalProcessorInformation(entries.data(), &length) != FALSE) {
+        for (const auto& entry : entries) {
+            if (entry.Relationship != RelationCache) {
+                continue;
+            }
+            if (entry.Cache.Level == 2) {
+                caches.l2 = std::max<std::size_t>(caches.l2, entry.Cache.Size);
+            } else if (entry.Cache.Level == 3) {
+                caches.l3 = std::max<std::size_t>(caches.l3, entry.Cache.Size);
+            }
+        }
+    }
+#elif defined(__APPLE__)
+    std::uint64_t value = 0;
+    std::size_t size = sizeof(value);
+    if (sysctlbyname("hw.l2cachesize", &value, &size, nullptr, 0) == 0) {
+        caches.l2 = static_cast<std::size_t>(value);
+    }
+    value = 0;
+    size = sizeof(value);
+    if (sysctlbyname("hw.l3cachesize", &value, &size, nullptr, 0) == 0) {
+        caches.l3 = static_cast<std::size_t>(value);
+    }
+#elif defined(_SC_LEVEL2_CACHE_SIZE) && defined(_SC_LEVEL3_CACHE_SIZE)
+    caches.l2 = static_cast<std::size_t>(std::max(0L, sysconf(_SC_LEVEL2_CACHE_SIZE)));
+    caches.l3 = static_cast<std::size_t>(std::max(0L, sysconf(_SC_LEVEL3_CACHE_SIZE)));
+#endif
+    return caches;
+}
+
+int chooseTileSize(
+    const int width,
+    const std::size_t bytes_per_pixel,
+    const int overlap,
+    const int threads,
+    const std::size_t memory_budget_bytes,
+    const CacheSizes& caches) noexcept {
+    const std::size_t pixel_bytes = std::max<std::size_t>(1, bytes_per_pixel);
+    std::size_t tile_bytes = 0;
+    if (caches.l2 > 0) {
+        tile_bytes = caches.l2 / 2;
+    }
+    if (caches.l3 > 0) {
+        const std::size_t share = caches.l3 / static_cast<std::size_t>(std::max(1, threads));
+        tile_bytes = tile_bytes > 0 ? std::min(tile_bytes, share) : share;
+    }
+    if (tile_bytes == 0) {
+        tile_bytes = kFallbackTileBytes;
+    }
+
+    int side = static_cast<int>(std::sqrt(static_cast<double>(tile_bytes / pixel_bytes)));
+    side = std::clamp(side / kTileAlignment * kTileAlignment, kMinAutomaticTile, kMaxAutomaticTile);
+    const int smallest = std::max(kTileAlignment, overlap);
+    while (side > smallest && stripeBytes(std::max(1, width), side, std::max(0, overlap), pixel_bytes) > memory_budget_bytes) {
+        side = std::max(smallest, side - kTileAlignment);
+    }
+    return side;
+}
+
+int resolveThreadCount(const int requested) noexcept {
+    if (requested > 0) {
+        return requested;
+    }
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+template <typename T>
+TileProcessor<T>::TileProcessor(const int width, const int height, const int samples_per_pixel, const TileOptions& options)
+    : pool_(options.pool != nullptr ? options.pool : &common::ThreadPool::shared()),
+      samples_per_pixel_(samples_per_pixel),
+      threads_(options.threads > 0 ? options.threads : pool_->workerCount()) {
+    static const CacheSizes caches = detectCacheSizes();
+    const std::size_t pixel_bytes = static_cast<std::size_t>(samples_per_pixel) * sizeof(T);
+    const int overlap = std::max(0, options.overlap);
+    // One thread gains nothing from tiles and still pays for the seams and copies, so it takes the
+    // whole frame as one tile whenever the frame fits the budget.
+    const std::size_t frame_bytes =
+        static_cast<std::size_t>(std::max(0, width)) * static_cast<std::size_t>(std::max(0, height)) * pixel_bytes;
+    const bool whole_frame = threads_ == 1 && frame_bytes <= options.memory_budget_bytes;
+    int requested = options.tile_size;
+    if (requested <= 0) {
+        requested = whole_frame ? std::max({width, height, 1})
+                                : chooseTileSize(width, pixel_bytes, overlap, threads_, options.memory_budget_bytes, caches);
+    }
+    const int side = std::min(requested, std::max({width, height, 1}));
+    grid_ = planTiles(width, height, side, overlap);
+
+    // Enough stripes per pass to give every thread a tile, as far as the budget allows.
+    const int wanted = (threads_ + grid_.columns() - 1) / grid_.columns();
+    const std::size_t one_stripe = std::max<std::size_t>(1, stripeBytes(width, side, overlap, pixel_bytes));
+    const auto affordable = static_cast<int>(std::min<std::size_t>(options.memory_budget_bytes / one_stripe, static_cast<std::size_t>(grid_.rows())));
+    stripes_per_pass_ = std::clamp(wanted, 1, std::max(1, affordable));
+}
+
+template <typename T>
+int TileProcessor<T>::concurrency() const noexcept {
+    return std::min(threads_, std::min(stripes_per_pass_, grid_.rows()) * grid_.columns());
+}
+
+template <typename T>
+std::size_t TileProcessor<T>::bufferBytes() const noexcept {
+    const int columns = grid_.columns();
+    const int rows = grid_.rows();
+    if (columns == 1 && rows == 1) {
+        return 0;
+    }
+    // Buffers keep the size of the largest tile they held: a pass of the largest stripes, plus the
+    // carried seam rows and one composed row.
+    std::size_t stripe_samples = 0;
+    for (int row = 0; row < rows; ++row) {
+        std::size_t samples = 0;
+        for (int column = 0; column < columns; ++column) {
+            const PixelRect extended = grid_.tile(column, row).extended;
+            samples += static_cast<std::size_t>(extended.width) * static_cast<std::size_t>(extended.height);
+        }
+        stripe_samples = std::max(stripe_samples, samples);
+    }
+    const std::size_t row_samples = static_cast<std::size_t>(grid_.width);
+    const std::size_t seam_samples = rows > 1 ? (static_cast<std::size_t>(grid_.overlap) + 1) * row_samples : 0;
+    const auto pass = static_cast<std::size_t>(std::min(stripes_per_pass_, rows));
+    return (pass * stripe_samples + seam_samples) * static_cast<std::size_t>(samples_per_pixel_) * sizeof(T);
+}
+
+template <typename T>
+void TileProcessor<T>::run(const TileFunction<T>& process, const MutableImageView<T> output) {
+    const int columns = grid_.columns();
+    const int rows = grid_.rows();
+    if (columns == 1 && rows == 1) {
+        process(grid_.tile(0, 0), output);
+        return;
+    }
+    const int before = grid_.overlap / 2;
+    const int after = grid_.overlap - before;
+    const auto samples = static_cast<std::size_t>(samples_per_pixel_);
+    const std::size_t row_samples = static_cast<std::size_t>(grid_.width) * samples;
+    // Step i of a ramp weighs the later tile (2i + 1) / (2 * overlap), symmetric about the seam.
+    std::vector<float> ramp(static_cast<std::size_t>(grid_.overlap));
+    for (int step = 0; step < grid_.overlap; ++step) {
+        ramp[static_cast<std::size_t>(step)] = static_cast<float>(2 * step + 1) / static_cast<float>(2 * grid_.overlap);
+    }
+
+    // Rows of the seam below the current stripe, kept until the next stripe blends over them.
+    std::vector<T> carry(rows > 1 ? static_cast<std::size_t>(grid_.overlap) * row_samples : 0);
+    std::vector<T> line(rows > 1 ? row_samples : 0);
+    std::vector<std::vector<T>> buffers(static_cast<std::size_t>(stripes_per_pass_ * columns));
+
+    // Pixels of a tile that no seam ramp touches; tiles copy these out themselves.
+    const auto interior = [&](const int column, const int row) {
+        const Tile tile = grid_.tile(column, row);
+        const int left = column > 0 ? tile.core.x + after : 0;
+        const int right = column + 1 < columns ? tile.core.right() - before : grid_.width;
+        const int top = row > 0 ? tile.core.y + after : 0;
+        const int bottom = row + 1 < rows ? tile.core.bottom() - before : grid_.height;
+        return PixelRect {left, top, right - left, bottom - top};
+    };
+
+    // Assembles image row `y` of stripe `row` from the tile buffers of that stripe: the seam ramps
+    // always, the rest too unless `seams_only`.
+    const auto compose_row = [&](const int row, const std::vector<T>* stripe, const int y, const bool seams_only, T* target) {
+        const int local_y = y - grid_.tile(0, row).extended.y;
+        const T* previous = nullptr;
+        int previous_left = 0;
+        for (int column = 0; column < columns; ++column) {
+            const Tile tile = grid_.tile(column, row);
+            const T* source = stripe[column].data() + static_cast<std::size_t>(local_y) * tile.extended.width * samples;
+            const int seam = tile.core.x;
+            if (!seams_only) {
+                const int copy_first = column > 0 ? seam + after : 0;
+                const int copy_last = column + 1 < columns ? tile.core.right() - before : grid_.width;
+                std::copy_n(
+                    source + static_cast<std::size_t>(copy_first - tile.extended.x) * samples,
+                    static_cast<std::size_t>(copy_last - copy_first) * samples, target + static_cast<std::size_t>(copy_first) * samples);
+            }
+            if (column > 0) {
+                for (int step = 0; step < grid_.overlap; ++step) {
+                    const int x = seam - before + step;
+                    blendSamples(
+                        previous + static_cast<std::size_t>(x - previous_left) * samples,
+                        source + static_cast<std::size_t>(x - tile.extended.x) * samples,
+                        ramp[static_cast<std::size_t>(step)], samples, target + static_cast<std::size_t>(x) * samples);
+                }
+            }
+            previous = source;
+            previous_left = tile.extended.x;
+        }
+    };
+
+    for (int first_row = 0; first_row < rows; first_row += stripes_per_pass_) {
+        const int pass_rows = std::min(stripes_per_pass_, rows - first_row);
+        pool_->parallelFor(pass_rows * columns, [&](const int index) {
+            const int column = index % columns;
+            const int row = first_row + index / columns;
+            const Tile tile = grid_.tile(column, row);
+            std::vector<T>& buffer = buffers[static_cast<std::size_t>(index)];
+            const std::size_t stride = static_cast<std::size_t>(tile.extended.width) * samples;
+            buffer.resize(stride * static_cast<std::size_t>(tile.extended.height));
+            const MutableImageView<T> target {buffer.data(), tile.extended.width, tile.extended.height, stride, samples_per_pixel_};
+            process(tile, target);
+
+            // Copy the interior out while it is still in cache; the pixels are this tile's alone.
+            const PixelRect own = interior(column, row);
+            const ImageView<T> kept = ImageView<T>(target).region(
+                {own.x - tile.extended.x, own.y - tile.extended.y, own.width, own.height});
+            for (int y = 0; y < own.height; ++y) {
+                std::copy_n(kept.row(y), kept.rowSamples(), output.row(own.y + y) + static_cast<std::size_t>(own.x) * samples);
+            }
+        }, threads_);
+
+        for (int row = first_row; row < first_row + pass_rows; ++row) {
+            const std::vector<T>* stripe = buffers.data() + static_cast<std::size_t>(row - first_row) * columns;
+            const PixelRect rows_spanned = grid_.tile(0, row).extended;
+            const int seam_above = grid_.row_edges[static_cast<std::size_t>(row)];
+            const int seam_below = grid_.row_edges[static_cast<std::size_t>(row) + 1];
+            for (int y = rows_spanned.y; y < rows_spanned.bottom(); ++y) {
+                if (row > 0 && y < seam_above + after) {
+                    const int step = y - (seam_above - before);
+                    compose_row(row, stripe, y, false, line.data());
+                    blendSamples(
+                        carry.data() + static_cast<std::size_t>(step) * row_samples, line.data(),
+                        ramp[static_cast<std::size_t>(step)], row_samples, output.row(y));
+                } else if (row + 1 < rows && y >= seam_below - before) {
+                    compose_row(
+                        row, stripe, y, false, carry.data() + static_cast<std::size_t>(y - (seam_below - before)) * row_samples);
+                } else {
+                    compose_row(row, stripe, y, true, output.row(y));
+                }
+            }
+        }
+    }
+}
+
+template class TileProcessor<std::uint8_t>;
+template class TileProcessor<std::uint16_t>;
+
+}  // namespace lumos::engine
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "common/ThreadPool.h"
+#include "engine/ImageView.h"
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace lumos::engine {
+
+struct TileOptions {
+    // Output pixels per tile side; 0 picks one from the cache sizes and the memory budget, or a single
+    // tile when one thread runs a frame that fits the budget.
+    int tile_size {0};
+    // Width of the linear ramp each seam is blended across.
+    int overlap {32};
+    // Tiles processed at once; 0 uses every worker of the pool.
+    int threads {0};
+    // Pool the tiles run on; nullptr uses ThreadPool::shared().
+    common::ThreadPool* pool {nullptr};
+    // Bound on the tile buffers in flight at once.
+    std::size_t memory_budget_bytes {std::size_t {256} << 20};
+};
+
+// `core` rectangles tile the image without gaps or overlap; `extended` grows a core by half the
+// overlap across every seam, so neighbouring tiles share `overlap` pixels around each seam.
+struct Tile {
+    PixelRect core {};
+    PixelRect extended {};
+};
+
+// Tiles of a width x height image in rows and columns. Tile column j spans pixels
+// [column_edges[j], column_edges[j + 1]); cores are at least `overlap` wide and tall so no two
+// seam ramps meet.
+struct TileGrid {
+    int width {0};
+    int height {0};
+    int overlap {0};
+    std::vector<int> column_edges {};
+    std::vector<int> row_edges {};
+
+    [[nodiscard]] int columns() const noexcept { return static_cast<int>(column_edges.size()) - 1; }
+    [[nodiscard]] int rows() const noexcept { return static_cast<int>(row_edges.size()) - 1; }
+    [[nodiscard]] Tile tile(int column, int row) const noexcept;
+};
+
+// Splits the image into tiles about `tile_size` on a side, sized evenly so there is no sliver at
+// the right or bottom edge.
+[[nodiscard]] TileGrid planTiles(int width, int height, int tile_size, int overlap);
+
+// Per-core level 2 and shared level 3 cache sizes in bytes; 0 when the platform does not report one.
+struct CacheSizes {
+    std::size_t l2 {0};
+    std::size_t l3 {0};
+};
+
+[[nodiscard]] CacheSizes detectCacheSizes() noexcept;
+
+// Tile side for an image `width` pixels wide at `bytes_per_pixel`: a tile fills at most half of L2
+// (or its thread's share of L3 when that is smaller), and a stripe of extended tiles fits in
+// `memory_budget_bytes`. A multiple of 16 in [64, 2048] unless the budget forces it lower.
+[[nodiscard]] int chooseTileSize(
+    int width,
+    std::size_t bytes_per_pixel,
+    int overlap,
+    int threads,
+    std::size_t memory_budget_bytes,
+    const CacheSizes& caches) noexcept;
+
+// `requested` when positive, otherwise the number of hardware threads.
+[[nodiscard]] int resolveThreadCount(int requested) noexcept;
+
+// Fills the extended rectangle of `tile` into `target`, which is exactly that size.
+template <typename T>
+using TileFunction = std::function<void(const Tile& tile, MutableImageView<T> target)>;
+
+// Runs a local-window stage chain tile by tile on a thread pool. Each tile writes its extended
+// rectangle into a buffer of its own and copies the part no seam touches straight to the output
+// while it is still in cache; seams are then blended into the output with linear ramps across the
+// overlap, and a grid of one tile writes the output directly. A chain that computes every pixel
+// the same way whatever tile it lands in (each tile reads enough input around its rectangle)
+// gives output identical to an untiled run, since blending two equal samples returns that sample.
+//
+// Stripes of tiles are processed a few at a time, as many as it takes to keep every thread busy,
+// so the buffers in flight stay within the budget whatever the image height.
+template <typename T>
+class TileProcessor {
+  public:
+    TileProcessor(int width, int height, int samples_per_pixel, const TileOptions& options);
+
+    [[nodiscard]] const TileGrid& grid() const noexcept { return grid_; }
+    [[nodiscard]] int threads() const noexcept { return threads_; }
+    // Most tiles run() processes at once, and most bytes of tile buffers it holds at once.
+    [[nodiscard]] int concurrency() const noexcept;
+    [[nodiscard]] std::size_t bufferBytes() const noexcept;
+
+    // Calls `process` once for every tile, up to threads() tiles at a time, and assembles
+    // `output`. Rethrows the first exception a tile throws once the other tiles in flight end.
+    void run(const TileFunction<T>& process, MutableImageView<T> output);
+
+  private:
+    common::ThreadPool* pool_ {nullptr};
+    TileGrid grid_ {};
+    int samples_per_pixel_ {1};
+    int threads_ {1};
+    int stripes_per_pass_ {1};
+};
+
+}  // namespace lumos::engine
@@ -0,0 +1,151 @@
+#include "engine/Upscale.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace lumos::engine {
+
+template <typename T>
+void expandRow(const T* source, const int width, const int samples_per_pixel, const int scale_factor, T* expanded) {
+    expandRowKernel<T>(activeKernels())(source, width, samples_per_pixel, scale_factor, expanded);
+}
+
+template <typename T>
+void upscaleNearestNeighbor(const ImageView<T> input, const int scale_factor, const MutableImageView<T> output) {
+    const std::size_t row_bytes = output.rowSamples() * sizeof(T);
+    const ExpandRowFn<T> expand = expandRowKernel<T>(activeKernels());
+    for (int y = 0; y < input.height; ++y) {
+        T* first = output.row(y * scale_factor);
+        expand(input.row(y), input.width, input.samples_per_pixel, scale_factor, first);
+        for (int repeat = 1; repeat < scale_factor; ++repeat) {
+            std::memcpy(output.row(y * scale_factor + repeat), first, row_bytes);
+        }
+    }
+}
+
+template <typename T>
+RowUpscaler<T>::RowUpscaler(
+    const ResampleFilter filter,
+    const int source_width,
+    const int source_height,
+    const int target_width,
+    const int target_height,
+    const int samples_per_pixel,
+    const T max_value)
+    : RowUpscaler(
+          filter, source_width, source_height, target_width, target_height, samples_per_pixel, max_value,
+          PixelRect {0, 0, target_width, target_height}) {}
+
+template <typename T>
+RowUpscaler<T>::RowUpscaler(
+    const ResampleFilter filter,
+    const int source_width,
+    const int source_height,
+    const int target_width,
+    const int target_height,
+    const int samples_per_pixel,
+    const T max_value,
+    const PixelRect& target_region)
+    : samples_per_pixel_(samples_per_pixel),
+      target_region_(target_region),
+      row_bytes_(static_cast<std::size_t>(target_region.width) * static_cast<std::size_t>(samples_per_pixel) * sizeof(T)) {
+    const int scale_factor = target_width / source_width;
+    const bool replicates = filter == ResampleFilter::kNearest && target_width == source_width * scale_factor &&
+                            target_height == source_height * scale_factor;
+    if (!replicates) {
+        resampler_.emplace(
+            filter, source_width, source_height, target_width, target_height, samples_per_pixel, max_value, target_region);
+        return;
+    }
+    expand_ = expandRowKernel<T>(activeKernels());
+    scale_factor_ = scale_factor;
+    const int first_column = target_region.x / scale_factor;
+    const int first_row = target_region.y / scale_factor;
+    source_region_ = {
+        first_column,
+        first_row,
+        (target_region.right() + scale_factor - 1) / scale_factor - first_column,
+        (target_region.bottom() + scale_factor - 1) / scale_factor - first_row,
+    };
+    if (source_region_.width * scale_factor != target_region.width) {
+        unaligned_.resize(
+            static_cast<std::size_t>(source_region_.width) * static_cast<std::size_t>(scale_factor) *
+            static_cast<std::size_t>(samples_per_pixel));
+        unaligned_offset_ = static_cast<std::size_t>(target_region.x - first_column * scale_factor) *
+                            static_cast<std::size_t>(samples_per_pixel);
+    }
+}
+
+template <typename T>
+bool RowUpscaler<T>::rowReady() const noexcept {
+    return resampler_ ? resampler_->rowReady() : pending_rows_ > 0;
+}
+
+template <typename T>
+void RowUpscaler<T>::pushRow(const T* row) {
+    if (resampler_) {
+        resampler_->pushRow(row);
+        return;
+    }
+    // Target rows of this source row that fall inside the region.
+    const int source_y = source_region_.y + rows_pushed_++;
+    const int first = std::max(source_y * scale_factor_, target_region_.y);
+    const int last = std::min((source_y + 1) * scale_factor_, target_region_.bottom());
+    source_row_ = row;
+    expanded_row_ = nullptr;
+    pending_rows_ = last - first;
+}
+
+template <typename T>
+void RowUpscaler<T>::writeRow(T* target) {
+    if (resampler_) {
+        resampler_->writeRow(target);
+        return;
+    }
+    if (expanded_row_ == nullptr) {
+        if (unaligned_.empty()) {
+            expand_(source_row_, source_region_.width, samples_per_pixel_, scale_factor_, target);
+        } else {
+            expand_(source_row_, source_region_.width, samples_per_pixel_, scale_factor_, unaligned_.data());
+            std::memcpy(target, unaligned_.data() + unaligned_offset_, row_bytes_);
+        }
+        expanded_row_ = target;
+    } else if (target != expanded_row_) {
+        std::memcpy(target, expanded_row_, row_bytes_);
+    }
+    --pending_rows_;
+    ++rows_written_;
+}
+
+template <typename T>
+int RowUpscaler<T>::rowsWritten() const noexcept {
+    return resampler_ ? resampler_->rowsWritten() : rows_written_;
+}
+
+template <typename T>
+PixelRect RowUpscaler<T>::sourceRegion() const noexcept {
+    return resampler_ ? resampler_->sourceRegion() : source_region_;
+}
+
+template <typename T>
+void upscale(const ImageView<T> input, const ResampleFilter filter, const T max_value, const MutableImageView<T> output) {
+    RowUpscaler<T> upscaler(filter, input.width, input.height, output.width, output.height, input.samples_per_pixel, max_value);
+    for (int y = 0; y < input.height; ++y) {
+        upscaler.pushRow(input.row(y));
+        while (upscaler.rowReady()) {
+            upscaler.writeRow(output.row(upscaler.rowsWritten()));
+        }
+    }
+}
+
+template class RowUpscaler<std::uint8_t>;
+template class RowUpscaler<std::uint16_t>;
+template void upscale<std::uint8_t>(ImageView<std::uint8_t>, ResampleFilter, std::uint8_t, MutableImageView<std::uint8_t>);
+template void upscale<std::uint16_t>(ImageView<std::uint16_t>, ResampleFilter, std::uint16_t, MutableImageView<std::uint16_t>);
+template void expandRow<std::uint8_t>(const std::uint8_t*, int, int, int, std::uint8_t*);
+template void expandRow<std::uint16_t>(const std::uint16_t*, int, int, int, std::uint16_t*);
+template void upscaleNearestNeighbor<std::uint8_t>(ImageView<std::uint8_t>, int, MutableImageView<std::uint8_t>);
+template void upscaleNearestNeighbor<std::uint16_t>(ImageView<std::uint16_t>, int, MutableImageView<std::uint16_t>);
+
+}  // namespace lumos::engine
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "engine/ImageView.h"
+#include "engine/KernelRegistry.h"
+#include "engine/Resample.h"
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace lumos::engine {
+
+// Repeats every pixel of one row `scale_factor` times into `expanded`, which must hold
+// width * scale_factor pixels. Runs the activeKernels() build, which has fixed-shape loops for
+// factors 2, 4 and 8 with 1 or 3 samples per pixel and a generic loop for anything else.
+template <typename T>
+void expandRow(const T* source, int width, int samples_per_pixel, int scale_factor, T* expanded);
+
+// Nearest-neighbour upscale of `input` into `output`, which must be exactly scale_factor times
+// larger. Each source row is expanded once into its first output row and block-copied into the
+// remaining scale_factor - 1, so the cost is dominated by output bandwidth.
+template <typename T>
+void upscaleNearestNeighbor(ImageView<T> input, int scale_factor, MutableImageView<T> output);
+
+// Upscaler fed one source row at a time with the same interface as Resampler. Nearest-neighbour at
+// a whole-number scale on both axes replicates pixels: the first output row of each source row is
+// expanded straight into its target and the rest are block-copied from that target, so callers
+// must leave the previously written row intact (or pass the same buffer again). Everything else
+// goes through the separable resampler. A `target_region` works as it does for Resampler: rows
+// pushed are the pixels of sourceRegion() and only that rectangle of the target comes out.
+template <typename T>
+class RowUpscaler {
+  public:
+    RowUpscaler(
+        ResampleFilter filter,
+        int source_width,
+        int source_height,
+        int target_width,
+        int target_height,
+        int samples_per_pixel,
+        T max_value);
+    RowUpscaler(
+        ResampleFilter filter,
+        int source_width,
+        int source_height,
+        int target_width,
+        int target_height,
+        int samples_per_pixel,
+        T max_value,
+        const PixelRect& target_region);
+
+    [[nodiscard]] bool rowReady() const noexcept;
+    // Feeds the next source row, which must stay valid until every ready row has been written;
+    // after the last source row every remaining target row is ready.
+    void pushRow(const T* row);
+    void writeRow(T* target);
+    [[nodiscard]] int rowsWritten() const noexcept;
+    [[nodiscard]] PixelRect sourceRegion() const noexcept;
+
+  private:
+    std::optional<Resampler<T>> resampler_ {};
+    ExpandRowFn<T> expand_ {nullptr};
+    int scale_factor_ {1};
+    int samples_per_pixel_ {1};
+    PixelRect target_region_ {};
+    PixelRect source_region_ {};
+    std::size_t row_bytes_ {0};
+    // Whole expanded source rows when the region does not start and end on a source pixel.
+    std::vector<T> unaligned_ {};
+    std::size_t unaligned_offset_ {0};
+    const T* source_row_ {nullptr};
+    const T* expanded_row_ {nullptr};
+    int rows_pushed_ {0};
+    int pending_rows_ {0};
+    int rows_written_ {0};
+};
+
+// Upscales all of `input` into `output` through a RowUpscaler.
+template <typename T>
+void upscale(ImageView<T> input, ResampleFilter filter, T max_value, MutableImageView<T> output);
+
+}  // namespace lumos::engine
@@ -0,0 +1,342 @@
+// Kernel loop bodies, compiled once per instruction set. Each Kernels*.cpp defines
+// LUMOS_KERNEL_NAMESPACE, sets its own target flags and includes this file, so the same source
+// becomes a separate set of functions per ISA. Keep these loops plain: no library algorithms or
+// containers, whose instantiations the linker could share with code built for a lower ISA.
+
+#ifndef LUMOS_KERNEL_NAMESPACE
+#error "define LUMOS_KERNEL_NAMESPACE before including KernelBodies.h"
+#endif
+
+#include "engine/kernels/KernelTable.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace lumos::engine::LUMOS_KERNEL_NAMESPACE {
+
+namespace {
+
+template <int Radius, typename T, typename Sum>
+void directSums(const T* extended, const std::size_t step, const std::size_t count, Sum* sums) {
+    for (std::size_t index = 0; index < count; ++index) {
+        Sum sum = 0;
+        for (int tap = 0; tap <= 2 * Radius; ++tap) {
+            sum = static_cast<Sum>(sum + extended[index + static_cast<std::size_t>(tap) * step]);
+        }
+        sums[index] = sum;
+    }
+}
+
+// Radii up to 4 sum their taps directly, which vectorizes cleanly; larger ones difference a
+// running prefix sum so the cost stays two loads and a subtract per sample. Prefix sums may
+// wrap; the differences stay exact because every box sum fits in Sum.
+template <typename T, typename Sum>
+void boxRowSums(const T* extended, const std::size_t step, const std::size_t count, const int radius, Sum* prefix, Sum* sums) {
+    switch (radius) {
+        case 1:
+            return directSums<1>(extended, step, count, sums);
+        case 2:
+            return directSums<2>(extended, step, count, sums);
+        case 3:
+            return directSums<3>(extended, step, count, sums);
+        case 4:
+            return directSums<4>(extended, step, count, sums);
+        default:
+            break;
+    }
+
+    const std::size_t span = static_cast<std::size_t>(2 * radius + 1) * step;
+    const std::size_t padded_count = count + span - step;
+    for (std::size_t index = 0; index < step; ++index) {
+        prefix[index] = 0;
+    }
+    for (std::size_t index = 0; index < padded_count; ++index) {
+        prefix[index + step] = static_cast<Sum>(prefix[index] + extended[index]);
+    }
+    for (std::size_t index = 0; index < count; ++index) {
+        sums[index] = static_cast<Sum>(prefix[index + span] - prefix[index]);
+    }
+}
+
+// Integer division does not vectorize, so the quotient is a reciprocal multiply:
+// (sum + 0.5) / area is never within 0.5 / area of an integer, which absorbs the rounding of
+// float while sums stay below 2^20 and of double beyond.
+template <typename Real, typename Sum, typename T>
+void slideAndDivideWith(
+    Sum* column,
+    const Sum* incoming,
+    Sum* leaving,
+    const std::size_t count,
+    const Real inverse,
+    T* output) {
+    for (std::size_t index = 0; index < count; ++index) {
+        const auto sum = static_cast<Sum>(column[index] + incoming[index] - leaving[index]);
+        column[index] = sum;
+        leaving[index] = incoming[index];
+        output[index] = static_cast<T>((static_cast<Real>(static_cast<std::int32_t>(sum)) + Real {0.5}) * inverse);
+    }
+}
+
+template <typename Sum, typename T>
+void slideAndDivide(
+    Sum* column,
+    const Sum* incoming,
+    Sum* leaving,
+    const std::size_t count,
+    const std::uint32_t area,
+    T* output) {
+    const std::uint64_t max_sum = static_cast<std::uint64_t>(static_cast<T>(~T {0})) * area;
+    if (max_sum < (std::uint64_t {1} << 20)) {
+        slideAndDivideWith(column, incoming, leaving, count, 1.0F / static_cast<float>(area), output);
+    } else {
+        slideAndDivideWith(column, incoming, leaving, count, 1.0 / static_cast<double>(area), output);
+    }
+}
+
+template <int Scale, int Channels, typename T>
+void expandFixed(const T* source, const int width, T* expanded) {
+    for (int x = 0; x < width; ++x) {
+        const T* pixel = source + static_cast<std::size_t>(x) * Channels;
+        T* target = expanded + static_cast<std::size_t>(x) * Scale * Channels;
+        for (int repeat = 0; repeat < Scale; ++repeat) {
+            for (int channel = 0; channel < Channels; ++channel) {
+                target[repeat * Channels + channel] = pixel[channel];
+            }
+        }
+    }
+}
+
+template <int Channels, typename T>
+bool expandFixedScale(const T* source, const int width, const int scale_factor, T* expanded) {
+    switch (scale_factor) {
+        case 2:
+            expandFixed<2, Channels>(source, width, expanded);
+            return true;
+        case 4:
+            expandFixed<4, Channels>(source, width, expanded);
+            return true;
+        case 8:
+            expandFixed<8, Channels>(source, width, expanded);
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Factors 2, 4 and 8 with 1 or 3 samples per pixel use fixed-shape loops the compiler turns into
+// vector broadcasts and shuffles; anything else takes the generic loop.
+template <typename T>
+void expandRow(const T* source, const int width, const int samples_per_pixel, const int scale_factor, T* expanded) {
+    if (samples_per_pixel == 1 && expandFixedScale<1>(source, width, scale_factor, expanded)) {
+        return;
+    }
+    if (samples_per_pixel == 3 && expandFixedScale<3>(source, width, scale_factor, expanded)) {
+        return;
+    }
+
+    const auto step = static_cast<std::size_t>(samples_per_pixel);
+    for (int x = 0; x < width; ++x) {
+        const T* pixel = source + static_cast<std::size_t>(x) * step;
+        for (int repeat = 0; repeat < scale_factor; ++repeat) {
+            for (std::size_t channel = 0; channel < step; ++channel) {
+                expanded[channel] = pixel[channel];
+            }
+            expanded += step;
+        }
+    }
+}
+
+template <typename Acc, typename Intermediate>
+Intermediate narrowHorizontal(const Acc sum) {
+    constexpr int kShift = kResampleWeightBits - kResampleIntermediateBits;
+    return static_cast<Intermediate>((sum + (Acc {1} << (kShift - 1))) >> kShift);
+}
+
+template <int Channels, int Taps, typename Acc, typename T, typename Intermediate>
+void resampleHorizontalFixed(
+    const T* source,
+    const int target_width,
+    const int taps,
+    const std::int32_t* first,
+    const std::int16_t* weights,
+    Intermediate* target) {
+    const int tap_count = Taps > 0 ? Taps : taps;
+    for (int x = 0; x < target_width; ++x) {
+        const T* pixels = source + static_cast<std::size_t>(first[x]) * Channels;
+        const std::int16_t* pixel_weights = weights + static_cast<std::size_t>(x) * static_cast<std::size_t>(tap_count);
+        Acc sums[Channels] = {};
+        for (int tap = 0; tap < tap_count; ++tap) {
+            const Acc weight = pixel_weights[tap];
+            for (int channel = 0; channel < Channels; ++channel) {
+                sums[channel] += static_cast<Acc>(pixels[tap * Channels + channel]) * weight;
+            }
+        }
+        for (int channel = 0; channel < Channels; ++channel) {
+            target[static_cast<std::size_t>(x) * Channels + channel] = narrowHorizontal<Acc, Intermediate>(sums[channel]);
+        }
+    }
+}
+
+// The tap counts of bilinear, bicubic and Lanczos-3 at 1x and up unroll completely.
+template <int Channels, typename Acc, typename T, typename Intermediate>
+void resampleHorizontalChannels(
+    const T* source,
+    const int target_width,
+    const int taps,
+    const std::int32_t* first,
+    const std::int16_t* weights,
+    Intermediate* target) {
+    switch (taps) {
+        case 2:
+            return resampleHorizontalFixed<Channels, 2, Acc>(source, target_width, taps, first, weights, target);
+        case 4:
+            return resampleHorizontalFixed<Channels, 4, Acc>(source, target_width, taps, first, weights, target);
+        case 6:
+            return resampleHorizontalFixed<Channels, 6, Acc>(source, target_width, taps, first, weights, target);
+        default:
+            return resampleHorizontalFixed<Channels, 0, Acc>(source, target_width, taps, first, weights, target);
+    }
+}
+
+// 1, 3 and 4 samples per pixel keep every channel's sum in a register across the taps.
+template <typename Acc, typename T, typename Intermediate>
+void resampleHorizontal(
+    const T* source,
+    const int samples_per_pixel,
+    const int target_width,
+    const int taps,
+    const std::int32_t* first,
+    const std::int16_t* weights,
+    Intermediate* target) {
+    switch (samples_per_pixel) {
+        case 1:
+            return resampleHorizontalChannels<1, Acc>(source, target_width, taps, first, weights, target);
+        case 3:
+            return resampleHorizontalChannels<3, Acc>(source, target_width, taps, first, weights, target);
+        case 4:
+            return resampleHorizontalChannels<4, Acc>(source, target_width, taps, first, weights, target);
+        default:
+            break;
+    }
+
+    const auto step = static_cast<std::size_t>(samples_per_pixel);
+    for (int x = 0; x < target_width; ++x) {
+        const T* pixels = source + static_cast<std::size_t>(first[x]) * step;
+        const std::int16_t* pixel_weights = weights + static_cast<std::size_t>(x) * static_cast<std::size_t>(taps);
+        for (std::size_t channel = 0; channel < step; ++channel) {
+            Acc sum = 0;
+            for (int tap = 0; tap < taps; ++tap) {
+                sum += static_cast<Acc>(pixels[static_cast<std::size_t>(tap) * step + channel]) * pixel_weights[tap];
+            }
+            target[static_cast<std::size_t>(x) * step + channel] = narrowHorizontal<Acc, Intermediate>(sum);
+        }
+    }
+}
+
+template <typename Acc, typename T>
+T narrowVertical(Acc sum, const T max_value) {
+    constexpr int kShift = kResampleWeightBits + kResampleIntermediateBits;
+    sum = (sum + (Acc {1} << (kShift - 1))) >> kShift;
+    return static_cast<T>(sum < 0 ? 0 : (sum > max_value ? max_value : sum));
+}
+
+template <int Taps, typename Acc, typename Intermediate, typename T>
+void resampleVerticalFixed(
+    const Intermediate* const* rows,
+    const std::int16_t* weights,
+    const std::size_t count,
+    const T max_value,
+    T* target) {
+    const Intermediate* taps[Taps];
+    Acc tap_weights[Taps];
+    for (int tap = 0; tap < Taps; ++tap) {
+        taps[tap] = rows[tap];
+        tap_weights[tap] = weights[tap];
+    }
+    for (std::size_t index = 0; index < count; ++index) {
+        Acc sum = 0;
+        for (int tap = 0; tap < Taps; ++tap) {
+            sum += static_cast<Acc>(taps[tap][index]) * tap_weights[tap];
+        }
+        target[index] = narrowVertical(sum, max_value);
+    }
+}
+
+// The tap counts of 2x-and-up bilinear, bicubic and Lanczos-3 unroll fully; other counts
+// accumulate a block of samples one row at a time, which vectorizes just as well.
+template <typename Acc, typename Intermediate, typename T>
+void resampleVertical(
+    const Intermediate* const* rows,
+    const int taps,
+    const std::int16_t* weights,
+    const std::size_t count,
+    const T max_value,
+    T* target) {
+    switch (taps) {
+        case 2:
+            return resampleVerticalFixed<2, Acc>(rows, weights, count, max_value, target);
+        case 4:
+            return resampleVerticalFixed<4, Acc>(rows, weights, count, max_value, target);
+        case 6:
+            return resampleVerticalFixed<6, Acc>(rows, weights, count, max_value, target);
+        default:
+            break;
+    }
+
+    constexpr std::size_t kBlock = 256;
+    Acc sums[kBlock];
+    for (std::size_t start = 0; start < count; start += kBlock) {
+        const std::size_t block = count - start < kBlock ? count - start : kBlock;
+        for (std::size_t index = 0; index < block; ++index) {
+            sums[index] = 0;
+        }
+        for (int tap = 0; tap < taps; ++tap) {
+            const Intermediate* row = rows[tap] + start;
+            const Acc weight = weights[tap];
+            for (std::size_t index = 0; index < block; ++index) {
+                sums[index] += static_cast<Acc>(row[index]) * weight;
+            }
+        }
+        for (std::size_t index = 0; index < block; ++index) {
+            target[start + index] = narrowVertical(sums[index], max_value);
+        }
+    }
+}
+
+void unpackBigEndian(const unsigned char* source, const std::size_t count, const std::uint16_t max_value, std::uint16_t* target) {
+    for (std::size_t index = 0; index < count; ++index) {
+        const auto value = static_cast<std::uint16_t>((source[index * 2] << 8) | source[index * 2 + 1]);
+        target[index] = value < max_value ? value : max_value;
+    }
+}
+
+void packBigEndian(const std::uint16_t* source, const std::size_t count, unsigned char* target) {
+    for (std::size_t index = 0; index < count; ++index) {
+        target[index * 2] = static_cast<unsigned char>(source[index] >> 8);
+        target[index * 2 + 1] = static_cast<unsigned char>(source[index] & 0xFFu);
+    }
+}
+
+}  // namespace
+
+KernelTable makeKernelTable(const CpuIsa isa) {
+    KernelTable table;
+    table.isa = isa;
+    table.box_row_sums_u8_u16 = &boxRowSums<std::uint8_t, std::uint16_t>;
+    table.box_row_sums_u8_u32 = &boxRowSums<std::uint8_t, std::uint32_t>;
+    table.box_row_sums_u16_u32 = &boxRowSums<std::uint16_t, std::uint32_t>;
+    table.slide_divide_u16_u8 = &slideAndDivide<std::uint16_t, std::uint8_t>;
+    table.slide_divide_u32_u8 = &slideAndDivide<std::uint32_t, std::uint8_t>;
+    table.slide_divide_u32_u16 = &slideAndDivide<std::uint32_t, std::uint16_t>;
+    table.expand_row_u8 = &expandRow<std::uint8_t>;
+    table.expand_row_u16 = &expandRow<std::uint16_t>;
+    table.resample_horizontal_u8 = &resampleHorizontal<std::int32_t, std::uint8_t, std::int16_t>;
+    table.resample_horizontal_u16 = &resampleHorizontal<std::int64_t, std::uint16_t, std::int32_t>;
+    table.resample_vertical_u8 = &resampleVertical<std::int32_t, std::int16_t, std::uint8_t>;
+    table.resample_vertical_u16 = &resampleVertical<std::int64_t, std::int32_t, std::uint16_t>;
+    table.unpack_big_endian_u16 = &unpackBigEndian;
+    table.pack_big_endian_u16 = &packBigEndian;
+    return table;
+}
+
+}  // namespace lumos::engine::LUMOS_KERNEL_NAMESPACE
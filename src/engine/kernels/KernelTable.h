@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Deliberately free of inline functions and library templates: this header is included by the
+// per-ISA kernel translation units, and any inline code they emit could be merged by the linker
+// into callers running on CPUs without that ISA.
+
+namespace lumos::engine {
+
+enum class CpuIsa {
+    kScalar,
+    kSse2,
+    kAvx2,
+    kAvx512,
+    kNeon,
+};
+
+// Horizontal box sums of one border-padded row: sums[i] adds 2 * radius + 1 samples `step`
+// apart starting at extended[i]. `prefix` is scratch of count + (2 * radius + 1) * step samples.
+template <typename T, typename Sum>
+using BoxRowSumsFn = void (*)(const T* extended, std::size_t step, std::size_t count, int radius, Sum* prefix, Sum* sums);
+
+// column += incoming - leaving; leaving = incoming; output = floor(column / area).
+template <typename Sum, typename T>
+using SlideDivideFn =
+    void (*)(Sum* column, const Sum* incoming, Sum* leaving, std::size_t count, std::uint32_t area, T* output);
+
+// Repeats every pixel of a row scale_factor times.
+template <typename T>
+using ExpandRowFn = void (*)(const T* source, int width, int samples_per_pixel, int scale_factor, T* expanded);
+
+// Horizontal pass of a separable resample: output pixel x is the Q14-weighted sum of `taps` pixels
+// starting at source pixel first[x], stored with kResampleIntermediateBits fractional bits.
+template <typename T, typename Intermediate>
+using ResampleHorizontalFn = void (*)(
+    const T* source,
+    int samples_per_pixel,
+    int target_width,
+    int taps,
+    const std::int32_t* first,
+    const std::int16_t* weights,
+    Intermediate* target);
+
+// Vertical pass: target[i] is the Q14-weighted sum of rows[0..taps)[i], rounded and clamped to
+// [0, max_value].
+template <typename Intermediate, typename T>
+using ResampleVerticalFn = void (*)(
+    const Intermediate* const* rows,
+    int taps,
+    const std::int16_t* weights,
+    std::size_t count,
+    T max_value,
+    T* target);
+
+inline constexpr int kResampleWeightBits = 14;
+inline constexpr int kResampleIntermediateBits = 6;
+
+// Big-endian 16-bit samples to native order, clamped to max_value, and back.
+using UnpackBigEndianFn = void (*)(const unsigned char* source, std::size_t count, std::uint16_t max_value, std::uint16_t* target);
+using PackBigEndianFn = void (*)(const std::uint16_t* source, std::size_t count, unsigned char* target);
+
+// One ISA's build of every dispatched kernel.
+struct KernelTable {
+    CpuIsa isa {CpuIsa::kScalar};
+    BoxRowSumsFn<std::uint8_t, std::uint16_t> box_row_sums_u8_u16 {nullptr};
+    BoxRowSumsFn<std::uint8_t, std::uint32_t> box_row_sums_u8_u32 {nullptr};
+    BoxRowSumsFn<std::uint16_t, std::uint32_t> box_row_sums_u16_u32 {nullptr};
+    SlideDivideFn<std::uint16_t, std::uint8_t> slide_divide_u16_u8 {nullptr};
+    SlideDivideFn<std::uint32_t, std::uint8_t> slide_divide_u32_u8 {nullptr};
+    SlideDivideFn<std::uint32_t, std::uint16_t> slide_divide_u32_u16 {nullptr};
+    ExpandRowFn<std::uint8_t> expand_row_u8 {nullptr};
+    ExpandRowFn<std::uint16_t> expand_row_u16 {nullptr};
+    ResampleHorizontalFn<std::uint8_t, std::int16_t> resample_horizontal_u8 {nullptr};
+    ResampleHorizontalFn<std::uint16_t, std::int32_t> resample_horizontal_u16 {nullptr};
+    ResampleVerticalFn<std::int16_t, std::uint8_t> resample_vertical_u8 {nullptr};
+    ResampleVerticalFn<std::int32_t, std::uint16_t> resample_vertical_u16 {nullptr};
+    UnpackBigEndianFn unpack_big_endian_u16 {nullptr};
+    PackBigEndianFn pack_big_endian_u16 {nullptr};
+};
+
+}  // namespace lumos::engine
@@ -0,0 +1,5 @@
+// Kernels built with AVX2 enabled (see CMakeLists.txt); only called once the CPU reports it.
+#if defined(__x86_64__) || defined(_M_X64)
+#define LUMOS_KERNEL_NAMESPACE avx2_kernels
+#include "engine/kernels/KernelBodies.h"
+#endif
@@ -0,0 +1,6 @@
+// Kernels built with AVX-512 F/BW/VL enabled (see CMakeLists.txt); only called once the CPU
+// reports them.
+#if defined(__x86_64__) || defined(_M_X64)
+#define LUMOS_KERNEL_NAMESPACE avx512_kernels
+#include "engine/kernels/KernelBodies.h"
+#endif
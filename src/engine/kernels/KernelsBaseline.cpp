@@ -0,0 +1,3 @@
+// Kernels built for the target's baseline instruction set: SSE2 on x86-64, NEON on AArch64.
+#define LUMOS_KERNEL_NAMESPACE baseline_kernels
+#include "engine/kernels/KernelBodies.h"
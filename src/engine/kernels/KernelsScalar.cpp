@@ -0,0 +1,4 @@
+// Reference build of the kernels with auto-vectorization disabled (see CMakeLists.txt). Forced
+// with LUMOS_CPU_ISA=scalar, and the baseline the per-ISA builds are checked against.
+#define LUMOS_KERNEL_NAMESPACE scalar_kernels
+#include "engine/kernels/KernelBodies.h"
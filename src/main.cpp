@@ -1,12 +1,15 @@
 #if defined(LUMOS_WITH_QT)
+#include "app/CachedPipeline.h"
 #include "app/EnhancementController.h"
 #include "common/Telemetry.h"
 #include "engine/CpuStubPipeline.h"
+#include "engine/DecodedImageCache.h"
 #include "ui/EnhanceViewModel.h"
 
 #include <QGuiApplication>
 #include <QQmlApplicationEngine>
 #include <QQmlContext>
+#include <QStandardPaths>
 #include <QUrl>
 #endif
 
@@ -18,8 +21,16 @@ int main(int argc, char* argv[]) {
     QQmlApplicationEngine engine;
 
     lumos::common::Telemetry telemetry;
-    lumos::engine::CpuStubPipeline pipeline;
-    lumos::app::EnhancementController controller(pipeline, telemetry);
+    lumos::engine::DecodedImageCache decoded_images;
+    const lumos::engine::PipelineOptions pipeline_options {.decoded_images = &decoded_images};
+    lumos::engine::CpuStubPipeline pipeline(pipeline_options);
+    // Salted with the engine version and output settings, so results cached before an upgrade or a
+    // filter change are not served.
+    const QString cache_directory =
+        QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/results");
+    lumos::app::CachedPipeline cached_pipeline(
+        pipeline, {.directory = cache_directory.toStdString(), .salt = lumos::engine::outputSignature(pipeline_options)});
+    lumos::app::EnhancementController controller(cached_pipeline, telemetry);
     lumos::ui::EnhanceViewModel enhance_view_model(controller);
     engine.rootContext()->setContextProperty("enhanceViewModel", &enhance_view_model);
 
@@ -6,6 +6,7 @@
 #include <QFileInfo>
 
 #include <chrono>
+#include <exception>
 #include <utility>
 
 namespace lumos::ui {
@@ -44,10 +45,10 @@ QUrl EnhanceViewModel::inputFileUrl() const {
 }
 
 QUrl EnhanceViewModel::resultFileUrl() const {
-    if (output_path_.isEmpty()) {
+    if (result_path_.isEmpty()) {
         return {};
     }
-    return QUrl::fromLocalFile(output_path_);
+    return QUrl::fromLocalFile(result_path_);
 }
 
 int EnhanceViewModel::scaleFactor() const noexcept {
@@ -63,7 +64,7 @@ bool EnhanceViewModel::busy() const noexcept {
 }
 
 bool EnhanceViewModel::canEnhance() const noexcept {
-    return !busy_ && !input_path_.isEmpty() && isPpmPath(input_path_);
+    return !busy_ && !input_path_.isEmpty() && input_readable_;
 }
 
 bool EnhanceViewModel::hasResult() const noexcept {
@@ -83,6 +84,7 @@ void EnhanceViewModel::setInputPath(const QString& input_path) {
     normalized = localPathFromUrl(normalized);
     const QFileInfo info(normalized);
     if (!info.exists() || !info.isFile()) {
+        input_readable_ = false;
         if (!input_path_.isEmpty()) {
             input_path_.clear();
             emit inputPathChanged();
@@ -112,6 +114,7 @@ void EnhanceViewModel::setInputPath(const QString& input_path) {
         emit inputPathChanged();
     }
 
+    input_readable_ = app::EnhancementController::probeInput(input_path_.toStdString()).has_value();
     controller_.trackInputSelected(input_path_.toStdString());
 
     if (has_result_) {
@@ -124,12 +127,12 @@ void EnhanceViewModel::setInputPath(const QString& input_path) {
     }
 
     refreshOutputPath();
-    if (isPpmPath(input_path_)) {
+    if (input_readable_) {
         setPhase("ready");
         setStatus("Ready to enhance. Review settings and click Enhance.");
     } else {
         setPhase("error");
-        setStatus("This prototype currently supports .ppm images.");
+        setStatus("This prototype currently supports PPM and PGM images.");
     }
 
     emit canEnhanceChanged();
@@ -162,7 +165,7 @@ void EnhanceViewModel::startEnhancement() {
 
     if (!canEnhance()) {
         setPhase("error");
-        setStatus("Select a valid .ppm image before running enhancement.");
+        setStatus("Select a valid .ppm or .pgm image before running enhancement.");
         return;
     }
 
@@ -176,7 +179,9 @@ void EnhanceViewModel::startEnhancement() {
     request.scale_factor = scale_factor_;
     request.denoise_enabled = denoise_enabled_;
 
-    pending_result_.emplace(controller_.runEnhancementAsync(std::move(request)));
+    app::ProgressiveRun run = controller_.runProgressiveAsync(std::move(request), kPreviewMaxExtent);
+    pending_preview_.emplace(std::move(run.preview));
+    pending_result_.emplace(std::move(run.full));
 
     busy_ = true;
     emit busyChanged();
@@ -204,10 +209,13 @@ void EnhanceViewModel::resetSession() {
     const bool had_result = has_result_;
     const bool had_input = !input_path_.isEmpty();
     const bool had_output = !output_path_.isEmpty();
+    const bool had_result_path = !result_path_.isEmpty();
     const bool had_summary = !result_summary_.isEmpty();
 
     input_path_.clear();
+    input_readable_ = false;
     output_path_.clear();
+    result_path_.clear();
     result_summary_.clear();
     has_result_ = false;
 
@@ -220,6 +228,9 @@ void EnhanceViewModel::resetSession() {
     if (had_output) {
         emit outputPathChanged();
     }
+    if (had_result_path) {
+        emit resultPathChanged();
+    }
     if (had_summary) {
         emit resultSummaryChanged();
     }
@@ -238,6 +249,21 @@ QString EnhanceViewModel::localPathFromUrl(const QString& raw_url) const {
 }
 
 void EnhanceViewModel::pollPendingResult() {
+    if (pending_preview_.has_value() && pending_preview_->wait_for(std::chrono::milliseconds(0)) == std::future_status::ready) {
+        // A failed preview leaves the error, if any, to the full-resolution run; one that threw is
+        // left as a default result, which is not ok.
+        contracts::EnhancementResult preview;
+        try {
+            preview = pending_preview_->get();
+        } catch (...) {
+        }
+        pending_preview_.reset();
+        if (preview.ok) {
+            showResult(preview, QStringLiteral("Preview "));
+            setStatus("Preview ready. Finishing full resolution...");
+        }
+    }
+
     if (!pending_result_.has_value()) {
         poll_timer_.stop();
         return;
@@ -247,7 +273,14 @@ void EnhanceViewModel::pollPendingResult() {
         return;
     }
 
-    contracts::EnhancementResult result = pending_result_->get();
+    contracts::EnhancementResult result;
+    try {
+        result = pending_result_->get();
+    } catch (const std::exception& ex) {
+        result.error = {contracts::ErrorCode::kProcessFailed, "enhance", ex.what()};
+    } catch (...) {
+        result.error = {contracts::ErrorCode::kProcessFailed, "enhance", "unknown error"};
+    }
     pending_result_.reset();
     poll_timer_.stop();
 
@@ -256,23 +289,7 @@ void EnhanceViewModel::pollPendingResult() {
     emit canEnhanceChanged();
 
     if (result.ok) {
-        const QString prior_output = output_path_;
-        output_path_ = QString::fromStdString(result.output_path);
-        if (prior_output != output_path_) {
-            emit outputPathChanged();
-        }
-
-        has_result_ = true;
-        emit hasResultChanged();
-
-        result_summary_ = QString("%1x%2 -> %3x%4 in %5 ms")
-                              .arg(result.metrics.input_width)
-                              .arg(result.metrics.input_height)
-                              .arg(result.metrics.output_width)
-                              .arg(result.metrics.output_height)
-                              .arg(static_cast<qulonglong>(result.metrics.duration_ms));
-        emit resultSummaryChanged();
-
+        showResult(result, QString());
         setPhase("success");
         setStatus("Enhancement complete. Review result and output path.");
         return;
@@ -302,9 +319,26 @@ bool EnhanceViewModel::isSupportedScaleFactor(const int scale_factor) noexcept {
     return scale_factor == 2 || scale_factor == 4 || scale_factor == 8;
 }
 
-bool EnhanceViewModel::isPpmPath(const QString& local_path) {
-    const QFileInfo info(local_path);
-    return info.suffix().compare("ppm", Qt::CaseInsensitive) == 0;
+void EnhanceViewModel::showResult(const contracts::EnhancementResult& result, const QString& label) {
+    const QString prior_result = result_path_;
+    result_path_ = QString::fromStdString(result.output_path);
+    if (prior_result != result_path_) {
+        emit resultPathChanged();
+    }
+
+    if (!has_result_) {
+        has_result_ = true;
+        emit hasResultChanged();
+    }
+
+    result_summary_ = QString("%1%2x%3 -> %4x%5 in %6 ms")
+                          .arg(label)
+                          .arg(result.metrics.input_width)
+                          .arg(result.metrics.input_height)
+                          .arg(result.metrics.output_width)
+                          .arg(result.metrics.output_height)
+                          .arg(static_cast<qulonglong>(result.metrics.duration_ms));
+    emit resultSummaryChanged();
 }
 
 void EnhanceViewModel::setPhase(const QString& next_phase) {
@@ -336,7 +370,8 @@ void EnhanceViewModel::refreshOutputPath() {
         const QFileInfo info(input_path_);
         const QString base_name = info.completeBaseName().isEmpty() ? QStringLiteral("output") : info.completeBaseName();
         next_output = QDir::toNativeSeparators(
-            info.dir().absoluteFilePath(QString("%1_lumos_%2x.ppm").arg(base_name).arg(scale_factor_)));
+            info.dir().absoluteFilePath(
+                QString("%1_lumos_%2x.%3").arg(base_name).arg(scale_factor_).arg(info.suffix().toLower())));
     }
 
     if (output_path_ == next_output) {
@@ -25,7 +25,7 @@ class EnhanceViewModel : public QObject {
     Q_PROPERTY(QString inputPath READ inputPath NOTIFY inputPathChanged)
     Q_PROPERTY(QString outputPath READ outputPath NOTIFY outputPathChanged)
     Q_PROPERTY(QUrl inputFileUrl READ inputFileUrl NOTIFY inputPathChanged)
-    Q_PROPERTY(QUrl resultFileUrl READ resultFileUrl NOTIFY outputPathChanged)
+    Q_PROPERTY(QUrl resultFileUrl READ resultFileUrl NOTIFY resultPathChanged)
     Q_PROPERTY(int scaleFactor READ scaleFactor NOTIFY scaleFactorChanged)
     Q_PROPERTY(bool denoiseEnabled READ denoiseEnabled NOTIFY denoiseEnabledChanged)
     Q_PROPERTY(bool busy READ busy NOTIFY busyChanged)
@@ -64,6 +64,7 @@ class EnhanceViewModel : public QObject {
     void resultSummaryChanged();
     void inputPathChanged();
     void outputPathChanged();
+    void resultPathChanged();
     void scaleFactorChanged();
     void denoiseEnabledChanged();
     void busyChanged();
@@ -75,26 +76,35 @@ class EnhanceViewModel : public QObject {
     void pollPendingResult();
 
   private:
+    // Longest side of the preview shown while the full-resolution result is computed.
+    static constexpr int kPreviewMaxExtent = 1920;
+
     static bool isSupportedScaleFactor(int scale_factor) noexcept;
-    static bool isPpmPath(const QString& local_path);
 
     void setPhase(const QString& next_phase);
     void setStatus(const QString& next_status);
     void refreshOutputPath();
+    // Shows a finished result, its summary starting with `label`.
+    void showResult(const contracts::EnhancementResult& result, const QString& label);
 
     app::EnhancementController& controller_;
     QTimer poll_timer_;
+    std::optional<std::future<contracts::EnhancementResult>> pending_preview_;
     std::optional<std::future<contracts::EnhancementResult>> pending_result_;
 
     QString phase_ {"empty"};
     QString status_text_ {"Drop a .ppm image to begin."};
     QString result_summary_;
     QString input_path_;
+    // Where the next run writes; the result on show may be a preview written next to it.
     QString output_path_;
+    QString result_path_;
     int scale_factor_ {4};
     bool denoise_enabled_ {true};
     bool busy_ {false};
     bool has_result_ {false};
+    // Whether the probe read an image header from input_path_.
+    bool input_readable_ {false};
 };
 
 }  // namespace lumos::ui
@@ -167,7 +167,7 @@ Rectangle {
                         TextField {
                             id: pathInput
                             Layout.fillWidth: true
-                            placeholderText: "Drop a local .ppm file or paste its absolute path"
+                            placeholderText: "Drop a local .ppm or .pgm file or paste its absolute path"
                             text: viewModel ? viewModel.inputPath : ""
                             color: theme.inkPrimary
                             placeholderTextColor: theme.inkMuted
@@ -260,7 +260,7 @@ Rectangle {
                             }
 
                             Label {
-                                text: "Current pipeline accepts .ppm while we harden broader format support."
+                                text: "Current pipeline accepts .ppm and .pgm (ASCII or binary) while we harden broader format support."
                                 color: theme.inkMuted
                                 font.pixelSize: 14
                                 font.family: theme.bodyFont
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
 #include <stdexcept>
 #include <string>
 #include <string_view>
@@ -21,6 +25,57 @@ inline std::filesystem::path tempOutputPath(const std::string_view filename) {
     return dir / filename;
 }
 
+inline std::filesystem::path writeTempFile(const std::string_view filename, const std::string_view contents) {
+    const auto path = tempOutputPath(filename);
+    std::ofstream output(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    output.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    return path;
+}
+
+inline std::string readFileBytes(const std::filesystem::path& path) {
+    std::ifstream input(path, std::ios::in | std::ios::binary);
+    return {std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>()};
+}
+
+// A width x height image of deterministic xorshift noise, every sample in [0, max_value].
+template <typename Buffer>
+Buffer makeNoise(
+    const int width,
+    const int height,
+    const std::uint32_t seed,
+    const std::uint32_t max_value = std::numeric_limits<typename Buffer::Sample>::max()) {
+    Buffer buffer(width, height);
+    std::uint32_t state = seed;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            for (int channel = 0; channel < Buffer::kChannels; ++channel) {
+                state ^= state << 13;
+                state ^= state >> 17;
+                state ^= state << 5;
+                buffer.at(x, y, channel) = static_cast<typename Buffer::Sample>(state % (std::uint64_t {max_value} + 1));
+            }
+        }
+    }
+    return buffer;
+}
+
+template <typename Buffer>
+bool samePixels(const Buffer& left, const Buffer& right) {
+    if (left.width() != right.width() || left.height() != right.height()) {
+        return false;
+    }
+    for (int y = 0; y < left.height(); ++y) {
+        for (int x = 0; x < left.width(); ++x) {
+            for (int channel = 0; channel < Buffer::kChannels; ++channel) {
+                if (left.at(x, y, channel) != right.at(x, y, channel)) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
 inline void require(const bool condition, const std::string& message) {
     if (!condition) {
         throw std::runtime_error(message);
@@ -0,0 +1,97 @@
+#include "engine/BatchExecutor.h"
+#include "engine/CpuStubPipeline.h"
+#include "engine/ImageBuffer.h"
+#include "engine/PpmCodec.h"
+#include "tests/TestHelpers.h"
+#include "tests/benchmarks/BenchHelpers.h"
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+std::vector<lumos::contracts::EnhancementRequest> writeBatch(
+    const std::filesystem::path& directory,
+    const int files,
+    const int width,
+    const int height) {
+    std::filesystem::create_directories(directory);
+    lumos::bench::SampleNoise noise;
+    std::vector<lumos::contracts::EnhancementRequest> requests;
+    for (int file = 0; file < files; ++file) {
+        lumos::engine::Rgb8Image pixels(width, height);
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                const std::uint32_t bits = noise.next();
+                for (int channel = 0; channel < 3; ++channel) {
+                    pixels.at(x, y, channel) = static_cast<std::uint8_t>(bits >> (8 * channel));
+                }
+            }
+        }
+        const lumos::engine::Image image {.max_value = 255, .pixels = std::move(pixels)};
+        lumos::contracts::EnhancementRequest request;
+        request.input_path = (directory / ("input_" + std::to_string(file) + ".ppm")).string();
+        request.output_path = (directory / ("output_" + std::to_string(file) + ".ppm")).string();
+        request.denoise_enabled = true;
+        std::string error;
+        lumos::engine::encodePpm(image, lumos::engine::PpmFormat::kBinaryRgb, request.input_path, &error);
+        requests.push_back(request);
+    }
+    return requests;
+}
+
+void reportBatch(const std::string_view label, const double ms, const int files) {
+    std::cout << std::left << std::setw(36) << label << std::right << std::fixed << std::setprecision(2) << std::setw(10) << ms
+              << " ms" << std::setw(12) << (files / (ms / 60000.0)) << " images/min\n";
+}
+
+void reportStage(const std::string_view name, const lumos::engine::StageUtilization& stage, const std::chrono::steady_clock::duration wall) {
+    const auto ms = [](const std::chrono::steady_clock::duration duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    };
+    std::cout << "  " << std::left << std::setw(8) << name << std::right << std::fixed << std::setprecision(1) << std::setw(6)
+              << (100.0 * stage.busyFraction(wall)) << "% busy" << std::setw(10) << ms(stage.starved) << " ms starved"
+              << std::setw(10) << ms(stage.blocked) << " ms blocked\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const int files = lumos::bench::argOrDefault(argc, argv, 1, 200);
+    const int width = lumos::bench::argOrDefault(argc, argv, 2, 640);
+    const int height = lumos::bench::argOrDefault(argc, argv, 3, 480);
+    const auto directory = lumos::tests::tempOutputPath("bench_batch");
+    const auto requests = writeBatch(directory, files, width, height);
+    lumos::engine::CpuStubPipeline pipeline;
+
+    std::cout << files << " P6 " << width << "x" << height << " at 2x with denoise\n";
+    bool ok = true;
+    const double serial_ms = lumos::bench::bestOfMs(1, [&] {
+        for (const auto& request : requests) {
+            ok = pipeline.run(request).ok && ok;
+        }
+    });
+    reportBatch("serial run() per file", serial_ms, files);
+
+    for (const int depth : {1, 2, 4}) {
+        const auto report = lumos::engine::BatchExecutor(pipeline, {.queue_depth = depth}).run(requests);
+        for (const auto& result : report.results) {
+            ok = result.ok && ok;
+        }
+        reportBatch(
+            "pipelined, queue depth " + std::to_string(depth), std::chrono::duration<double, std::milli>(report.wall).count(), files);
+        reportStage("decode", report.decode, report.wall);
+        reportStage("enhance", report.enhance, report.wall);
+        reportStage("encode", report.encode, report.wall);
+        std::cout << "  peak frames " << report.peak_frames << "\n";
+    }
+
+    std::filesystem::remove_all(directory);
+    return ok ? 0 : 1;
+}
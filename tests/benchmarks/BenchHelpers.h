@@ -0,0 +1,59 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string_view>
+
+namespace lumos::bench {
+
+// Best-of-N wall time; the minimum is the most stable estimator on a shared machine.
+template <typename Fn>
+double bestOfMs(const int iterations, Fn&& fn) {
+    double best_ms = std::numeric_limits<double>::max();
+    for (int i = 0; i < iterations; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        const auto stop = std::chrono::steady_clock::now();
+        best_ms = std::min(best_ms, std::chrono::duration<double, std::milli>(stop - start).count());
+    }
+    return best_ms;
+}
+
+inline int argOrDefault(const int argc, char* argv[], const int index, const int fallback) {
+    if (argc > index) {
+        const int value = std::atoi(argv[index]);
+        if (value > 0) {
+            return value;
+        }
+    }
+    return fallback;
+}
+
+inline void report(const std::string_view label, const double ms, const double megabytes, const double megapixels) {
+    std::cout << std::left << std::setw(36) << label << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << ms << " ms" << std::setw(10) << (megabytes / (ms / 1000.0)) << " MB/s"
+              << std::setw(10) << (megapixels / (ms / 1000.0)) << " MP/s\n";
+}
+
+// Deterministic xorshift so every benchmark run sees the same pixels.
+class SampleNoise {
+  public:
+    explicit SampleNoise(const std::uint32_t seed = 0x9E3779B9u) : state_(seed) {}
+
+    std::uint32_t next() noexcept {
+        state_ ^= state_ << 13;
+        state_ ^= state_ >> 17;
+        state_ ^= state_ << 5;
+        return state_;
+    }
+
+  private:
+    std::uint32_t state_;
+};
+
+}  // namespace lumos::bench
@@ -0,0 +1,108 @@
+#include "engine/BoxBlur.h"
+#include "engine/GuidedFilter.h"
+#include "engine/ImageBuffer.h"
+#include "engine/KernelRegistry.h"
+#include "tests/benchmarks/BenchHelpers.h"
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+namespace {
+
+// The scalar 3x3 gather that shipped before the sliding-window blur, kept as the baseline.
+void legacyBlur(const lumos::engine::Rgb8Image& input, lumos::engine::Rgb8Image& output) {
+    const std::size_t step = 3;
+    const std::size_t row_samples = static_cast<std::size_t>(input.width()) * step;
+    for (int y = 0; y < input.height(); ++y) {
+        const std::uint8_t* source = input.row(y);
+        std::uint8_t* target = output.row(y);
+        std::copy(source, source + row_samples, target);
+        if (y == 0 || y == input.height() - 1) {
+            continue;
+        }
+        const std::uint8_t* above = input.row(y - 1);
+        const std::uint8_t* below = input.row(y + 1);
+        for (std::size_t index = step; index < row_samples - step; ++index) {
+            std::uint32_t sum = 0;
+            for (const std::uint8_t* sample_row : {above, source, below}) {
+                sum += static_cast<std::uint32_t>(sample_row[index - step]) + sample_row[index] + sample_row[index + step];
+            }
+            target[index] = static_cast<std::uint8_t>(sum / 9u);
+        }
+    }
+}
+
+// The same gather at any radius, to show what a stronger preset would cost without sliding sums.
+void gatherBlur(const lumos::engine::Rgb8Image& input, const int radius, lumos::engine::Rgb8Image& output) {
+    const std::size_t step = 3;
+    const std::size_t row_samples = static_cast<std::size_t>(input.width()) * step;
+    const std::size_t edge = static_cast<std::size_t>(radius) * step;
+    const auto area = static_cast<std::uint32_t>((2 * radius + 1) * (2 * radius + 1));
+    for (int y = 0; y < input.height(); ++y) {
+        const std::uint8_t* source = input.row(y);
+        std::uint8_t* target = output.row(y);
+        std::copy(source, source + row_samples, target);
+        if (y < radius || y >= input.height() - radius) {
+            continue;
+        }
+        for (std::size_t index = edge; index < row_samples - edge; ++index) {
+            std::uint32_t sum = 0;
+            for (int dy = -radius; dy <= radius; ++dy) {
+                const std::uint8_t* sample_row = input.row(y + dy);
+                for (std::size_t tap = index - edge; tap <= index + edge; tap += step) {
+                    sum += sample_row[tap];
+                }
+            }
+            target[index] = static_cast<std::uint8_t>(sum / area);
+        }
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const int width = lumos::bench::argOrDefault(argc, argv, 1, 4000);
+    const int height = lumos::bench::argOrDefault(argc, argv, 2, 3000);
+    const int iterations = lumos::bench::argOrDefault(argc, argv, 3, 3);
+
+    lumos::engine::Rgb8Image input(width, height);
+    lumos::bench::SampleNoise noise;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const std::uint32_t bits = noise.next();
+            for (int channel = 0; channel < 3; ++channel) {
+                input.at(x, y, channel) = static_cast<std::uint8_t>(bits >> (8 * channel));
+            }
+        }
+    }
+    lumos::engine::Rgb8Image output(width, height);
+    const double megabytes = static_cast<double>(width) * static_cast<double>(height) * 3.0 / (1024.0 * 1024.0);
+    const double megapixels = static_cast<double>(width) * static_cast<double>(height) / 1.0e6;
+    std::cout << "RGB8 box blur " << width << "x" << height << " (" << lumos::engine::cpuIsaName(lumos::engine::activeKernels().isa)
+              << " kernels; set LUMOS_CPU_ISA to compare)\n";
+
+    const double legacy_ms = lumos::bench::bestOfMs(iterations, [&] { legacyBlur(input, output); });
+    lumos::bench::report("legacy 3x3 gather", legacy_ms, megabytes, megapixels);
+    const double gather_ms = lumos::bench::bestOfMs(iterations, [&] { gatherBlur(input, 3, output); });
+    lumos::bench::report("gather r=3", gather_ms, megabytes, megapixels);
+
+    for (const int radius : {1, 3, 8, 32}) {
+        for (const auto border : {lumos::engine::BorderMode::kUntouched, lumos::engine::BorderMode::kMirror}) {
+            const lumos::engine::BoxBlurOptions options {.radius = radius, .border = border};
+            const double ms =
+                lumos::bench::bestOfMs(iterations, [&] { lumos::engine::boxBlur(input.view(), options, output.mutableView()); });
+            const std::string label = "sliding r=" + std::to_string(radius) +
+                                      (border == lumos::engine::BorderMode::kMirror ? " mirror" : " untouched");
+            lumos::bench::report(label, ms, megabytes, megapixels);
+        }
+    }
+
+    for (const int radius : {2, 4, 8}) {
+        const lumos::engine::GuidedFilterOptions options {.radius = radius, .strength = 0.5f};
+        const double ms = lumos::bench::bestOfMs(
+            iterations, [&] { lumos::engine::guidedFilter(input.view(), options, std::uint8_t {255}, output.mutableView()); });
+        lumos::bench::report("guided r=" + std::to_string(radius), ms, megabytes, megapixels);
+    }
+    return 0;
+}
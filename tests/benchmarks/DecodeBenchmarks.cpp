@@ -0,0 +1,142 @@
+#include "engine/PpmCodec.h"
+#include "tests/TestHelpers.h"
+#include "tests/benchmarks/BenchHelpers.h"
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// The int-per-channel pixel store and token-vector parser that shipped before PpmReader, kept
+// verbatim as the baseline.
+struct LegacyPixel {
+    int r {0};
+    int g {0};
+    int b {0};
+};
+
+struct LegacyImage {
+    int width {0};
+    int height {0};
+    int max_value {255};
+    std::vector<LegacyPixel> pixels;
+};
+
+bool legacyParsePpm(const std::string& path, LegacyImage* image) {
+    std::ifstream input(path, std::ios::in);
+    if (!input.good()) {
+        return false;
+    }
+
+    std::vector<std::string> tokens;
+    std::string token;
+    while (input >> token) {
+        if (!token.empty() && token[0] == '#') {
+            std::string skip_line;
+            std::getline(input, skip_line);
+            continue;
+        }
+        tokens.push_back(token);
+    }
+
+    if (tokens.size() < 4 || tokens[0] != "P3") {
+        return false;
+    }
+
+    int width = 0;
+    int height = 0;
+    int max_value = 0;
+    try {
+        width = std::stoi(tokens[1]);
+        height = std::stoi(tokens[2]);
+        max_value = std::stoi(tokens[3]);
+    } catch (...) {
+        return false;
+    }
+
+    const std::size_t pixel_count = static_cast<std::size_t>(width) * static_cast<std::size_t>(height);
+    if (tokens.size() < 4 + pixel_count * 3) {
+        return false;
+    }
+
+    image->width = width;
+    image->height = height;
+    image->max_value = max_value;
+    image->pixels.assign(pixel_count, {});
+
+    std::size_t index = 4;
+    for (LegacyPixel& pixel : image->pixels) {
+        try {
+            pixel.r = std::clamp(std::stoi(tokens[index++]), 0, max_value);
+            pixel.g = std::clamp(std::stoi(tokens[index++]), 0, max_value);
+            pixel.b = std::clamp(std::stoi(tokens[index++]), 0, max_value);
+        } catch (...) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::filesystem::path writeSyntheticP3(const int width, const int height) {
+    const auto path = lumos::tests::tempOutputPath("bench_decode_input.ppm");
+    std::string text = "P3\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+    text.reserve(text.size() + static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * 12);
+
+    lumos::bench::SampleNoise noise;
+    char digits[4];
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width * 3; ++x) {
+            const auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), noise.next() & 0xFFu);
+            (void)ec;
+            text.append(digits, end);
+            text.push_back(x + 1 == width * 3 ? '\n' : ' ');
+        }
+    }
+
+    lumos::tests::writeTempFile(path.filename().string(), text);
+    return path;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const int width = lumos::bench::argOrDefault(argc, argv, 1, 2000);
+    const int height = lumos::bench::argOrDefault(argc, argv, 2, 1500);
+    const int iterations = lumos::bench::argOrDefault(argc, argv, 3, 3);
+
+    const auto path = writeSyntheticP3(width, height);
+    const double megabytes = static_cast<double>(std::filesystem::file_size(path)) / (1024.0 * 1024.0);
+    const double megapixels = static_cast<double>(width) * static_cast<double>(height) / 1.0e6;
+    std::cout << "P3 decode " << width << "x" << height << " (" << megabytes << " MB)\n";
+
+    LegacyImage legacy;
+    const double legacy_ms = lumos::bench::bestOfMs(iterations, [&] { legacyParsePpm(path.string(), &legacy); });
+    lumos::bench::report("legacy token-vector parser", legacy_ms, megabytes, megapixels);
+
+    lumos::engine::Image mapped;
+    std::string error;
+    const double mapped_ms = lumos::bench::bestOfMs(iterations, [&] { lumos::engine::decodePpm(path.string(), &mapped, &error); });
+    lumos::bench::report("mapped from_chars decoder", mapped_ms, megabytes, megapixels);
+
+    bool identical = legacy.width == mapped.width() && legacy.height == mapped.height();
+    for (int y = 0; identical && y < legacy.height; ++y) {
+        for (int x = 0; identical && x < legacy.width; ++x) {
+            const LegacyPixel& pixel = legacy.pixels[static_cast<std::size_t>(y) * static_cast<std::size_t>(legacy.width) + static_cast<std::size_t>(x)];
+            identical = pixel.r == mapped.sample(x, y, 0) && pixel.g == mapped.sample(x, y, 1) && pixel.b == mapped.sample(x, y, 2);
+        }
+    }
+    std::cout << "speedup " << (legacy_ms / mapped_ms) << "x, outputs " << (identical ? "identical" : "DIFFER") << '\n';
+
+    const auto binary_path = lumos::tests::tempOutputPath("bench_decode_input_p6.ppm");
+    lumos::engine::encodePpm(mapped, lumos::engine::PpmFormat::kBinaryRgb, binary_path.string(), &error);
+    const double binary_megabytes = static_cast<double>(std::filesystem::file_size(binary_path)) / (1024.0 * 1024.0);
+    lumos::engine::Image binary;
+    const double binary_ms =
+        lumos::bench::bestOfMs(iterations, [&] { lumos::engine::decodePpm(binary_path.string(), &binary, &error); });
+    lumos::bench::report("mapped P6 decoder", binary_ms, binary_megabytes, megapixels);
+    return identical ? 0 : 1;
+}
@@ -0,0 +1,75 @@
+#include "engine/PpmCodec.h"
+#include "tests/TestHelpers.h"
+#include "tests/benchmarks/BenchHelpers.h"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct LegacyPixel {
+    int r {0};
+    int g {0};
+    int b {0};
+};
+
+// The per-pixel stream-insert writer that shipped before PpmWriter, kept as the baseline.
+void legacyWritePpm(const std::vector<LegacyPixel>& pixels, const int width, const int height, const std::string& path) {
+    std::ofstream output(path, std::ios::out | std::ios::trunc);
+    output << "P3\n" << width << " " << height << "\n" << 255 << "\n";
+    for (const LegacyPixel& pixel : pixels) {
+        output << pixel.r << " " << pixel.g << " " << pixel.b << "\n";
+    }
+}
+
+double fileMegabytes(const std::filesystem::path& path) {
+    return static_cast<double>(std::filesystem::file_size(path)) / (1024.0 * 1024.0);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const int width = lumos::bench::argOrDefault(argc, argv, 1, 4000);
+    const int height = lumos::bench::argOrDefault(argc, argv, 2, 3000);
+    const int iterations = lumos::bench::argOrDefault(argc, argv, 3, 3);
+
+    std::vector<LegacyPixel> legacy_pixels(static_cast<std::size_t>(width) * static_cast<std::size_t>(height));
+    lumos::engine::Rgb8Image pixels(width, height);
+    lumos::bench::SampleNoise noise;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const std::uint32_t bits = noise.next();
+            auto& legacy = legacy_pixels[static_cast<std::size_t>(y) * static_cast<std::size_t>(width) + static_cast<std::size_t>(x)];
+            legacy = {static_cast<int>(bits & 0xFFu), static_cast<int>((bits >> 8) & 0xFFu), static_cast<int>((bits >> 16) & 0xFFu)};
+            pixels.at(x, y, 0) = static_cast<std::uint8_t>(legacy.r);
+            pixels.at(x, y, 1) = static_cast<std::uint8_t>(legacy.g);
+            pixels.at(x, y, 2) = static_cast<std::uint8_t>(legacy.b);
+        }
+    }
+    const lumos::engine::Image image {.max_value = 255, .pixels = std::move(pixels)};
+
+    const double megapixels = static_cast<double>(width) * static_cast<double>(height) / 1.0e6;
+    std::cout << "PPM encode " << width << "x" << height << '\n';
+
+    const auto legacy_path = lumos::tests::tempOutputPath("bench_encode_legacy.ppm");
+    const double legacy_ms = lumos::bench::bestOfMs(iterations, [&] { legacyWritePpm(legacy_pixels, width, height, legacy_path.string()); });
+    lumos::bench::report("legacy stream-insert P3", legacy_ms, fileMegabytes(legacy_path), megapixels);
+
+    std::string error;
+    const auto ascii_path = lumos::tests::tempOutputPath("bench_encode_ascii.ppm");
+    const double ascii_ms = lumos::bench::bestOfMs(iterations, [&] {
+        lumos::engine::encodePpm(image, lumos::engine::PpmFormat::kAsciiRgb, ascii_path.string(), &error);
+    });
+    lumos::bench::report("buffered P3", ascii_ms, fileMegabytes(ascii_path), megapixels);
+
+    const auto binary_path = lumos::tests::tempOutputPath("bench_encode_binary.ppm");
+    const double binary_ms = lumos::bench::bestOfMs(iterations, [&] {
+        lumos::engine::encodePpm(image, lumos::engine::PpmFormat::kBinaryRgb, binary_path.string(), &error);
+    });
+    lumos::bench::report("buffered P6", binary_ms, fileMegabytes(binary_path), megapixels);
+
+    std::cout << "P3 speedup " << (legacy_ms / ascii_ms) << "x\n";
+    return 0;
+}
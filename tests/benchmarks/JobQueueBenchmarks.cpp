@@ -0,0 +1,87 @@
+#include "app/EnhancementController.h"
+#include "app/JobQueue.h"
+#include "common/Telemetry.h"
+#include "common/ThreadPool.h"
+#include "engine/CpuStubPipeline.h"
+#include "engine/ImageBuffer.h"
+#include "engine/PpmCodec.h"
+#include "tests/TestHelpers.h"
+#include "tests/benchmarks/BenchHelpers.h"
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<std::filesystem::path> writeBatch(const std::filesystem::path& directory, const int files, const int width, const int height) {
+    std::filesystem::create_directories(directory);
+    lumos::bench::SampleNoise noise;
+    std::vector<std::filesystem::path> paths;
+    for (int file = 0; file < files; ++file) {
+        lumos::engine::Rgb8Image pixels(width, height);
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                const std::uint32_t bits = noise.next();
+                for (int channel = 0; channel < 3; ++channel) {
+                    pixels.at(x, y, channel) = static_cast<std::uint8_t>(bits >> (8 * channel));
+                }
+            }
+        }
+        const lumos::engine::Image image {.max_value = 255, .pixels = std::move(pixels)};
+        paths.push_back(directory / ("input_" + std::to_string(file) + ".ppm"));
+        std::string error;
+        lumos::engine::encodePpm(image, lumos::engine::PpmFormat::kBinaryRgb, paths.back().string(), &error);
+    }
+    return paths;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const int files = lumos::bench::argOrDefault(argc, argv, 1, 1000);
+    const int width = lumos::bench::argOrDefault(argc, argv, 2, 160);
+    const int height = lumos::bench::argOrDefault(argc, argv, 3, 120);
+
+    const auto directory = lumos::tests::tempOutputPath("bench_job_queue");
+    const auto inputs = writeBatch(directory, files, width, height);
+    lumos::common::Telemetry telemetry(directory / "events.jsonl");
+    lumos::engine::CpuStubPipeline pipeline;
+    lumos::common::ThreadPool& pool = lumos::common::ThreadPool::shared();
+    lumos::app::EnhancementController controller(pipeline, telemetry, pool);
+
+    std::cout << files << " P6 " << width << "x" << height << " at 2x with denoise on " << pool.workerCount() << " workers\n";
+    bool ok = true;
+    std::vector<int> limits {1, 2, 4};
+    if (pool.workerCount() > 4) {
+        limits.push_back(pool.workerCount());
+    }
+    for (const int concurrent : limits) {
+        lumos::app::JobQueue queue(
+            controller, {.max_concurrent = concurrent, .finished_history = static_cast<std::size_t>(files)}, pool);
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<lumos::app::JobId> ids;
+        for (int file = 0; file < files; ++file) {
+            lumos::contracts::EnhancementRequest request;
+            request.input_path = inputs[static_cast<std::size_t>(file)].string();
+            request.output_path = (directory / ("output_" + std::to_string(file) + ".ppm")).string();
+            request.denoise_enabled = true;
+            ids.push_back(queue.enqueue(std::move(request), lumos::app::JobPriority::kBatch));
+        }
+        queue.waitIdle();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        for (const auto id : ids) {
+            ok = ok && queue.status(id)->state == lumos::app::JobState::kSucceeded;
+        }
+        std::cout << std::left << std::setw(36) << ("max " + std::to_string(concurrent) + " concurrent jobs") << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(10) << (seconds * 1000.0) << " ms" << std::setw(12) << (files / seconds * 60.0)
+                  << " images/min\n";
+    }
+
+    std::filesystem::remove_all(directory);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,174 @@
+#include "app/CachedPipeline.h"
+#include "engine/CpuStubPipeline.h"
+#include "engine/DecodedImageCache.h"
+#include "engine/ImageBuffer.h"
+#include "engine/PpmCodec.h"
+#include "tests/TestHelpers.h"
+#include "tests/benchmarks/BenchHelpers.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+
+namespace {
+
+// The pre-ImageBuffer pixel store: three ints per pixel regardless of sample depth.
+struct LegacyPixel {
+    int r {0};
+    int g {0};
+    int b {0};
+};
+
+void reportFootprint(const std::string_view label, const std::size_t bytes, const std::size_t pixels) {
+    std::cout << std::left << std::setw(36) << label << std::right << std::fixed << std::setprecision(1) << std::setw(10)
+              << (static_cast<double>(bytes) / (1024.0 * 1024.0)) << " MiB" << std::setw(10)
+              << (static_cast<double>(bytes) / static_cast<double>(pixels)) << " B/px\n";
+}
+
+std::filesystem::path writeSyntheticP6(const int width, const int height) {
+    lumos::engine::Rgb8Image pixels(width, height);
+    lumos::bench::SampleNoise noise;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const std::uint32_t bits = noise.next();
+            for (int channel = 0; channel < 3; ++channel) {
+                pixels.at(x, y, channel) = static_cast<std::uint8_t>(bits >> (8 * channel));
+            }
+        }
+    }
+    const lumos::engine::Image image {.max_value = 255, .pixels = std::move(pixels)};
+    const auto path = lumos::tests::tempOutputPath("bench_pipeline_input.ppm");
+    std::string error;
+    lumos::engine::encodePpm(image, lumos::engine::PpmFormat::kBinaryRgb, path.string(), &error);
+    return path;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const int width = lumos::bench::argOrDefault(argc, argv, 1, 2000);
+    const int height = lumos::bench::argOrDefault(argc, argv, 2, 1500);
+    const int iterations = lumos::bench::argOrDefault(argc, argv, 3, 3);
+    const int scale = 4;
+
+    // Frame footprints at the size of a 4x upscaled output.
+    const int out_width = width * scale;
+    const int out_height = height * scale;
+    const std::size_t out_pixels = static_cast<std::size_t>(out_width) * static_cast<std::size_t>(out_height);
+    std::cout << "Frame footprint " << out_width << "x" << out_height << "\n";
+    reportFootprint("legacy Pixel{int r,g,b}", out_pixels * sizeof(LegacyPixel), out_pixels);
+    reportFootprint("Rgb8Image", lumos::engine::Rgb8Image(out_width, out_height).byteSize(), out_pixels);
+    reportFootprint("Rgb16Image", lumos::engine::Rgb16Image(out_width, out_height).byteSize(), out_pixels);
+    reportFootprint(
+        "ImageBuffer<float, 3, planar>",
+        lumos::engine::ImageBuffer<float, 3, lumos::engine::PixelLayout::kPlanar>(out_width, out_height).byteSize(),
+        out_pixels);
+
+    const auto input = writeSyntheticP6(width, height);
+    const double input_megapixels = static_cast<double>(width) * static_cast<double>(height) / 1.0e6;
+    const double output_megabytes = static_cast<double>(out_pixels) * 3.0 / (1024.0 * 1024.0);
+
+    lumos::contracts::EnhancementRequest request {};
+    request.input_path = input.string();
+    request.output_path = lumos::tests::tempOutputPath("bench_pipeline_output.ppm").string();
+    request.scale_factor = scale;
+    request.denoise_enabled = true;
+
+    std::cout << "P6 " << width << "x" << height << " at " << scale << "x with denoise\n";
+    bool ok = true;
+    lumos::engine::CpuStubPipeline one_tile({.tiling = {.tile_size = std::numeric_limits<int>::max(), .threads = 1}});
+    const double one_tile_ms = lumos::bench::bestOfMs(iterations, [&] { ok = one_tile.run(request).ok && ok; });
+    lumos::bench::report("full frame, one tile", one_tile_ms, output_megabytes, input_megapixels);
+
+    lumos::engine::CpuStubPipeline full_frame;
+    const lumos::engine::TileProcessor<std::uint8_t> tiles(out_width, out_height, 3, {});
+    const double full_ms = lumos::bench::bestOfMs(iterations, [&] { ok = full_frame.run(request).ok && ok; });
+    lumos::bench::report(
+        "full frame, " + std::to_string(tiles.grid().columns() * tiles.grid().rows()) + " tiles of " +
+            std::to_string(tiles.grid().column_edges[1]) + "px on " + std::to_string(tiles.threads()) + " threads",
+        full_ms, output_megabytes, input_megapixels);
+
+    // Reruns of an input already decoded by an earlier run.
+    lumos::engine::DecodedImageCache decoded_images;
+    lumos::engine::CpuStubPipeline reusing({.decoded_images = &decoded_images});
+    ok = reusing.run(request).ok && ok;
+    std::uint64_t cached_decode_ns = 0;
+    const double reused_ms = lumos::bench::bestOfMs(iterations, [&] {
+        const auto result = reusing.run(request);
+        ok = result.ok && ok;
+        cached_decode_ns = result.metrics.stages.front().duration_ns;
+    });
+    lumos::bench::report("full frame, decoded input cached", reused_ms, output_megabytes, input_megapixels);
+    std::cout << "  decode " << static_cast<double>(cached_decode_ns) / 1e6 << " ms\n";
+
+    lumos::engine::CpuStubPipeline streaming({.memory_budget_bytes = 0, .band_rows = 64});
+    const double streaming_ms = lumos::bench::bestOfMs(iterations, [&] { ok = streaming.run(request).ok && ok; });
+    lumos::bench::report("streaming (64-row bands)", streaming_ms, output_megabytes, input_megapixels);
+
+    request.sharpen_strength = 0.8f;
+    std::uint64_t sharpen_ns = std::numeric_limits<std::uint64_t>::max();
+    lumos::contracts::EnhancementMetrics sharpened_metrics;
+    const double sharpened_ms = lumos::bench::bestOfMs(iterations, [&] {
+        const auto result = full_frame.run(request);
+        ok = result.ok && ok;
+        for (const auto& stage : result.metrics.stages) {
+            if (stage.name == "sharpen") {
+                sharpen_ns = std::min(sharpen_ns, stage.duration_ns);
+            }
+        }
+        sharpened_metrics = result.metrics;
+    });
+    lumos::bench::report("full frame + sharpen", sharpened_ms, output_megabytes, input_megapixels);
+    std::cout << "  of which sharpen (best) " << static_cast<double>(sharpen_ns) / 1e6 << " ms\n";
+    const auto streamed = streaming.run(request);
+    ok = streamed.ok && ok;
+    for (const auto& [label, metrics] :
+         {std::pair {"full frame", &std::as_const(sharpened_metrics)}, std::pair {"streaming", &streamed.metrics}}) {
+        std::cout << "  " << label << " stages (last run):";
+        for (const auto& stage : metrics->stages) {
+            std::cout << ' ' << stage.name << ' ' << static_cast<double>(stage.duration_ns) / 1e6 << " ms";
+        }
+        std::cout << "; peak buffers " << static_cast<double>(metrics->peak_buffer_bytes) / (1024.0 * 1024.0) << " MiB on "
+                  << metrics->threads << " threads\n";
+    }
+
+    // Time from cancel() half way through each stage to the run returning, worst of the iterations.
+    for (const auto& [label, pipeline, stage] :
+         {std::tuple {"full frame", &full_frame, "decode"}, std::tuple {"full frame", &full_frame, "enhance"},
+          std::tuple {"full frame", &full_frame, "encode"}, std::tuple {"streaming", &streaming, "enhance"}}) {
+        double worst_ms = 0.0;
+        for (int iteration = 0; iteration < iterations; ++iteration) {
+            lumos::contracts::RunControl control;
+            std::chrono::steady_clock::time_point cancelled_at {};
+            control.progress = [&](const std::string_view reported, const double fraction) {
+                if (reported == stage && fraction >= 0.5 && !control.cancelled()) {
+                    control.cancellation.cancel();
+                    cancelled_at = std::chrono::steady_clock::now();
+                }
+            };
+            const auto result = pipeline->run(request, control);
+            ok = result.error.code == lumos::contracts::ErrorCode::kCancelled && ok;
+            worst_ms = std::max(worst_ms, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - cancelled_at).count());
+        }
+        std::cout << "cancel latency, " << label << " in " << stage << " " << std::fixed << std::setprecision(2) << worst_ms << " ms\n";
+    }
+
+    // The same request again through the result cache: one miss to fill it, then hits.
+    const auto cache_directory = lumos::tests::tempOutputPath("bench_result_cache");
+    std::filesystem::remove_all(cache_directory);
+    lumos::app::CachedPipeline cached(full_frame, {.directory = cache_directory});
+    ok = cached.run(request).ok && ok;
+    const double hit_ms = lumos::bench::bestOfMs(iterations, [&] { ok = cached.run(request).metrics.cache_hit && ok; });
+    lumos::bench::report("full frame + sharpen, result cache hit", hit_ms, output_megabytes, input_megapixels);
+    std::cout << "  saved " << static_cast<double>(cached.stats().saved_ns) / 1e6 << " ms over " << cached.stats().hits << " hits\n";
+    std::filesystem::remove_all(cache_directory);
+    return ok ? 0 : 1;
+}
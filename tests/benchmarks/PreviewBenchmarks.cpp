@@ -0,0 +1,124 @@
+#include "app/EnhancementController.h"
+#include "engine/CpuStubPipeline.h"
+#include "engine/ImageBuffer.h"
+#include "engine/PpmCodec.h"
+#include "tests/TestHelpers.h"
+#include "tests/benchmarks/BenchHelpers.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <utility>
+
+namespace {
+
+constexpr int kScreenExtent = 1920;
+// Output pixels a 1920x1080 compare view shows at 200% zoom.
+constexpr int kViewportWidth = 960;
+constexpr int kViewportHeight = 540;
+
+std::filesystem::path writeSyntheticP6(const int width, const int height) {
+    lumos::engine::Rgb8Image pixels(width, height);
+    lumos::bench::SampleNoise noise;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const std::uint32_t bits = noise.next();
+            for (int channel = 0; channel < 3; ++channel) {
+                pixels.at(x, y, channel) = static_cast<std::uint8_t>(bits >> (8 * channel));
+            }
+        }
+    }
+    const lumos::engine::Image image {.max_value = 255, .pixels = std::move(pixels)};
+    const auto path = lumos::tests::tempOutputPath("bench_preview_input.ppm");
+    std::string error;
+    lumos::engine::encodePpm(image, lumos::engine::PpmFormat::kBinaryRgb, path.string(), &error);
+    return path;
+}
+
+void reportStages(const lumos::contracts::EnhancementMetrics& metrics) {
+    std::cout << "  stages:";
+    for (const auto& stage : metrics.stages) {
+        std::cout << ' ' << stage.name << ' ' << static_cast<double>(stage.duration_ns) / 1e6 << " ms";
+    }
+    std::cout << "; " << metrics.input_width << "x" << metrics.input_height << " -> " << metrics.output_width << "x"
+              << metrics.output_height << '\n';
+}
+
+}  // namespace
+
+// Time to the first visible result of a 4x denoise request on a 50MP input: a preview sized for a
+// 1920px screen and the full-resolution viewport of a zoomed compare view, against the cheapest
+// full-resolution run of the same input.
+int main(int argc, char* argv[]) {
+    const int width = lumos::bench::argOrDefault(argc, argv, 1, 8660);
+    const int height = lumos::bench::argOrDefault(argc, argv, 2, 5774);
+    const int iterations = lumos::bench::argOrDefault(argc, argv, 3, 3);
+
+    const auto input = writeSyntheticP6(width, height);
+    const double input_megapixels = static_cast<double>(width) * static_cast<double>(height) / 1.0e6;
+    const double input_megabytes = static_cast<double>(std::filesystem::file_size(input)) / (1024.0 * 1024.0);
+    std::cout << "P6 " << width << "x" << height << " (" << input_megapixels << " MP)\n";
+
+    lumos::contracts::EnhancementRequest request {};
+    request.input_path = input.string();
+    request.output_path = lumos::tests::tempOutputPath("bench_preview_output.ppm").string();
+    request.scale_factor = 4;
+    request.denoise_enabled = true;
+    const auto preview = lumos::app::previewRequestFor(request, kScreenExtent);
+
+    lumos::engine::CpuStubPipeline pipeline;
+    bool ok = true;
+    lumos::contracts::EnhancementMetrics preview_metrics;
+    const double preview_ms = lumos::bench::bestOfMs(iterations, [&] {
+        const auto result = pipeline.run(preview);
+        ok = result.ok && ok;
+        preview_metrics = result.metrics;
+    });
+    lumos::bench::report(
+        "preview at 4x for " + std::to_string(kScreenExtent) + "px, step " +
+            std::to_string(lumos::contracts::previewStep(width, height, preview)),
+        preview_ms, input_megabytes, input_megapixels);
+    reportStages(preview_metrics);
+
+    const lumos::contracts::ImageRegion centre {
+        .x = (lumos::contracts::scaledExtent(width, request) - kViewportWidth) / 2,
+        .y = (lumos::contracts::scaledExtent(height, request) - kViewportHeight) / 2,
+        .width = kViewportWidth,
+        .height = kViewportHeight,
+    };
+    const auto viewport = lumos::app::viewportRequestFor(request, centre);
+    lumos::contracts::EnhancementMetrics viewport_metrics;
+    const double viewport_ms = lumos::bench::bestOfMs(iterations, [&] {
+        const auto result = pipeline.run(viewport);
+        ok = result.ok && ok;
+        viewport_metrics = result.metrics;
+    });
+    lumos::bench::report(
+        "viewport at 4x, " + std::to_string(kViewportWidth) + "x" + std::to_string(kViewportHeight) + " at the centre",
+        viewport_ms, input_megabytes, input_megapixels);
+    reportStages(viewport_metrics);
+
+    // Every full-resolution run decodes and denoises the whole frame; at 1x it stops there.
+    request.scale_factor = 1;
+    lumos::contracts::EnhancementMetrics full_metrics;
+    const double full_ms = lumos::bench::bestOfMs(iterations, [&] {
+        const auto result = pipeline.run(request);
+        ok = result.ok && ok;
+        full_metrics = result.metrics;
+    });
+    lumos::bench::report("full resolution at 1x (lower bound)", full_ms, input_megabytes, input_megapixels);
+    reportStages(full_metrics);
+    std::cout << "first feedback " << full_ms / preview_ms << "x sooner; viewport " << full_ms / viewport_ms << "x sooner\n";
+
+    std::error_code error;
+    std::filesystem::remove(input, error);
+    std::filesystem::remove(preview.output_path, error);
+    std::filesystem::remove(viewport.output_path, error);
+    std::filesystem::remove(request.output_path, error);
+    if (!ok) {
+        std::cerr << "a preview benchmark run failed\n";
+        return 1;
+    }
+    return 0;
+}
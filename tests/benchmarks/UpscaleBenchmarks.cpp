@@ -0,0 +1,100 @@
+#include "engine/ImageBuffer.h"
+#include "engine/KernelRegistry.h"
+#include "engine/Resample.h"
+#include "engine/Upscale.h"
+#include "tests/benchmarks/BenchHelpers.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <utility>
+
+namespace {
+
+// The per-output-pixel divide and copy that shipped before the row-replicating kernel.
+template <typename Buffer>
+void legacyUpscale(const Buffer& input, const int scale_factor, Buffer& output) {
+    const auto step = static_cast<std::size_t>(Buffer::kSamplesPerPixel);
+    for (int y = 0; y < output.height(); ++y) {
+        const auto* source_row = input.row(y / scale_factor);
+        auto* output_row = output.row(y);
+        for (int x = 0; x < output.width(); ++x) {
+            const auto* pixel = source_row + static_cast<std::size_t>(x / scale_factor) * step;
+            std::copy(pixel, pixel + step, output_row + static_cast<std::size_t>(x) * step);
+        }
+    }
+}
+
+template <typename Buffer>
+void runFactor(const std::string& label, const Buffer& input, const int scale_factor, const int iterations) {
+    Buffer output(input.width() * scale_factor, input.height() * scale_factor);
+    const double output_pixels = static_cast<double>(output.width()) * static_cast<double>(output.height());
+    const double megabytes = output_pixels * Buffer::kChannels * sizeof(typename Buffer::Sample) / (1024.0 * 1024.0);
+    const double megapixels = output_pixels / 1.0e6;
+
+    const double legacy_ms = lumos::bench::bestOfMs(iterations, [&] { legacyUpscale(input, scale_factor, output); });
+    lumos::bench::report(label + " " + std::to_string(scale_factor) + "x per-pixel", legacy_ms, megabytes, megapixels);
+    const double row_ms = lumos::bench::bestOfMs(
+        iterations, [&] { lumos::engine::upscaleNearestNeighbor(input.view(), scale_factor, output.mutableView()); });
+    lumos::bench::report(label + " " + std::to_string(scale_factor) + "x row-replicating", row_ms, megabytes, megapixels);
+}
+
+template <typename Buffer>
+void runFilter(
+    const std::string& label,
+    const Buffer& input,
+    const lumos::contracts::ResampleFilter filter,
+    const int numerator,
+    const int denominator,
+    const int iterations) {
+    Buffer output(input.width() * numerator / denominator, input.height() * numerator / denominator);
+    const double output_pixels = static_cast<double>(output.width()) * static_cast<double>(output.height());
+    const double megabytes = output_pixels * Buffer::kChannels * sizeof(typename Buffer::Sample) / (1024.0 * 1024.0);
+    const double ms = lumos::bench::bestOfMs(iterations, [&] {
+        lumos::engine::resample(input.view(), filter, typename Buffer::Sample {255}, output.mutableView());
+    });
+    lumos::bench::report(
+        label + " " + std::to_string(numerator) + "/" + std::to_string(denominator) + " " +
+            std::string(lumos::contracts::toString(filter)),
+        ms, megabytes, output_pixels / 1.0e6);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const int width = lumos::bench::argOrDefault(argc, argv, 1, 1000);
+    const int height = lumos::bench::argOrDefault(argc, argv, 2, 750);
+    const int iterations = lumos::bench::argOrDefault(argc, argv, 3, 3);
+
+    lumos::engine::Rgb8Image rgb(width, height);
+    lumos::engine::Gray8Image gray(width, height);
+    lumos::bench::SampleNoise noise;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const std::uint32_t bits = noise.next();
+            for (int channel = 0; channel < 3; ++channel) {
+                rgb.at(x, y, channel) = static_cast<std::uint8_t>(bits >> (8 * channel));
+            }
+            gray.at(x, y, 0) = static_cast<std::uint8_t>(bits >> 24);
+        }
+    }
+
+    std::cout << "Nearest-neighbour upscale of " << width << "x" << height << " (MB/s and MP/s of output, "
+              << lumos::engine::cpuIsaName(lumos::engine::activeKernels().isa) << " kernels)\n";
+    for (const int scale_factor : {2, 4, 8}) {
+        runFactor("rgb8", rgb, scale_factor, iterations);
+        runFactor("gray8", gray, scale_factor, iterations);
+    }
+
+    std::cout << "Separable resampling (MB/s and MP/s of output)\n";
+    for (const auto filter : {lumos::contracts::ResampleFilter::kBilinear, lumos::contracts::ResampleFilter::kBicubic,
+                              lumos::contracts::ResampleFilter::kLanczos3}) {
+        for (const auto& [numerator, denominator] : {std::pair {2, 1}, std::pair {4, 1}, std::pair {3, 2}}) {
+            runFilter("rgb8", rgb, filter, numerator, denominator, iterations);
+        }
+        runFilter("gray8", gray, filter, 2, 1, iterations);
+    }
+
+    return 0;
+}
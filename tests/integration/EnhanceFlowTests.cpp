@@ -3,13 +3,33 @@
 #include "engine/CpuStubPipeline.h"
 #include "tests/TestHelpers.h"
 
+#include <algorithm>
 #include <chrono>
 #include <exception>
+#include <filesystem>
 #include <future>
 #include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 
 namespace {
 
+// Runs previews through the CPU pipeline and throws on every full-resolution run.
+class ThrowingFullRunPipeline final : public lumos::contracts::IEnhancementPipeline {
+  public:
+    lumos::contracts::EnhancementResult run(const lumos::contracts::EnhancementRequest& request) override {
+        if (request.preview_max_extent > 0) {
+            return inner_.run(request);
+        }
+        throw std::runtime_error("full run failed");
+    }
+
+  private:
+    lumos::engine::CpuStubPipeline inner_;
+};
+
 void testEndToEndEnhancementAsyncFlow() {
     const auto log_path = lumos::tests::tempOutputPath("enhance_flow_events.jsonl");
     lumos::common::Telemetry telemetry(log_path);
@@ -40,11 +60,111 @@ void testEndToEndEnhancementAsyncFlow() {
     lumos::tests::requireFileSizePositive(log_path, "telemetry output should exist and be non-empty");
 }
 
+void testProgressiveRunPreviewsFirst() {
+    const auto log_path = lumos::tests::tempOutputPath("enhance_flow_progressive_events.jsonl");
+    std::filesystem::remove(log_path);
+    lumos::common::Telemetry telemetry(log_path);
+    lumos::engine::CpuStubPipeline pipeline;
+    lumos::app::EnhancementController controller(pipeline, telemetry);
+
+    std::string text = "P3\n40 30\n255\n";
+    for (int index = 0; index < 40 * 30 * 3; ++index) {
+        text += std::to_string(index * 7 % 256) + "\n";
+    }
+    lumos::contracts::EnhancementRequest request;
+    request.input_path = lumos::tests::writeTempFile("enhance_flow_progressive.ppm", text).string();
+    request.output_path = lumos::tests::tempOutputPath("enhance_flow_progressive_out.ppm").string();
+    request.scale_factor = 2;
+    request.denoise_enabled = true;
+
+    // A file that happens to have the old preview name next to the output is left alone.
+    const auto bystander = lumos::tests::writeTempFile("enhance_flow_progressive_out.preview.ppm", "not a preview");
+    auto run = controller.runProgressiveAsync(request, 20);
+    const auto preview = run.preview.get();
+    lumos::tests::require(preview.ok, "the preview should succeed");
+    lumos::tests::require(
+        std::filesystem::path(preview.output_path).parent_path() == std::filesystem::temp_directory_path() / "lumos_previews",
+        "the preview should be written under the temporary directory");
+    // 80x60 at full resolution needs step 4: a 10x8 proxy upscaled to 20x16.
+    lumos::tests::require(preview.metrics.output_width == 20 && preview.metrics.output_height == 16, "the preview should fit");
+
+    const auto full = run.full.get();
+    lumos::tests::require(full.ok && full.metrics.output_width == 80 && full.metrics.output_height == 60, "full run size");
+    lumos::tests::requireFileSizePositive(request.output_path, "the full-resolution output should exist");
+    lumos::tests::require(!std::filesystem::exists(preview.output_path), "the full result should replace the preview file");
+    lumos::tests::require(
+        lumos::tests::readFileBytes(bystander) == "not a preview", "a file beside the output should not be touched by the preview");
+
+    // Each run's events carry its mode; fields are written in key order, so match whole lines.
+    std::size_t full_completed = 0;
+    std::size_t preview_completed = 0;
+    std::istringstream events(lumos::tests::readFileBytes(log_path));
+    for (std::string line; std::getline(events, line);) {
+        if (line.find("\"event\":\"enhance_completed\"") != std::string::npos) {
+            full_completed += line.find("\"mode\":\"full\"") != std::string::npos ? 1 : 0;
+            preview_completed += line.find("\"mode\":\"preview\"") != std::string::npos ? 1 : 0;
+        }
+    }
+    lumos::tests::require(
+        full_completed == 1 && preview_completed == 1, "the preview's events should be told apart from the full run's");
+
+    // A full run cancelled once the preview is written removes the preview as well.
+    lumos::contracts::RunControl control;
+    bool preview_encoded = false;
+    control.progress = [&control, &preview_encoded](const std::string_view stage, double) {
+        if (stage == "encode") {
+            preview_encoded = true;
+        } else if (preview_encoded) {
+            control.cancellation.cancel();
+        }
+    };
+    auto cancelled = controller.runProgressiveAsync(request, 20, control);
+    const auto cancelled_preview = cancelled.preview.get();
+    lumos::tests::require(cancelled_preview.ok && !cancelled.full.get().ok, "only the full run should be cancelled");
+    lumos::tests::require(!std::filesystem::exists(cancelled_preview.output_path), "a cancelled run should leave no preview file");
+
+    // A preview that would already be full resolution is not run apart: both futures get the full result.
+    const auto before = std::ranges::count(lumos::tests::readFileBytes(log_path), '\n');
+    auto small = controller.runProgressiveAsync(request, 200);
+    const auto small_preview = small.preview.get();
+    const auto small_full = small.full.get();
+    lumos::tests::require(
+        small_preview.ok && small_full.ok && small_preview.output_path == request.output_path &&
+            small_preview.metrics.output_width == 80,
+        "a step-1 preview should be the full result");
+    const auto after = std::ranges::count(lumos::tests::readFileBytes(log_path), '\n');
+    lumos::tests::require(after - before == 3, "a step-1 progressive run should emit the events of one run");
+
+    // A full run that throws still removes the preview, and the exception reaches the full future.
+    ThrowingFullRunPipeline throwing;
+    lumos::app::EnhancementController throwing_controller(throwing, telemetry);
+    auto thrown = throwing_controller.runProgressiveAsync(request, 20);
+    const auto thrown_preview = thrown.preview.get();
+    lumos::tests::require(thrown_preview.ok, "the preview before a throwing full run should succeed");
+    bool rethrown = false;
+    try {
+        static_cast<void>(thrown.full.get());
+    } catch (const std::runtime_error&) {
+        rethrown = true;
+    }
+    lumos::tests::require(rethrown, "the full run's exception should reach its future");
+    lumos::tests::require(!std::filesystem::exists(thrown_preview.output_path), "a throwing run should leave no preview file");
+
+    // A zoomed viewport runs at full resolution over its own rectangle only.
+    const auto viewport = controller.runEnhancementAsync(lumos::app::viewportRequestFor(request, {8, 6, 24, 18})).get();
+    lumos::tests::require(
+        viewport.ok && viewport.metrics.output_width == 24 && viewport.metrics.output_height == 18, "viewport run size");
+    lumos::tests::require(
+        viewport.output_path == lumos::tests::tempOutputPath("enhance_flow_progressive_out.viewport.ppm").string(),
+        "the viewport should be written next to the output");
+}
+
 }  // namespace
 
 int main() {
     try {
         testEndToEndEnhancementAsyncFlow();
+        testProgressiveRunPreviewsFirst();
         std::cout << "EnhanceFlowTests passed\n";
         return 0;
     } catch (const std::exception& ex) {
@@ -0,0 +1,125 @@
+#include "engine/BatchExecutor.h"
+#include "engine/CpuStubPipeline.h"
+#include "tests/TestHelpers.h"
+
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+std::filesystem::path writeNoiseP6(const std::string& name, const int width, const int height, std::uint32_t seed) {
+    std::string text = "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+    for (int index = 0; index < width * height * 3; ++index) {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        text.push_back(static_cast<char>(seed % 256));
+    }
+    return lumos::tests::writeTempFile(name, text);
+}
+
+std::vector<lumos::contracts::EnhancementRequest> makeBatch(const int count) {
+    std::vector<lumos::contracts::EnhancementRequest> requests;
+    for (int index = 0; index < count; ++index) {
+        lumos::contracts::EnhancementRequest request;
+        // Every fifth image is large enough to go over the budget below and stream.
+        const bool large = index % 5 == 4;
+        request.input_path = writeNoiseP6(
+                                 "batch_input_" + std::to_string(index) + ".ppm", large ? 300 : 20 + 7 * index, large ? 60 : 15 + index,
+                                 2463534242u + static_cast<std::uint32_t>(index))
+                                 .string();
+        request.output_path = lumos::tests::tempOutputPath("batch_output_" + std::to_string(index) + ".ppm").string();
+        request.scale_factor = 2 + index % 2;
+        request.filter = index % 3 == 0 ? lumos::contracts::ResampleFilter::kBicubic : lumos::contracts::ResampleFilter::kNearest;
+        request.denoise_enabled = index % 2 == 0;
+        request.sharpen_strength = index % 4 == 1 ? 0.8f : 0.0f;
+        requests.push_back(request);
+    }
+    requests[3].input_path = lumos::tests::tempOutputPath("batch_missing_input.ppm").string();
+    requests[6].scale_factor = 0;
+    return requests;
+}
+
+const lumos::engine::PipelineOptions kOptions {.memory_budget_bytes = 100000, .band_rows = 8, .tiling = {.tile_size = 32, .overlap = 8}};
+
+void testBatchMatchesSingleRuns() {
+    const lumos::engine::CpuStubPipeline pipeline(kOptions);
+    const auto requests = makeBatch(12);
+    for (const std::size_t index : {std::size_t {4}, std::size_t {5}}) {
+        lumos::engine::PipelineFrame frame;
+        lumos::tests::require(pipeline.decode(requests[index], {}, &frame), "decode should succeed");
+        lumos::tests::require(frame.plan.streamed == (index == 4), "large requests should stream and small ones not");
+    }
+    std::vector<lumos::contracts::EnhancementResult> expected;
+    std::vector<std::string> expected_bytes;
+    for (auto request : requests) {
+        request.output_path += ".single";
+        expected.push_back(lumos::engine::CpuStubPipeline(kOptions).run(request));
+        expected_bytes.push_back(expected.back().ok ? lumos::tests::readFileBytes(request.output_path) : std::string {});
+    }
+
+    for (const int depth : {1, 3}) {
+        const auto report = lumos::engine::BatchExecutor(pipeline, {.queue_depth = depth}).run(requests);
+        const std::string label = "depth " + std::to_string(depth);
+        lumos::tests::require(report.results.size() == requests.size(), label + " should return a result per request");
+        for (std::size_t index = 0; index < requests.size(); ++index) {
+            const auto& result = report.results[index];
+            const std::string request_label = label + " request " + std::to_string(index);
+            lumos::tests::require(result.ok == expected[index].ok, request_label + " should succeed exactly when a single run does");
+            lumos::tests::require(result.error.code == expected[index].error.code, request_label + " should fail the same way");
+            if (result.ok) {
+                lumos::tests::require(
+                    result.metrics.output_width == expected[index].metrics.output_width &&
+                        result.metrics.output_height == expected[index].metrics.output_height,
+                    request_label + " metrics");
+                lumos::tests::require(
+                    lumos::tests::readFileBytes(requests[index].output_path) == expected_bytes[index],
+                    request_label + " output should match a single run");
+            }
+        }
+        // The large requests stream and never hold a frame.
+        lumos::tests::require(report.peak_frames >= 1 && report.peak_frames <= 3 + 2 * depth, label + " should hold at most 3 + 2 * depth frames");
+        for (const auto* stage : {&report.decode, &report.enhance, &report.encode}) {
+            lumos::tests::require(stage->busy.count() > 0 && stage->busy <= report.wall, label + " stages should report busy time");
+            lumos::tests::require(stage->busyFraction(report.wall) <= 1.0, label + " busy fraction");
+        }
+    }
+}
+
+void testCancellationStopsTheBatch() {
+    const lumos::engine::CpuStubPipeline pipeline(kOptions);
+    const auto requests = makeBatch(10);
+    lumos::contracts::RunControl control;
+    std::vector<double> reported;
+    control.progress = [&](const std::string_view stage, const double fraction) {
+        lumos::tests::require(stage == "batch", "only the batch should report progress");
+        reported.push_back(fraction);
+        if (reported.size() == 2) {
+            control.cancellation.cancel();
+        }
+    };
+    const auto report = lumos::engine::BatchExecutor(pipeline).run(requests, control);
+    lumos::tests::require(report.results[0].ok, "requests finished before the cancel should succeed");
+    lumos::tests::require(
+        report.results.back().error.code == lumos::contracts::ErrorCode::kCancelled, "requests after the cancel should be cancelled");
+    lumos::tests::require(reported.size() == requests.size() && reported.back() == 1.0, "every request should be reported");
+}
+
+}  // namespace
+
+int main() {
+    try {
+        testBatchMatchesSingleRuns();
+        testCancellationStopsTheBatch();
+        std::cout << "BatchExecutorTests passed\n";
+        return 0;
+    } catch (const std::exception& ex) {
+        std::cerr << "BatchExecutorTests failed: " << ex.what() << '\n';
+        return 1;
+    }
+}
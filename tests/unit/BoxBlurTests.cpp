@@ -0,0 +1,170 @@
+#include "engine/BoxBlur.h"
+#include "engine/ImageBuffer.h"
+#include "tests/TestHelpers.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <utility>
+
+namespace {
+
+using lumos::tests::makeNoise;
+using lumos::tests::samePixels;
+
+// The 3x3 gather the pipeline shipped before the sliding-window blur.
+template <typename Buffer>
+Buffer legacyBlur(const Buffer& input) {
+    Buffer output = input;
+    const int width = input.width();
+    const int height = input.height();
+    if (width <= 2 || height <= 2) {
+        return output;
+    }
+    for (int y = 1; y < height - 1; ++y) {
+        for (int x = 1; x < width - 1; ++x) {
+            for (int channel = 0; channel < Buffer::kChannels; ++channel) {
+                std::uint32_t sum = 0;
+                for (int dy = -1; dy <= 1; ++dy) {
+                    for (int dx = -1; dx <= 1; ++dx) {
+                        sum += input.at(x + dx, y + dy, channel);
+                    }
+                }
+                output.at(x, y, channel) = static_cast<typename Buffer::Sample>(sum / 9);
+            }
+        }
+    }
+    return output;
+}
+
+int referenceIndex(const int index, const int size, const lumos::engine::BorderMode border) {
+    if (border != lumos::engine::BorderMode::kMirror) {
+        return std::clamp(index, 0, size - 1);
+    }
+    int mirrored = index;
+    while (mirrored < 0 || mirrored >= size) {
+        mirrored = mirrored < 0 ? -mirrored : 2 * (size - 1) - mirrored;
+    }
+    return mirrored;
+}
+
+template <typename Buffer>
+Buffer referenceBlur(const Buffer& input, const int radius, const lumos::engine::BorderMode border) {
+    Buffer output = input;
+    const int width = input.width();
+    const int height = input.height();
+    const bool untouched = border == lumos::engine::BorderMode::kUntouched;
+    const std::uint32_t area = static_cast<std::uint32_t>((2 * radius + 1) * (2 * radius + 1));
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            if (untouched && (x < radius || y < radius || x >= width - radius || y >= height - radius)) {
+                continue;
+            }
+            for (int channel = 0; channel < Buffer::kChannels; ++channel) {
+                std::uint32_t sum = 0;
+                for (int dy = -radius; dy <= radius; ++dy) {
+                    for (int dx = -radius; dx <= radius; ++dx) {
+                        sum += input.at(referenceIndex(x + dx, width, border), referenceIndex(y + dy, height, border), channel);
+                    }
+                }
+                output.at(x, y, channel) = static_cast<typename Buffer::Sample>(sum / area);
+            }
+        }
+    }
+    return output;
+}
+
+template <typename Buffer>
+Buffer blurred(const Buffer& input, const lumos::engine::BoxBlurOptions& options) {
+    Buffer output(input.width(), input.height());
+    lumos::engine::boxBlur(input.view(), options, output.mutableView());
+    return output;
+}
+
+template <typename Buffer>
+void requireMatchesLegacyAtRadiusOne(const std::string& label) {
+    for (const auto& [width, height] : {std::pair {37, 23}, std::pair {3, 3}, std::pair {2, 9}, std::pair {1, 1}}) {
+        const Buffer input = makeNoise<Buffer>(width, height, 0x1234567u + static_cast<std::uint32_t>(width));
+        lumos::tests::require(
+            samePixels(blurred(input, {}), legacyBlur(input)),
+            label + " radius 1 should be bit-exact with the 3x3 blur at " + std::to_string(width) + "x" + std::to_string(height));
+    }
+}
+
+void testRadiusOneMatchesLegacyBlur() {
+    requireMatchesLegacyAtRadiusOne<lumos::engine::Rgb8Image>("rgb8");
+    requireMatchesLegacyAtRadiusOne<lumos::engine::Gray8Image>("gray8");
+    requireMatchesLegacyAtRadiusOne<lumos::engine::Rgb16Image>("rgb16");
+}
+
+void testRadiiAndBordersMatchReference() {
+    const auto rgb8 = makeNoise<lumos::engine::Rgb8Image>(29, 17, 0xBEEFu);
+    const auto gray16 = makeNoise<lumos::engine::Gray16Image>(13, 31, 0xCAFEu);
+    for (const auto border :
+         {lumos::engine::BorderMode::kUntouched, lumos::engine::BorderMode::kClamp, lumos::engine::BorderMode::kMirror}) {
+        for (const int radius : {0, 1, 2, 5, 20}) {
+            const lumos::engine::BoxBlurOptions options {.radius = radius, .border = border};
+            const std::string label = "radius " + std::to_string(radius) + " border " + std::to_string(static_cast<int>(border));
+            lumos::tests::require(samePixels(blurred(rgb8, options), referenceBlur(rgb8, radius, border)), "rgb8 " + label);
+            lumos::tests::require(samePixels(blurred(gray16, options), referenceBlur(gray16, radius, border)), "gray16 " + label);
+        }
+    }
+}
+
+void testLargeRadiusDivisionIsExact() {
+    lumos::engine::Gray8Image flat(140, 140);
+    lumos::engine::Gray16Image flat16(140, 140);
+    for (int y = 0; y < 140; ++y) {
+        for (int x = 0; x < 140; ++x) {
+            flat.at(x, y, 0) = 255;
+            flat16.at(x, y, 0) = 65535;
+        }
+    }
+    const lumos::engine::BoxBlurOptions options {.radius = lumos::engine::kMaxBoxBlurRadius, .border = lumos::engine::BorderMode::kMirror};
+    lumos::tests::require(samePixels(blurred(flat, options), flat), "flat 8-bit image should stay flat at max radius");
+    lumos::tests::require(samePixels(blurred(flat16, options), flat16), "flat 16-bit image should stay flat at max radius");
+}
+
+void testRowRangesMatchWholeImage() {
+    const auto input = makeNoise<lumos::engine::Rgb8Image>(21, 19, 0xF00Du);
+    for (const auto border : {lumos::engine::BorderMode::kUntouched, lumos::engine::BorderMode::kMirror}) {
+        const lumos::engine::BoxBlurOptions options {.radius = 3, .border = border};
+        const auto whole = blurred(input, options);
+        for (int first_row = 0; first_row < input.height(); first_row += 4) {
+            const int last_row = std::min(input.height(), first_row + 4);
+            const int window_first = std::max(0, first_row - 3);
+            const int window_last = std::min(input.height(), last_row + 3);
+            lumos::engine::Rgb8Image band(input.width(), last_row - first_row);
+            lumos::engine::boxBlurRows(
+                input.view().rows(window_first, window_last - window_first), window_first, input.height(), first_row,
+                last_row, options, band.mutableView());
+            for (int y = first_row; y < last_row; ++y) {
+                for (int x = 0; x < input.width(); ++x) {
+                    for (int channel = 0; channel < 3; ++channel) {
+                        lumos::tests::require(
+                            band.at(x, y - first_row, channel) == whole.at(x, y, channel),
+                            "band blur should match whole-image blur at row " + std::to_string(y));
+                    }
+                }
+            }
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    try {
+        testRadiusOneMatchesLegacyBlur();
+        testRadiiAndBordersMatchReference();
+        testLargeRadiusDivisionIsExact();
+        testRowRangesMatchWholeImage();
+        std::cout << "BoxBlurTests passed\n";
+        return 0;
+    } catch (const std::exception& ex) {
+        std::cerr << "BoxBlurTests failed: " << ex.what() << '\n';
+        return 1;
+    }
+}
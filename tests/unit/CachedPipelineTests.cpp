@@ -0,0 +1,213 @@
+#include "app/CachedPipeline.h"
+#include "common/Hash.h"
+#include "engine/CpuStubPipeline.h"
+#include "tests/TestHelpers.h"
+
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace {
+
+// Counts the runs that reach the engine.
+class CountingPipeline final : public lumos::contracts::IEnhancementPipeline {
+  public:
+    lumos::contracts::EnhancementResult run(const lumos::contracts::EnhancementRequest& request) override {
+        ++runs;
+        return engine_.run(request);
+    }
+
+    int runs {0};
+
+  private:
+    lumos::engine::CpuStubPipeline engine_;
+};
+
+std::filesystem::path freshCacheDirectory(const std::string& name) {
+    const auto directory = lumos::tests::tempOutputPath(name);
+    std::filesystem::remove_all(directory);
+    return directory;
+}
+
+std::string writeInput(const std::string& name, const int seed) {
+    std::string text = "P3\n12 9\n255\n";
+    for (int index = 0; index < 12 * 9 * 3; ++index) {
+        text += std::to_string((index * 53 + seed * 17) % 256) + "\n";
+    }
+    return lumos::tests::writeTempFile(name, text).string();
+}
+
+lumos::contracts::EnhancementRequest makeRequest(const std::string& input, const std::string& output) {
+    lumos::contracts::EnhancementRequest request;
+    request.input_path = input;
+    request.output_path = lumos::tests::tempOutputPath(output).string();
+    request.denoise_enabled = true;
+    return request;
+}
+
+void testHashAndCanonicalSettings() {
+    lumos::tests::require(lumos::common::hash64("") == 0xEF46DB3751D8E999ULL, "empty input should match the XXH64 reference");
+    lumos::tests::require(lumos::common::hash64("abc") == 0x44BC2CF5AD770999ULL, "short input should match the XXH64 reference");
+    const std::string long_text(1000, 'x');
+    lumos::tests::require(
+        lumos::common::hash64(long_text) != lumos::common::hash64(long_text, 1), "the seed should change the hash");
+
+    auto request = makeRequest("a.ppm", "a_out.ppm");
+    auto other = makeRequest("b.ppm", "b_out.ppm");
+    request.scale_factor = 4;
+    request.scale_denominator = 2;
+    other.denoise_strength = 0.9f;
+    using lumos::app::canonicalSettings;
+    lumos::tests::require(
+        canonicalSettings(request) == canonicalSettings(other),
+        "paths, an unreduced scale and the box preset's unused strength should not change the settings");
+    other.preset_name = std::string(lumos::contracts::kEdgePreservingPreset);
+    lumos::tests::require(canonicalSettings(request) != canonicalSettings(other), "the guided strength should count");
+    other = request;
+    other.sharpen_strength = 0.5f;
+    lumos::tests::require(canonicalSettings(request) != canonicalSettings(other), "sharpening should count");
+    other = request;
+    other.region = {.x = 8, .y = 4, .width = 32, .height = 16};
+    lumos::tests::require(canonicalSettings(request) != canonicalSettings(other), "a region should count");
+}
+
+void testRepeatedRequestsHitTheCache() {
+    const auto directory = freshCacheDirectory("result_cache_hits");
+    const std::string input = writeInput("result_cache_input.ppm", 1);
+    CountingPipeline engine;
+    lumos::app::CachedPipeline cached(engine, {.directory = directory});
+
+    const auto first = cached.run(makeRequest(input, "result_cache_first.ppm"));
+    lumos::tests::require(first.ok && !first.metrics.cache_hit && engine.runs == 1, "the first run should miss");
+    const std::string expected = lumos::tests::readFileBytes(first.output_path);
+
+    auto request = makeRequest(input, "result_cache_second.ppm");
+    const auto second = cached.run(request);
+    lumos::tests::require(second.ok && second.metrics.cache_hit && engine.runs == 1, "a repeated request should hit");
+    lumos::tests::require(lumos::tests::readFileBytes(second.output_path) == expected, "a hit should give the same bytes");
+    lumos::tests::require(
+        second.metrics.output_width == first.metrics.output_width && second.metrics.output_height == first.metrics.output_height,
+        "a hit should report the cached result's dimensions");
+
+    request.sharpen_strength = 0.7f;
+    lumos::tests::require(cached.run(request).ok && engine.runs == 2, "other settings should miss");
+    lumos::tests::require(
+        lumos::tests::readFileBytes(first.output_path) == expected,
+        "rewriting an output linked to the cache should leave the cached result intact");
+    writeInput("result_cache_input.ppm", 2);
+    lumos::tests::require(cached.run(makeRequest(input, "result_cache_third.ppm")).ok && engine.runs == 3, "new input bytes should miss");
+
+    const auto stats = cached.stats();
+    lumos::tests::require(stats.hits == 1 && stats.misses == 3 && stats.entries == 3, "hits, misses and entries should be counted");
+
+    // A new cache over the same directory picks up the stored results.
+    writeInput("result_cache_input.ppm", 1);
+    lumos::app::CachedPipeline reopened(engine, {.directory = directory});
+    const auto reused = reopened.run(makeRequest(input, "result_cache_fourth.ppm"));
+    lumos::tests::require(reused.ok && reused.metrics.cache_hit && engine.runs == 3, "entries should survive a restart");
+    lumos::tests::require(lumos::tests::readFileBytes(reused.output_path) == expected, "a reloaded entry should give the same bytes");
+}
+
+void testLeastRecentlyUsedEviction() {
+    const auto directory = freshCacheDirectory("result_cache_eviction");
+    const std::string inputs[] = {
+        writeInput("result_cache_lru_0.ppm", 10), writeInput("result_cache_lru_1.ppm", 11), writeInput("result_cache_lru_2.ppm", 12)};
+    CountingPipeline engine;
+    lumos::app::CachedPipeline probe(engine, {.directory = freshCacheDirectory("result_cache_probe")});
+    const auto output_bytes = probe.run(makeRequest(inputs[0], "result_cache_lru_probe.ppm")).metrics.bytes_written;
+
+    // Room for two outputs, which differ by a few bytes in ASCII, but not three.
+    const std::uint64_t cap = 2 * output_bytes + output_bytes / 2;
+    lumos::app::CachedPipeline cached(engine, {.directory = directory, .max_bytes = cap});
+    engine.runs = 0;
+    cached.run(makeRequest(inputs[0], "result_cache_lru_out.ppm"));
+    cached.run(makeRequest(inputs[1], "result_cache_lru_out.ppm"));
+    lumos::tests::require(cached.run(makeRequest(inputs[0], "result_cache_lru_out.ppm")).metrics.cache_hit, "entry 0 should hit");
+    cached.run(makeRequest(inputs[2], "result_cache_lru_out.ppm"));
+    lumos::tests::require(engine.runs == 3 && cached.stats().evictions == 1, "the third entry should evict one");
+    lumos::tests::require(cached.stats().bytes <= cap, "the cache should stay within its cap");
+    lumos::tests::require(cached.run(makeRequest(inputs[0], "result_cache_lru_out.ppm")).metrics.cache_hit, "recently used stays");
+    lumos::tests::require(
+        !cached.run(makeRequest(inputs[1], "result_cache_lru_out.ppm")).metrics.cache_hit, "the least recently used goes");
+}
+
+void testDamagedEntriesAreDropped() {
+    const auto directory = freshCacheDirectory("result_cache_damaged");
+    const std::string input = writeInput("result_cache_damaged_input.ppm", 5);
+    CountingPipeline engine;
+    {
+        lumos::app::CachedPipeline cached(engine, {.directory = directory});
+        cached.run(makeRequest(input, "result_cache_damaged_out.ppm"));
+    }
+    for (const auto& file : std::filesystem::directory_iterator(directory)) {
+        if (file.path().extension() == ".ppm") {
+            std::filesystem::resize_file(file.path(), 10);
+        }
+    }
+    lumos::app::CachedPipeline reopened(engine, {.directory = directory});
+    lumos::tests::require(reopened.stats().entries == 0, "a truncated entry should be dropped on load");
+    const auto result = reopened.run(makeRequest(input, "result_cache_damaged_out.ppm"));
+    lumos::tests::require(result.ok && !result.metrics.cache_hit && engine.runs == 2, "a dropped entry should be recomputed");
+    const std::string expected = lumos::tests::readFileBytes(result.output_path);
+
+    // Writing over a served output in place must not reach the entry it was served from.
+    const auto served = reopened.run(makeRequest(input, "result_cache_damaged_out.ppm"));
+    lumos::tests::require(served.ok && served.metrics.cache_hit, "the recomputed entry should hit");
+    std::ofstream(served.output_path, std::ios::binary | std::ios::trunc) << std::string(expected.size(), 'x');
+    const auto again = reopened.run(makeRequest(input, "result_cache_damaged_again.ppm"));
+    lumos::tests::require(
+        again.metrics.cache_hit && lumos::tests::readFileBytes(again.output_path) == expected,
+        "an output written in place should leave the cached result intact");
+
+    // An entry damaged without changing its size is caught by its hash and recomputed.
+    for (const auto& file : std::filesystem::directory_iterator(directory)) {
+        if (file.path().extension() == ".ppm") {
+            std::fstream entry(file.path(), std::ios::binary | std::ios::in | std::ios::out);
+            entry.seekg(-2, std::ios::end);
+            const char digit = static_cast<char>(entry.get());
+            entry.seekp(-2, std::ios::end);
+            entry.put(digit == '9' ? '8' : '9');
+        }
+    }
+    const auto damaged = reopened.run(makeRequest(input, "result_cache_damaged_out.ppm"));
+    lumos::tests::require(damaged.ok && !damaged.metrics.cache_hit && engine.runs == 3, "a damaged entry should not be served");
+    lumos::tests::require(lumos::tests::readFileBytes(damaged.output_path) == expected, "the recomputed output should be right");
+}
+
+void testFailedRunsKeepTheOldOutput() {
+    const auto directory = freshCacheDirectory("result_cache_failed");
+    CountingPipeline engine;
+    lumos::app::CachedPipeline cached(engine, {.directory = directory});
+    const auto input = lumos::tests::writeTempFile("result_cache_failed_input.ppm", "P3\n12 9\n255\n1 2 3\n");
+    const auto request = makeRequest(input.string(), "result_cache_failed_out.ppm");
+    std::ofstream(request.output_path, std::ios::trunc) << "an earlier result";
+    const auto result = cached.run(request);
+    lumos::tests::require(!result.ok && engine.runs == 1, "an input the engine cannot decode should fail");
+    lumos::tests::require(
+        lumos::tests::readFileBytes(request.output_path) == "an earlier result", "a failed run should leave the old output");
+    std::size_t files = 0;
+    for (const auto& file : std::filesystem::directory_iterator(std::filesystem::path(request.output_path).parent_path())) {
+        files += file.path().filename().string().starts_with("result_cache_failed_out.tmp") ? 1 : 0;
+    }
+    lumos::tests::require(files == 0, "a failed run should leave no staged output");
+}
+
+}  // namespace
+
+int main() {
+    try {
+        testHashAndCanonicalSettings();
+        testRepeatedRequestsHitTheCache();
+        testLeastRecentlyUsedEviction();
+        testDamagedEntriesAreDropped();
+        testFailedRunsKeepTheOldOutput();
+        std::cout << "CachedPipelineTests passed\n";
+        return 0;
+    } catch (const std::exception& ex) {
+        std::cerr << "CachedPipelineTests failed: " << ex.what() << '\n';
+        return 1;
+    }
+}
@@ -0,0 +1,149 @@
+#include "engine/BoxBlur.h"
+#include "engine/CpuStubPipeline.h"
+#include "engine/DecodedImageCache.h"
+#include "engine/Pipeline.h"
+#include "engine/Stage.h"
+#include "tests/TestHelpers.h"
+
+#include <cstddef>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using lumos::engine::DecodedImage;
+using lumos::engine::DecodedImageCache;
+
+std::string writeInput(const std::string& name, const int width, const int seed) {
+    std::string text = "P3\n" + std::to_string(width) + " 9\n255\n";
+    for (int index = 0; index < width * 9 * 3; ++index) {
+        text += std::to_string((index * 41 + seed * 13) % 256) + "\n";
+    }
+    return lumos::tests::writeTempFile(name, text).string();
+}
+
+std::shared_ptr<const DecodedImage> makeImage(const int width, const int height) {
+    return std::make_shared<const DecodedImage>(DecodedImage {
+        .header = {.format = lumos::engine::PpmFormat::kBinaryRgb, .width = width, .height = height, .max_value = 255},
+        .pixels = lumos::engine::Rgb8Image(width, height),
+    });
+}
+
+void testEvictsLeastRecentlyUsedWithinBudget() {
+    const std::string paths[] = {
+        writeInput("decoded_cache_0.ppm", 4, 0), writeInput("decoded_cache_1.ppm", 4, 1), writeInput("decoded_cache_2.ppm", 4, 2)};
+    // Rows are padded to 64 bytes, so each 64x64 frame takes 64 * 64 * 3 bytes.
+    const std::size_t frame_bytes = std::size_t {64} * 64 * 3;
+    DecodedImageCache cache(2 * frame_bytes);
+    for (const auto& path : paths) {
+        lumos::tests::require(cache.find(path) == nullptr, "an empty cache should miss");
+    }
+    cache.insert(paths[0], *lumos::engine::stampOf(paths[0]), makeImage(64, 64));
+    cache.insert(paths[1], *lumos::engine::stampOf(paths[1]), makeImage(64, 64));
+    const auto held = cache.find(paths[0]);
+    lumos::tests::require(held != nullptr && held->header.width == 64, "a cached frame should be found");
+    cache.insert(paths[2], *lumos::engine::stampOf(paths[2]), makeImage(64, 64));
+
+    const auto stats = cache.stats();
+    lumos::tests::require(stats.entries == 2 && stats.bytes == 2 * frame_bytes && stats.evictions == 1, "one frame should go");
+    lumos::tests::require(cache.find(paths[1]) == nullptr, "the least recently used frame should be evicted");
+    lumos::tests::require(cache.header(paths[0]).has_value() && cache.header(paths[2]).has_value(), "the others should stay");
+
+    cache.insert(paths[1], *lumos::engine::stampOf(paths[1]), makeImage(512, 512));
+    lumos::tests::require(cache.stats().entries == 2 && !cache.header(paths[1]), "a frame over the budget should not be kept");
+
+    cache.clear();
+    lumos::tests::require(cache.stats().entries == 0 && held->header.width == 64, "an evicted frame should outlive the cache");
+}
+
+void testChangedFilesMiss() {
+    const std::string path = writeInput("decoded_cache_changed.ppm", 4, 3);
+    DecodedImageCache cache;
+    cache.insert(path, *lumos::engine::stampOf(path), makeImage(4, 9));
+    lumos::tests::require(cache.find(path) != nullptr, "an unchanged file should hit");
+    writeInput("decoded_cache_changed.ppm", 5, 3);
+    lumos::tests::require(cache.find(path) == nullptr && cache.stats().entries == 0, "a rewritten file should miss and be dropped");
+}
+
+// Two box blurs of the same size fuse into separate groups, the second writing over the frame the
+// first read: with a cache, that frame is the shared decoded one and must stay intact.
+void testPipelineSharesDecodedFrames() {
+    const std::string input = writeInput("decoded_cache_pipeline.ppm", 23, 4);
+    lumos::contracts::EnhancementRequest request;
+    request.input_path = input;
+    request.scale_factor = 1;
+    request.denoise_enabled = true;
+
+    const auto stages = [] {
+        using lumos::engine::DenoiseStage;
+        std::vector<std::unique_ptr<lumos::engine::IStage>> list;
+        list.push_back(std::make_unique<lumos::engine::DecodeStage>());
+        list.push_back(std::make_unique<DenoiseStage>(lumos::engine::BoxBlurOptions {.radius = 1}, lumos::engine::GuidedFilterOptions {}));
+        list.push_back(std::make_unique<DenoiseStage>(lumos::engine::BoxBlurOptions {.radius = 2}, lumos::engine::GuidedFilterOptions {}));
+        list.push_back(std::make_unique<lumos::engine::EncodeStage>());
+        return list;
+    };
+    request.output_path = lumos::tests::tempOutputPath("decoded_cache_expected.ppm").string();
+    lumos::engine::Pipeline uncached(stages());
+    const lumos::engine::PpmHeader header {.format = lumos::engine::PpmFormat::kAsciiRgb, .width = 23, .height = 9, .max_value = 255};
+    lumos::tests::require(uncached.plan(request, header).groups[1].reuses_frame, "the second group should reuse the decoded frame");
+    lumos::tests::require(uncached.run(request).ok, "uncached run should succeed");
+    const std::string expected = lumos::tests::readFileBytes(request.output_path);
+
+    DecodedImageCache cache;
+    lumos::engine::Pipeline cached(stages(), {.decoded_images = &cache});
+    for (int run = 0; run < 3; ++run) {
+        request.output_path = lumos::tests::tempOutputPath("decoded_cache_output.ppm").string();
+        const auto result = cached.run(request);
+        lumos::tests::require(result.ok, "cached run should succeed");
+        lumos::tests::require(
+            lumos::tests::readFileBytes(request.output_path) == expected, "run " + std::to_string(run) + " should match the uncached run");
+    }
+    lumos::tests::require(cache.stats().hits == 2 && cache.stats().misses == 1, "only the first run should decode");
+
+    // A region is cut from the shared frame, and decoded on its own it is not shared.
+    request.region = {.x = 3, .y = 2, .width = 11, .height = 5};
+    request.output_path = lumos::tests::tempOutputPath("decoded_cache_region_expected.ppm").string();
+    lumos::tests::require(uncached.run(request).ok, "uncached region run should succeed");
+    const std::string expected_region = lumos::tests::readFileBytes(request.output_path);
+    request.output_path = lumos::tests::tempOutputPath("decoded_cache_region.ppm").string();
+    lumos::tests::require(cached.run(request).ok && cache.stats().hits == 3, "a region should read the shared frame");
+    lumos::tests::require(
+        lumos::tests::readFileBytes(request.output_path) == expected_region, "the shared frame's region should match");
+    DecodedImageCache region_cache;
+    lumos::engine::Pipeline region_only(stages(), {.decoded_images = &region_cache});
+    lumos::tests::require(region_only.run(request).ok, "a region run on an empty cache should succeed");
+    lumos::tests::require(region_cache.stats().entries == 0, "a decoded region should not be shared");
+    lumos::tests::require(lumos::tests::readFileBytes(request.output_path) == expected_region, "the decoded region should match");
+    request.region = {};
+
+    // Other settings reuse the frame as well, and a request with nothing to do encodes it as is.
+    request.denoise_enabled = false;
+    request.output_path = lumos::tests::tempOutputPath("decoded_cache_copy_expected.ppm").string();
+    lumos::tests::require(lumos::engine::CpuStubPipeline().run(request).ok, "uncached pass-through run should succeed");
+    const std::string copied = lumos::tests::readFileBytes(request.output_path);
+    lumos::engine::CpuStubPipeline stub({.decoded_images = &cache});
+    request.output_path = lumos::tests::tempOutputPath("decoded_cache_copy.ppm").string();
+    lumos::tests::require(stub.run(request).ok, "pass-through run should succeed");
+    lumos::tests::require(cache.stats().hits == 4, "a settings change should not decode again");
+    lumos::tests::require(lumos::tests::readFileBytes(request.output_path) == copied, "pass-through should encode the cached frame");
+}
+
+}  // namespace
+
+int main() {
+    try {
+        testEvictsLeastRecentlyUsedWithinBudget();
+        testChangedFilesMiss();
+        testPipelineSharesDecodedFrames();
+        std::cout << "DecodedImageCacheTests passed\n";
+        return 0;
+    } catch (const std::exception& ex) {
+        std::cerr << "DecodedImageCacheTests failed: " << ex.what() << '\n';
+        return 1;
+    }
+}
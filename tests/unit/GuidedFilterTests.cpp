@@ -0,0 +1,189 @@
+#include "engine/BoxBlur.h"
+#include "engine/GuidedFilter.h"
+#include "engine/ImageBuffer.h"
+#include "tests/TestHelpers.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using lumos::tests::makeNoise;
+
+template <typename Buffer>
+Buffer filtered(const Buffer& input, const lumos::engine::GuidedFilterOptions& options, const int max_value) {
+    Buffer output(input.width(), input.height());
+    lumos::engine::guidedFilter(input.view(), options, static_cast<typename Buffer::Sample>(max_value), output.mutableView());
+    return output;
+}
+
+// He et al. in double precision with direct window sums and edge pixels repeated.
+template <typename Buffer>
+std::vector<double> referenceGuidedFilter(const Buffer& input, const int radius, const double strength, const int max_value, const int channel) {
+    const int width = input.width();
+    const int height = input.height();
+    const double sigma = 0.2 * strength * max_value;
+    const double eps = std::max(sigma * sigma, 1.0e-6);
+    const auto at = [&](const int x, const int y) {
+        return static_cast<double>(input.at(std::clamp(x, 0, width - 1), std::clamp(y, 0, height - 1), channel));
+    };
+    const double area = (2.0 * radius + 1) * (2.0 * radius + 1);
+    std::vector<double> a(static_cast<std::size_t>(width * height));
+    std::vector<double> b(a.size());
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            double sum = 0.0;
+            double squares = 0.0;
+            for (int dy = -radius; dy <= radius; ++dy) {
+                for (int dx = -radius; dx <= radius; ++dx) {
+                    sum += at(x + dx, y + dy);
+                    squares += at(x + dx, y + dy) * at(x + dx, y + dy);
+                }
+            }
+            const double mean = sum / area;
+            const double variance = std::max(0.0, squares / area - mean * mean);
+            const auto index = static_cast<std::size_t>(y * width + x);
+            a[index] = variance / (variance + eps);
+            b[index] = mean * (1.0 - a[index]);
+        }
+    }
+    std::vector<double> output(a.size());
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            double a_sum = 0.0;
+            double b_sum = 0.0;
+            for (int dy = -radius; dy <= radius; ++dy) {
+                for (int dx = -radius; dx <= radius; ++dx) {
+                    const auto index = static_cast<std::size_t>(std::clamp(y + dy, 0, height - 1) * width + std::clamp(x + dx, 0, width - 1));
+                    a_sum += a[index];
+                    b_sum += b[index];
+                }
+            }
+            output[static_cast<std::size_t>(y * width + x)] = std::clamp(a_sum / area * at(x, y) + b_sum / area, 0.0, static_cast<double>(max_value));
+        }
+    }
+    return output;
+}
+
+template <typename Buffer>
+void requireMatchesReference(const std::string& label, const int width, const int height, const int max_value) {
+    const Buffer input = makeNoise<Buffer>(width, height, 0xC0FFEEu + static_cast<std::uint32_t>(width), max_value);
+    for (const int radius : {1, 2, 4}) {
+        for (const float strength : {0.2f, 0.7f}) {
+            const Buffer output = filtered(input, {.radius = radius, .strength = strength}, max_value);
+            for (int channel = 0; channel < Buffer::kChannels; ++channel) {
+                const auto expected = referenceGuidedFilter(input, radius, strength, max_value, channel);
+                for (int y = 0; y < height; ++y) {
+                    for (int x = 0; x < width; ++x) {
+                        const double want = expected[static_cast<std::size_t>(y * width + x)];
+                        lumos::tests::require(
+                            std::abs(output.at(x, y, channel) - want) <= 1.0,
+                            label + " radius " + std::to_string(radius) + " should match the reference at " + std::to_string(x) +
+                                "," + std::to_string(y));
+                    }
+                }
+            }
+        }
+    }
+}
+
+void testMatchesReference() {
+    requireMatchesReference<lumos::engine::Rgb8Image>("rgb8", 19, 13, 255);
+    requireMatchesReference<lumos::engine::Gray16Image>("gray16", 11, 17, 65535);
+    requireMatchesReference<lumos::engine::Gray16Image>("gray12", 3, 2, 4095);
+}
+
+void testZeroStrengthAndRadiusKeepTheImage() {
+    const auto input = makeNoise<lumos::engine::Rgb8Image>(16, 9, 77u, 255);
+    for (const auto& options : {lumos::engine::GuidedFilterOptions {.radius = 3, .strength = 0.0f},
+                                lumos::engine::GuidedFilterOptions {.radius = 0, .strength = 1.0f}}) {
+        const auto output = filtered(input, options, 255);
+        for (int y = 0; y < 9; ++y) {
+            for (int x = 0; x < 16; ++x) {
+                for (int channel = 0; channel < 3; ++channel) {
+                    lumos::tests::require(output.at(x, y, channel) == input.at(x, y, channel), "guided filter should leave the image unchanged");
+                }
+            }
+        }
+    }
+}
+
+void testPreservesEdgesTheBoxBlurSmears() {
+    // A hard step with low-amplitude noise on both sides.
+    constexpr int kWidth = 32;
+    constexpr int kHeight = 12;
+    const auto noise = makeNoise<lumos::engine::Gray8Image>(kWidth, kHeight, 4242u, 16);
+    lumos::engine::Gray8Image input(kWidth, kHeight);
+    for (int y = 0; y < kHeight; ++y) {
+        for (int x = 0; x < kWidth; ++x) {
+            input.at(x, y, 0) = static_cast<std::uint8_t>((x < kWidth / 2 ? 40 : 200) + noise.at(x, y, 0) - 8);
+        }
+    }
+    const auto guided = filtered(input, {.radius = 2, .strength = 0.3f}, 255);
+    lumos::engine::Gray8Image blurred(kWidth, kHeight);
+    lumos::engine::boxBlur(input.view(), {.radius = 2, .border = lumos::engine::BorderMode::kClamp}, blurred.mutableView());
+
+    double input_spread = 0.0;
+    double guided_spread = 0.0;
+    for (int y = 0; y < kHeight; ++y) {
+        const int dark = guided.at(kWidth / 2 - 1, y, 0);
+        const int light = guided.at(kWidth / 2, y, 0);
+        lumos::tests::require(light - dark > 130, "guided filter should keep the step");
+        lumos::tests::require(blurred.at(kWidth / 2, y, 0) - blurred.at(kWidth / 2 - 1, y, 0) < 70, "box blur should smear the step");
+        for (int x = 2; x < kWidth / 2 - 3; ++x) {
+            input_spread += std::abs(input.at(x, y, 0) - 40);
+            guided_spread += std::abs(guided.at(x, y, 0) - 40);
+        }
+    }
+    lumos::tests::require(guided_spread < 0.6 * input_spread, "guided filter should smooth the noise in flat areas");
+}
+
+void testBandsMatchWholeImage() {
+    const auto input = makeNoise<lumos::engine::Rgb16Image>(10, 23, 99u, 1023);
+    const lumos::engine::GuidedFilterOptions options {.radius = 3, .strength = 0.5f};
+    const auto whole = filtered(input, options, 1023);
+    const int halo = 2 * options.radius;
+    for (const int band_rows : {1, 4, 7}) {
+        lumos::engine::Rgb16Image banded(10, 23);
+        for (int first = 0; first < 23; first += band_rows) {
+            const int last = std::min(23, first + band_rows);
+            const int window_first = std::max(0, first - halo);
+            const int window_last = std::min(23, last + halo);
+            lumos::engine::GuidedFilterRowStream<std::uint16_t> rows(
+                input.view().rows(window_first, window_last - window_first), window_first, 23, first, options, 1023);
+            for (int y = first; y < last; ++y) {
+                rows.nextRow(banded.row(y));
+            }
+        }
+        for (int y = 0; y < 23; ++y) {
+            for (int x = 0; x < 10; ++x) {
+                for (int channel = 0; channel < 3; ++channel) {
+                    lumos::tests::require(
+                        banded.at(x, y, channel) == whole.at(x, y, channel),
+                        "bands of " + std::to_string(band_rows) + " rows should match the whole image");
+                }
+            }
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    try {
+        testMatchesReference();
+        testZeroStrengthAndRadiusKeepTheImage();
+        testPreservesEdgesTheBoxBlurSmears();
+        testBandsMatchWholeImage();
+        std::cout << "GuidedFilterTests passed\n";
+        return 0;
+    } catch (const std::exception& ex) {
+        std::cerr << "GuidedFilterTests failed: " << ex.what() << '\n';
+        return 1;
+    }
+}
@@ -0,0 +1,91 @@
+#include "engine/ImageBuffer.h"
+#include "tests/TestHelpers.h"
+
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <utility>
+
+namespace {
+
+template <typename Buffer>
+void requireAlignedRows(const Buffer& buffer, const std::string& label) {
+    lumos::tests::require(buffer.strideBytes() % lumos::engine::kRowAlignmentBytes == 0, label + " stride should be 64-byte multiple");
+    for (int plane = 0; plane < Buffer::kPlanes; ++plane) {
+        for (int y = 0; y < buffer.height(); ++y) {
+            const auto address = reinterpret_cast<std::uintptr_t>(buffer.row(y, plane));
+            lumos::tests::require(address % lumos::engine::kRowAlignmentBytes == 0, label + " row should be 64-byte aligned");
+        }
+    }
+}
+
+void testRowsAreAlignedAndStridePadded() {
+    const lumos::engine::Rgb8Image rgb8(5, 3);
+    lumos::tests::require(rgb8.stride() == 64, "5 rgb8 pixels should pad to one 64-byte row");
+    requireAlignedRows(rgb8, "rgb8");
+
+    const lumos::engine::Rgb16Image rgb16(11, 4);
+    lumos::tests::require(rgb16.stride() == 64 && rgb16.strideBytes() == 128, "11 rgb16 pixels should pad to 128 bytes");
+    requireAlignedRows(rgb16, "rgb16");
+
+    const lumos::engine::ImageBuffer<float, 3, lumos::engine::PixelLayout::kPlanar> planar(17, 2);
+    lumos::tests::require(planar.stride() == 32, "17 float samples should pad to 32 samples");
+    lumos::tests::require(planar.byteSize() == 3u * 2u * 32u * sizeof(float), "planar buffer should hold three planes");
+    requireAlignedRows(planar, "planar float");
+
+    const lumos::engine::Gray8Image empty(0, 10);
+    lumos::tests::require(empty.empty() && empty.byteSize() == 0, "zero-width buffer should be empty");
+}
+
+void testInterleavedAndPlanarAddressing() {
+    lumos::engine::Rgb16Image interleaved(4, 2);
+    lumos::engine::ImageBuffer<std::uint16_t, 3, lumos::engine::PixelLayout::kPlanar> planar(4, 2);
+    for (int y = 0; y < 2; ++y) {
+        for (int x = 0; x < 4; ++x) {
+            for (int channel = 0; channel < 3; ++channel) {
+                const auto value = static_cast<std::uint16_t>(1000 * channel + 10 * y + x);
+                interleaved.at(x, y, channel) = value;
+                planar.at(x, y, channel) = value;
+            }
+        }
+    }
+
+    lumos::tests::require(interleaved.row(1)[2 * 3 + 1] == 1012, "interleaved samples should be packed per pixel");
+    lumos::tests::require(planar.row(1, 1)[2] == 1012, "planar samples should live in their channel plane");
+    lumos::tests::require(planar.row(0, 2)[3] == 2003, "last plane should hold the last channel");
+}
+
+void testCopyIsDeepCountedAndMoveTransfers() {
+    lumos::engine::ImageBuffer<float, 1> original(3, 3);
+    original.at(1, 1, 0) = 0.5F;
+
+    const std::uint64_t copied_before = lumos::engine::copiedPixelBytes();
+    lumos::engine::ImageBuffer<float, 1> copy = original;
+    lumos::tests::require(
+        lumos::engine::copiedPixelBytes() - copied_before == 3u * 3u * sizeof(float), "copy should be counted");
+    copy.at(1, 1, 0) = 2.0F;
+    lumos::tests::require(original.at(1, 1, 0) == 0.5F, "copy should not alias the original");
+
+    const float* storage = original.row(0);
+    lumos::engine::ImageBuffer<float, 1> moved = std::move(original);
+    lumos::tests::require(
+        lumos::engine::copiedPixelBytes() - copied_before == 3u * 3u * sizeof(float), "move should not copy");
+    lumos::tests::require(moved.row(0) == storage && moved.at(1, 1, 0) == 0.5F, "move should transfer storage");
+    lumos::tests::require(original.empty(), "moved-from buffer should be empty");
+}
+
+}  // namespace
+
+int main() {
+    try {
+        testRowsAreAlignedAndStridePadded();
+        testInterleavedAndPlanarAddressing();
+        testCopyIsDeepCountedAndMoveTransfers();
+        std::cout << "ImageBufferTests passed\n";
+        return 0;
+    } catch (const std::exception& ex) {
+        std::cerr << "ImageBufferTests failed: " << ex.what() << '\n';
+        return 1;
+    }
+}
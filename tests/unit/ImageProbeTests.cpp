@@ -0,0 +1,164 @@
+#include "app/EnhancementController.h"
+#include "app/JobQueue.h"
+#include "engine/CpuStubPipeline.h"
+#include "engine/ImageProbe.h"
+#include "engine/PpmCodec.h"
+#include "tests/TestHelpers.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+namespace {
+
+using lumos::engine::ImageProbe;
+using lumos::engine::PpmFormat;
+
+std::string asciiRaster(const int samples) {
+    std::string text;
+    for (int index = 0; index < samples; ++index) {
+        text += std::to_string(index % 200) + " ";
+    }
+    return text;
+}
+
+// The probe must agree with the decoder on every header the decoder accepts.
+void requireMatchesReader(const std::string& path, const std::string& label) {
+    lumos::engine::PpmReader reader;
+    std::string reader_error;
+    const bool reader_ok = reader.open(path, &reader_error);
+    ImageProbe probe;
+    std::string probe_error;
+    const bool probe_ok = lumos::engine::probeImage(path, &probe, &probe_error);
+    lumos::tests::require(probe_ok == reader_ok, label + ": probe and reader should agree on validity");
+    if (!reader_ok) {
+        lumos::tests::require(probe_error == reader_error, label + ": probe should fail like the reader, got " + probe_error);
+        return;
+    }
+    const auto& header = reader.header();
+    lumos::tests::require(
+        probe.header.format == header.format && probe.header.width == header.width && probe.header.height == header.height &&
+            probe.header.max_value == header.max_value,
+        label + ": probe should read the reader's header");
+    lumos::tests::require(probe.raster_offset == reader.bytesRead(), label + ": the raster should start where the reader does");
+}
+
+void testFormatsAndComments() {
+    const std::string binary_raster(4 * 3 * 3, '\x7f');
+    const std::string cases[][2] = {
+        {"probe_p3.ppm", "P3\n4 3\n255\n" + asciiRaster(4 * 3 * 3)},
+        {"probe_p2.pgm", "P2 4 3 1023 " + asciiRaster(4 * 3)},
+        {"probe_p6_comments.ppm", "P6\n# written by a scanner\n4 # width\n#height next\n3\n255\n" + binary_raster},
+        {"probe_p5_comment_before_raster.pgm", "P5 4 3\n# max value follows\n255\n" + binary_raster.substr(0, 12)},
+        {"probe_p6_wide.ppm", "P6\n4 3\n65535\n" + binary_raster + binary_raster},
+        {"probe_long_comment.ppm", "P3\n#" + std::string(3 * lumos::engine::kProbeReadBytes, 'c') + "\n4 3 255\n" + asciiRaster(36)},
+        {"probe_bad_magic.ppm", "P7\n4 3\n255\n" + binary_raster},
+        {"probe_bad_width.ppm", "P6\nx 3\n255\n" + binary_raster},
+        {"probe_zero_height.ppm", "P6\n4 0\n255\n"},
+        {"probe_deep.ppm", "P6\n4 3\n70000\n" + binary_raster},
+        {"probe_truncated.ppm", "P6\n4 3\n255\n" + binary_raster.substr(1)},
+        {"probe_no_raster.ppm", "P6\n4 3\n255"},
+        {"probe_header_only.ppm", "P3\n4 3"},
+        {"probe_empty.ppm", ""},
+    };
+    for (const auto& [name, text] : cases) {
+        requireMatchesReader(lumos::tests::writeTempFile(name, text).string(), name);
+    }
+
+    ImageProbe probe;
+    lumos::tests::require(
+        lumos::engine::probeImage(lumos::tests::writeTempFile("probe_gray16.pgm", "P2 2 2 1023 1 2 3 4\n").string(), &probe),
+        "a 10-bit graymap should probe");
+    lumos::tests::require(
+        probe.header.format == PpmFormat::kAsciiGray && probe.channels == 1 && probe.bit_depth == 10 && probe.sample_bytes == 2,
+        "channels, depth and sample size should follow the header");
+    std::string error;
+    lumos::tests::require(
+        !lumos::engine::probeImage(lumos::tests::tempOutputPath("probe_missing.ppm").string(), &probe, &error) &&
+            error == "failed to open file",
+        "a missing file should fail to open");
+}
+
+// Width x height x 3 x 2 of these headers wraps to a few kilobytes in 64 bits.
+void testWrappingRasterSizesAreRejected() {
+    const std::string raster(5000, '1');
+    for (const std::string magic : {"P6", "P3"}) {
+        const std::string name = "probe_wrapping_" + magic + ".ppm";
+        const std::string path =
+            lumos::tests::writeTempFile(name, magic + "\n2146721619 1432163965\n65535\n" + raster).string();
+        requireMatchesReader(path, name);
+        ImageProbe probe;
+        std::string error;
+        lumos::tests::require(
+            !lumos::engine::probeImage(path, &probe, &error) && error == "ppm data is incomplete",
+            name + ": a raster the file cannot hold should be rejected");
+
+        lumos::contracts::EnhancementRequest request;
+        request.input_path = path;
+        request.output_path = lumos::tests::tempOutputPath("probe_wrapping_out.ppm").string();
+        const auto result = lumos::engine::CpuStubPipeline().run(request);
+        lumos::tests::require(
+            !result.ok && result.error.code == lumos::contracts::ErrorCode::kDecodeFailed, name + ": the run should fail to decode");
+    }
+}
+
+void testChunkedFeedMatchesWhole() {
+    const std::string text = "P6 # comment\n#another\n 640\t480 # after\n255\n";
+    const std::uint64_t file_bytes = text.size() + 640 * 480 * 3;
+    ImageProbe whole;
+    lumos::tests::require(lumos::engine::probeImage(text, file_bytes, &whole), "the header should parse from memory");
+
+    lumos::engine::PpmHeaderParser parser;
+    std::size_t fed = 0;
+    while (fed < text.size() && !parser.feed(std::string_view(text).substr(fed, 1))) {
+        ++fed;
+    }
+    lumos::engine::PpmHeader header;
+    std::size_t raster_offset = 0;
+    lumos::tests::require(parser.finish(file_bytes, &header, &raster_offset, nullptr), "byte-at-a-time parsing should succeed");
+    lumos::tests::require(
+        header.width == 640 && header.height == 480 && raster_offset == whole.raster_offset && raster_offset == text.size(),
+        "chunking should not change the header or the raster offset");
+}
+
+void testCostsAndControllerUseTheProbe() {
+    const std::string path =
+        lumos::tests::writeTempFile("probe_cost.pgm", "P5\n# sixteen bit\n8 4\n4095\n" + std::string(64, '\0')).string();
+    ImageProbe probe;
+    lumos::tests::require(lumos::engine::probeImage(path, &probe), "the cost input should probe");
+
+    lumos::contracts::EnhancementRequest request;
+    request.input_path = path;
+    request.scale_factor = 2;
+    const auto cost = lumos::engine::estimateCost(probe, request);
+    lumos::tests::require(cost.input_frame_bytes == 8 * 4 * 2 && cost.output_frame_bytes == 16 * 8 * 2, "frames follow depth");
+    lumos::tests::require(cost.raster_bytes == 64 && cost.output_samples == 16 * 8, "raster and output sizes should be exact");
+    lumos::tests::require(lumos::app::estimateJobBytes(request) == cost.workingSetBytes(), "admission should use the probe");
+
+    // The controller's old extraction-based check stopped at the comment line.
+    const auto inspected = lumos::app::EnhancementController::probeInput(path);
+    lumos::tests::require(inspected && inspected->header.width == 8 && inspected->header.height == 4, "comments should be skipped");
+    request.input_path = lumos::tests::writeTempFile("probe_not_an_image.ppm", "hello").string();
+    lumos::tests::require(
+        !lumos::app::EnhancementController::probeInput(request.input_path) && lumos::app::estimateJobBytes(request) == 0,
+        "unreadable inputs should have no probe and no estimate");
+}
+
+}  // namespace
+
+int main() {
+    try {
+        testFormatsAndComments();
+        testWrappingRasterSizesAreRejected();
+        testChunkedFeedMatchesWhole();
+        testCostsAndControllerUseTheProbe();
+        std::cout << "ImageProbeTests passed\n";
+        return 0;
+    } catch (const std::exception& ex) {
+        std::cerr << "ImageProbeTests failed: " << ex.what() << '\n';
+        return 1;
+    }
+}
@@ -0,0 +1,289 @@
+#include "app/EnhancementController.h"
+#include "app/JobQueue.h"
+#include "common/Telemetry.h"
+#include "common/ThreadPool.h"
+#include "tests/TestHelpers.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using lumos::app::JobPriority;
+using lumos::app::JobState;
+
+// Holds every run until opened and records the order runs start in, keyed by output path. Runs
+// report half way through once they start, and come back cancelled if asked to while held.
+class GatedPipeline final : public lumos::contracts::IEnhancementPipeline {
+  public:
+    lumos::contracts::EnhancementResult run(const lumos::contracts::EnhancementRequest& request) override {
+        return run(request, {});
+    }
+
+    lumos::contracts::EnhancementResult run(
+        const lumos::contracts::EnhancementRequest& request,
+        const lumos::contracts::RunControl& control) override {
+        control.report("enhance", 0.5);
+        std::unique_lock<std::mutex> lock(mutex_);
+        started_.push_back(request.output_path);
+        peak_ = std::max(peak_, ++running_);
+        changed_.notify_all();
+        changed_.wait(lock, [this] { return open_; });
+        --running_;
+        if (control.cancelled()) {
+            return lumos::contracts::cancelledResult("enhance");
+        }
+        if (request.output_path == "throw") {
+            throw 42;
+        }
+        lumos::contracts::EnhancementResult result;
+        result.ok = request.output_path != "fail";
+        result.output_path = request.output_path;
+        return result;
+    }
+
+    void open() {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        open_ = true;
+        changed_.notify_all();
+    }
+
+    void waitForStarts(const std::size_t count) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        changed_.wait(lock, [&] { return started_.size() >= count; });
+    }
+
+    std::vector<std::string> started() {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        return started_;
+    }
+
+    int peak() {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        return peak_;
+    }
+
+  private:
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    std::vector<std::string> started_;
+    int running_ {0};
+    int peak_ {0};
+    bool open_ {false};
+};
+
+lumos::contracts::EnhancementRequest requestFor(const std::string& name) {
+    lumos::contracts::EnhancementRequest request;
+    request.output_path = name;
+    return request;
+}
+
+struct Fixture {
+    lumos::common::Telemetry telemetry {lumos::tests::tempOutputPath("job_queue_events.jsonl")};
+    GatedPipeline pipeline;
+    lumos::common::ThreadPool pool {4};
+    lumos::app::EnhancementController controller {pipeline, telemetry, pool};
+};
+
+void testInteractiveJumpsAheadOfBatch() {
+    Fixture fixture;
+    lumos::app::JobQueue queue(fixture.controller, {.max_concurrent = 1}, fixture.pool);
+    const auto blocker = queue.enqueue(requestFor("blocker"), JobPriority::kBatch);
+    fixture.pipeline.waitForStarts(1);
+    const auto first_batch = queue.enqueue(requestFor("batch_a"), JobPriority::kBatch);
+    const auto second_batch = queue.enqueue(requestFor("batch_b"), JobPriority::kBatch);
+    const auto third_batch = queue.enqueue(requestFor("batch_c"), JobPriority::kBatch);
+    queue.enqueue(requestFor("interactive"), JobPriority::kInteractive);
+    const auto failing = queue.enqueue(requestFor("fail"), JobPriority::kBatch);
+
+    lumos::tests::require(queue.status(blocker)->state == JobState::kRunning, "the first job should be running");
+    lumos::tests::require(
+        queue.status(blocker)->stage == "enhance" && queue.status(blocker)->progress == 0.5, "running jobs should report progress");
+    lumos::tests::require(queue.status(first_batch)->state == JobState::kQueued, "later jobs should wait for the slot");
+    lumos::tests::require(queue.cancel(second_batch), "a queued job should be cancellable");
+    lumos::tests::require(queue.cancel(blocker), "a running job should accept cancellation");
+    lumos::tests::require(queue.reprioritize(third_batch, JobPriority::kNormal), "a queued job should be reprioritizable");
+    lumos::tests::require(!queue.reprioritize(blocker, JobPriority::kInteractive), "a running job keeps its priority");
+
+    fixture.pipeline.open();
+    queue.waitIdle();
+    const std::vector<std::string> expected {"blocker", "interactive", "batch_c", "batch_a", "fail"};
+    lumos::tests::require(fixture.pipeline.started() == expected, "jobs should start by priority, then in queue order");
+    lumos::tests::require(queue.status(second_batch)->state == JobState::kCancelled, "cancelled jobs should never run");
+    lumos::tests::require(queue.status(blocker)->state == JobState::kCancelled, "a run stopped part way should report cancelled");
+    lumos::tests::require(!queue.cancel(blocker), "a finished job cannot be cancelled");
+    lumos::tests::require(queue.status(first_batch)->state == JobState::kSucceeded, "finished jobs should report success");
+    lumos::tests::require(queue.status(first_batch)->result.output_path == "batch_a", "finished jobs should keep their result");
+    lumos::tests::require(queue.status(failing)->state == JobState::kFailed, "failed runs should report failure");
+    lumos::tests::require(queue.jobs().size() == 6, "every queued job should be listed");
+    lumos::tests::require(!queue.status(999).has_value(), "unknown ids have no status");
+}
+
+void testConcurrencyLimit() {
+    Fixture fixture;
+    lumos::app::JobQueue queue(fixture.controller, {.max_concurrent = 2}, fixture.pool);
+    for (int index = 0; index < 8; ++index) {
+        queue.enqueue(requestFor("job_" + std::to_string(index)), JobPriority::kBatch);
+    }
+    fixture.pipeline.waitForStarts(2);
+    lumos::tests::require(queue.runningCount() == 2, "two jobs should run at once");
+    fixture.pipeline.open();
+    queue.waitIdle();
+    lumos::tests::require(fixture.pipeline.peak() == 2, "no more than max_concurrent jobs should overlap");
+}
+
+void testMemoryBudget() {
+    Fixture fixture;
+    lumos::app::JobQueue queue(
+        fixture.controller,
+        {.max_concurrent = 4,
+         .memory_budget_bytes = 100,
+         .estimate_bytes = [](const lumos::contracts::EnhancementRequest& request) -> std::size_t {
+             return request.output_path == "huge" ? 500 : 40;
+         }},
+        fixture.pool);
+    queue.enqueue(requestFor("huge"), JobPriority::kBatch);
+    for (int index = 0; index < 4; ++index) {
+        queue.enqueue(requestFor("small_" + std::to_string(index)), JobPriority::kBatch);
+    }
+    fixture.pipeline.waitForStarts(1);
+    lumos::tests::require(queue.runningCount() == 1, "a job over the budget should run alone");
+    fixture.pipeline.open();
+    queue.waitIdle();
+    lumos::tests::require(fixture.pipeline.peak() <= 2, "small jobs should share the budget two at a time");
+}
+
+void testFinishedJobsAreForgotten() {
+    Fixture fixture;
+    fixture.pipeline.open();
+    lumos::app::JobQueue queue(fixture.controller, {.max_concurrent = 1, .finished_history = 2}, fixture.pool);
+    std::vector<lumos::app::JobId> ids;
+    for (int index = 0; index < 5; ++index) {
+        ids.push_back(queue.enqueue(requestFor("job_" + std::to_string(index))));
+    }
+    queue.waitIdle();
+    lumos::tests::require(queue.jobs().size() == 2, "only the most recent finished jobs should be kept");
+    lumos::tests::require(!queue.status(ids.front()).has_value(), "the oldest finished job should be forgotten");
+    lumos::tests::require(
+        queue.status(ids.back())->result.output_path == "job_4", "the latest finished job should keep its result");
+    lumos::tests::require(!queue.cancel(ids.front()), "a forgotten job cannot be cancelled");
+}
+
+void testNonStandardExceptionsFailTheJob() {
+    Fixture fixture;
+    fixture.pipeline.open();
+    lumos::app::JobQueue queue(fixture.controller, {.max_concurrent = 1}, fixture.pool);
+    const auto thrower = queue.enqueue(requestFor("throw"));
+    const auto next = queue.enqueue(requestFor("after"));
+    queue.waitIdle();
+    const auto status = queue.status(thrower);
+    lumos::tests::require(
+        status->state == JobState::kFailed && status->result.error.code == lumos::contracts::ErrorCode::kProcessFailed,
+        "a job whose run throws something other than std::exception should fail");
+    lumos::tests::require(queue.status(next)->state == JobState::kSucceeded, "jobs behind it should still run");
+}
+
+void testJournalKeepsUnfinishedJobs() {
+    const auto journal = lumos::tests::tempOutputPath("job_queue_journal.txt");
+    std::filesystem::remove(journal);
+    lumos::contracts::EnhancementRequest odd = requestFor("odd name\nwith a newline.ppm");
+    odd.scale_factor = 3;
+    odd.denoise_strength = 0.3f;
+    odd.region = {1, 2, 3, 4};
+    {
+        Fixture fixture;
+        std::thread opener;
+        {
+            lumos::app::JobQueue queue(fixture.controller, {.max_concurrent = 1, .journal = journal}, fixture.pool);
+            queue.enqueue(requestFor("running"), JobPriority::kBatch);
+            fixture.pipeline.waitForStarts(1);
+            queue.enqueue(odd, JobPriority::kBatch);
+            const auto dropped = queue.enqueue(requestFor("dropped"), JobPriority::kBatch);
+            queue.enqueue(requestFor("urgent"), JobPriority::kInteractive);
+            lumos::tests::require(queue.cancel(dropped), "a queued job should cancel");
+            opener = std::thread([&fixture] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                fixture.pipeline.open();
+            });
+        }
+        opener.join();
+    }
+
+    std::vector<lumos::contracts::EnhancementRequest> seen;
+    {
+        Fixture fixture;
+        std::mutex seen_mutex;
+        fixture.pipeline.open();
+        lumos::app::JobQueue queue(
+            fixture.controller,
+            {.max_concurrent = 1,
+             .estimate_bytes =
+                 [&](const lumos::contracts::EnhancementRequest& request) -> std::size_t {
+                     const std::lock_guard<std::mutex> lock(seen_mutex);
+                     seen.push_back(request);
+                     return 0;
+                 },
+             .journal = journal},
+            fixture.pool);
+        queue.waitIdle();
+        lumos::tests::require(
+            fixture.pipeline.started() == std::vector<std::string> {"running", "urgent", odd.output_path},
+            "unfinished jobs should run again in their old order, and cancelled ones not at all");
+    }
+    lumos::tests::require(seen.size() == 3, "three jobs should be restored");
+    const auto& restored = seen[2];
+    lumos::tests::require(
+        restored.output_path == odd.output_path && restored.scale_factor == 3 && restored.denoise_strength == 0.3f &&
+            restored.region.x == 1 && restored.region.height == 4,
+        "a restored request should match the one queued");
+
+    Fixture fixture;
+    lumos::app::JobQueue drained(fixture.controller, {.journal = journal}, fixture.pool);
+    lumos::tests::require(drained.jobs().empty(), "jobs that finished should not be saved");
+}
+
+void testDestructorCancelsQueuedJobs() {
+    Fixture fixture;
+    std::thread opener;
+    {
+        lumos::app::JobQueue queue(fixture.controller, {.max_concurrent = 1}, fixture.pool);
+        for (int index = 0; index < 5; ++index) {
+            queue.enqueue(requestFor("job_" + std::to_string(index)));
+        }
+        fixture.pipeline.waitForStarts(1);
+        // Let the running job finish only once the destructor has cancelled the rest.
+        opener = std::thread([&fixture] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            fixture.pipeline.open();
+        });
+    }
+    opener.join();
+    lumos::tests::require(fixture.pipeline.started().size() == 1, "queued jobs should not run after the queue is gone");
+}
+
+}  // namespace
+
+int main() {
+    try {
+        testInteractiveJumpsAheadOfBatch();
+        testConcurrencyLimit();
+        testMemoryBudget();
+        testFinishedJobsAreForgotten();
+        testNonStandardExceptionsFailTheJob();
+        testJournalKeepsUnfinishedJobs();
+        testDestructorCancelsQueuedJobs();
+        std::cout << "JobQueueTests passed\n";
+        return 0;
+    } catch (const std::exception& ex) {
+        std::cerr << "JobQueueTests failed: " << ex.what() << '\n';
+        return 1;
+    }
+}
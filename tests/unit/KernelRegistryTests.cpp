@@ -0,0 +1,248 @@
+#include "engine/KernelRegistry.h"
+#include "engine/Resample.h"
+#include "tests/TestHelpers.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using lumos::engine::CpuIsa;
+using lumos::engine::KernelTable;
+
+struct Noise {
+    std::uint32_t state;
+
+    std::uint32_t next(const std::uint32_t bound) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return static_cast<std::uint32_t>((static_cast<std::uint64_t>(state) * bound) >> 32);
+    }
+};
+
+template <typename T>
+std::vector<T> noiseSamples(const std::size_t count, const std::uint32_t bound, Noise& noise) {
+    std::vector<T> samples(count);
+    for (T& sample : samples) {
+        sample = static_cast<T>(noise.next(bound));
+    }
+    return samples;
+}
+
+std::string isaLabel(const KernelTable& kernels) {
+    return lumos::engine::cpuIsaName(kernels.isa);
+}
+
+template <typename T, typename Sum>
+void requireSameBoxKernels(const KernelTable& reference, const KernelTable& candidate, const int max_radius) {
+    Noise noise {0x9E3779B9u};
+    const std::uint32_t sample_bound = std::numeric_limits<T>::max() + 1u;
+    for (const std::size_t step : {std::size_t {1}, std::size_t {3}}) {
+        for (const std::size_t count : {std::size_t {3}, std::size_t {67}, std::size_t {1001}}) {
+            for (const int radius : {1, 2, 3, 4, 5, 7, 9, 64}) {
+                if (radius > max_radius) {
+                    continue;
+                }
+                const auto taps = static_cast<std::uint32_t>(2 * radius + 1);
+                const std::size_t span = static_cast<std::size_t>(taps) * step;
+                const auto extended = noiseSamples<T>(count + span - step, sample_bound, noise);
+                std::vector<Sum> prefix(count + span);
+                std::vector<Sum> expected(count);
+                std::vector<Sum> actual(count);
+                lumos::engine::boxRowSumsKernel<T, Sum>(reference)(extended.data(), step, count, radius, prefix.data(), expected.data());
+                lumos::engine::boxRowSumsKernel<T, Sum>(candidate)(extended.data(), step, count, radius, prefix.data(), actual.data());
+                const std::string label = isaLabel(candidate) + " radius " + std::to_string(radius) + " count " + std::to_string(count);
+                lumos::tests::require(expected == actual, label + " row sums should match scalar");
+
+                // A column of taps row sums sliding by one row, so every sum stays a valid box sum.
+                const std::uint32_t row_bound = (sample_bound - 1) * taps + 1;
+                const auto leaving = noiseSamples<Sum>(count, row_bound, noise);
+                const auto incoming = noiseSamples<Sum>(count, row_bound, noise);
+                auto column = noiseSamples<Sum>(count, (sample_bound - 1) * taps * (taps - 1) + 1, noise);
+                for (std::size_t index = 0; index < count; ++index) {
+                    column[index] = static_cast<Sum>(column[index] + leaving[index]);
+                }
+                auto expected_column = column;
+                auto expected_leaving = leaving;
+                auto actual_column = column;
+                auto actual_leaving = leaving;
+                std::vector<T> expected_output(count);
+                std::vector<T> actual_output(count);
+                lumos::engine::slideDivideKernel<Sum, T>(reference)(
+                    expected_column.data(), incoming.data(), expected_leaving.data(), count, taps * taps, expected_output.data());
+                lumos::engine::slideDivideKernel<Sum, T>(candidate)(
+                    actual_column.data(), incoming.data(), actual_leaving.data(), count, taps * taps, actual_output.data());
+                lumos::tests::require(
+                    expected_column == actual_column && expected_leaving == actual_leaving && expected_output == actual_output,
+                    label + " slide and divide should match scalar");
+                for (std::size_t index = 0; index < count; ++index) {
+                    lumos::tests::require(
+                        expected_output[index] == static_cast<T>(expected_column[index] / (taps * taps)),
+                        label + " slide and divide should truncate the mean");
+                }
+            }
+        }
+    }
+}
+
+template <typename T>
+void requireSameExpandKernel(const KernelTable& reference, const KernelTable& candidate) {
+    Noise noise {0x85EBCA6Bu};
+    for (const int samples_per_pixel : {1, 3, 4}) {
+        for (const int scale_factor : {2, 3, 4, 8}) {
+            const int width = 61;
+            const auto source = noiseSamples<T>(static_cast<std::size_t>(width * samples_per_pixel), 65536u, noise);
+            const auto expanded_samples = static_cast<std::size_t>(width * samples_per_pixel * scale_factor);
+            std::vector<T> expected(expanded_samples);
+            std::vector<T> actual(expanded_samples);
+            lumos::engine::expandRowKernel<T>(reference)(source.data(), width, samples_per_pixel, scale_factor, expected.data());
+            lumos::engine::expandRowKernel<T>(candidate)(source.data(), width, samples_per_pixel, scale_factor, actual.data());
+            lumos::tests::require(
+                expected == actual, isaLabel(candidate) + " expand row should match scalar at " + std::to_string(scale_factor) + "x");
+        }
+    }
+}
+
+template <typename T>
+void requireSameResampleKernels(const KernelTable& reference, const KernelTable& candidate) {
+    using Intermediate = lumos::engine::ResampleIntermediate<T>;
+    Noise noise {0x27D4EB2Fu};
+    const T max_value = static_cast<T>(std::numeric_limits<T>::max() - 3);
+    for (const auto filter : {lumos::contracts::ResampleFilter::kBilinear, lumos::contracts::ResampleFilter::kBicubic,
+                              lumos::contracts::ResampleFilter::kLanczos3}) {
+        for (const int samples_per_pixel : {1, 3, 4, 2}) {
+            for (const auto& [source_width, target_width] : {std::pair {37, 74}, std::pair {37, 55}, std::pair {37, 20}}) {
+                const auto weights = lumos::engine::resampleWeights(filter, source_width, target_width);
+                const auto row_samples = static_cast<std::size_t>(target_width * samples_per_pixel);
+                std::vector<std::vector<Intermediate>> expected_rows;
+                for (int row = 0; row < weights->taps; ++row) {
+                    const auto source = noiseSamples<T>(
+                        static_cast<std::size_t>(source_width * samples_per_pixel), std::numeric_limits<T>::max() + 1u, noise);
+                    std::vector<Intermediate> expected(row_samples);
+                    std::vector<Intermediate> actual(row_samples);
+                    lumos::engine::resampleHorizontalKernel<T>(reference)(
+                        source.data(), samples_per_pixel, target_width, weights->taps, weights->first.data(),
+                        weights->weights.data(), expected.data());
+                    lumos::engine::resampleHorizontalKernel<T>(candidate)(
+                        source.data(), samples_per_pixel, target_width, weights->taps, weights->first.data(),
+                        weights->weights.data(), actual.data());
+                    lumos::tests::require(expected == actual, isaLabel(candidate) + " horizontal resample should match scalar");
+                    expected_rows.push_back(std::move(expected));
+                }
+
+                std::vector<const Intermediate*> rows;
+                for (const auto& row : expected_rows) {
+                    rows.push_back(row.data());
+                }
+                for (int target_row = 0; target_row < 3; ++target_row) {
+                    const std::int16_t* row_weights = weights->weights.data() + target_row * weights->taps;
+                    std::vector<T> expected(row_samples);
+                    std::vector<T> actual(row_samples);
+                    lumos::engine::resampleVerticalKernel<T>(reference)(
+                        rows.data(), weights->taps, row_weights, row_samples, max_value, expected.data());
+                    lumos::engine::resampleVerticalKernel<T>(candidate)(
+                        rows.data(), weights->taps, row_weights, row_samples, max_value, actual.data());
+                    lumos::tests::require(expected == actual, isaLabel(candidate) + " vertical resample should match scalar");
+                }
+            }
+        }
+    }
+}
+
+void requireSameBigEndianKernels(const KernelTable& reference, const KernelTable& candidate) {
+    Noise noise {0xC2B2AE35u};
+    const std::size_t count = 1003;
+    const auto bytes = noiseSamples<unsigned char>(count * 2, 256u, noise);
+    for (const std::uint16_t max_value : {std::uint16_t {300}, std::uint16_t {4095}, std::uint16_t {65535}}) {
+        std::vector<std::uint16_t> expected(count);
+        std::vector<std::uint16_t> actual(count);
+        reference.unpack_big_endian_u16(bytes.data(), count, max_value, expected.data());
+        candidate.unpack_big_endian_u16(bytes.data(), count, max_value, actual.data());
+        lumos::tests::require(expected == actual, isaLabel(candidate) + " big-endian unpack should match scalar");
+        lumos::tests::require(
+            std::all_of(actual.begin(), actual.end(), [max_value](const std::uint16_t value) { return value <= max_value; }),
+            isaLabel(candidate) + " big-endian unpack should clamp to max value");
+    }
+
+    const auto samples = noiseSamples<std::uint16_t>(count, 65536u, noise);
+    std::vector<unsigned char> expected(count * 2);
+    std::vector<unsigned char> actual(count * 2);
+    reference.pack_big_endian_u16(samples.data(), count, expected.data());
+    candidate.pack_big_endian_u16(samples.data(), count, actual.data());
+    lumos::tests::require(expected == actual, isaLabel(candidate) + " big-endian pack should match scalar");
+    std::vector<std::uint16_t> round_trip(count);
+    candidate.unpack_big_endian_u16(actual.data(), count, 65535, round_trip.data());
+    lumos::tests::require(round_trip == samples, isaLabel(candidate) + " big-endian pack should round-trip");
+}
+
+void testIsaNamesRoundTrip() {
+    for (const CpuIsa isa : {CpuIsa::kScalar, CpuIsa::kSse2, CpuIsa::kAvx2, CpuIsa::kAvx512, CpuIsa::kNeon}) {
+        CpuIsa parsed = CpuIsa::kScalar;
+        lumos::tests::require(
+            lumos::engine::parseCpuIsa(lumos::engine::cpuIsaName(isa), &parsed) && parsed == isa,
+            std::string("isa name should parse back: ") + lumos::engine::cpuIsaName(isa));
+    }
+    CpuIsa parsed = CpuIsa::kAvx2;
+    lumos::tests::require(!lumos::engine::parseCpuIsa("AVX2", &parsed), "isa names should be lower case");
+    lumos::tests::require(!lumos::engine::parseCpuIsa("", &parsed) && parsed == CpuIsa::kAvx2, "empty isa name should not parse");
+}
+
+void testOverrideResolvesToSupportedIsa() {
+    const auto supported = lumos::engine::supportedCpuIsas();
+    const CpuIsa detected = lumos::engine::detectCpuIsa();
+    lumos::tests::require(!supported.empty() && supported.front() == CpuIsa::kScalar, "scalar kernels should always be available");
+    lumos::tests::require(
+        std::find(supported.begin(), supported.end(), detected) != supported.end(), "detected isa should be supported");
+    lumos::tests::require(
+        std::find(supported.begin(), supported.end(), lumos::engine::activeKernels().isa) != supported.end(),
+        "active kernels should be a supported isa");
+
+    lumos::tests::require(lumos::engine::resolveCpuIsa(detected, "") == detected, "no override should keep the detected isa");
+    lumos::tests::require(lumos::engine::resolveCpuIsa(detected, "scalar") == CpuIsa::kScalar, "scalar override should apply");
+    lumos::tests::require(lumos::engine::resolveCpuIsa(detected, "mmx") == detected, "unknown override should be ignored");
+    for (const CpuIsa isa : {CpuIsa::kSse2, CpuIsa::kAvx2, CpuIsa::kAvx512, CpuIsa::kNeon}) {
+        const bool available = lumos::engine::kernelsFor(isa) != nullptr;
+        const CpuIsa resolved = lumos::engine::resolveCpuIsa(detected, lumos::engine::cpuIsaName(isa));
+        lumos::tests::require(
+            resolved == (available ? isa : detected),
+            std::string("override should fall back unless supported: ") + lumos::engine::cpuIsaName(isa));
+    }
+}
+
+void testEveryIsaMatchesScalar() {
+    const KernelTable& reference = *lumos::engine::kernelsFor(CpuIsa::kScalar);
+    for (const CpuIsa isa : lumos::engine::supportedCpuIsas()) {
+        const KernelTable& candidate = *lumos::engine::kernelsFor(isa);
+        lumos::tests::require(candidate.isa == isa, "kernel table should report its isa");
+        requireSameBoxKernels<std::uint8_t, std::uint16_t>(reference, candidate, 7);
+        requireSameBoxKernels<std::uint8_t, std::uint32_t>(reference, candidate, 64);
+        requireSameBoxKernels<std::uint16_t, std::uint32_t>(reference, candidate, 64);
+        requireSameExpandKernel<std::uint8_t>(reference, candidate);
+        requireSameExpandKernel<std::uint16_t>(reference, candidate);
+        requireSameResampleKernels<std::uint8_t>(reference, candidate);
+        requireSameResampleKernels<std::uint16_t>(reference, candidate);
+        requireSameBigEndianKernels(reference, candidate);
+    }
+}
+
+}  // namespace
+
+int main() {
+    try {
+        testIsaNamesRoundTrip();
+        testOverrideResolvesToSupportedIsa();
+        testEveryIsaMatchesScalar();
+        std::cout << "KernelRegistryTests passed\n";
+        return 0;
+    } catch (const std::exception& ex) {
+        std::cerr << "KernelRegistryTests failed: " << ex.what() << '\n';
+        return 1;
+    }
+}
@@ -1,8 +1,23 @@
+#include "engine/BoxBlur.h"
 #include "engine/CpuStubPipeline.h"
+#include "engine/ImageBuffer.h"
+#include "engine/ImageView.h"
+#include "engine/PpmCodec.h"
+#include "engine/Sharpen.h"
+#include "engine/Upscale.h"
 #include "tests/TestHelpers.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
 #include <exception>
+#include <filesystem>
 #include <iostream>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 namespace {
 
@@ -47,13 +62,449 @@ void testRejectsUnsupportedScaleFactor() {
     lumos::contracts::EnhancementRequest request;
     request.input_path = lumos::tests::fixturePath("sample_input.ppm").string();
     request.output_path = lumos::tests::tempOutputPath("invalid_scale.ppm").string();
-    request.scale_factor = 3;
+    for (const auto& [numerator, denominator] : {std::pair {9, 1}, std::pair {1, 9}, std::pair {0, 1}, std::pair {2, 0}, std::pair {1, 1 << 29},
+             std::pair {1 << 29, 1}, std::pair {std::numeric_limits<int>::max(), 1}}) {
+        request.scale_factor = numerator;
+        request.scale_denominator = denominator;
+        const auto result = pipeline.run(request);
+        lumos::tests::require(!result.ok, "pipeline should fail unsupported scale factor");
+        lumos::tests::require(
+            result.error.code == lumos::contracts::ErrorCode::kInvalidRequest,
+            "error code should be kInvalidRequest");
+    }
+}
 
-    const auto result = pipeline.run(request);
-    lumos::tests::require(!result.ok, "pipeline should fail unsupported scale factor");
+void testOutputKeepsInputEncodingUnlessOverridden() {
+    lumos::engine::CpuStubPipeline pipeline;
+
+    const auto input = lumos::tests::writeTempFile("binary_input.ppm", std::string("P6\n1 1\n255\n\x01\x02\x03", 14));
+    lumos::contracts::EnhancementRequest request;
+    request.input_path = input.string();
+    request.output_path = lumos::tests::tempOutputPath("binary_output.ppm").string();
+    request.scale_factor = 2;
+
+    auto result = pipeline.run(request);
+    lumos::tests::require(result.ok, "binary input should process");
+    lumos::engine::PpmHeader header;
     lumos::tests::require(
-        result.error.code == lumos::contracts::ErrorCode::kInvalidRequest,
-        "error code should be kInvalidRequest");
+        lumos::engine::decodePpm(request.output_path, nullptr, nullptr, &header),
+        "binary output should decode");
+    lumos::tests::require(header.format == lumos::engine::PpmFormat::kBinaryRgb, "output should stay binary P6");
+
+    request.output_encoding = lumos::contracts::OutputEncoding::kAscii;
+    result = pipeline.run(request);
+    lumos::tests::require(result.ok, "ascii override should process");
+    lumos::tests::require(
+        lumos::engine::decodePpm(request.output_path, nullptr, nullptr, &header),
+        "ascii output should decode");
+    lumos::tests::require(header.format == lumos::engine::PpmFormat::kAsciiRgb, "override should produce ASCII P3");
+}
+
+void testStreamingMatchesFullFrameOutput() {
+    std::string text = "P3\n7 5\n255\n";
+    for (int index = 0; index < 7 * 5 * 3; ++index) {
+        text += std::to_string((index * 37 + 11) % 256) + "\n";
+    }
+    const auto input = lumos::tests::writeTempFile("streaming_input.ppm", text);
+
+    const lumos::engine::BoxBlurOptions strong_mirror {.radius = 3, .border = lumos::engine::BorderMode::kMirror};
+    for (const auto& [denoise, blur] : {std::pair {false, lumos::engine::BoxBlurOptions {}},
+                                        std::pair {true, lumos::engine::BoxBlurOptions {}},
+                                        std::pair {true, strong_mirror}}) {
+        lumos::contracts::EnhancementRequest request;
+        request.input_path = input.string();
+        request.output_path = lumos::tests::tempOutputPath("streaming_reference.ppm").string();
+        request.scale_factor = 2;
+        request.denoise_enabled = denoise;
+
+        lumos::engine::CpuStubPipeline full_frame({.denoise = blur});
+        lumos::tests::require(full_frame.run(request).ok, "full-frame run should succeed");
+        const std::string reference = lumos::tests::readFileBytes(request.output_path);
+
+        for (const int band_rows : {1, 2, 3, 64}) {
+            lumos::engine::CpuStubPipeline streaming({.memory_budget_bytes = 0, .band_rows = band_rows, .denoise = blur});
+            request.output_path = lumos::tests::tempOutputPath("streaming_output.ppm").string();
+            const auto result = streaming.run(request);
+            lumos::tests::require(result.ok, "streaming run should succeed");
+            lumos::tests::require(result.metrics.output_width == 14 && result.metrics.output_height == 10, "streaming dimensions");
+            lumos::tests::require(
+                lumos::tests::readFileBytes(request.output_path) == reference,
+                "streaming output should match full frame for band_rows " + std::to_string(band_rows));
+        }
+    }
+}
+
+void testResampledStreamingMatchesFullFrame() {
+    std::string text = "P3\n9 7\n1000\n";
+    for (int index = 0; index < 9 * 7 * 3; ++index) {
+        text += std::to_string((index * 337 + 11) % 1001) + "\n";
+    }
+    const auto input = lumos::tests::writeTempFile("resample_streaming_input.ppm", text);
+
+    using lumos::contracts::ResampleFilter;
+    for (const auto filter : {ResampleFilter::kNearest, ResampleFilter::kBilinear, ResampleFilter::kBicubic, ResampleFilter::kLanczos3}) {
+        for (const auto& [numerator, denominator] : {std::pair {2, 1}, std::pair {3, 2}, std::pair {2, 3}}) {
+            lumos::contracts::EnhancementRequest request;
+            request.input_path = input.string();
+            request.output_path = lumos::tests::tempOutputPath("resample_reference.ppm").string();
+            request.scale_factor = numerator;
+            request.scale_denominator = denominator;
+            request.filter = filter;
+            request.denoise_enabled = true;
+            const std::string label = std::string(lumos::contracts::toString(filter)) + " " + std::to_string(numerator) + "/" +
+                                      std::to_string(denominator);
+
+            lumos::engine::CpuStubPipeline full_frame;
+            const auto reference_result = full_frame.run(request);
+            lumos::tests::require(reference_result.ok, label + " full-frame run should succeed");
+            lumos::tests::require(
+                reference_result.metrics.output_width == lumos::contracts::scaledExtent(9, request) &&
+                    reference_result.metrics.output_height == lumos::contracts::scaledExtent(7, request),
+                label + " output dimensions");
+            const std::string reference = lumos::tests::readFileBytes(request.output_path);
+
+            for (const int band_rows : {1, 3, 64}) {
+                lumos::engine::CpuStubPipeline streaming({.memory_budget_bytes = 0, .band_rows = band_rows});
+                request.output_path = lumos::tests::tempOutputPath("resample_streaming_output.ppm").string();
+                lumos::tests::require(streaming.run(request).ok, label + " streaming run should succeed");
+                lumos::tests::require(
+                    lumos::tests::readFileBytes(request.output_path) == reference,
+                    label + " streaming output should match full frame for band_rows " + std::to_string(band_rows));
+            }
+        }
+    }
+}
+
+// The pipeline fuses denoise into the upscale; decode, blur, upscale and encode run as separate
+// whole-frame stages here and must produce the same file.
+void testDenoisedRunMatchesSeparateStages() {
+    std::string text = "P3\n11 8\n255\n";
+    for (int index = 0; index < 11 * 8 * 3; ++index) {
+        text += std::to_string((index * 97 + 5) % 256) + "\n";
+    }
+    const auto input = lumos::tests::writeTempFile("fused_input.ppm", text);
+    const lumos::engine::BoxBlurOptions blur {.radius = 2, .border = lumos::engine::BorderMode::kClamp};
+
+    using lumos::contracts::ResampleFilter;
+    for (const auto filter : {ResampleFilter::kNearest, ResampleFilter::kBicubic}) {
+        for (const auto& [numerator, denominator] : {std::pair {3, 1}, std::pair {3, 2}}) {
+            lumos::contracts::EnhancementRequest request;
+            request.input_path = input.string();
+            request.output_path = lumos::tests::tempOutputPath("fused_output.ppm").string();
+            request.scale_factor = numerator;
+            request.scale_denominator = denominator;
+            request.filter = filter;
+            request.denoise_enabled = true;
+            lumos::engine::CpuStubPipeline pipeline({.denoise = blur});
+            lumos::tests::require(pipeline.run(request).ok, "denoised run should succeed");
+
+            lumos::engine::PpmReader reader;
+            std::string error;
+            lumos::tests::require(reader.open(input.string(), &error), "reference decode should open");
+            lumos::engine::Rgb8Image decoded(11, 8);
+            lumos::tests::require(reader.readRows(decoded.mutableView(), &error), "reference decode should succeed");
+            lumos::engine::Rgb8Image blurred(11, 8);
+            lumos::engine::boxBlur(decoded.view(), blur, blurred.mutableView());
+            lumos::engine::PpmHeader header = reader.header();
+            header.width = lumos::contracts::scaledExtent(11, request);
+            header.height = lumos::contracts::scaledExtent(8, request);
+            lumos::engine::Rgb8Image upscaled(header.width, header.height);
+            lumos::engine::upscale(blurred.view(), filter, std::uint8_t {255}, upscaled.mutableView());
+            const auto reference_path = lumos::tests::tempOutputPath("fused_reference.ppm");
+            lumos::engine::PpmWriter writer;
+            lumos::tests::require(
+                writer.open(reference_path.string(), header, &error) && writer.writeRows(upscaled.view(), &error) &&
+                    writer.close(&error),
+                "reference encode should succeed");
+
+            lumos::tests::require(
+                lumos::tests::readFileBytes(request.output_path) == lumos::tests::readFileBytes(reference_path),
+                std::string(lumos::contracts::toString(filter)) + " denoised run should match blur then upscale");
+        }
+    }
+}
+
+void testEdgePreservingPresetStreamsLikeFullFrame() {
+    std::string text = "P5\n13 11\n4095\n";
+    for (int index = 0; index < 13 * 11; ++index) {
+        // A vertical step with noise on both sides, as big-endian 16-bit samples.
+        const int value = (index % 13 < 6 ? 500 : 3500) + (index * 53) % 200;
+        text.push_back(static_cast<char>(value >> 8));
+        text.push_back(static_cast<char>(value & 0xFF));
+    }
+    const auto input = lumos::tests::writeTempFile("edge_preserving_input.pgm", text);
+
+    lumos::contracts::EnhancementRequest request;
+    request.input_path = input.string();
+    request.output_path = lumos::tests::tempOutputPath("edge_preserving_reference.pgm").string();
+    request.scale_factor = 2;
+    request.filter = lumos::contracts::ResampleFilter::kBilinear;
+    request.denoise_enabled = true;
+    request.denoise_strength = 0.8f;
+    request.preset_name = std::string(lumos::contracts::kEdgePreservingPreset);
+
+    const lumos::engine::GuidedFilterOptions guided {.radius = 3};
+    lumos::engine::CpuStubPipeline full_frame({.guided_denoise = guided});
+    lumos::tests::require(full_frame.run(request).ok, "edge-preserving full-frame run should succeed");
+    const std::string reference = lumos::tests::readFileBytes(request.output_path);
+
+    request.preset_name = std::string(lumos::contracts::kDefaultPreset);
+    request.output_path = lumos::tests::tempOutputPath("edge_preserving_box.pgm").string();
+    lumos::tests::require(full_frame.run(request).ok, "default preset run should succeed");
+    lumos::tests::require(
+        lumos::tests::readFileBytes(request.output_path) != reference, "edge-preserving preset should not use the box blur");
+
+    request.preset_name = std::string(lumos::contracts::kEdgePreservingPreset);
+    for (const int band_rows : {1, 4, 64}) {
+        lumos::engine::CpuStubPipeline streaming({.memory_budget_bytes = 0, .band_rows = band_rows, .guided_denoise = guided});
+        request.output_path = lumos::tests::tempOutputPath("edge_preserving_streaming.pgm").string();
+        lumos::tests::require(streaming.run(request).ok, "edge-preserving streaming run should succeed");
+        lumos::tests::require(
+            lumos::tests::readFileBytes(request.output_path) == reference,
+            "edge-preserving streaming should match full frame for band_rows " + std::to_string(band_rows));
+    }
+}
+
+void testRejectsUnknownPresetAndStrength() {
+    lumos::engine::CpuStubPipeline pipeline;
+    lumos::contracts::EnhancementRequest request;
+    request.input_path = lumos::tests::fixturePath("sample_input.ppm").string();
+    request.output_path = lumos::tests::tempOutputPath("invalid_preset.ppm").string();
+
+    request.preset_name = "vivid";
+    lumos::tests::require(
+        pipeline.run(request).error.code == lumos::contracts::ErrorCode::kInvalidRequest, "unknown preset should be rejected");
+    request.preset_name = std::string(lumos::contracts::kEdgePreservingPreset);
+    for (const float strength : {-0.1f, 1.5f}) {
+        request.denoise_strength = strength;
+        lumos::tests::require(
+            pipeline.run(request).error.code == lumos::contracts::ErrorCode::kInvalidRequest,
+            "out-of-range denoise strength should be rejected");
+    }
+}
+
+// Sharpening runs fused on each upscaled row; it must match upscaling and then sharpening the
+// whole frame, in both the full-frame and streaming paths.
+void testSharpenedRunMatchesSeparateStages() {
+    std::string text = "P3\n10 7\n255\n";
+    for (int index = 0; index < 10 * 7 * 3; ++index) {
+        text += std::to_string((index * 71 + 29) % 256) + "\n";
+    }
+    const auto input = lumos::tests::writeTempFile("sharpen_input.ppm", text);
+    const lumos::engine::UnsharpMaskOptions sharpen {.radius = 2};
+
+    using lumos::contracts::ResampleFilter;
+    for (const auto& [filter, numerator] : {std::pair {ResampleFilter::kNearest, 8}, std::pair {ResampleFilter::kBicubic, 3}}) {
+        lumos::contracts::EnhancementRequest request;
+        request.input_path = input.string();
+        request.output_path = lumos::tests::tempOutputPath("sharpen_output.ppm").string();
+        request.scale_factor = numerator;
+        request.scale_denominator = 2;
+        request.filter = filter;
+        request.denoise_enabled = true;
+        request.sharpen_strength = 1.5f;
+        const std::string label = std::string(lumos::contracts::toString(filter));
+
+        lumos::engine::CpuStubPipeline full_frame({.sharpen = sharpen});
+        const auto result = full_frame.run(request);
+        lumos::tests::require(result.ok, label + " sharpened run should succeed");
+        lumos::tests::require(
+            std::ranges::any_of(result.metrics.stages, [](const auto& stage) { return stage.name == "sharpen"; }),
+            label + " sharpen should be timed as a stage");
+        const std::string output = lumos::tests::readFileBytes(request.output_path);
+
+        lumos::engine::PpmReader reader;
+        std::string error;
+        lumos::tests::require(reader.open(input.string(), &error), "reference decode should open");
+        lumos::engine::Rgb8Image decoded(10, 7);
+        lumos::tests::require(reader.readRows(decoded.mutableView(), &error), "reference decode should succeed");
+        lumos::engine::Rgb8Image blurred(10, 7);
+        lumos::engine::boxBlur(decoded.view(), {}, blurred.mutableView());
+        lumos::engine::PpmHeader header = reader.header();
+        header.width = lumos::contracts::scaledExtent(10, request);
+        header.height = lumos::contracts::scaledExtent(7, request);
+        lumos::engine::Rgb8Image upscaled(header.width, header.height);
+        lumos::engine::upscale(blurred.view(), filter, std::uint8_t {255}, upscaled.mutableView());
+        lumos::engine::unsharpMask(upscaled.view(), {.radius = 2, .strength = 1.5f}, upscaled.mutableView());
+        const auto reference_path = lumos::tests::tempOutputPath("sharpen_reference.ppm");
+        lumos::engine::PpmWriter writer;
+        lumos::tests::require(
+            writer.open(reference_path.string(), header, &error) && writer.writeRows(upscaled.view(), &error) &&
+                writer.close(&error),
+            "reference encode should succeed");
+        lumos::tests::require(
+            output == lumos::tests::readFileBytes(reference_path), label + " sharpened run should match upscale then sharpen");
+
+        for (const int band_rows : {1, 3, 64}) {
+            lumos::engine::CpuStubPipeline streaming({.memory_budget_bytes = 0, .band_rows = band_rows, .sharpen = sharpen});
+            request.output_path = lumos::tests::tempOutputPath("sharpen_streaming.ppm").string();
+            lumos::tests::require(streaming.run(request).ok, label + " sharpened streaming run should succeed");
+            lumos::tests::require(
+                lumos::tests::readFileBytes(request.output_path) == output,
+                label + " sharpened streaming should match full frame for band_rows " + std::to_string(band_rows));
+        }
+    }
+
+    lumos::contracts::EnhancementRequest invalid;
+    invalid.input_path = input.string();
+    invalid.output_path = lumos::tests::tempOutputPath("sharpen_invalid.ppm").string();
+    invalid.sharpen_strength = 2.5f;
+    lumos::engine::CpuStubPipeline pipeline;
+    lumos::tests::require(
+        pipeline.run(invalid).error.code == lumos::contracts::ErrorCode::kInvalidRequest, "sharpen strength above 2 should be rejected");
+}
+
+void testTiledRunMatchesStreaming() {
+    std::string text = "P6\n37 29\n255\n";
+    std::uint32_t state = 2463534242u;
+    for (int index = 0; index < 37 * 29 * 3; ++index) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        text.push_back(static_cast<char>(state % 256));
+    }
+    const auto input = lumos::tests::writeTempFile("tiled_input.ppm", text);
+
+    using lumos::contracts::ResampleFilter;
+    struct Case {
+        ResampleFilter filter;
+        int numerator;
+        int denominator;
+    };
+    for (const Case& scale : {Case {ResampleFilter::kNearest, 2, 1}, Case {ResampleFilter::kNearest, 3, 1},
+                              Case {ResampleFilter::kBilinear, 3, 2}, Case {ResampleFilter::kBicubic, 3, 1},
+                              Case {ResampleFilter::kLanczos3, 2, 3}}) {
+        for (const int denoise : {0, 1, 2}) {
+            for (const float sharpen : {0.0f, 1.2f}) {
+                lumos::contracts::EnhancementRequest request;
+                request.input_path = input.string();
+                request.scale_factor = scale.numerator;
+                request.scale_denominator = scale.denominator;
+                request.filter = scale.filter;
+                request.denoise_enabled = denoise > 0;
+                request.preset_name = denoise == 2 ? lumos::contracts::kEdgePreservingPreset : lumos::contracts::kDefaultPreset;
+                request.sharpen_strength = sharpen;
+                const std::string label = std::string(lumos::contracts::toString(scale.filter)) + " " +
+                                          std::to_string(scale.numerator) + "/" + std::to_string(scale.denominator) + " denoise " +
+                                          std::to_string(denoise) + " sharpen " + std::to_string(sharpen);
+
+                const lumos::engine::PipelineOptions common {
+                    .denoise = {.radius = 2, .border = lumos::engine::BorderMode::kMirror},
+                    .sharpen = {.radius = 2},
+                };
+                lumos::engine::PipelineOptions streaming_options = common;
+                streaming_options.memory_budget_bytes = 0;
+                request.output_path = lumos::tests::tempOutputPath("tiled_streaming.ppm").string();
+                lumos::tests::require(lumos::engine::CpuStubPipeline(streaming_options).run(request).ok, label + " streaming run");
+                const std::string expected = lumos::tests::readFileBytes(request.output_path);
+
+                for (const auto& [tile_size, overlap] : {std::pair {16, 6}, std::pair {23, 0}}) {
+                    lumos::engine::PipelineOptions tiled_options = common;
+                    tiled_options.tiling = {.tile_size = tile_size, .overlap = overlap, .threads = 3};
+                    request.output_path = lumos::tests::tempOutputPath("tiled_output.ppm").string();
+                    lumos::tests::require(lumos::engine::CpuStubPipeline(tiled_options).run(request).ok, label + " tiled run");
+                    lumos::tests::require(
+                        lumos::tests::readFileBytes(request.output_path) == expected,
+                        label + " tiled output should match streaming for tile " + std::to_string(tile_size));
+                }
+            }
+        }
+    }
+}
+
+void testRunMakesNoFrameCopies() {
+    std::string text = "P6\n64 48\n255\n";
+    for (int index = 0; index < 64 * 48 * 3; ++index) {
+        text.push_back(static_cast<char>((index * 37 + 11) % 256));
+    }
+    const auto input = lumos::tests::writeTempFile("copy_count_input.ppm", text);
+    const std::uint64_t frame_bytes = 64u * 48u * 3u;
+    const std::uint64_t halo_row_bytes = 64u * 3u;
+
+    lumos::contracts::EnhancementRequest request;
+    request.input_path = input.string();
+    request.output_path = lumos::tests::tempOutputPath("copy_count_output.ppm").string();
+    request.scale_factor = 4;
+    request.denoise_enabled = true;
+
+    lumos::engine::CpuStubPipeline full_frame;
+    std::uint64_t before = lumos::engine::copiedPixelBytes();
+    lumos::tests::require(full_frame.run(request).ok, "full-frame run should succeed");
+    lumos::tests::require(lumos::engine::copiedPixelBytes() == before, "full-frame run should copy no pixels");
+
+    // Streaming carries the two halo rows forward at each of the five band boundaries.
+    lumos::engine::CpuStubPipeline streaming({.memory_budget_bytes = 0, .band_rows = 8});
+    before = lumos::engine::copiedPixelBytes();
+    lumos::tests::require(streaming.run(request).ok, "streaming run should succeed");
+    const std::uint64_t copied = lumos::engine::copiedPixelBytes() - before;
+    lumos::tests::require(copied == 5u * 2u * halo_row_bytes, "streaming should copy only halo rows");
+    lumos::tests::require(copied < frame_bytes, "streaming copies should stay below one frame");
+}
+
+void testProgressAndCancellation() {
+    // Over a megabyte in and out, so decode and encode both take more than one step.
+    std::string text = "P6\n700 500\n255\n";
+    for (int index = 0; index < 700 * 500 * 3; ++index) {
+        text.push_back(static_cast<char>((index * 53 + index / 700) % 256));
+    }
+    const auto input = lumos::tests::writeTempFile("progress_input.ppm", text);
+    lumos::contracts::EnhancementRequest request;
+    request.input_path = input.string();
+    request.output_path = lumos::tests::tempOutputPath("progress_output.ppm").string();
+    request.scale_factor = 2;
+    request.denoise_enabled = true;
+
+    const lumos::engine::PipelineOptions full_frame {.tiling = {.tile_size = 256, .threads = 3}};
+    const lumos::engine::PipelineOptions streaming {.memory_budget_bytes = 0, .band_rows = 32};
+    for (const auto& [options, stages] :
+         {std::pair {full_frame, std::vector<std::string> {"decode", "enhance", "encode"}},
+          std::pair {streaming, std::vector<std::string> {"enhance"}}}) {
+        const std::string mode = options.memory_budget_bytes == 0 ? "streaming" : "full frame";
+        std::vector<std::pair<std::string, double>> reports;
+        lumos::contracts::RunControl control;
+        control.progress = [&](const std::string_view stage, const double fraction) { reports.emplace_back(stage, fraction); };
+        lumos::tests::require(lumos::engine::CpuStubPipeline(options).run(request, control).ok, mode + " run should succeed");
+        std::vector<std::string> seen;
+        for (std::size_t index = 0; index < reports.size(); ++index) {
+            const auto& [stage, fraction] = reports[index];
+            if (seen.empty() || seen.back() != stage) {
+                seen.push_back(stage);
+            } else {
+                lumos::tests::require(fraction >= reports[index - 1].second, mode + " progress should never go back");
+            }
+            lumos::tests::require(fraction > 0.0 && fraction <= 1.0, mode + " progress should be a fraction");
+            if (index + 1 == reports.size() || reports[index + 1].first != stage) {
+                lumos::tests::require(fraction == 1.0, mode + " " + stage + " should end at 1");
+            }
+        }
+        lumos::tests::require(seen == stages, mode + " should report its stages in order");
+
+        for (const std::string& stage : stages) {
+            std::filesystem::remove(request.output_path);
+            lumos::contracts::RunControl cancelling;
+            std::chrono::steady_clock::time_point cancelled_at {};
+            cancelling.progress = [&](const std::string_view reported, const double fraction) {
+                if (reported == stage && fraction < 1.0 && !cancelling.cancelled()) {
+                    cancelling.cancellation.cancel();
+                    cancelled_at = std::chrono::steady_clock::now();
+                }
+            };
+            const auto result = lumos::engine::CpuStubPipeline(options).run(request, cancelling);
+            const auto latency = std::chrono::steady_clock::now() - cancelled_at;
+            const std::string label = mode + " cancelled in " + stage;
+            lumos::tests::require(!result.ok && result.error.code == lumos::contracts::ErrorCode::kCancelled, label + " should fail as cancelled");
+            lumos::tests::require(result.error.stage == stage, label + " should stop in that stage");
+            lumos::tests::require(!std::filesystem::exists(request.output_path), label + " should leave no output");
+            // The target is 50 ms; leave headroom for a loaded machine.
+            lumos::tests::require(latency < std::chrono::milliseconds(250), label + " should stop promptly");
+        }
+    }
+
+    lumos::contracts::RunControl cancelled;
+    cancelled.cancellation.cancel();
+    lumos::tests::require(
+        lumos::engine::CpuStubPipeline().run(request, cancelled).error.code == lumos::contracts::ErrorCode::kCancelled,
+        "a run cancelled before it starts should not run");
 }
 
 }  // namespace
@@ -63,6 +514,16 @@ int main() {
         testRejectsInvalidRequest();
         testWritesExpectedOutputDimensions();
         testRejectsUnsupportedScaleFactor();
+        testOutputKeepsInputEncodingUnlessOverridden();
+        testStreamingMatchesFullFrameOutput();
+        testResampledStreamingMatchesFullFrame();
+        testDenoisedRunMatchesSeparateStages();
+        testEdgePreservingPresetStreamsLikeFullFrame();
+        testRejectsUnknownPresetAndStrength();
+        testSharpenedRunMatchesSeparateStages();
+        testTiledRunMatchesStreaming();
+        testRunMakesNoFrameCopies();
+        testProgressAndCancellation();
         std::cout << "PipelineContractTests passed\n";
         return 0;
     } catch (const std::exception& ex) {
@@ -0,0 +1,370 @@
+#include "engine/BoxBlur.h"
+#include "engine/CpuStubPipeline.h"
+#include "engine/ImageBuffer.h"
+#include "engine/Pipeline.h"
+#include "engine/PpmCodec.h"
+#include "engine/Sharpen.h"
+#include "engine/Stage.h"
+#include "engine/Upscale.h"
+#include "tests/TestHelpers.h"
+
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using lumos::engine::PpmHeader;
+using lumos::tests::samePixels;
+
+constexpr int kWidth = 53;
+constexpr int kHeight = 41;
+
+std::string writeInput() {
+    lumos::engine::Rgb8Image pixels(kWidth, kHeight);
+    for (int y = 0; y < kHeight; ++y) {
+        for (int x = 0; x < kWidth; ++x) {
+            for (int channel = 0; channel < 3; ++channel) {
+                pixels.at(x, y, channel) = static_cast<std::uint8_t>((x * 37 + y * 11 + channel * 89 + x * y * 7) % 256);
+            }
+        }
+    }
+    const auto path = lumos::tests::tempOutputPath("stage_pipeline_input.ppm").string();
+    std::string error;
+    lumos::tests::require(
+        lumos::engine::encodePpm(
+            {.max_value = 255, .pixels = std::move(pixels)}, lumos::engine::PpmFormat::kBinaryRgb, path, &error),
+        "input should encode");
+    return path;
+}
+
+lumos::engine::Rgb8Image decodeRgb(const std::string& path) {
+    lumos::engine::PpmReader reader;
+    std::string error;
+    lumos::tests::require(reader.open(path, &error), "decode should open " + path);
+    lumos::engine::Rgb8Image image(reader.header().width, reader.header().height);
+    lumos::tests::require(reader.readRows(image.mutableView(), &error), "decode should read " + path);
+    return image;
+}
+
+// Resample first, then denoise twice and sharpen on the upscaled frame: an order the standard
+// configuration cannot express.
+std::vector<std::unique_ptr<lumos::engine::IStage>> reorderedStages() {
+    using lumos::engine::BoxBlurOptions;
+    using lumos::engine::GuidedFilterOptions;
+    std::vector<std::unique_ptr<lumos::engine::IStage>> stages;
+    stages.push_back(std::make_unique<lumos::engine::DecodeStage>());
+    stages.push_back(std::make_unique<lumos::engine::ResampleStage>());
+    stages.push_back(std::make_unique<lumos::engine::DenoiseStage>(BoxBlurOptions {.radius = 2}, GuidedFilterOptions {}));
+    stages.push_back(std::make_unique<lumos::engine::SharpenStage>(lumos::engine::UnsharpMaskOptions {.radius = 1}));
+    stages.push_back(std::make_unique<lumos::engine::DenoiseStage>(BoxBlurOptions {.radius = 1}, GuidedFilterOptions {}));
+    stages.push_back(std::make_unique<lumos::engine::EncodeStage>());
+    return stages;
+}
+
+void testPlannerFusesAndSkipsStages() {
+    const lumos::engine::CpuStubPipeline pipeline;
+    const PpmHeader header {.format = lumos::engine::PpmFormat::kBinaryRgb, .width = 100, .height = 80, .max_value = 255};
+
+    lumos::contracts::EnhancementRequest request;
+    request.denoise_enabled = true;
+    request.sharpen_strength = 0.5f;
+    request.output_encoding = lumos::contracts::OutputEncoding::kAscii;
+    auto plan = pipeline.plan(request, header);
+    lumos::tests::require(plan.stages.size() == 3, "denoise, resample and sharpen should all run");
+    lumos::tests::require(
+        plan.groups.size() == 1 && plan.groups[0].first == 0 && plan.groups[0].last == 3, "the three should fuse into one group");
+    lumos::tests::require(
+        plan.stages[0].requirements.reads_window && plan.stages[0].requirements.halo == 1, "denoise reads a window with its halo");
+    lumos::tests::require(
+        plan.stages[1].output.width == 200 && plan.stages[2].input.width == 200, "stages after resample see the upscaled frame");
+    lumos::tests::require(
+        plan.output_header.format == lumos::engine::PpmFormat::kAsciiRgb, "encode should pick the requested encoding");
+    lumos::tests::require(plan.frame_bytes == (100 * 80 + 200 * 160) * 3, "the frames held are the decoded and the enhanced one");
+    lumos::tests::require(!plan.streamed, "a frame within budget should not stream");
+
+    request.denoise_enabled = false;
+    request.sharpen_strength = 0.0f;
+    request.scale_factor = 1;
+    plan = pipeline.plan(request, header);
+    lumos::tests::require(plan.stages.empty() && plan.groups.empty(), "a 1x nearest request without filters has nothing to run");
+    request.filter = lumos::contracts::ResampleFilter::kBilinear;
+    lumos::tests::require(pipeline.plan(request, header).stages.size() == 1, "a filtered resample runs even at 1x");
+
+    const lumos::engine::Pipeline reordered(reorderedStages(), {.memory_budget_bytes = 0});
+    request.scale_factor = 2;
+    request.denoise_enabled = true;
+    request.sharpen_strength = 0.5f;
+    plan = reordered.plan(request, header);
+    lumos::tests::require(plan.groups.size() == 3, "each denoise after another stage should start a group");
+    lumos::tests::require(
+        plan.groups[0].last == 1 && plan.groups[1].last == 3 && plan.groups[2].last == 4, "sharpen should fuse behind denoise");
+    lumos::tests::require(
+        !plan.groups[1].reuses_frame && plan.groups[2].reuses_frame, "a group should reuse the frame two back when sizes match");
+    lumos::tests::require(!plan.streamed, "several groups cannot stream");
+
+    bool rejected = false;
+    try {
+        std::vector<std::unique_ptr<lumos::engine::IStage>> stages;
+        stages.push_back(std::make_unique<lumos::engine::ResampleStage>());
+        stages.push_back(std::make_unique<lumos::engine::EncodeStage>());
+        const lumos::engine::Pipeline invalid(std::move(stages));
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    lumos::tests::require(rejected, "a pipeline without a decode stage should be rejected");
+}
+
+void testReorderedStagesMatchFrameByFrame() {
+    const std::string input = writeInput();
+    lumos::contracts::EnhancementRequest request;
+    request.input_path = input;
+    request.filter = lumos::contracts::ResampleFilter::kBicubic;
+    request.denoise_enabled = true;
+    request.sharpen_strength = 1.2f;
+
+    // Each stage over the whole frame, one after the other.
+    const auto decoded = decodeRgb(input);
+    const int width = lumos::contracts::scaledExtent(kWidth, request);
+    const int height = lumos::contracts::scaledExtent(kHeight, request);
+    lumos::engine::Rgb8Image upscaled(width, height);
+    lumos::engine::upscale(decoded.view(), request.filter, std::uint8_t {255}, upscaled.mutableView());
+    lumos::engine::Rgb8Image blurred(width, height);
+    lumos::engine::boxBlur(upscaled.view(), {.radius = 2}, blurred.mutableView());
+    lumos::engine::unsharpMask(blurred.view(), {.radius = 1, .strength = 1.2f}, blurred.mutableView());
+    lumos::engine::Rgb8Image expected(width, height);
+    lumos::engine::boxBlur(blurred.view(), {.radius = 1}, expected.mutableView());
+
+    for (const int tile_size : {16, 1 << 20}) {
+        lumos::engine::Pipeline pipeline(
+            reorderedStages(), {.memory_budget_bytes = 0, .tiling = {.tile_size = tile_size, .overlap = 8}});
+        request.output_path = lumos::tests::tempOutputPath("stage_pipeline_reordered.ppm").string();
+        const auto result = pipeline.run(request);
+        const std::string label = "tile size " + std::to_string(tile_size);
+        lumos::tests::require(result.ok, label + " run should succeed");
+        lumos::tests::require(
+            result.metrics.output_width == width && result.metrics.output_height == height, label + " dimensions");
+        lumos::tests::require(
+            samePixels(decodeRgb(request.output_path), expected), label + " should match the stages run frame by frame");
+    }
+}
+
+void testPassThroughStreamsAndCopies() {
+    const std::string input = writeInput();
+    lumos::contracts::EnhancementRequest request;
+    request.input_path = input;
+    request.scale_factor = 1;
+    for (const std::size_t budget : {std::size_t {0}, std::size_t {1} << 30}) {
+        request.output_path = lumos::tests::tempOutputPath("stage_pipeline_copy.ppm").string();
+        const lumos::engine::PipelineOptions options {.memory_budget_bytes = budget, .band_rows = 7};
+        lumos::tests::require(lumos::engine::CpuStubPipeline(options).run(request).ok, "copy should succeed");
+        lumos::tests::require(
+            lumos::tests::readFileBytes(request.output_path) == lumos::tests::readFileBytes(input),
+            "a request with nothing to do should copy the input, budget " + std::to_string(budget));
+    }
+}
+
+// A preview decodes every step-th row and column and runs the same chain on that proxy, so it must
+// match a full run over the proxy written out as its own file.
+void testPreviewRunsTheChainOnAProxy() {
+    const std::string input = writeInput();
+    lumos::contracts::EnhancementRequest request;
+    request.input_path = input;
+    request.denoise_enabled = true;
+    request.sharpen_strength = 0.5f;
+    request.preview_max_extent = 40;
+    // The 106x82 output needs step 3, giving a 18x14 proxy.
+    lumos::tests::require(lumos::contracts::previewStep(kWidth, kHeight, request) == 3, "the step should fit the extent");
+
+    const lumos::engine::Rgb8Image source = decodeRgb(input);
+    lumos::engine::Rgb8Image proxy(18, 14);
+    for (int y = 0; y < proxy.height(); ++y) {
+        for (int x = 0; x < proxy.width(); ++x) {
+            for (int channel = 0; channel < 3; ++channel) {
+                proxy.at(x, y, channel) = source.at(x * 3, y * 3, channel);
+            }
+        }
+    }
+    lumos::contracts::EnhancementRequest expected_request = request;
+    expected_request.preview_max_extent = 0;
+    expected_request.input_path = lumos::tests::tempOutputPath("stage_pipeline_proxy.ppm").string();
+    expected_request.output_path = lumos::tests::tempOutputPath("stage_pipeline_proxy_out.ppm").string();
+    std::string error;
+    lumos::tests::require(
+        lumos::engine::encodePpm(
+            {.max_value = 255, .pixels = proxy}, lumos::engine::PpmFormat::kBinaryRgb, expected_request.input_path, &error),
+        "proxy should encode");
+    lumos::tests::require(lumos::engine::CpuStubPipeline().run(expected_request).ok, "proxy run should succeed");
+    const lumos::engine::Rgb8Image expected = decodeRgb(expected_request.output_path);
+
+    for (const std::size_t budget : {std::size_t {0}, std::size_t {1} << 30}) {
+        request.output_path = lumos::tests::tempOutputPath("stage_pipeline_preview.ppm").string();
+        const auto result = lumos::engine::CpuStubPipeline({.memory_budget_bytes = budget, .band_rows = 5}).run(request);
+        const std::string label = budget == 0 ? "streamed" : "full frame";
+        lumos::tests::require(result.ok, label + " preview should succeed");
+        lumos::tests::require(result.metrics.output_width == 36 && result.metrics.output_height == 28, label + " preview size");
+        lumos::tests::require(samePixels(decodeRgb(request.output_path), expected), label + " preview should match the proxy run");
+    }
+
+    request.preview_max_extent = -1;
+    lumos::tests::require(!lumos::engine::CpuStubPipeline().run(request).ok, "a negative extent should be rejected");
+}
+
+lumos::engine::Rgb8Image cropOf(const lumos::engine::Rgb8Image& image, const lumos::contracts::ImageRegion& region) {
+    lumos::engine::Rgb8Image crop(region.width, region.height);
+    for (int y = 0; y < region.height; ++y) {
+        for (int x = 0; x < region.width; ++x) {
+            for (int channel = 0; channel < 3; ++channel) {
+                crop.at(x, y, channel) = image.at(region.x + x, region.y + y, channel);
+            }
+        }
+    }
+    return crop;
+}
+
+// A region runs the stages over only the pixels it depends on, so it must match the same rectangle
+// cut from a run of the whole image, tiled or streamed and with one group or several.
+void testRegionMatchesCropOfWholeRun() {
+    const std::string input = writeInput();
+    lumos::contracts::EnhancementRequest request;
+    request.input_path = input;
+    request.filter = lumos::contracts::ResampleFilter::kLanczos3;
+    request.denoise_enabled = true;
+    request.preset_name = std::string(lumos::contracts::kEdgePreservingPreset);
+    request.sharpen_strength = 0.8f;
+    const lumos::contracts::ImageRegion regions[] = {
+        {.x = 37, .y = 29, .width = 24, .height = 17},
+        {.x = 0, .y = 0, .width = 9, .height = 5},
+        {.x = 80, .y = 60, .width = 26, .height = 22},
+        {.x = 0, .y = 0, .width = 106, .height = 82},
+    };
+
+    const auto run_whole = [&](lumos::engine::Pipeline& pipeline, const std::string& name) {
+        request.region = {};
+        request.output_path = lumos::tests::tempOutputPath(name).string();
+        lumos::tests::require(pipeline.run(request).ok, name + " whole run should succeed");
+        return decodeRgb(request.output_path);
+    };
+    const auto require_regions = [&](lumos::engine::Pipeline& pipeline, const lumos::engine::Rgb8Image& whole,
+                                     const std::string& label) {
+        for (const auto& region : regions) {
+            request.region = region;
+            request.output_path = lumos::tests::tempOutputPath("stage_pipeline_region.ppm").string();
+            const auto result = pipeline.run(request);
+            const std::string at = label + " region at " + std::to_string(region.x) + "," + std::to_string(region.y);
+            lumos::tests::require(result.ok, at + " should succeed");
+            lumos::tests::require(
+                result.metrics.output_width == region.width && result.metrics.output_height == region.height, at + " size");
+            lumos::tests::require(
+                samePixels(decodeRgb(request.output_path), cropOf(whole, region)), at + " should match the crop");
+        }
+    };
+
+    lumos::engine::CpuStubPipeline reference;
+    const auto whole = run_whole(reference, "stage_pipeline_region_whole.ppm");
+    for (const std::size_t budget : {std::size_t {0}, std::size_t {1} << 30}) {
+        lumos::engine::CpuStubPipeline pipeline(
+            {.memory_budget_bytes = budget, .band_rows = 5, .tiling = {.tile_size = 16, .overlap = 8}});
+        require_regions(pipeline, whole, budget == 0 ? "streamed" : "tiled");
+    }
+    lumos::engine::Pipeline reordered(reorderedStages());
+    require_regions(reordered, run_whole(reordered, "stage_pipeline_region_reordered.ppm"), "reordered");
+
+    // The planner keeps only what the region reaches: the rows and columns of its halo.
+    const PpmHeader header {.format = lumos::engine::PpmFormat::kBinaryRgb, .width = kWidth, .height = kHeight, .max_value = 255};
+    request.region = regions[0];
+    const auto plan = reference.plan(request, header);
+    const lumos::engine::PixelRect& source = plan.regions.front();
+    lumos::tests::require(
+        plan.output_header.width == 24 && plan.regions.back() == lumos::engine::PixelRect {37, 29, 24, 17},
+        "the output is the region");
+    lumos::tests::require(
+        source.x > 0 && source.y > 0 && source.right() < kWidth && source.bottom() < kHeight,
+        "the input region should be interior");
+    lumos::tests::require(plan.frame_bytes < static_cast<std::size_t>(kWidth) * kHeight * 3, "a region holds less than a frame");
+
+    request.region = {.x = 100, .y = 0, .width = 7, .height = 5};
+    const auto outside = reference.run(request);
+    lumos::tests::require(
+        !outside.ok && outside.error.code == lumos::contracts::ErrorCode::kInvalidRequest,
+        "a region past the output should fail");
+    request.region = {.x = 0, .y = 0, .width = 5, .height = 0};
+    lumos::tests::require(!reference.run(request).ok, "a region with one side should be rejected");
+}
+
+void testRunReportsMetrics() {
+    const std::string input = writeInput();
+    lumos::contracts::EnhancementRequest request;
+    request.input_path = input;
+    request.denoise_enabled = true;
+    request.sharpen_strength = 0.5f;
+    const std::size_t frames = static_cast<std::size_t>(kWidth) * kHeight * 3 * (1 + 4);
+    for (const std::size_t budget : {std::size_t {0}, std::size_t {1} << 30}) {
+        request.output_path = lumos::tests::tempOutputPath("stage_pipeline_metrics.ppm").string();
+        const auto result = lumos::engine::CpuStubPipeline({.memory_budget_bytes = budget, .band_rows = 8}).run(request);
+        const std::string label = budget == 0 ? "streamed" : "full frame";
+        lumos::tests::require(result.ok, label + " run should succeed");
+        const auto& metrics = result.metrics;
+
+        const std::vector<std::string> names {"decode", "denoise", "resample", "sharpen", "encode"};
+        lumos::tests::require(metrics.stages.size() == names.size(), label + " should time every stage that ran");
+        for (std::size_t index = 0; index < names.size(); ++index) {
+            lumos::tests::require(metrics.stages[index].name == names[index], label + " stage " + names[index]);
+            lumos::tests::require(metrics.stages[index].duration_ns > 0, label + " " + names[index] + " should take time");
+        }
+        const std::uint64_t decode_and_encode = metrics.stages.front().duration_ns + metrics.stages.back().duration_ns;
+        lumos::tests::require(metrics.duration_ns >= decode_and_encode, label + " decode and encode are part of the run");
+        lumos::tests::require(
+            metrics.bytes_read == lumos::tests::readFileBytes(input).size(), label + " should read the whole input");
+        lumos::tests::require(
+            metrics.bytes_written == lumos::tests::readFileBytes(request.output_path).size(),
+            label + " should count the whole output");
+        lumos::tests::require(metrics.megapixels_per_second > 0.0 && metrics.threads >= 1, label + " throughput and threads");
+        if (budget == 0) {
+            lumos::tests::require(
+                metrics.peak_buffer_bytes > 0 && metrics.peak_buffer_bytes < frames, label + " should hold less than a frame");
+        } else {
+            lumos::tests::require(metrics.peak_buffer_bytes >= frames, label + " should hold the input and output frames");
+        }
+    }
+}
+
+void testOutputSignatureFollowsOutputSettings() {
+    const lumos::engine::PipelineOptions defaults;
+    const std::string signature = lumos::engine::outputSignature(defaults);
+    lumos::tests::require(signature.starts_with("lumos "), "the signature should start with the engine version");
+    lumos::tests::require(
+        lumos::engine::outputSignature({.memory_budget_bytes = 0, .band_rows = 8, .tiling = {.tile_size = 64}}) == signature,
+        "settings that do not change the output should not change the signature");
+    lumos::tests::require(
+        lumos::engine::outputSignature({.denoise = {.radius = 2}}) != signature, "the denoise radius should change it");
+    lumos::tests::require(
+        lumos::engine::outputSignature({.guided_denoise = {.strength = 0.25f}}) != signature,
+        "the guided strength should change it");
+    lumos::tests::require(
+        lumos::engine::outputSignature({.sharpen = {.radius = 3}}) != signature, "the sharpen radius should change it");
+}
+
+}  // namespace
+
+int main() {
+    try {
+        testPlannerFusesAndSkipsStages();
+        testReorderedStagesMatchFrameByFrame();
+        testPassThroughStreamsAndCopies();
+        testPreviewRunsTheChainOnAProxy();
+        testRegionMatchesCropOfWholeRun();
+        testRunReportsMetrics();
+        testOutputSignatureFollowsOutputSettings();
+        std::cout << "PipelineTests passed\n";
+        return 0;
+    } catch (const std::exception& ex) {
+        std::cerr << "PipelineTests failed: " << ex.what() << '\n';
+        return 1;
+    }
+}
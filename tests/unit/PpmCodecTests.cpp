@@ -0,0 +1,282 @@
+#include "engine/PpmCodec.h"
+#include "tests/TestHelpers.h"
+
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <variant>
+
+namespace {
+
+std::string decodeError(const std::string_view filename, const std::string_view contents) {
+    const auto path = lumos::tests::writeTempFile(filename, contents);
+    lumos::engine::Image image;
+    std::string error;
+    lumos::tests::require(!lumos::engine::decodePpm(path.string(), &image, &error), "decode should fail");
+    return error;
+}
+
+void testDecodesFixture() {
+    lumos::engine::Image image;
+    std::string error;
+    const bool ok = lumos::engine::decodePpm(lumos::tests::fixturePath("sample_input.ppm").string(), &image, &error);
+    lumos::tests::require(ok, "fixture should decode: " + error);
+    lumos::tests::require(image.width() == 2 && image.height() == 2, "fixture should be 2x2");
+    lumos::tests::require(image.max_value == 255, "fixture max value should be 255");
+    lumos::tests::require(image.sample(0, 0, 0) == 255 && image.sample(0, 0, 1) == 0, "first pixel should be red");
+    lumos::tests::require(image.sample(0, 1, 2) == 255 && image.sample(0, 1, 0) == 0, "third pixel should be blue");
+    lumos::tests::require(image.sample(1, 1, 0) == 255 && image.sample(1, 1, 2) == 255, "last pixel should be white");
+}
+
+void testHandlesCommentsWhitespaceAndClamping() {
+    const auto path = lumos::tests::writeTempFile(
+        "codec_comments.ppm",
+        "P3 # magic\n# full line comment\n2\t1\r\n100\n#inside data\n  -4 50 300\n+7 8x 9\n");
+
+    lumos::engine::Image image;
+    std::string error;
+    lumos::tests::require(lumos::engine::decodePpm(path.string(), &image, &error), "commented file should decode: " + error);
+    lumos::tests::require(image.width() == 2 && image.height() == 1, "dimensions should skip comments");
+    lumos::tests::require(image.max_value == 100, "max value should be parsed");
+    lumos::tests::require(image.sample(0, 0, 0) == 0, "negative samples should clamp to zero");
+    lumos::tests::require(image.sample(0, 0, 2) == 100, "large samples should clamp to max value");
+    lumos::tests::require(image.sample(1, 0, 0) == 7, "leading plus sign should be accepted");
+    lumos::tests::require(image.sample(1, 0, 1) == 8, "trailing token characters should be ignored");
+    lumos::tests::require(image.sample(1, 0, 2) == 9, "parsing should continue after a suffixed token");
+}
+
+void testKeepsLegacyErrorMessages() {
+    lumos::engine::Image image;
+    std::string error;
+    const auto missing = lumos::tests::tempOutputPath("codec_missing.ppm");
+    std::filesystem::remove(missing);
+    lumos::tests::require(!lumos::engine::decodePpm(missing.string(), &image, &error), "missing file should fail");
+    lumos::tests::require(error == "failed to open file", "missing file error should be preserved");
+
+    lumos::tests::require(
+        decodeError("codec_magic.ppm", "P7 1 1 255 0 0 0") == "unsupported or invalid ppm header",
+        "unknown magic should report header error");
+    lumos::tests::require(
+        decodeError("codec_short.ppm", "P3 1 1") == "unsupported or invalid ppm header",
+        "truncated header should report header error");
+    lumos::tests::require(
+        decodeError("codec_dims.ppm", "P3 x 1 255 0 0 0") == "invalid ppm dimensions",
+        "non-numeric width should report invalid dimensions");
+    lumos::tests::require(
+        decodeError("codec_zero.ppm", "P3 0 1 255 0 0 0") == "ppm dimensions must be positive",
+        "zero width should report non-positive dimensions");
+    lumos::tests::require(
+        decodeError("codec_incomplete.ppm", "P3 2 1 255 0 0 0 1 1") == "ppm data is incomplete",
+        "missing samples should report incomplete data");
+    lumos::tests::require(
+        decodeError("codec_huge.ppm", "P3 100000 100000 255 0 0 0") == "ppm data is incomplete",
+        "oversized header should be rejected before allocation");
+    lumos::tests::require(
+        decodeError("codec_binary_short.ppm", std::string_view("P6 2 1 255\n\x01\x02\x03", 14)) == "ppm data is incomplete",
+        "short binary raster should report incomplete data");
+    lumos::tests::require(
+        decodeError("codec_binary_range.ppm", "P5 1 1 70000\n\x01\x02") == "unsupported or invalid ppm header",
+        "binary max value above 65535 should be rejected");
+    lumos::tests::require(
+        decodeError("codec_bad_pixel.ppm", "P3 1 1 255 0 zz 0") == "ppm pixel parse failed",
+        "non-numeric sample should report parse failure");
+}
+
+void testBinaryRoundTripsEightAndSixteenBit() {
+    const std::string p6("P6\n# rgb\n2 1\n255\n\x0A\x14\x1E\xFF\x00\x80", 23);
+    const auto rgb_path = lumos::tests::writeTempFile("codec_rgb8.ppm", p6);
+
+    lumos::engine::Image rgb;
+    lumos::engine::PpmHeader header;
+    std::string error;
+    lumos::tests::require(lumos::engine::decodePpm(rgb_path.string(), &rgb, &error, &header), "P6 should decode: " + error);
+    lumos::tests::require(header.format == lumos::engine::PpmFormat::kBinaryRgb, "P6 header should report binary rgb");
+    lumos::tests::require(rgb.channels() == 3, "P6 should decode three channels");
+    lumos::tests::require(rgb.sample(0, 0, 0) == 10 && rgb.sample(0, 0, 1) == 20 && rgb.sample(0, 0, 2) == 30, "P6 first pixel mismatch");
+    lumos::tests::require(rgb.sample(1, 0, 0) == 255 && rgb.sample(1, 0, 1) == 0 && rgb.sample(1, 0, 2) == 128, "P6 second pixel mismatch");
+
+    const auto rgb_out = lumos::tests::tempOutputPath("codec_rgb8_out.ppm");
+    lumos::tests::require(
+        lumos::engine::encodePpm(rgb, lumos::engine::PpmFormat::kBinaryRgb, rgb_out.string(), &error),
+        "P6 should encode: " + error);
+    lumos::tests::require(std::filesystem::file_size(rgb_out) == std::string("P6\n2 1\n255\n").size() + 6, "P6 raster should be 3 bytes per pixel");
+
+    const std::string p5("P5 2 1 65535\n\x12\x34\xFF\xFE", 17);
+    const auto gray_path = lumos::tests::writeTempFile("codec_gray16.pgm", p5);
+    lumos::engine::Image gray;
+    lumos::tests::require(lumos::engine::decodePpm(gray_path.string(), &gray, &error, &header), "P5 should decode: " + error);
+    lumos::tests::require(header.format == lumos::engine::PpmFormat::kBinaryGray, "P5 header should report binary gray");
+    lumos::tests::require(gray.channels() == 1 && gray.max_value == 65535, "P5 should decode one 16-bit channel");
+    lumos::tests::require(gray.sample(0, 0, 0) == 0x1234 && std::holds_alternative<lumos::engine::Gray16Image>(gray.pixels), "16-bit samples should be big-endian");
+    lumos::tests::require(gray.sample(1, 0, 0) == 0xFFFE, "second 16-bit sample mismatch");
+
+    const auto gray_out = lumos::tests::tempOutputPath("codec_gray16_out.pgm");
+    lumos::tests::require(
+        lumos::engine::encodePpm(gray, lumos::engine::PpmFormat::kBinaryGray, gray_out.string(), &error),
+        "P5 should encode: " + error);
+    lumos::engine::Image reread;
+    lumos::tests::require(lumos::engine::decodePpm(gray_out.string(), &reread, &error), "P5 output should decode: " + error);
+    lumos::tests::require(reread.sample(0, 0, 0) == 0x1234 && reread.sample(1, 0, 0) == 0xFFFE, "P5 round trip should be lossless");
+}
+
+// A 7x5 image read with step 3 is the 3x2 proxy of pixels (0, 3, 6) x (0, 3); reading it skips the
+// rows between and, for binary files, ends at the end of the raster.
+void testSubsampledReadsKeepEveryStepthPixel() {
+    lumos::engine::Rgb16Image pixels(7, 5);
+    for (int y = 0; y < 5; ++y) {
+        for (int x = 0; x < 7; ++x) {
+            for (int channel = 0; channel < 3; ++channel) {
+                pixels.at(x, y, channel) = static_cast<std::uint16_t>(x * 1000 + y * 100 + channel);
+            }
+        }
+    }
+    const lumos::engine::Image image {.max_value = 65535, .pixels = pixels};
+    for (const auto format : {lumos::engine::PpmFormat::kAsciiRgb, lumos::engine::PpmFormat::kBinaryRgb}) {
+        const auto path = lumos::tests::tempOutputPath("codec_subsample.ppm").string();
+        std::string error;
+        lumos::tests::require(lumos::engine::encodePpm(image, format, path, &error), "subsample input should encode");
+        const std::string label = std::string(lumos::engine::magicFor(format)) + " ";
+
+        lumos::engine::PpmReader reader;
+        lumos::tests::require(reader.open(path, &error), label + "should open");
+        reader.subsample(3);
+        lumos::tests::require(reader.header().width == 3 && reader.header().height == 2, label + "proxy should be 3x2");
+        lumos::tests::require(reader.sourceHeader().width == 7 && reader.sourceHeader().height == 5, label + "source stays 7x5");
+        lumos::engine::Rgb16Image proxy(3, 2);
+        lumos::tests::require(
+            reader.readRows(proxy.mutableView().rows(0, 1), &error) && reader.readRows(proxy.mutableView().rows(1, 1), &error),
+            label + "proxy rows should read: " + error);
+        for (int y = 0; y < 2; ++y) {
+            for (int x = 0; x < 3; ++x) {
+                for (int channel = 0; channel < 3; ++channel) {
+                    lumos::tests::require(
+                        proxy.at(x, y, channel) == pixels.at(x * 3, y * 3, channel), label + "proxy pixel should be a source pixel");
+                }
+            }
+        }
+        if (lumos::engine::isBinary(format)) {
+            lumos::tests::require(reader.bytesRead() == std::filesystem::file_size(path), label + "should read to the raster's end");
+        }
+    }
+}
+
+void testCroppedReadsKeepTheRectangle() {
+    for (const int max_value : {255, 65535}) {
+        lumos::engine::Rgb16Image pixels(7, 5);
+        for (int y = 0; y < 5; ++y) {
+            for (int x = 0; x < 7; ++x) {
+                for (int channel = 0; channel < 3; ++channel) {
+                    pixels.at(x, y, channel) = static_cast<std::uint16_t>((x * 1000 + y * 100 + channel) % (max_value + 1));
+                }
+            }
+        }
+        const lumos::engine::Image image {.max_value = max_value, .pixels = pixels};
+        for (const auto format : {lumos::engine::PpmFormat::kAsciiRgb, lumos::engine::PpmFormat::kBinaryRgb}) {
+            const auto path = lumos::tests::tempOutputPath("codec_crop.ppm").string();
+            std::string error;
+            lumos::tests::require(lumos::engine::encodePpm(image, format, path, &error), "crop input should encode");
+            const std::string label = std::string(lumos::engine::magicFor(format)) + " max " + std::to_string(max_value) + " ";
+
+            // Step 1 keeps the rectangle itself; step 2 keeps it of the 4x3 proxy.
+            for (const int step : {1, 2}) {
+                const lumos::engine::PixelRect rect =
+                    step == 1 ? lumos::engine::PixelRect {2, 1, 4, 3} : lumos::engine::PixelRect {1, 1, 3, 2};
+                lumos::engine::PpmReader reader;
+                lumos::tests::require(reader.open(path, &error), label + "should open");
+                reader.subsample(step);
+                reader.crop(rect);
+                lumos::tests::require(
+                    reader.header().width == rect.width && reader.header().height == rect.height,
+                    label + "should read as the rectangle");
+                lumos::engine::Rgb16Image crop(rect.width, rect.height);
+                lumos::tests::require(
+                    reader.readRows(crop.mutableView().rows(0, 1), &error) &&
+                        reader.readRows(crop.mutableView().rows(1, rect.height - 1), &error),
+                    label + "cropped rows should read: " + error);
+                for (int y = 0; y < rect.height; ++y) {
+                    for (int x = 0; x < rect.width; ++x) {
+                        for (int channel = 0; channel < 3; ++channel) {
+                            lumos::tests::require(
+                                crop.at(x, y, channel) == pixels.at((rect.x + x) * step, (rect.y + y) * step, channel),
+                                label + "step " + std::to_string(step) + " pixel should come from the rectangle");
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void testAsciiEncoderKeepsLayoutAcrossFlushes() {
+    lumos::engine::Image image;
+    std::string error;
+    lumos::tests::require(
+        lumos::engine::decodePpm(lumos::tests::fixturePath("sample_input.ppm").string(), &image, &error),
+        "fixture should decode: " + error);
+
+    const auto small_out = lumos::tests::tempOutputPath("codec_ascii_layout.ppm");
+    lumos::tests::require(
+        lumos::engine::encodePpm(image, lumos::engine::PpmFormat::kAsciiRgb, small_out.string(), &error),
+        "fixture should encode: " + error);
+    std::ifstream written(small_out, std::ios::in | std::ios::binary);
+    const std::string text((std::istreambuf_iterator<char>(written)), std::istreambuf_iterator<char>());
+    lumos::tests::require(
+        text == "P3\n2 2\n255\n255 0 0\n0 255 0\n0 0 255\n255 255 255\n",
+        "ASCII output should keep one pixel per line");
+
+    // Large enough to cross several PpmWriter::kFlushBytes boundaries mid-row.
+    lumos::engine::Rgb16Image large_pixels(613, 401);
+    for (int y = 0; y < large_pixels.height(); ++y) {
+        for (int x = 0; x < large_pixels.width(); ++x) {
+            const auto index = static_cast<std::size_t>(y) * 613 + static_cast<std::size_t>(x);
+            const auto value = static_cast<std::uint16_t>((index * 7919) % 1001);
+            large_pixels.at(x, y, 0) = value;
+            large_pixels.at(x, y, 1) = static_cast<std::uint16_t>(1000 - value);
+            large_pixels.at(x, y, 2) = static_cast<std::uint16_t>(index % 10);
+        }
+    }
+    const lumos::engine::Image large {.max_value = 1000, .pixels = std::move(large_pixels)};
+
+    for (const auto format : {lumos::engine::PpmFormat::kAsciiRgb, lumos::engine::PpmFormat::kBinaryRgb}) {
+        const auto large_out = lumos::tests::tempOutputPath("codec_large_round_trip.ppm");
+        lumos::tests::require(
+            lumos::engine::encodePpm(large, format, large_out.string(), &error),
+            "large image should encode: " + error);
+        lumos::engine::Image reread;
+        lumos::tests::require(lumos::engine::decodePpm(large_out.string(), &reread, &error), "large image should decode: " + error);
+        lumos::tests::require(
+            reread.width() == large.width() && reread.height() == large.height(),
+            "large round trip should keep dimensions");
+        for (int y = 0; y < large.height(); ++y) {
+            for (int x = 0; x < large.width(); ++x) {
+                for (int channel = 0; channel < 3; ++channel) {
+                    lumos::tests::require(
+                        reread.sample(x, y, channel) == large.sample(x, y, channel),
+                        "large round trip should be lossless at " + std::to_string(x) + "," + std::to_string(y));
+                }
+            }
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    try {
+        testDecodesFixture();
+        testHandlesCommentsWhitespaceAndClamping();
+        testKeepsLegacyErrorMessages();
+        testBinaryRoundTripsEightAndSixteenBit();
+        testSubsampledReadsKeepEveryStepthPixel();
+        testCroppedReadsKeepTheRectangle();
+        testAsciiEncoderKeepsLayoutAcrossFlushes();
+        std::cout << "PpmCodecTests passed\n";
+        return 0;
+    } catch (const std::exception& ex) {
+        std::cerr << "PpmCodecTests failed: " << ex.what() << '\n';
+        return 1;
+    }
+}
@@ -0,0 +1,248 @@
+#include "engine/ImageBuffer.h"
+#include "engine/Resample.h"
+#include "engine/Upscale.h"
+#include "tests/TestHelpers.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <utility>
+
+namespace {
+
+using lumos::contracts::ResampleFilter;
+
+constexpr ResampleFilter kFilters[] = {
+    ResampleFilter::kNearest,
+    ResampleFilter::kBilinear,
+    ResampleFilter::kBicubic,
+    ResampleFilter::kLanczos3,
+};
+
+std::string filterLabel(const ResampleFilter filter) {
+    return std::string(lumos::contracts::toString(filter));
+}
+
+void testWeightTablesAreNormalizedAndCached() {
+    for (const auto filter : kFilters) {
+        for (const auto& [source, target] : {std::pair {10, 20}, std::pair {7, 16}, std::pair {16, 7}, std::pair {3, 24}, std::pair {1, 5}, std::pair {7, 21}}) {
+            const auto weights = lumos::engine::resampleWeights(filter, source, target);
+            const std::string label = filterLabel(filter) + " " + std::to_string(source) + "->" + std::to_string(target);
+            lumos::tests::require(weights->taps >= 1 && weights->taps <= source, label + " tap count");
+            for (int index = 0; index < target; ++index) {
+                const int first = weights->first[static_cast<std::size_t>(index)];
+                lumos::tests::require(first >= 0 && first + weights->taps <= source, label + " taps should stay inside the source");
+                lumos::tests::require(
+                    index == 0 || first >= weights->first[static_cast<std::size_t>(index) - 1], label + " windows should never move back");
+                int total = 0;
+                for (int tap = 0; tap < weights->taps; ++tap) {
+                    total += weights->weights[static_cast<std::size_t>(index * weights->taps + tap)];
+                }
+                lumos::tests::require(total == 1 << lumos::engine::kResampleWeightBits, label + " weights should sum to one");
+            }
+            lumos::tests::require(
+                lumos::engine::resampleWeights(filter, source, target) == weights, label + " weights should be cached");
+        }
+    }
+    lumos::tests::require(lumos::engine::resampleWeights(ResampleFilter::kBilinear, 100, 200)->taps == 2, "bilinear 2x taps");
+    lumos::tests::require(lumos::engine::resampleWeights(ResampleFilter::kBicubic, 100, 200)->taps == 4, "bicubic 2x taps");
+    lumos::tests::require(lumos::engine::resampleWeights(ResampleFilter::kLanczos3, 100, 200)->taps == 6, "lanczos3 2x taps");
+}
+
+template <typename Buffer>
+Buffer resampled(const Buffer& input, const ResampleFilter filter, const int width, const int height, const int max_value) {
+    Buffer output(width, height);
+    lumos::engine::resample(input.view(), filter, static_cast<typename Buffer::Sample>(max_value), output.mutableView());
+    return output;
+}
+
+void testFlatImagesStayFlat() {
+    lumos::engine::Rgb8Image rgb(13, 9);
+    lumos::engine::Gray16Image gray(13, 9);
+    for (int y = 0; y < 9; ++y) {
+        for (int x = 0; x < 13; ++x) {
+            for (int channel = 0; channel < 3; ++channel) {
+                rgb.at(x, y, channel) = static_cast<std::uint8_t>(40 + 90 * channel);
+            }
+            gray.at(x, y, 0) = 4095;
+        }
+    }
+    for (const auto filter : kFilters) {
+        for (const auto& [width, height] : {std::pair {26, 18}, std::pair {20, 13}, std::pair {5, 4}}) {
+            const auto rgb_out = resampled(rgb, filter, width, height, 255);
+            const auto gray_out = resampled(gray, filter, width, height, 4095);
+            for (int y = 0; y < height; ++y) {
+                for (int x = 0; x < width; ++x) {
+                    for (int channel = 0; channel < 3; ++channel) {
+                        lumos::tests::require(rgb_out.at(x, y, channel) == 40 + 90 * channel, filterLabel(filter) + " rgb8 should stay flat");
+                    }
+                    lumos::tests::require(gray_out.at(x, y, 0) == 4095, filterLabel(filter) + " gray16 should stay flat");
+                }
+            }
+        }
+    }
+}
+
+void testNearestMatchesPixelReplication() {
+    lumos::engine::Rgb8Image input(11, 6);
+    for (int y = 0; y < 6; ++y) {
+        for (int x = 0; x < 11; ++x) {
+            for (int channel = 0; channel < 3; ++channel) {
+                input.at(x, y, channel) = static_cast<std::uint8_t>(x * 23 + y * 7 + channel * 50);
+            }
+        }
+    }
+    for (const int scale_factor : {2, 3, 4}) {
+        lumos::engine::Rgb8Image replicated(11 * scale_factor, 6 * scale_factor);
+        lumos::engine::upscaleNearestNeighbor(input.view(), scale_factor, replicated.mutableView());
+        const auto filtered = resampled(input, ResampleFilter::kNearest, 11 * scale_factor, 6 * scale_factor, 255);
+        for (int y = 0; y < replicated.height(); ++y) {
+            for (int x = 0; x < replicated.width(); ++x) {
+                for (int channel = 0; channel < 3; ++channel) {
+                    lumos::tests::require(
+                        filtered.at(x, y, channel) == replicated.at(x, y, channel),
+                        "nearest resample should match replication at " + std::to_string(scale_factor) + "x");
+                }
+            }
+        }
+    }
+}
+
+void testRampsInterpolateLinearly() {
+    // Bilinear and Catmull-Rom reproduce linear ramps exactly between the edge pixels.
+    constexpr int kWidth = 24;
+    lumos::engine::Gray8Image ramp(kWidth, 4);
+    for (int y = 0; y < 4; ++y) {
+        for (int x = 0; x < kWidth; ++x) {
+            ramp.at(x, y, 0) = static_cast<std::uint8_t>(10 * x);
+        }
+    }
+    for (const auto filter : {ResampleFilter::kBilinear, ResampleFilter::kBicubic}) {
+        for (const auto& [numerator, denominator] : {std::pair {2, 1}, std::pair {3, 2}, std::pair {5, 2}}) {
+            const int width = kWidth * numerator / denominator;
+            const auto output = resampled(ramp, filter, width, 4 * numerator / denominator, 255);
+            for (int x = 0; x < width; ++x) {
+                const double position = (x + 0.5) * denominator / numerator - 0.5;
+                if (position < 2.0 || position > kWidth - 3.0) {
+                    continue;
+                }
+                const double expected = 10.0 * position;
+                lumos::tests::require(
+                    std::abs(output.at(x, 1, 0) - expected) <= 1.0,
+                    filterLabel(filter) + " ramp at " + std::to_string(x) + " should interpolate linearly");
+            }
+        }
+    }
+}
+
+void testOvershootClampsToMaxValue() {
+    lumos::engine::Gray16Image step(16, 3);
+    for (int y = 0; y < 3; ++y) {
+        for (int x = 0; x < 16; ++x) {
+            step.at(x, y, 0) = x < 8 ? 0 : 4095;
+        }
+    }
+    for (const auto filter : {ResampleFilter::kBicubic, ResampleFilter::kLanczos3}) {
+        const auto output = resampled(step, filter, 48, 9, 4095);
+        std::uint16_t largest = 0;
+        for (int x = 0; x < 48; ++x) {
+            largest = std::max(largest, output.at(x, 4, 0));
+        }
+        lumos::tests::require(largest == 4095, filterLabel(filter) + " ringing should clamp to max value");
+    }
+}
+
+void testUnitScaleIsIdentity() {
+    lumos::engine::Rgb16Image input(9, 5);
+    for (int y = 0; y < 5; ++y) {
+        for (int x = 0; x < 9; ++x) {
+            for (int channel = 0; channel < 3; ++channel) {
+                input.at(x, y, channel) = static_cast<std::uint16_t>((x * 7919 + y * 104729 + channel * 31) % 65536);
+            }
+        }
+    }
+    for (const auto filter : kFilters) {
+        const auto output = resampled(input, filter, 9, 5, 65535);
+        for (int y = 0; y < 5; ++y) {
+            for (int x = 0; x < 9; ++x) {
+                for (int channel = 0; channel < 3; ++channel) {
+                    lumos::tests::require(
+                        output.at(x, y, channel) == input.at(x, y, channel), filterLabel(filter) + " at 1x should copy the input");
+                }
+            }
+        }
+    }
+}
+
+// Rows of `region` produced on their own, fed only the source pixels they read.
+template <typename Upscaler>
+lumos::engine::Rgb8Image regionOf(const lumos::engine::Rgb8Image& input, Upscaler& upscaler, const lumos::engine::PixelRect& region) {
+    const lumos::engine::PixelRect source = upscaler.sourceRegion();
+    const auto window = input.view().region(source);
+    lumos::engine::Rgb8Image output(region.width, region.height);
+    for (int y = 0; y < source.height; ++y) {
+        upscaler.pushRow(window.row(y));
+        while (upscaler.rowReady()) {
+            upscaler.writeRow(output.mutableView().row(upscaler.rowsWritten()));
+        }
+    }
+    lumos::tests::require(upscaler.rowsWritten() == region.height, "region should be complete after its source rows");
+    return output;
+}
+
+void testRegionsMatchWholeImage() {
+    lumos::engine::Rgb8Image input(21, 15);
+    for (int y = 0; y < 15; ++y) {
+        for (int x = 0; x < 21; ++x) {
+            for (int channel = 0; channel < 3; ++channel) {
+                input.at(x, y, channel) = static_cast<std::uint8_t>((x * 53 + y * 97 + channel * 71) % 256);
+            }
+        }
+    }
+    constexpr lumos::engine::PixelRect kRegions[] = {{0, 0, 5, 4}, {3, 7, 9, 6}, {1, 1, 1, 1}};
+    for (const auto filter : kFilters) {
+        for (const auto& [width, height] : {std::pair {42, 30}, std::pair {63, 45}, std::pair {31, 22}, std::pair {10, 7}}) {
+            const auto whole = resampled(input, filter, width, height, 255);
+            const std::string label = filterLabel(filter) + " to " + std::to_string(width) + "x" + std::to_string(height);
+            for (lumos::engine::PixelRect region : kRegions) {
+                region.x = std::min(region.x, width - region.width);
+                region.y = std::min(region.y, height - region.height);
+                lumos::engine::Resampler<std::uint8_t> resampler(filter, 21, 15, width, height, 3, 255, region);
+                lumos::engine::RowUpscaler<std::uint8_t> upscaler(filter, 21, 15, width, height, 3, 255, region);
+                const auto resampled_region = regionOf(input, resampler, region);
+                const auto upscaled_region = regionOf(input, upscaler, region);
+                for (int y = 0; y < region.height; ++y) {
+                    for (int x = 0; x < region.width; ++x) {
+                        for (int channel = 0; channel < 3; ++channel) {
+                            const auto expected = whole.at(region.x + x, region.y + y, channel);
+                            lumos::tests::require(resampled_region.at(x, y, channel) == expected, label + " resampled region should match");
+                            lumos::tests::require(upscaled_region.at(x, y, channel) == expected, label + " upscaled region should match");
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    try {
+        testWeightTablesAreNormalizedAndCached();
+        testFlatImagesStayFlat();
+        testNearestMatchesPixelReplication();
+        testRampsInterpolateLinearly();
+        testOvershootClampsToMaxValue();
+        testUnitScaleIsIdentity();
+        testRegionsMatchWholeImage();
+        std::cout << "ResampleTests passed\n";
+        return 0;
+    } catch (const std::exception& ex) {
+        std::cerr << "ResampleTests failed: " << ex.what() << '\n';
+        return 1;
+    }
+}
@@ -0,0 +1,120 @@
+#include "engine/ImageBuffer.h"
+#include "engine/Sharpen.h"
+#include "tests/TestHelpers.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <string>
+
+namespace {
+
+using lumos::tests::makeNoise;
+
+template <typename Buffer>
+Buffer sharpened(const Buffer& input, const lumos::engine::UnsharpMaskOptions& options) {
+    Buffer output(input.width(), input.height());
+    lumos::engine::unsharpMask(input.view(), options, output.mutableView());
+    return output;
+}
+
+// Direct per-pixel unsharp mask with the neighbourhood clamp, edge pixels repeated.
+template <typename Buffer>
+double referenceSample(const Buffer& input, const int x, const int y, const int channel, const int radius, const double strength) {
+    double sum = 0.0;
+    double lowest = 1.0e9;
+    double highest = -1.0;
+    for (int dy = -radius; dy <= radius; ++dy) {
+        for (int dx = -radius; dx <= radius; ++dx) {
+            const double value = input.at(std::clamp(x + dx, 0, input.width() - 1), std::clamp(y + dy, 0, input.height() - 1), channel);
+            sum += value;
+            lowest = std::min(lowest, value);
+            highest = std::max(highest, value);
+        }
+    }
+    const double value = input.at(x, y, channel);
+    const double blurred = sum / ((2.0 * radius + 1) * (2.0 * radius + 1));
+    return std::clamp(value + strength * (value - blurred), lowest, highest);
+}
+
+template <typename Buffer>
+void requireMatchesReference(const std::string& label, const int width, const int height, const int max_value) {
+    const Buffer input = makeNoise<Buffer>(width, height, 0xBADC0DEu + static_cast<std::uint32_t>(height), max_value);
+    for (const int radius : {1, 2, 4}) {
+        for (const float strength : {0.3f, 1.0f, 2.0f}) {
+            const Buffer output = sharpened(input, {.radius = radius, .strength = strength});
+            for (int y = 0; y < height; ++y) {
+                for (int x = 0; x < width; ++x) {
+                    for (int channel = 0; channel < Buffer::kChannels; ++channel) {
+                        const double expected = referenceSample(input, x, y, channel, radius, strength);
+                        lumos::tests::require(
+                            std::abs(output.at(x, y, channel) - expected) <= 1.0,
+                            label + " radius " + std::to_string(radius) + " should match the reference at " + std::to_string(x) +
+                                "," + std::to_string(y));
+                    }
+                }
+            }
+        }
+    }
+}
+
+void testMatchesReference() {
+    requireMatchesReference<lumos::engine::Rgb8Image>("rgb8", 15, 9, 255);
+    requireMatchesReference<lumos::engine::Gray16Image>("gray16", 7, 12, 65535);
+    requireMatchesReference<lumos::engine::Gray8Image>("gray8 single row", 5, 1, 255);
+}
+
+void testEdgeSharpensWithoutHalos() {
+    // A soft edge: flat 60, a ramp of 24 per pixel, flat 180.
+    constexpr int kWidth = 16;
+    lumos::engine::Gray8Image edge(kWidth, 5);
+    for (int y = 0; y < 5; ++y) {
+        for (int x = 0; x < kWidth; ++x) {
+            edge.at(x, y, 0) = static_cast<std::uint8_t>(std::clamp(60 + (x - 3) * 24, 60, 180));
+        }
+    }
+    const auto output = sharpened(edge, {.radius = 2, .strength = 2.0f});
+    for (int y = 0; y < 5; ++y) {
+        // The ramp steepens at both ends...
+        lumos::tests::require(output.at(4, y, 0) < 84, "foot of the edge should darken");
+        lumos::tests::require(output.at(7, y, 0) > 156, "shoulder of the edge should brighten");
+        // ...but nothing leaves the range of its neighbourhood, so no rims form on the flats.
+        for (int x = 0; x < kWidth; ++x) {
+            lumos::tests::require(output.at(x, y, 0) >= 60 && output.at(x, y, 0) <= 180, "sharpening should not overshoot");
+        }
+        lumos::tests::require(output.at(2, y, 0) == 60 && output.at(10, y, 0) == 180, "flats beside the edge should stay flat");
+    }
+}
+
+void testZeroStrengthAndInPlace() {
+    const auto input = makeNoise<lumos::engine::Rgb8Image>(12, 8, 31337u, 255);
+    const auto unchanged = sharpened(input, {.radius = 3, .strength = 0.0f});
+    const auto expected = sharpened(input, {.radius = 1, .strength = 0.8f});
+    auto in_place = input;
+    lumos::engine::unsharpMask(in_place.view(), {.radius = 1, .strength = 0.8f}, in_place.mutableView());
+    for (int y = 0; y < 8; ++y) {
+        for (int x = 0; x < 12; ++x) {
+            for (int channel = 0; channel < 3; ++channel) {
+                lumos::tests::require(unchanged.at(x, y, channel) == input.at(x, y, channel), "strength 0 should copy the input");
+                lumos::tests::require(in_place.at(x, y, channel) == expected.at(x, y, channel), "in-place sharpening should match");
+            }
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    try {
+        testMatchesReference();
+        testEdgeSharpensWithoutHalos();
+        testZeroStrengthAndInPlace();
+        std::cout << "SharpenTests passed\n";
+        return 0;
+    } catch (const std::exception& ex) {
+        std::cerr << "SharpenTests failed: " << ex.what() << '\n';
+        return 1;
+    }
+}
@@ -7,6 +7,7 @@
 #include <exception>
 #include <filesystem>
 #include <iostream>
+#include <string>
 
 namespace {
 
@@ -45,9 +46,16 @@ void testSuccessPathEmitsRequiredEvents() {
 
     const auto* completed = findEvent(events, "enhance_completed");
     lumos::tests::require(completed != nullptr, "enhance_completed should be emitted");
+    for (const char* field : {"duration_ms", "duration_ns", "bytes_read", "bytes_written", "megapixels_per_second",
+                              "peak_buffer_bytes", "threads", "stage_decode_ns", "stage_encode_ns", "cache_hit",
+                              "cache_saved_ns"}) {
+        lumos::tests::require(
+            completed->fields.find(field) != completed->fields.end(),
+            std::string("enhance_completed should include ") + field);
+    }
     lumos::tests::require(
-        completed->fields.find("duration_ms") != completed->fields.end(),
-        "enhance_completed should include duration_ms");
+        completed->fields.find("stage_sharpen_ns") == completed->fields.end(),
+        "enhance_completed should only time the stages that ran");
 
     lumos::tests::requireFileSizePositive(log_path, "telemetry log should be written");
 }
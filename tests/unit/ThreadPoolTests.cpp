@@ -0,0 +1,156 @@
+#include "app/EnhancementController.h"
+#include "common/Telemetry.h"
+#include "common/ThreadPool.h"
+#include "tests/TestHelpers.h"
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <future>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Records how many runs overlap, holding each run long enough for the others to pile up.
+class CountingPipeline final : public lumos::contracts::IEnhancementPipeline {
+  public:
+    lumos::contracts::EnhancementResult run(const lumos::contracts::EnhancementRequest& request) override {
+        const int now = ++running_;
+        for (int seen = peak_.load(); now > seen && !peak_.compare_exchange_weak(seen, now);) {
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        --running_;
+        lumos::contracts::EnhancementResult result;
+        result.ok = true;
+        result.output_path = request.output_path;
+        return result;
+    }
+
+    [[nodiscard]] int peak() const { return peak_.load(); }
+
+  private:
+    std::atomic<int> running_ {0};
+    std::atomic<int> peak_ {0};
+};
+
+void testSubmitDeliversResultsAndExceptions() {
+    lumos::common::ThreadPool pool(3);
+    lumos::tests::require(pool.workerCount() == 3, "pool should start the workers it was asked for");
+    lumos::tests::require(!pool.onWorkerThread(), "the test thread is not a worker");
+
+    std::vector<std::future<int>> results;
+    for (int index = 0; index < 100; ++index) {
+        results.push_back(pool.submit([index] { return index * index; }));
+    }
+    for (int index = 0; index < 100; ++index) {
+        lumos::tests::require(results[static_cast<std::size_t>(index)].get() == index * index, "submit should return the task's result");
+    }
+
+    auto on_worker = pool.submit([&pool] { return pool.onWorkerThread(); });
+    lumos::tests::require(on_worker.get(), "tasks should run on the pool's workers");
+
+    auto failing = pool.submit([]() -> int { throw std::runtime_error("task failed"); });
+    bool thrown = false;
+    try {
+        static_cast<void>(failing.get());
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    lumos::tests::require(thrown, "a task's exception should reach its future");
+}
+
+void testParallelForNestsAndCaps() {
+    lumos::common::ThreadPool pool(2);
+    // Every outer index blocks a thread on an inner loop; the callers take part, so this cannot
+    // run out of workers.
+    std::vector<std::atomic<int>> hits(64 * 16);
+    pool.parallelFor(64, [&](const int outer) {
+        pool.parallelFor(16, [&](const int inner) { ++hits[static_cast<std::size_t>(outer * 16 + inner)]; });
+    });
+    for (const auto& hit : hits) {
+        lumos::tests::require(hit.load() == 1, "nested parallelFor should run every index exactly once");
+    }
+
+    std::atomic<int> running {0};
+    std::atomic<int> peak {0};
+    pool.parallelFor(
+        32,
+        [&](int) {
+            const int now = ++running;
+            for (int seen = peak.load(); now > seen && !peak.compare_exchange_weak(seen, now);) {
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            --running;
+        },
+        2);
+    lumos::tests::require(peak.load() <= 2, "parallelFor should not exceed max_parallel");
+
+    std::atomic<int> started {0};
+    bool thrown = false;
+    try {
+        pool.parallelFor(1000, [&](const int index) {
+            ++started;
+            if (index == 3) {
+                throw std::runtime_error("index failed");
+            }
+        });
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    lumos::tests::require(thrown, "parallelFor should rethrow a task's exception");
+    lumos::tests::require(started.load() < 1000, "indices after a failure should be skipped");
+}
+
+void testDestructorRunsQueuedTasks() {
+    std::atomic<int> ran {0};
+    {
+        lumos::common::ThreadPool pool(1);
+        for (int index = 0; index < 50; ++index) {
+            static_cast<void>(pool.submit([&ran] {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+                ++ran;
+            }));
+        }
+    }
+    lumos::tests::require(ran.load() == 50, "destroying the pool should finish the queued tasks");
+}
+
+void testControllerQueuesOnThePool() {
+    lumos::common::Telemetry telemetry(lumos::tests::tempOutputPath("thread_pool_events.jsonl"));
+    CountingPipeline pipeline;
+    lumos::common::ThreadPool pool(2);
+    std::vector<std::future<lumos::contracts::EnhancementResult>> results;
+    {
+        lumos::app::EnhancementController controller(pipeline, telemetry, pool);
+        for (int index = 0; index < 40; ++index) {
+            lumos::contracts::EnhancementRequest request;
+            request.output_path = "out_" + std::to_string(index) + ".ppm";
+            results.push_back(controller.runEnhancementAsync(std::move(request)));
+        }
+    }
+    for (auto& result : results) {
+        lumos::tests::require(result.wait_for(std::chrono::seconds(5)) == std::future_status::ready, "queued runs should finish");
+        lumos::tests::require(result.get().ok, "queued runs should succeed");
+    }
+    lumos::tests::require(pipeline.peak() <= 2, "no more runs than workers should overlap");
+}
+
+}  // namespace
+
+int main() {
+    try {
+        testSubmitDeliversResultsAndExceptions();
+        testParallelForNestsAndCaps();
+        testDestructorRunsQueuedTasks();
+        testControllerQueuesOnThePool();
+        std::cout << "ThreadPoolTests passed\n";
+        return 0;
+    } catch (const std::exception& ex) {
+        std::cerr << "ThreadPoolTests failed: " << ex.what() << '\n';
+        return 1;
+    }
+}
@@ -0,0 +1,177 @@
+#include "engine/ImageBuffer.h"
+#include "engine/TileProcessor.h"
+#include "tests/TestHelpers.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+
+namespace {
+
+using lumos::engine::PixelRect;
+using lumos::engine::Tile;
+
+void testGridTilesTheImage() {
+    for (const auto& [width, height, tile_size, overlap] :
+         {std::tuple {100, 70, 32, 8}, std::tuple {513, 37, 128, 32}, std::tuple {20, 20, 512, 32}, std::tuple {90, 45, 10, 0},
+          std::tuple {60, 50, 16, 31}}) {
+        const auto grid = lumos::engine::planTiles(width, height, tile_size, overlap);
+        const std::string label =
+            std::to_string(width) + "x" + std::to_string(height) + " tile " + std::to_string(tile_size) + " overlap " + std::to_string(overlap);
+        lumos::tests::require(grid.column_edges.front() == 0 && grid.column_edges.back() == width, label + " columns should span the width");
+        lumos::tests::require(grid.row_edges.front() == 0 && grid.row_edges.back() == height, label + " rows should span the height");
+        for (int column = 0; column < grid.columns(); ++column) {
+            for (int row = 0; row < grid.rows(); ++row) {
+                const Tile tile = grid.tile(column, row);
+                // Only an overlap wider than half a tile may stretch cores past the tile size.
+                lumos::tests::require(tile.core.width <= std::max(tile_size, 2 * overlap), label + " cores should not exceed the tile size");
+                if (grid.columns() > 1) {
+                    lumos::tests::require(tile.core.width >= overlap, label + " cores should be at least the overlap wide");
+                }
+                if (grid.rows() > 1) {
+                    lumos::tests::require(tile.core.height >= overlap, label + " cores should be at least the overlap tall");
+                }
+                const int left = column > 0 ? overlap / 2 : 0;
+                const int right = column + 1 < grid.columns() ? overlap - overlap / 2 : 0;
+                const int top = row > 0 ? overlap / 2 : 0;
+                const int bottom = row + 1 < grid.rows() ? overlap - overlap / 2 : 0;
+                const PixelRect expected {
+                    tile.core.x - left, tile.core.y - top, tile.core.width + left + right, tile.core.height + top + bottom};
+                lumos::tests::require(tile.extended == expected, label + " extended tiles should cross each seam by half the overlap");
+            }
+        }
+    }
+}
+
+lumos::engine::Rgb8Image makePattern(const int width, const int height) {
+    lumos::engine::Rgb8Image image(width, height);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            for (int channel = 0; channel < 3; ++channel) {
+                image.at(x, y, channel) = static_cast<std::uint8_t>((x * 31 + y * 17 + channel * 101 + x * y) % 256);
+            }
+        }
+    }
+    return image;
+}
+
+void testTilesThatAgreeReassembleExactly() {
+    const auto source = makePattern(157, 93);
+    for (const int threads : {1, 4}) {
+        for (const auto& [tile_size, overlap] : {std::pair {32, 8}, std::pair {40, 17}, std::pair {64, 0}, std::pair {1024, 32}}) {
+            lumos::engine::TileProcessor<std::uint8_t> processor(
+                157, 93, 3, {.tile_size = tile_size, .overlap = overlap, .threads = threads});
+            lumos::engine::Rgb8Image output(157, 93);
+            std::atomic<int> calls {0};
+            processor.run(
+                [&](const Tile& tile, const lumos::engine::MutableImageView<std::uint8_t> target) {
+                    lumos::engine::copyPixels(source.view().region(tile.extended), target);
+                    ++calls;
+                },
+                output.mutableView());
+            const std::string label = "tile " + std::to_string(tile_size) + " overlap " + std::to_string(overlap) + " threads " +
+                                      std::to_string(threads);
+            lumos::tests::require(
+                calls == processor.grid().columns() * processor.grid().rows(), label + " should process every tile once");
+            for (int y = 0; y < 93; ++y) {
+                for (int x = 0; x < 157; ++x) {
+                    for (int channel = 0; channel < 3; ++channel) {
+                        lumos::tests::require(output.at(x, y, channel) == source.at(x, y, channel), label + " should match the source");
+                    }
+                }
+            }
+        }
+    }
+}
+
+void testSeamsRampBetweenTiles() {
+    // Two tiles side by side, 1000 on the left and 3000 on the right, blended over 16 columns.
+    lumos::engine::TileProcessor<std::uint16_t> processor(64, 4, 1, {.tile_size = 32, .overlap = 16, .threads = 2});
+    lumos::tests::require(processor.grid().columns() == 2 && processor.grid().rows() == 1, "grid should be two tiles wide");
+    lumos::engine::Gray16Image output(64, 4);
+    processor.run(
+        [](const Tile& tile, const lumos::engine::MutableImageView<std::uint16_t> target) {
+            const auto value = static_cast<std::uint16_t>(tile.core.x == 0 ? 1000 : 3000);
+            for (int y = 0; y < target.height; ++y) {
+                std::fill_n(target.row(y), target.rowSamples(), value);
+            }
+        },
+        output.mutableView());
+    for (int y = 0; y < 4; ++y) {
+        for (int x = 0; x < 64; ++x) {
+            const int value = output.at(x, y, 0);
+            if (x < 24) {
+                lumos::tests::require(value == 1000, "left of the ramp should keep the left tile");
+            } else if (x >= 40) {
+                lumos::tests::require(value == 3000, "right of the ramp should keep the right tile");
+            } else {
+                const int expected = (1000 * (32 - (2 * (x - 24) + 1)) + 3000 * (2 * (x - 24) + 1) + 16) / 32;
+                lumos::tests::require(value == expected, "seam should ramp linearly");
+            }
+        }
+    }
+}
+
+void testTileFailuresPropagate() {
+    lumos::engine::TileProcessor<std::uint8_t> processor(96, 96, 3, {.tile_size = 32, .overlap = 8, .threads = 3});
+    lumos::engine::Rgb8Image output(96, 96);
+    bool thrown = false;
+    try {
+        processor.run(
+            [](const Tile& tile, lumos::engine::MutableImageView<std::uint8_t>) {
+                if (tile.core.x > 0 && tile.core.y > 0) {
+                    throw std::runtime_error("tile failed");
+                }
+            },
+            output.mutableView());
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    lumos::tests::require(thrown, "a failing tile should fail the run");
+}
+
+void testTileSizeFollowsCachesAndBudget() {
+    const lumos::engine::CacheSizes caches {.l2 = std::size_t {1} << 20, .l3 = std::size_t {32} << 20};
+    const std::size_t plenty = std::size_t {1} << 30;
+    const int from_l2 = lumos::engine::chooseTileSize(8000, 3, 32, 8, plenty, caches);
+    lumos::tests::require(from_l2 == 416, "half of a 1 MiB L2 at 3 bytes per pixel should give 416");
+    lumos::tests::require(
+        lumos::engine::chooseTileSize(8000, 3, 32, 128, plenty, caches) < from_l2, "a small L3 share per thread should shrink tiles");
+    lumos::tests::require(
+        lumos::engine::chooseTileSize(8000, 3, 32, 8, plenty, {}) % 16 == 0, "tiles without cache sizes should still be aligned");
+    const int squeezed = lumos::engine::chooseTileSize(8000, 3, 32, 8, std::size_t {4} << 20, caches);
+    lumos::tests::require(squeezed < from_l2 && squeezed >= 32, "a small budget should shrink tiles down to the overlap");
+    const auto tileCount = [](const lumos::engine::TileOptions& options) {
+        const lumos::engine::TileProcessor<std::uint8_t> processor(4000, 3000, 3, options);
+        return processor.grid().columns() * processor.grid().rows();
+    };
+    lumos::tests::require(tileCount({.threads = 1}) == 1, "one thread should run a frame that fits the budget as one tile");
+    lumos::tests::require(tileCount({.threads = 2}) > 1, "several threads should split the frame");
+    lumos::tests::require(
+        tileCount({.threads = 1, .memory_budget_bytes = std::size_t {1} << 20}) > 1, "a frame over the budget should still be tiled");
+    lumos::tests::require(tileCount({.tile_size = 512, .threads = 1}) > 1, "an explicit tile size should be kept");
+    lumos::tests::require(lumos::engine::resolveThreadCount(3) == 3 && lumos::engine::resolveThreadCount(0) >= 1, "thread count");
+}
+
+}  // namespace
+
+int main() {
+    try {
+        testGridTilesTheImage();
+        testTilesThatAgreeReassembleExactly();
+        testSeamsRampBetweenTiles();
+        testTileFailuresPropagate();
+        testTileSizeFollowsCachesAndBudget();
+        std::cout << "TileProcessorTests passed\n";
+        return 0;
+    } catch (const std::exception& ex) {
+        std::cerr << "TileProcessorTests failed: " << ex.what() << '\n';
+        return 1;
+    }
+}
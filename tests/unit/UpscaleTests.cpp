@@ -0,0 +1,83 @@
+#include "engine/ImageBuffer.h"
+#include "engine/Resample.h"
+#include "engine/Upscale.h"
+#include "tests/TestHelpers.h"
+
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <string>
+
+namespace {
+
+using lumos::contracts::ResampleFilter;
+using lumos::tests::makeNoise;
+using lumos::tests::samePixels;
+
+template <typename Buffer>
+void requireMatchesPerPixelReference(const std::string& label, const int width, const int height) {
+    Buffer input(width, height);
+    std::uint32_t state = 0x2468ACEu + static_cast<std::uint32_t>(width);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            for (int channel = 0; channel < Buffer::kChannels; ++channel) {
+                state = state * 1664525u + 1013904223u;
+                input.at(x, y, channel) = static_cast<typename Buffer::Sample>(state >> 8);
+            }
+        }
+    }
+
+    for (const int scale_factor : {2, 3, 4, 8}) {
+        Buffer output(width * scale_factor, height * scale_factor);
+        lumos::engine::upscaleNearestNeighbor(input.view(), scale_factor, output.mutableView());
+        for (int y = 0; y < output.height(); ++y) {
+            for (int x = 0; x < output.width(); ++x) {
+                for (int channel = 0; channel < Buffer::kChannels; ++channel) {
+                    lumos::tests::require(
+                        output.at(x, y, channel) == input.at(x / scale_factor, y / scale_factor, channel),
+                        label + " " + std::to_string(scale_factor) + "x should match the per-pixel reference at " +
+                            std::to_string(x) + "," + std::to_string(y));
+                }
+            }
+        }
+    }
+}
+
+void testMatchesPerPixelReference() {
+    requireMatchesPerPixelReference<lumos::engine::Rgb8Image>("rgb8", 13, 5);
+    requireMatchesPerPixelReference<lumos::engine::Gray8Image>("gray8", 33, 3);
+    requireMatchesPerPixelReference<lumos::engine::Rgb16Image>("rgb16", 7, 4);
+    requireMatchesPerPixelReference<lumos::engine::Gray16Image>("gray16", 1, 1);
+    requireMatchesPerPixelReference<lumos::engine::ImageBuffer<std::uint8_t, 4>>("rgba8", 9, 2);
+}
+
+void testRowUpscalerMatchesWholeImageStages() {
+    const auto input = makeNoise<lumos::engine::Rgb8Image>(10, 7, 12345u, 255);
+    for (const int scale_factor : {1, 2, 5}) {
+        lumos::engine::Rgb8Image replicated(10 * scale_factor, 7 * scale_factor);
+        lumos::engine::upscaleNearestNeighbor(input.view(), scale_factor, replicated.mutableView());
+        lumos::engine::Rgb8Image rows(10 * scale_factor, 7 * scale_factor);
+        lumos::engine::upscale(input.view(), ResampleFilter::kNearest, std::uint8_t {255}, rows.mutableView());
+        lumos::tests::require(
+            samePixels(rows, replicated), "row upscaler should replicate at " + std::to_string(scale_factor) + "x");
+    }
+    lumos::engine::Rgb8Image resampled(15, 10);
+    lumos::engine::resample(input.view(), ResampleFilter::kBicubic, std::uint8_t {255}, resampled.mutableView());
+    lumos::engine::Rgb8Image rows(15, 10);
+    lumos::engine::upscale(input.view(), ResampleFilter::kBicubic, std::uint8_t {255}, rows.mutableView());
+    lumos::tests::require(samePixels(rows, resampled), "row upscaler should resample non-integer scales");
+}
+
+}  // namespace
+
+int main() {
+    try {
+        testMatchesPerPixelReference();
+        testRowUpscalerMatchesWholeImageStages();
+        std::cout << "UpscaleTests passed\n";
+        return 0;
+    } catch (const std::exception& ex) {
+        std::cerr << "UpscaleTests failed: " << ex.what() << '\n';
+        return 1;
+    }
+}